@@ -1,7 +1,12 @@
 // STL
 #include <cassert>
+#include <iostream>
+#include <sstream>
 #include <string.h>
 #include <vector>
+#include <random>
+#include <algorithm>
+#include <ctime>
 
 // Boost
 #include <boost/array.hpp>
@@ -25,43 +30,91 @@ client::client(
 	m_UDPsocket(ioService),
 	m_serverPort(inServerPort),
 	m_terminate(false),
-	m_sequenceNumber(0)
+	m_sequenceNumber(0),
+	m_getIntervalMilliseconds(constants::updateIntervalMilliseconds),
+	m_getRequested(false),
+	m_trafficSinceLastGet(false),
+	m_renderer("Enter a message: "),
+	m_outbox(inUsername + constants::outboxFileExtension)
 {
 	this->m_username = inUsername;
+
+	// never reuse a sequence number still waiting in the outbox
+	this->m_sequenceNumber.store(
+		this->m_outbox.viewHighestSequenceNumber());
+
 	this->m_serverIndex = inServerIndex;
 
 	this->m_activeProtocol =
 		client::Protocol::p_UDP;
 
-	const std::string serverAddress = 
-		constants::serverHostName(this->m_serverIndex);
+	// identifies this client's session to whichever server it fails over to
+	std::random_device randomDevice;
+	std::stringstream resumeToken;
 
-	const std::string serverPort =
-		std::to_string(inServerPort);
+	resumeToken << std::hex << randomDevice() << randomDevice();
+	this->m_resumeToken = resumeToken.str();
 
-	boost::asio::ip::udp::resolver::query serverQuery(
-		boost::asio::ip::udp::v4(),
-		serverAddress,
-		serverPort);
+	const boost::chrono::steady_clock::time_point now =
+		boost::chrono::steady_clock::now();
 
-	this->m_serverEndPoint =
-		*this->m_resolver.resolve(serverQuery);
+	for(int8_t i = 0; i < constants::numberOfServers; i++)
+	{
+		const std::string serverAddress = 
+			constants::serverHostName(i);
 
-	this->m_UDPsocket.open(
-		boost::asio::ip::udp::v4());
+		const std::string serverPort = (i == this->m_serverIndex)
+			? std::to_string(inServerPort)
+			: std::to_string(constants::serverIndexToListeningPort(i));
 
-	std::string destination = constants::serverIndexToServerName(this->m_serverIndex);
-	std::string initiateMessage = this->m_username + " has connected.";
+		boost::asio::ip::udp::resolver::query serverQuery(
+			boost::asio::ip::udp::v4(),
+			serverAddress,
+			serverPort);
 
-	dataMessage connectionMessage(
-		this->sequenceNumber(),
-		constants::mt_CLIENT_CONNECT,
-		this->m_username,
-		destination,
-		initiateMessage);
+		// other servers may be unknown on this network, only the chosen one
+		// has to resolve
+		boost::system::error_code resolveError;
+
+		boost::asio::ip::udp::resolver::iterator resolved =
+			this->m_resolver.resolve(serverQuery, resolveError);
+
+		if(i == this->m_serverIndex)
+		{
+			if(resolveError)
+			{
+				throw boost::system::system_error(resolveError);
+			}
+
+			this->m_serverEndPoint = *resolved;
+		}
+		else if(resolveError)
+		{
+			continue;
+		}
+
+		serverCandidate candidate;
+		candidate.index = i;
+		candidate.endpoint = *resolved;
+		candidate.pingSequenceNumber = -1;
+		candidate.timePingSent = boost::chrono::steady_clock::time_point();
+		candidate.timeOfLastResponse = (i == this->m_serverIndex)
+			? now
+			: boost::chrono::steady_clock::time_point();
+		candidate.roundTripMicroseconds = -1;
+		candidate.cookie = "";
+		candidate.capabilities = 0;
+
+		this->m_serverCandidates.push_back(candidate);
+	}
 
-	this->sendOverUDP(
-		connectionMessage);
+	this->m_UDPsocket.open(
+		boost::asio::ip::udp::v4());
+
+	// the server answers with a cookie, and the connect is sent again
+	this->sendConnect(
+		this->m_serverEndPoint,
+		"");
 };
 
 //-------------------------------------------------------------------------- run
@@ -71,10 +124,22 @@ client::client(
 //------------------------------------------------------------------------------
 void client::run()
 {
+	// thread for writing to the console
+	this->m_threads.create_thread(
+		boost::bind(&consoleRenderer::renderLoop, &this->m_renderer));
+
 	// thread for getting the server to relay messages to this client
 	this->m_threads.create_thread(
 		boost::bind(&client::getLoop, this));
 
+	// thread for draining the outbox to the server
+	this->m_threads.create_thread(
+		boost::bind(&client::outboxLoop, this));
+
+	// thread for watching the server and failing over
+	this->m_threads.create_thread(
+		boost::bind(&client::pingLoop, this));
+
 	// thread for input/sending messages
 	this->m_threads.create_thread(
 		boost::bind(&client::inputLoop, this));
@@ -88,8 +153,11 @@ void client::run()
 
 //---------------------------------------------------------------------- getLoop
 // Implementation notes:
-//  The client periodically sends a get to the server, which will cause the
-//  server to send all messages destined for this client.
+//  The client sends a get to the server, which will cause the server to send
+//  all messages destined for this client. The interval between gets doubles
+//  after every get that brought nothing, up to the ceiling, and drops to the
+//  floor as soon as messages flow. A pending hint from the server cuts the
+//  wait short.
 //------------------------------------------------------------------------------
 void client::getLoop()
 {
@@ -97,25 +165,231 @@ void client::getLoop()
 	{
 		try
 		{
+			const std::vector<std::string> getFields({
+				"cookie=" + this->viewServerCookie(),
+				dataMessage::capabilitiesField(constants::localCapabilities)});
+
 			dataMessage connectionMessage(
 				this->sequenceNumber(),
 				constants::mt_CLIENT_GET,
 				this->m_username,
 				constants::serverIndexToServerName(this->m_serverIndex),
-				"blank");
+				dataMessage::createServerSyncPayload(getFields));
 
 			this->sendOverUDP(
 				connectionMessage);
 		}
 		catch(std::exception& exception)
 		{
-			std::cout << exception.what() << std::endl;
+			this->m_renderer.queueLine(exception.what());
+		}
+
+		boost::unique_lock<boost::mutex> lock(
+			this->m_getMutex);
+
+		if(!this->m_getRequested)
+		{
+			this->m_getCondition.timed_wait(
+				lock,
+				boost::posix_time::millisec(
+				this->m_getIntervalMilliseconds));
+		}
+
+		if(!this->m_trafficSinceLastGet)
+		{
+			this->m_getIntervalMilliseconds = std::min<uint16_t>(
+				this->m_getIntervalMilliseconds * 2,
+				constants::getIntervalMaximumMilliseconds);
+		}
+
+		this->m_getRequested = false;
+		this->m_trafficSinceLastGet = false;
+	}
+};
+
+//------------------------------------------------------------------- requestGet
+// Implementation notes:
+//  Only an immediate request wakes the loop, resetting the interval takes
+//  effect from the next wait
+//------------------------------------------------------------------------------
+void client::requestGet(
+	const bool& inImmediately)
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_getMutex);
+
+	this->m_trafficSinceLastGet = true;
+	this->m_getIntervalMilliseconds =
+		constants::getIntervalMinimumMilliseconds;
+
+	if(inImmediately)
+	{
+		this->m_getRequested = true;
+		this->m_getCondition.notify_one();
+	}
+};
+
+//------------------------------------------------------------------- outboxLoop
+// Implementation notes:
+//  While the server is unreachable the sends fail or go unacknowledged, and
+//  the messages simply stay in the outbox. Once acknowledgements come back,
+//  each one wakes this loop to send the next window, so a backlog drains in
+//  a few round trips rather than one datagram per message. A server that
+//  has not announced batches gets each message in a datagram of its own.
+//------------------------------------------------------------------------------
+void client::outboxLoop()
+{
+	while(!this->m_terminate)
+	{
+		const std::vector<dataMessage> dueMessages =
+			this->m_outbox.takeDueMessages();
+
+		const bool serverAcceptsBatch =
+			(this->viewServerCapabilities() & constants::cap_BATCH) != 0;
+
+		std::vector<dataMessage> batch;
+		size_t batchLength = 0;
+
+		for(size_t i = 0; i <= dueMessages.size(); i++)
+		{
+			const size_t messageLength = (i < dueMessages.size())
+				? dueMessages[i].asCharVector().size()
+				: 0;
+
+			const bool batchIsFull = !batch.empty()
+				&& ((i == dueMessages.size())
+					|| !serverAcceptsBatch
+					|| (batchLength + messageLength > constants::outboxMaximumBatchLength));
+
+			if(batchIsFull)
+			{
+				try
+				{
+					this->m_UDPsocket.send_to(
+						boost::asio::buffer(serverAcceptsBatch
+							? dataMessage::createBatch(batch)
+							: batch.front().asCharVector()),
+						this->viewServerEndpoint());
+				}
+				catch(std::exception& exception)
+				{
+					// server unreachable, the messages stay in the outbox
+				}
+
+				batch.clear();
+				batchLength = 0;
+			}
+
+			if(i < dueMessages.size())
+			{
+				batch.push_back(dueMessages[i]);
+				batchLength += messageLength;
+			}
+		}
+
+		boost::unique_lock<boost::mutex> lock(
+			this->m_outboxMutex);
+
+		this->m_outboxCondition.timed_wait(
+			lock,
+			boost::posix_time::millisec(
+			constants::outboxFlushIntervalMilliseconds));
+	}
+};
+
+//--------------------------------------------------------------------- pingLoop
+// Implementation notes:
+//  The get and ack traffic already flowing is what shows the current server
+//  is alive, so a busy client never pings it. Going by the get interval
+//  means an idle client pings as rarely as it polls, while a client that
+//  just sent something notices a dead server within twice the failover
+//  timeout. A ping counts as unanswered once nothing at all arrived since.
+//------------------------------------------------------------------------------
+void client::pingLoop()
+{
+	const boost::chrono::milliseconds failoverTimeout(
+		constants::failoverTimeoutMilliseconds);
+
+	while(!this->m_terminate)
+	{
+		uint16_t getIntervalMilliseconds = 0;
+
+		{
+			boost::lock_guard<boost::mutex> lock(
+				this->m_getMutex);
+
+			getIntervalMilliseconds = this->m_getIntervalMilliseconds;
+		}
+
+		const boost::chrono::milliseconds silenceBeforePing(std::max<uint16_t>(
+			constants::failoverTimeoutMilliseconds,
+			getIntervalMilliseconds));
+
+		const boost::chrono::milliseconds probeInterval(std::max<uint16_t>(
+			constants::candidateProbeIntervalMilliseconds,
+			getIntervalMilliseconds));
+
+		{
+			boost::lock_guard<boost::mutex> lock(
+				this->m_serverMutex);
+
+			const boost::chrono::steady_clock::time_point now =
+				boost::chrono::steady_clock::now();
+
+			for(serverCandidate& currentCandidate : this->m_serverCandidates)
+			{
+				const bool isCurrentServer =
+					(currentCandidate.index == this->m_serverIndex);
+
+				const bool pingUnanswered =
+					(currentCandidate.timePingSent > currentCandidate.timeOfLastResponse);
+
+				if(isCurrentServer
+					&& (pingUnanswered
+						|| (now - currentCandidate.timeOfLastResponse < silenceBeforePing)))
+				{
+					continue;
+				}
+
+				if(!isCurrentServer
+					&& (now - currentCandidate.timePingSent < probeInterval))
+				{
+					continue;
+				}
+
+				currentCandidate.pingSequenceNumber = this->sequenceNumber();
+				currentCandidate.timePingSent = now;
+
+				const dataMessage pingMessage(
+					currentCandidate.pingSequenceNumber,
+					constants::MessageType::mt_PING,
+					this->m_username,
+					constants::serverIndexToServerName(currentCandidate.index),
+					"blank");
+
+				boost::system::error_code ignoredError;
+
+				this->m_UDPsocket.send_to(
+					boost::asio::buffer(pingMessage.asCharVector()),
+					currentCandidate.endpoint, 0, ignoredError);
+			}
+
+			for(const serverCandidate& currentCandidate : this->m_serverCandidates)
+			{
+				if((currentCandidate.index == this->m_serverIndex)
+					&& (currentCandidate.timePingSent > currentCandidate.timeOfLastResponse)
+					&& (now - currentCandidate.timePingSent > failoverTimeout))
+				{
+					this->failOver(
+						probeInterval);
+					break;
+				}
+			}
 		}
 
-		// sleep
 		boost::this_thread::sleep(
 			boost::posix_time::millisec(
-			constants::updateIntervalMilliseconds));
+			constants::livenessCheckIntervalMilliseconds));
 	}
 };
 
@@ -130,13 +404,14 @@ void client::inputLoop()
 	{
 		std::string chatInput("");
 
-		// communication with the server
-		std::cout << "Enter a message: " << std::endl;
-		std::getline(std::cin, chatInput);
+		// communication with the server, the renderer draws the prompt and
+		// echoes what is typed so it can redraw it with every frame
+		this->m_renderer.readLine(chatInput);
+		this->m_renderer.requestPrompt();
 
 		// By default, destination and message type are "broadcast"
 		// and "chat", respectively
-		std::string destination = "broadcast";
+		std::string destination = constants::broadcastDestination;
 		constants::MessageType messageType = constants::MessageType::mt_UNDEFINED;
 
 		std::stringstream ss;
@@ -153,12 +428,69 @@ void client::inputLoop()
 			std::getline(ss, chatInput);
 			messageType = constants::MessageType::mt_CLIENT_SEND;
 		}
+		else if((temp == "/broadcast") || (temp == "/b"))
+		{
+			destination = constants::broadcastDestination;
+
+			std::getline(ss, chatInput);
+			messageType = constants::MessageType::mt_CLIENT_SEND;
+		}
+		else if(temp == "/admin")
+		{
+			// admin commands go straight to the current server, which
+			// replies with the outcome instead of an acknowledgement
+			std::string command("");
+			std::getline(ss >> std::ws, command);
+
+			if(command.empty())
+			{
+				this->m_renderer.queueLine("Invalid command. (Use '/admin stats',"
+					" '/admin profile start' or '/admin profile stop' on the server's host)");
+				continue;
+			}
+
+			this->sendOverUDP(dataMessage(
+				this->sequenceNumber(),
+				constants::MessageType::mt_ADMIN,
+				this->m_username,
+				constants::serverIndexToServerName(this->m_serverIndex),
+				command));
+			continue;
+		}
 		else
 		{
-			std::cout << "Invalid command. (Use '/m' || '/message' <target> <message>" << std::endl;
+			this->m_renderer.queueLine("Invalid command. (Use '/m' || '/message' <target> [@<time>] <message>"
+				" or '/b' || '/broadcast' [@<time>] <message>)");
 			continue;
 		}
 
+		// a leading @<time> makes it a scheduled send, the server holds the
+		// message until then
+		std::stringstream messageStream;
+		messageStream << chatInput;
+
+		std::string deliveryTime("");
+		messageStream >> deliveryTime;
+
+		if(!deliveryTime.empty() && (deliveryTime[0] == '@'))
+		{
+			const int64_t dueMilliseconds = client::parseDeliveryTime(
+				deliveryTime.substr(1));
+
+			if(dueMilliseconds < 0)
+			{
+				this->m_renderer.queueLine("Invalid time. (Use '@' followed by a delay"
+					" such as 30s, 15m, 2h or 1d, or a time of day such as 18:30)");
+				continue;
+			}
+
+			std::string remainingText("");
+			std::getline(messageStream, remainingText);
+
+			chatInput = std::to_string(dueMilliseconds) + remainingText;
+			messageType = constants::MessageType::mt_CLIENT_SCHEDULE;
+		}
+
 		dataMessage currentMessage(
 			this->sequenceNumber(),
 			messageType,
@@ -169,6 +501,7 @@ void client::inputLoop()
 		if(currentMessage.viewPayload() == "/exit")
 		{
 			this->m_terminate = true;
+			this->m_renderer.terminate();
 
 			std::string disconnectMessage =
 				this->m_username + " has disconnected.";
@@ -189,7 +522,11 @@ void client::inputLoop()
 			{
 				case client::Protocol::p_UDP:
 				{
-					this->sendOverUDP(currentMessage);
+					this->m_outbox.append(currentMessage);
+					this->m_outboxCondition.notify_one();
+
+					// a reply is likely, poll at the floor again
+					this->requestGet(false);
 					break;
 				}
 				case client::Protocol::p_BLUETOOTH:
@@ -208,6 +545,333 @@ void client::inputLoop()
 	}
 };
 
+//--------------------------------------------------------------------- failOver
+// Implementation notes:
+//  A candidate counts as responsive if it answered within the last probe
+//  interval plus the failover timeout. If none is, the next server along the
+//  chain is tried blind, and the next failover moves on again from there.
+//------------------------------------------------------------------------------
+void client::failOver(
+	const boost::chrono::milliseconds& inProbeInterval)
+{
+	const boost::chrono::steady_clock::time_point now =
+		boost::chrono::steady_clock::now();
+
+	const boost::chrono::milliseconds responsiveWindow(
+		inProbeInterval
+		+ boost::chrono::milliseconds(constants::failoverTimeoutMilliseconds));
+
+	serverCandidate* currentServer = nullptr;
+	serverCandidate* bestCandidate = nullptr;
+	int64_t bestScore = 0;
+
+	for(serverCandidate& currentCandidate : this->m_serverCandidates)
+	{
+		if(currentCandidate.index == this->m_serverIndex)
+		{
+			currentServer = &currentCandidate;
+			continue;
+		}
+
+		if((currentCandidate.roundTripMicroseconds < 0)
+			|| (now - currentCandidate.timeOfLastResponse > responsiveWindow))
+		{
+			continue;
+		}
+
+		const int64_t score = currentCandidate.roundTripMicroseconds
+			+ (currentCandidate.load.score() * constants::failoverLoadWeightMicroseconds);
+
+		if((bestCandidate == nullptr) || (score < bestScore))
+		{
+			bestCandidate = &currentCandidate;
+			bestScore = score;
+		}
+	}
+
+	if(bestCandidate == nullptr)
+	{
+		for(int8_t i = 1; (i < constants::numberOfServers) && (bestCandidate == nullptr); i++)
+		{
+			const int8_t nextIndex =
+				(this->m_serverIndex + i) % constants::numberOfServers;
+
+			for(serverCandidate& currentCandidate : this->m_serverCandidates)
+			{
+				if(currentCandidate.index == nextIndex)
+				{
+					bestCandidate = &currentCandidate;
+					break;
+				}
+			}
+		}
+	}
+
+	if(bestCandidate == nullptr)
+	{
+		// the only server this client knows of, keep trying it
+		currentServer->timeOfLastResponse = now;
+		return;
+	}
+
+	this->m_renderer.queueLine("Lost contact with "
+		+ constants::serverIndexToServerName(this->m_serverIndex)
+		+ ", switching to "
+		+ constants::serverIndexToServerName(bestCandidate->index) + ".");
+
+	this->switchToServer(
+		*bestCandidate);
+};
+
+//--------------------------------------------------------------- switchToServer
+// Implementation notes:
+//  The new server is given a full failover timeout before it is judged
+//------------------------------------------------------------------------------
+void client::switchToServer(
+	serverCandidate& inCandidate)
+{
+	this->m_serverIndex = inCandidate.index;
+	this->m_serverEndPoint = inCandidate.endpoint;
+	this->m_serverPort = inCandidate.endpoint.port();
+
+	inCandidate.timeOfLastResponse =
+		boost::chrono::steady_clock::now();
+
+	this->sendConnect(
+		this->m_serverEndPoint,
+		inCandidate.cookie);
+
+	// the new server never saw the messages in flight to the old one
+	this->m_outbox.resendPending();
+	this->m_outboxCondition.notify_one();
+
+	this->requestGet(true);
+};
+
+//--------------------------------------------------------------- followRedirect
+// Implementation notes:
+//  Only the current server may move the client, a late redirect from a
+//  server already left behind is ignored
+//------------------------------------------------------------------------------
+void client::followRedirect(
+	const dataMessage& inRedirectMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_serverMutex);
+
+	const std::string targetIndex =
+		inRedirectMessage.viewPayloadField("server");
+
+	if((inSenderEndpoint != this->m_serverEndPoint) || targetIndex.empty())
+	{
+		return;
+	}
+
+	for(serverCandidate& currentCandidate : this->m_serverCandidates)
+	{
+		if((currentCandidate.index == std::stoi(targetIndex))
+			&& (currentCandidate.index != this->m_serverIndex))
+		{
+			this->m_renderer.queueLine(
+				constants::serverIndexToServerName(this->m_serverIndex)
+				+ " is busy, switching to "
+				+ constants::serverIndexToServerName(currentCandidate.index) + ".");
+
+			this->switchToServer(
+				currentCandidate);
+			break;
+		}
+	}
+};
+
+//------------------------------------------------------------------ sendConnect
+// Implementation notes:
+//  Sent straight to the given endpoint, failOver calls this while holding
+//  the lock viewServerEndpoint takes
+//------------------------------------------------------------------------------
+void client::sendConnect(
+	const boost::asio::ip::udp::endpoint& inServerEndpoint,
+	const std::string& inCookie)
+{
+	std::vector<std::string> connectFields({
+		"token=" + this->m_resumeToken,
+		dataMessage::capabilitiesField(constants::localCapabilities)});
+
+	if(!inCookie.empty())
+	{
+		connectFields.push_back("cookie=" + inCookie);
+	}
+
+	const dataMessage connectionMessage(
+		this->sequenceNumber(),
+		constants::mt_CLIENT_CONNECT,
+		this->m_username,
+		constants::serverIndexToServerName(this->m_serverIndex),
+		dataMessage::createServerSyncPayload(connectFields));
+
+	boost::system::error_code ignoredError;
+
+	this->m_UDPsocket.send_to(
+		boost::asio::buffer(connectionMessage.asCharVector()),
+		inServerEndpoint, 0, ignoredError);
+};
+
+//--------------------------------------------------------- recordServerResponse
+// Implementation notes:
+//  Ping replies echo the sequence number of the ping, a stale reply to an
+//  earlier ping still counts as a sign of life but is not timed. Ping replies
+//  also refresh the cookie, so a failover needs no extra round trip, and the
+//  capabilities, so an upgraded server is used to the full from its next
+//  reply on. A server that never announced the checksum capability is taken
+//  to predate the trailer, its messages are accepted without one.
+//------------------------------------------------------------------------------
+bool client::recordServerResponse(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_serverMutex);
+
+	const boost::chrono::steady_clock::time_point now =
+		boost::chrono::steady_clock::now();
+
+	for(serverCandidate& currentCandidate : this->m_serverCandidates)
+	{
+		if(currentCandidate.endpoint != inSenderEndpoint)
+		{
+			continue;
+		}
+
+		if(!inMessage.viewHasChecksum()
+			&& ((currentCandidate.capabilities & constants::cap_CHECKSUM) != 0))
+		{
+			// the trailer was lost on the way, treat it like a corrupt message
+			return false;
+		}
+
+		currentCandidate.timeOfLastResponse = now;
+
+		const bool answersLatestPing =
+			(inMessage.viewMessageType() == constants::MessageType::mt_PING)
+			&& (inMessage.viewSequenceNumber() == currentCandidate.pingSequenceNumber);
+
+		if(answersLatestPing)
+		{
+			currentCandidate.roundTripMicroseconds =
+				boost::chrono::duration_cast<boost::chrono::microseconds>(
+					now - currentCandidate.timePingSent).count();
+
+			currentCandidate.load = serverLoad(
+				inMessage);
+		}
+
+		const bool carriesCookie =
+			(inMessage.viewMessageType() == constants::MessageType::mt_PING)
+			|| (inMessage.viewMessageType() == constants::MessageType::mt_SERVER_COOKIE);
+
+		if(carriesCookie && !inMessage.viewPayloadField("cookie").empty())
+		{
+			currentCandidate.cookie =
+				inMessage.viewPayloadField("cookie");
+
+			currentCandidate.capabilities =
+				inMessage.viewPayloadCapabilities()
+				& constants::localCapabilities;
+		}
+
+		break;
+	}
+
+	return true;
+};
+
+//------------------------------------------------------------- resendWithCookie
+// Implementation notes:
+//  The server may have dropped the connect as well as the get, so both are
+//  sent again. A connect for a session that already exists only refreshes
+//  it.
+//------------------------------------------------------------------------------
+void client::resendWithCookie(
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	{
+		boost::lock_guard<boost::mutex> lock(
+			this->m_serverMutex);
+
+		if(inSenderEndpoint != this->m_serverEndPoint)
+		{
+			// Do nothing, a server already left behind
+			return;
+		}
+
+		for(const serverCandidate& currentCandidate : this->m_serverCandidates)
+		{
+			if(currentCandidate.index == this->m_serverIndex)
+			{
+				this->sendConnect(
+					this->m_serverEndPoint,
+					currentCandidate.cookie);
+				break;
+			}
+		}
+	}
+
+	this->requestGet(true);
+};
+
+//------------------------------------------------------------- viewServerCookie
+// Implementation notes:
+//  Copies under the lock, ping replies keep replacing the cookie
+//------------------------------------------------------------------------------
+std::string client::viewServerCookie()
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_serverMutex);
+
+	for(const serverCandidate& currentCandidate : this->m_serverCandidates)
+	{
+		if(currentCandidate.index == this->m_serverIndex)
+		{
+			return currentCandidate.cookie;
+		}
+	}
+
+	return "";
+};
+
+//------------------------------------------------------- viewServerCapabilities
+// Implementation notes:
+//  Copies under the lock, ping replies keep replacing the capabilities
+//------------------------------------------------------------------------------
+uint32_t client::viewServerCapabilities()
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_serverMutex);
+
+	for(const serverCandidate& currentCandidate : this->m_serverCandidates)
+	{
+		if(currentCandidate.index == this->m_serverIndex)
+		{
+			return currentCandidate.capabilities;
+		}
+	}
+
+	return 0;
+};
+
+//----------------------------------------------------------- viewServerEndpoint
+// Implementation notes:
+//  Copies under the lock, since failOver may replace the endpoint
+//------------------------------------------------------------------------------
+boost::asio::ip::udp::endpoint client::viewServerEndpoint()
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_serverMutex);
+
+	return this->m_serverEndPoint;
+};
+
 //------------------------------------------------------------------ sendOverUDP
 // Implementation notes:
 //  Sends a message to the sever over UDP
@@ -217,7 +881,7 @@ void client::sendOverUDP(
 {
 	this->m_UDPsocket.send_to(
 		boost::asio::buffer(message.asCharVector()),
-		this->m_serverEndPoint);
+		this->viewServerEndpoint());
 };
 
 //------------------------------------------------------------ sendOverBluetooth
@@ -245,108 +909,218 @@ void client::receiveLoop()
 
 //--------------------------------------------------------------- receiveOverUDP
 // Implementation notes:
-//  Listen for any messages the server sends back over UDP
+//  Listen for any messages the server sends back over UDP. A batch, as sent
+//  in answer to a get, is handled message by message, and may come
+//  compressed since this client announces it accepts that.
 //------------------------------------------------------------------------------
 void client::receiveOverUDP()
 {
 	try
 	{
-		const uint16_t arbitraryLength = 256;
-
-		std::vector<char> receivedMessage(arbitraryLength);
+		std::vector<char> receivedMessage(constants::maximumDatagramLength);
+		boost::asio::ip::udp::endpoint senderEndpoint;
 
 		size_t incomingMessageLength =
 			this->m_UDPsocket.receive_from(
 				boost::asio::buffer(receivedMessage),
-				this->m_serverEndPoint);
+				senderEndpoint);
 
-		dataMessage message(
-			receivedMessage);
+		receivedMessage.resize(incomingMessageLength);
 
 		if(incomingMessageLength > 0)
 		{
-			constants::MessageType messageType = 
-				message.viewMessageType();
+			std::vector<dataMessage> messages;
 
-			switch(messageType)
+			if(dataMessage::isCompressedBatch(receivedMessage))
 			{
-				case constants::MessageType::mt_UNDEFINED:
-				{
-					assert(false);
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_CONNECT:
-				{
-					assert(false);
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_DISCONNECT:
-				{
-					assert(false);
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_SEND:
-				{
-					assert(false);
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_GET:
-				{
-					assert(false);
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_ACK:
-				{
-					assert(false);
-					break;
-				}
-				case constants::MessageType::mt_SERVER_SEND:
-				{
-					std::cout << message.viewSourceIdentifier()
-						<< " says: " << message.viewPayload() << std::endl;
-
-					dataMessage ackMessage(
-						message.viewSequenceNumber(),
-						constants::mt_CLIENT_ACK,
-						this->m_username,
-						constants::serverIndexToServerName(this->m_serverIndex),
-						"blank");
+				messages = dataMessage::parseCompressedBatch(receivedMessage);
+			}
+			else if(dataMessage::isBatch(receivedMessage))
+			{
+				messages = dataMessage::parseBatch(receivedMessage);
+			}
+			else
+			{
+				messages.push_back(dataMessage(receivedMessage));
+			}
 
-					this->sendOverUDP(ackMessage);
-					break;
-				}
-				case constants::MessageType::mt_SERVER_ACK:
-				{
-					assert(false);
-					break;
-				}
-				case constants::MessageType::mt_SERVER_SYNC:
-				{
-					// Syncs are only used by servers, never by clients
-					assert(false);
-					break;
-				}
-				case constants::MessageType::mt_PING:
-				{
-					// #TODO necessary?
-					break;
-				}
-				default:
+			for(const dataMessage& currentMessage : messages)
+			{
+				if(!this->recordServerResponse(
+					currentMessage,
+					senderEndpoint))
 				{
-					// Programming error, unexpected type
-					assert(false);
+					continue;
 				}
+
+				this->dispatchMessage(
+					currentMessage,
+					senderEndpoint);
 			}
 		}
-
-		// sleep
-		boost::this_thread::sleep(
-			boost::posix_time::millisec(
-			constants::updateIntervalMilliseconds));
 	}
 	catch(std::exception& exception)
 	{
-		std::cout << exception.what() << std::endl;
+		this->m_renderer.queueLine(exception.what());
+	}
+};
+
+//-------------------------------------------------------------- dispatchMessage
+// Implementation notes:
+//  Acts on a single message received from a server
+//------------------------------------------------------------------------------
+void client::dispatchMessage(
+	const dataMessage& message,
+	const boost::asio::ip::udp::endpoint& senderEndpoint)
+{
+	constants::MessageType messageType = 
+		message.viewMessageType();
+
+	switch(messageType)
+	{
+		case constants::MessageType::mt_UNDEFINED:
+		{
+			// Do nothing, a message type only newer servers know
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_CONNECT:
+		{
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_DISCONNECT:
+		{
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_SEND:
+		{
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_GET:
+		{
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_ACK:
+		{
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_SEND:
+		{
+			this->m_renderer.queueLine(message.viewSourceIdentifier()
+				+ " says: " + message.viewPayload());
+
+			// the sequence number is the id of the server's mailbox entry
+			dataMessage ackMessage(
+				message.viewSequenceNumber(),
+				constants::mt_CLIENT_ACK,
+				this->m_username,
+				constants::serverIndexToServerName(this->m_serverIndex),
+				"blank");
+
+			this->sendOverUDP(ackMessage);
+
+			// a conversation is going, poll at the floor again
+			this->requestGet(false);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_ACK:
+		{
+			for(const std::string& acknowledged : message.viewServerSyncPayload())
+			{
+				this->m_outbox.acknowledge(
+					std::stoll(acknowledged));
+			}
+
+			this->m_outboxCondition.notify_one();
+			break;
+		}
+		case constants::MessageType::mt_SERVER_SYNC:
+		{
+			// Syncs are only used by servers, never by clients
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_PING:
+		{
+			// Ping replies are timed by recordServerResponse, the current
+			// server also says whether messages are waiting for us
+			const std::string pendingMessages =
+				message.viewPayloadField("pending");
+
+			if(!pendingMessages.empty()
+				&& (std::stoll(pendingMessages) > 0)
+				&& (senderEndpoint == this->viewServerEndpoint()))
+			{
+				this->requestGet(true);
+			}
+			break;
+		}
+		case constants::MessageType::mt_SERVER_NACK:
+		{
+			// NACKs are only used by servers, never by clients
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_LOAD:
+		{
+			// Load reports are only used by servers, never by clients
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_REDIRECT:
+		{
+			this->followRedirect(
+				message,
+				senderEndpoint);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_PENDING:
+		{
+			// more messages than fit one get response
+			this->requestGet(true);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_COOKIE:
+		{
+			// the server wants proof we receive at our address
+			this->resendWithCookie(
+				senderEndpoint);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_SCHEDULE:
+		{
+			// scheduled sends are only handled by servers
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_HELLO:
+		{
+			// hellos are only exchanged between servers
+			assert(false);
+			break;
+		}
+		case constants::MessageType::mt_ADMIN:
+		{
+			// statistics come one line per message type
+			std::stringstream outcome(message.viewPayload());
+			std::string line("");
+
+			while(std::getline(outcome, line))
+			{
+				this->m_renderer.queueLine(message.viewSourceIdentifier()
+					+ " admin: " + line);
+			}
+			break;
+		}
+		default:
+		{
+			// Programming error, unexpected type
+			assert(false);
+		}
 	}
 };
 
@@ -361,9 +1135,90 @@ void client::receiveOverBluetooth()
 
 //--------------------------------------------------------------- sequenceNumber
 // Implementation notes:
-//  Increments the sequence number every time it is used, self explanatory.
+//  Increments the sequence number every time it is used. The input, get
+//  and ping loops all take numbers, so the increment is atomic and the
+//  number is returned by value, never two of them alike.
+//------------------------------------------------------------------------------
+int64_t client::sequenceNumber()
+{
+	return this->m_sequenceNumber.fetch_add(1) + 1;
+};
+
+//------------------------------------------------------------ parseDeliveryTime
+// Implementation notes:
+//  A time of day is resolved with the local calendar, so mktime takes care
+//  of the day, month and daylight saving rollovers.
 //------------------------------------------------------------------------------
-const int64_t& client::sequenceNumber()
+int64_t client::parseDeliveryTime(
+	const std::string& inDeliveryTime)
 {
-	return ++this->m_sequenceNumber;
+	const std::time_t now = std::time(nullptr);
+
+	const size_t colon = inDeliveryTime.find(':');
+
+	try
+	{
+		if(colon != std::string::npos)
+		{
+			size_t hourLength = 0;
+			size_t minuteLength = 0;
+
+			const int hour = std::stoi(inDeliveryTime.substr(0, colon), &hourLength);
+			const int minute = std::stoi(inDeliveryTime.substr(colon + 1), &minuteLength);
+
+			if((hourLength != colon)
+				|| (minuteLength != inDeliveryTime.size() - colon - 1)
+				|| (hour < 0) || (hour > 23) || (minute < 0) || (minute > 59))
+			{
+				return -1;
+			}
+
+			std::tm deliveryDate = *std::localtime(&now);
+			deliveryDate.tm_hour = hour;
+			deliveryDate.tm_min = minute;
+			deliveryDate.tm_sec = 0;
+			deliveryDate.tm_isdst = -1;
+
+			std::time_t deliveryTime = std::mktime(&deliveryDate);
+
+			if(deliveryTime <= now)
+			{
+				deliveryDate.tm_mday++;
+				deliveryDate.tm_isdst = -1;
+				deliveryTime = std::mktime(&deliveryDate);
+			}
+
+			return static_cast<int64_t>(deliveryTime) * 1000;
+		}
+
+		size_t amountLength = 0;
+
+		const int64_t amount = std::stoll(inDeliveryTime, &amountLength);
+
+		if((amount < 0) || (amountLength + 1 != inDeliveryTime.size()))
+		{
+			return -1;
+		}
+
+		// seconds per unit, in the order of the unit characters
+		const std::string units("smhd");
+		const int64_t unitSeconds[] = {1, 60, 60 * 60, 24 * 60 * 60};
+
+		const size_t unit = units.find(inDeliveryTime.back());
+
+		if(unit == std::string::npos)
+		{
+			return -1;
+		}
+
+		const int64_t nowMilliseconds =
+			boost::chrono::duration_cast<boost::chrono::milliseconds>(
+				boost::chrono::system_clock::now().time_since_epoch()).count();
+
+		return nowMilliseconds + amount * unitSeconds[unit] * 1000;
+	}
+	catch(std::exception& exception)
+	{
+		return -1;
+	}
 };
\ No newline at end of file
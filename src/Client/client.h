@@ -3,13 +3,18 @@
 // STL
 #include <vector>
 #include <cstdint>
+#include <atomic>
 
 // Boost
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
+#include <boost/chrono.hpp>
 
 // Project
 #include "../Common/dataMessage.h"
+#include "../Common/serverLoad.h"
+#include "consoleRenderer.h"
+#include "clientOutbox.h"
 
 class client
 {
@@ -54,7 +59,23 @@ public:
 	void run();
 
 private:
-	
+
+	// A server the client can fail over to. The round trip time is negative
+	// until the server answered a ping, the cookie empty until the server
+	// issued one.
+	struct serverCandidate
+	{
+		int8_t index;
+		boost::asio::ip::udp::endpoint endpoint;
+		int64_t pingSequenceNumber;
+		boost::chrono::steady_clock::time_point timePingSent;
+		boost::chrono::steady_clock::time_point timeOfLastResponse;
+		int64_t roundTripMicroseconds;
+		serverLoad load;
+		std::string cookie;
+		uint32_t capabilities;
+	};
+
 	//------------------------------------------------------------------ getLoop
 	// Brief Description
 	//  The client loop that periodically sends get requests to the server.
@@ -68,6 +89,46 @@ private:
 	//--------------------------------------------------------------------------
 	void getLoop();
 
+	//--------------------------------------------------------------- requestGet
+	// Brief Description
+	//  Drops the get interval back to the floor because messages are
+	//  flowing, and if asked to, makes the get loop send a get right away.
+	//
+	// Method:    requestGet
+	// FullName:  client::requestGet
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const bool& inImmediately
+	//--------------------------------------------------------------------------
+	void requestGet(
+		const bool& inImmediately);
+
+	//--------------------------------------------------------------- outboxLoop
+	// Brief Description
+	//  Drains the outbox. Messages that are due are packed several to a
+	//  datagram and sent, with a bounded number left unacknowledged at any
+	//  time. Woken whenever a message is queued or acknowledged.
+	//
+	// Method:    outboxLoop
+	// FullName:  client::outboxLoop
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void outboxLoop();
+
+	//----------------------------------------------------------------- pingLoop
+	// Brief Description
+	//  Pings the current server once it has gone quiet and probes every
+	//  other server, backing off while the client is idle. Fails over to the
+	//  best ranked candidate when the current server stops responding.
+	//
+	// Method:    pingLoop
+	// FullName:  client::pingLoop
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void pingLoop();
+
 	//---------------------------------------------------------------- inputLoop
 	// Brief Description
 	//  Input loop for getting input from the user via command line. The input
@@ -81,6 +142,138 @@ private:
 	//--------------------------------------------------------------------------
 	void inputLoop();
 
+	//----------------------------------------------------------------- failOver
+	// Brief Description
+	//  Switches to the responsive candidate with the lowest round trip time
+	//  and load, given the interval the candidates are currently probed at.
+	//  Requires m_serverMutex to be held by the caller.
+	//
+	// Method:    failOver
+	// FullName:  client::failOver
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const boost::chrono::milliseconds& inProbeInterval
+	//--------------------------------------------------------------------------
+	void failOver(
+		const boost::chrono::milliseconds& inProbeInterval);
+
+	//----------------------------------------------------------- switchToServer
+	// Brief Description
+	//  Makes the given candidate the current server, connects to it with
+	//  this client's resume token, and resends every message the outbox
+	//  still holds. Requires m_serverMutex to be held by the caller.
+	//
+	// Method:    switchToServer
+	// FullName:  client::switchToServer
+	// Access:    private 
+	// Returns:   void
+	// Parameter: serverCandidate& inCandidate
+	//--------------------------------------------------------------------------
+	void switchToServer(
+		serverCandidate& inCandidate);
+
+	//----------------------------------------------------------- followRedirect
+	// Brief Description
+	//  Moves to the server named in a redirect, sent by a busy server in
+	//  answer to this client's connect.
+	//
+	// Method:    followRedirect
+	// FullName:  client::followRedirect
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inRedirectMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void followRedirect(
+		const dataMessage& inRedirectMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//-------------------------------------------------------------- sendConnect
+	// Brief Description
+	//  Sends a connect to the given server, carrying the resume token so a
+	//  server that already knows this client continues the same session, and
+	//  the cookie the server issued if there is one.
+	//
+	// Method:    sendConnect
+	// FullName:  client::sendConnect
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const boost::asio::ip::udp::endpoint& inServerEndpoint
+	// Parameter: const std::string& inCookie
+	//--------------------------------------------------------------------------
+	void sendConnect(
+		const boost::asio::ip::udp::endpoint& inServerEndpoint,
+		const std::string& inCookie);
+
+	//----------------------------------------------------- recordServerResponse
+	// Brief Description
+	//  Marks the candidate the message came from as alive, and takes the
+	//  round trip time and load from the message if it answers a ping.
+	//  Returns false, recording nothing, for a message without a checksum
+	//  trailer from a candidate that announced the checksum capability.
+	//
+	// Method:    recordServerResponse
+	// FullName:  client::recordServerResponse
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	bool recordServerResponse(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//--------------------------------------------------------- resendWithCookie
+	// Brief Description
+	//  Sends the connect and get again after the current server answered
+	//  with a cookie, because the previous ones carried none or an expired
+	//  one.
+	//
+	// Method:    resendWithCookie
+	// FullName:  client::resendWithCookie
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void resendWithCookie(
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//--------------------------------------------------------- viewServerCookie
+	// Brief Description
+	//  Returns a copy of the cookie the current server issued, empty if it
+	//  has not issued one yet.
+	//
+	// Method:    viewServerCookie
+	// FullName:  client::viewServerCookie
+	// Access:    private 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string viewServerCookie();
+
+	//--------------------------------------------------- viewServerCapabilities
+	// Brief Description
+	//  Returns the capabilities the current server announced that this client
+	//  shares, none if it has not announced any yet.
+	//
+	// Method:    viewServerCapabilities
+	// FullName:  client::viewServerCapabilities
+	// Access:    private 
+	// Returns:   uint32_t
+	//--------------------------------------------------------------------------
+	uint32_t viewServerCapabilities();
+
+	//------------------------------------------------------- viewServerEndpoint
+	// Brief Description
+	//  Returns a copy of the endpoint of the server currently in use, which
+	//  changes when the client fails over.
+	//
+	// Method:    viewServerEndpoint
+	// FullName:  client::viewServerEndpoint
+	// Access:    private 
+	// Returns:   boost::asio::ip::udp::endpoint
+	//--------------------------------------------------------------------------
+	boost::asio::ip::udp::endpoint viewServerEndpoint();
+
 	//-------------------------------------------------------------- sendOverUDP
 	// Brief Description
 	//  Sends messages to the server over UDP.
@@ -130,6 +323,21 @@ private:
 	//--------------------------------------------------------------------------
 	void receiveOverUDP();
 
+	//---------------------------------------------------------- dispatchMessage
+	// Brief Description
+	//  Acts on a single message received from a server.
+	//
+	// Method:    dispatchMessage
+	// FullName:  client::dispatchMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& message
+	// Parameter: const boost::asio::ip::udp::endpoint& senderEndpoint
+	//--------------------------------------------------------------------------
+	void dispatchMessage(
+		const dataMessage& message,
+		const boost::asio::ip::udp::endpoint& senderEndpoint);
+
 	//----------------------------------------------------- receiveOverBluetooth
 	// Brief Description
 	//  Receives messages from the server over Bluetooth.
@@ -145,14 +353,30 @@ private:
 	// Brief Description
 	//  The sequence number for the client. This increments every time it is
 	//  called and can be used to verify which messages were received by
-	//  the server.
+	//  the server. Safe to call from any of the client's threads.
 	//
 	// Method:    sequenceNumber
 	// FullName:  client::sequenceNumber
 	// Access:    private 
-	// Returns:   const int64_t&
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	int64_t sequenceNumber();
+
+	//-------------------------------------------------------- parseDeliveryTime
+	// Brief Description
+	//  Converts the delivery time of a scheduled message to milliseconds since
+	//  the epoch. Accepts a delay such as "90s", "15m", "2h" or "1d", or a
+	//  local time of day "HH:MM", taken as tomorrow once it has passed today.
+	//  Returns -1 if the time can't be parsed.
+	//
+	// Method:    parseDeliveryTime
+	// FullName:  client::parseDeliveryTime
+	// Access:    private static 
+	// Returns:   int64_t
+	// Parameter: const std::string& inDeliveryTime
 	//--------------------------------------------------------------------------
-	const int64_t& sequenceNumber();
+	static int64_t parseDeliveryTime(
+		const std::string& inDeliveryTime);
 
 	// Member Variables
 	boost::asio::ip::udp::socket m_UDPsocket;
@@ -161,8 +385,20 @@ private:
 	boost::thread_group m_threads;
 	client::Protocol m_activeProtocol;
 	bool m_terminate;
-	int64_t m_sequenceNumber;
+	std::atomic<int64_t> m_sequenceNumber;
+	uint16_t m_getIntervalMilliseconds;
+	bool m_getRequested;
+	bool m_trafficSinceLastGet;
+	boost::mutex m_getMutex;
+	boost::condition_variable m_getCondition;
 	std::string m_username;
 	uint16_t m_serverPort;
 	int8_t m_serverIndex;
+	consoleRenderer m_renderer;
+	clientOutbox m_outbox;
+	boost::mutex m_outboxMutex;
+	boost::condition_variable m_outboxCondition;
+	std::vector<serverCandidate> m_serverCandidates;
+	boost::mutex m_serverMutex;
+	std::string m_resumeToken;
 };
\ No newline at end of file
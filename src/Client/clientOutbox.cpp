@@ -0,0 +1,234 @@
+// STL
+#include <string>
+#include <algorithm>
+
+// Project
+#include "clientOutbox.h"
+#include "../Common/constants.h"
+#include "../Common/crc32c.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Each line of the file is either "S <encoded message>" when a message is
+//  stored or "A <sequence number>" when it is acknowledged, prefixed with
+//  its checksum. Replaying the lines in order leaves exactly the pending
+//  messages.
+//------------------------------------------------------------------------------
+clientOutbox::clientOutbox(
+	const std::string& inFilePath) :
+	m_filePath(inFilePath),
+	m_highestSequenceNumber(0)
+{
+	std::ifstream existingFile(inFilePath);
+	std::string line;
+	std::string record;
+
+	while(std::getline(existingFile, line))
+	{
+		if(!crc32c::openLine(line, record))
+		{
+			// a torn last record from a crash, nothing after it was written
+			break;
+		}
+
+		if(record.size() < 2)
+		{
+			continue;
+		}
+
+		try
+		{
+			const std::string recordBody(
+				record.substr(2));
+
+			if(record[0] == 'S')
+			{
+				const pendingMessage storedMessage = {
+					dataMessage(std::vector<char>(recordBody.begin(), recordBody.end())),
+					false,
+					boost::chrono::steady_clock::time_point()};
+
+				const int64_t sequenceNumber =
+					storedMessage.message.viewSequenceNumber();
+
+				this->m_pendingMessages.insert(
+					std::make_pair(sequenceNumber, storedMessage));
+
+				this->m_highestSequenceNumber =
+					std::max(this->m_highestSequenceNumber, sequenceNumber);
+			}
+			else if(record[0] == 'A')
+			{
+				this->m_pendingMessages.erase(
+					std::stoll(recordBody));
+			}
+		}
+		catch(std::exception& exception)
+		{
+			// intact but unreadable, the records after it cannot be trusted
+			break;
+		}
+	}
+
+	existingFile.close();
+
+	this->rewriteFile();
+};
+
+//----------------------------------------------------------------------- append
+// Implementation notes:
+//  Flushed straight away so the message survives the client being closed
+//------------------------------------------------------------------------------
+void clientOutbox::append(
+	const dataMessage& inMessage)
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_mutex);
+
+	const std::vector<char> encodedMessage(
+		inMessage.asCharVector());
+
+	this->m_file << crc32c::sealLine(
+		"S " + std::string(encodedMessage.begin(), encodedMessage.end())) << '\n';
+	this->m_file.flush();
+
+	const pendingMessage newMessage = {
+		inMessage,
+		false,
+		boost::chrono::steady_clock::time_point()};
+
+	this->m_pendingMessages.insert(
+		std::make_pair(inMessage.viewSequenceNumber(), newMessage));
+
+	this->m_highestSequenceNumber = std::max(
+		this->m_highestSequenceNumber,
+		inMessage.viewSequenceNumber());
+};
+
+//------------------------------------------------------------------ acknowledge
+// Implementation notes:
+//  Once nothing is pending the file is cut back to empty
+//------------------------------------------------------------------------------
+void clientOutbox::acknowledge(
+	const int64_t& inSequenceNumber)
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_mutex);
+
+	if(this->m_pendingMessages.erase(inSequenceNumber) == 0)
+	{
+		// Do nothing, duplicate acknowledgement
+		return;
+	}
+
+	if(this->m_pendingMessages.empty())
+	{
+		this->rewriteFile();
+	}
+	else
+	{
+		this->m_file << crc32c::sealLine(
+			"A " + std::to_string(inSequenceNumber)) << '\n';
+		this->m_file.flush();
+	}
+};
+
+//-------------------------------------------------------------- takeDueMessages
+// Implementation notes:
+//  Messages are taken oldest first. Messages in flight, sent recently and
+//  not yet acknowledged, count against the window.
+//------------------------------------------------------------------------------
+std::vector<dataMessage> clientOutbox::takeDueMessages()
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_mutex);
+
+	const boost::chrono::steady_clock::time_point now =
+		boost::chrono::steady_clock::now();
+
+	const boost::chrono::milliseconds retransmitInterval(
+		constants::outboxRetransmitIntervalMilliseconds);
+
+	size_t messagesInFlight = 0;
+
+	for(const std::pair<const int64_t, pendingMessage>& currentEntry : this->m_pendingMessages)
+	{
+		if(currentEntry.second.sent
+			&& (now - currentEntry.second.timeSent < retransmitInterval))
+		{
+			messagesInFlight++;
+		}
+	}
+
+	std::vector<dataMessage> outMessages;
+
+	for(std::pair<const int64_t, pendingMessage>& currentEntry : this->m_pendingMessages)
+	{
+		if(messagesInFlight + outMessages.size() >= constants::outboxWindowMessages)
+		{
+			break;
+		}
+
+		if(!currentEntry.second.sent
+			|| (now - currentEntry.second.timeSent >= retransmitInterval))
+		{
+			currentEntry.second.sent = true;
+			currentEntry.second.timeSent = now;
+
+			outMessages.push_back(currentEntry.second.message);
+		}
+	}
+
+	return outMessages;
+};
+
+//---------------------------------------------------------------- resendPending
+// Implementation notes:
+//  Only the in-memory send state changes, the file holds no send state
+//------------------------------------------------------------------------------
+void clientOutbox::resendPending()
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_mutex);
+
+	for(std::pair<const int64_t, pendingMessage>& currentEntry : this->m_pendingMessages)
+	{
+		currentEntry.second.sent = false;
+	}
+};
+
+//---------------------------------------------------- viewHighestSequenceNumber
+// Implementation notes:
+//  Returns a const reference to the highest sequence number stored
+//------------------------------------------------------------------------------
+const int64_t& clientOutbox::viewHighestSequenceNumber() const
+{
+	return this->m_highestSequenceNumber;
+};
+
+//------------------------------------------------------------------ rewriteFile
+// Implementation notes:
+//  Truncates the file and stores every pending message again
+//------------------------------------------------------------------------------
+void clientOutbox::rewriteFile()
+{
+	if(this->m_file.is_open())
+	{
+		this->m_file.close();
+	}
+
+	this->m_file.open(
+		this->m_filePath,
+		std::ios::out | std::ios::trunc | std::ios::binary);
+
+	for(const std::pair<const int64_t, pendingMessage>& currentEntry : this->m_pendingMessages)
+	{
+		const std::vector<char> encodedMessage(
+			currentEntry.second.message.asCharVector());
+
+		this->m_file << crc32c::sealLine(
+			"S " + std::string(encodedMessage.begin(), encodedMessage.end())) << '\n';
+	}
+
+	this->m_file.flush();
+};
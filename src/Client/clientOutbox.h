@@ -0,0 +1,128 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <cstdint>
+
+// Boost
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+
+// Project
+#include "../Common/dataMessage.h"
+
+class clientOutbox
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Opens the outbox file, restoring every message a previous run of the
+	//  client stored but never got acknowledged.
+	//
+	// Method:    clientOutbox
+	// FullName:  clientOutbox::clientOutbox
+	// Access:    public 
+	// Returns:   
+	// Parameter: const std::string& inFilePath
+	//--------------------------------------------------------------------------
+	clientOutbox(
+		const std::string& inFilePath);
+
+	//------------------------------------------------------------------- append
+	// Brief Description
+	//  Stores a message until the server acknowledges it. The message is
+	//  written to the file before this returns.
+	//
+	// Method:    append
+	// FullName:  clientOutbox::append
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void append(
+		const dataMessage& inMessage);
+
+	//-------------------------------------------------------------- acknowledge
+	// Brief Description
+	//  Removes the message with the given sequence number, the server has
+	//  confirmed receiving it.
+	//
+	// Method:    acknowledge
+	// FullName:  clientOutbox::acknowledge
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int64_t& inSequenceNumber
+	//--------------------------------------------------------------------------
+	void acknowledge(
+		const int64_t& inSequenceNumber);
+
+	//---------------------------------------------------------- takeDueMessages
+	// Brief Description
+	//  Returns the messages that should be sent now: ones never sent, and ones
+	//  sent too long ago without an acknowledgement. No more are returned than
+	//  fit in the window of unacknowledged messages.
+	//
+	// Method:    takeDueMessages
+	// FullName:  clientOutbox::takeDueMessages
+	// Access:    public 
+	// Returns:   std::vector<dataMessage>
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> takeDueMessages();
+
+	//------------------------------------------------------------ resendPending
+	// Brief Description
+	//  Marks every pending message as not yet sent, so the next call to
+	//  takeDueMessages returns them straight away. Used after switching to
+	//  another server, which never saw the messages in flight.
+	//
+	// Method:    resendPending
+	// FullName:  clientOutbox::resendPending
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void resendPending();
+
+	//------------------------------------------------ viewHighestSequenceNumber
+	// Brief Description
+	//  Returns the highest sequence number ever stored in the outbox, so a
+	//  restarted client does not reuse the sequence numbers still pending.
+	//
+	// Method:    viewHighestSequenceNumber
+	// FullName:  clientOutbox::viewHighestSequenceNumber
+	// Access:    public 
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& viewHighestSequenceNumber() const;
+
+private:
+
+	struct pendingMessage
+	{
+		dataMessage message;
+		bool sent;
+		boost::chrono::steady_clock::time_point timeSent;
+	};
+
+	//-------------------------------------------------------------- rewriteFile
+	// Brief Description
+	//  Replaces the file with one holding only the pending messages, which
+	//  keeps the append-only file from growing without bound.
+	//
+	// Method:    rewriteFile
+	// FullName:  clientOutbox::rewriteFile
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void rewriteFile();
+
+	// Member Variables
+	std::string m_filePath;
+	std::ofstream m_file;
+	std::map<int64_t, pendingMessage> m_pendingMessages;
+	int64_t m_highestSequenceNumber;
+	boost::mutex m_mutex;
+};
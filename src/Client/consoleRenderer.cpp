@@ -0,0 +1,387 @@
+// STL
+#include <iostream>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <conio.h>
+#include <io.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+// Project
+#include "consoleRenderer.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The prompt is drawn on the first frame. On Windows the console has to be
+//  told to interpret the escape sequences used to redraw the input line.
+//------------------------------------------------------------------------------
+consoleRenderer::consoleRenderer(
+	const std::string& inPrompt) :
+	m_prompt(inPrompt),
+	m_droppedLines(0),
+	m_promptRequested(true),
+	m_terminate(false),
+	m_lineEditingDisabled(false)
+{
+#ifdef _WIN32
+	this->m_inputIsTerminal = (_isatty(_fileno(stdin)) != 0);
+#else
+	this->m_inputIsTerminal = (isatty(STDIN_FILENO) != 0);
+#endif
+
+#ifdef _WIN32
+	HANDLE outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+	DWORD outputMode = 0;
+
+	if(GetConsoleMode(outputHandle, &outputMode))
+	{
+		SetConsoleMode(
+			outputHandle,
+			outputMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+	}
+#endif
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  A client stopped while waiting for input would otherwise leave the shell
+//  without echo
+//------------------------------------------------------------------------------
+consoleRenderer::~consoleRenderer()
+{
+	this->setLineEditing(true);
+};
+
+//--------------------------------------------------------------------- readLine
+// Implementation notes:
+//  Input that is not a terminal, a pipe or a file, is read a line at a time
+//  as before, there is nothing on the screen to redraw. The terminal's line
+//  editing is only off while a line is being read.
+//------------------------------------------------------------------------------
+bool consoleRenderer::readLine(
+	std::string& outLine)
+{
+	if(!this->m_inputIsTerminal)
+	{
+		return static_cast<bool>(std::getline(std::cin, outLine));
+	}
+
+	this->setLineEditing(false);
+
+	int key = this->readKey();
+
+	while((key >= 0) && !this->echoInput(key))
+	{
+		key = this->readKey();
+	}
+
+	this->setLineEditing(true);
+
+	boost::lock_guard<boost::mutex> lock(
+		this->m_outputMutex);
+
+	outLine.swap(this->m_pendingInput);
+	this->m_pendingInput.clear();
+
+	return (key >= 0);
+};
+
+//-------------------------------------------------------------------- queueLine
+// Implementation notes:
+//  Only wakes the render loop, the write itself happens on its thread
+//------------------------------------------------------------------------------
+void consoleRenderer::queueLine(
+	const std::string& inLine)
+{
+	{
+		boost::lock_guard<boost::mutex> lock(
+			this->m_queueMutex);
+
+		if(this->m_queuedLines.size() >= constants::renderQueueMaximumLines)
+		{
+			this->m_queuedLines.pop_front();
+			this->m_droppedLines++;
+		}
+
+		this->m_queuedLines.push_back(inLine);
+	}
+
+	this->m_queueCondition.notify_one();
+};
+
+//---------------------------------------------------------------- requestPrompt
+// Implementation notes:
+//  An empty frame still redraws the prompt
+//------------------------------------------------------------------------------
+void consoleRenderer::requestPrompt()
+{
+	{
+		boost::lock_guard<boost::mutex> lock(
+			this->m_queueMutex);
+
+		this->m_promptRequested = true;
+	}
+
+	this->m_queueCondition.notify_one();
+};
+
+//------------------------------------------------------------------- renderLoop
+// Implementation notes:
+//  Sleeps until there is something to draw, draws it, then waits out the
+//  rest of the render interval so a busy room is drawn in a few large
+//  writes instead of one write per message.
+//------------------------------------------------------------------------------
+void consoleRenderer::renderLoop()
+{
+	while(true)
+	{
+		{
+			boost::unique_lock<boost::mutex> lock(
+				this->m_queueMutex);
+
+			while(!this->m_terminate
+				&& this->m_queuedLines.empty()
+				&& !this->m_promptRequested)
+			{
+				this->m_queueCondition.wait(lock);
+			}
+
+			if(this->m_terminate)
+			{
+				break;
+			}
+		}
+
+		this->renderFrame();
+
+		// sleep
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			constants::renderIntervalMilliseconds));
+	}
+
+	this->renderFrame();
+};
+
+//-------------------------------------------------------------------- terminate
+// Implementation notes:
+//  The final frame is drawn by the render loop on its way out
+//------------------------------------------------------------------------------
+void consoleRenderer::terminate()
+{
+	{
+		boost::lock_guard<boost::mutex> lock(
+			this->m_queueMutex);
+
+		this->m_terminate = true;
+	}
+
+	this->m_queueCondition.notify_one();
+};
+
+//------------------------------------------------------------------ renderFrame
+// Implementation notes:
+//  The input line is cleared, the queued lines are written in its place and
+//  the prompt is drawn again below them, followed by whatever the user has
+//  typed so far.
+//------------------------------------------------------------------------------
+void consoleRenderer::renderFrame()
+{
+	std::deque<std::string> linesToRender;
+	uint64_t droppedLines = 0;
+	bool promptRequested = false;
+
+	{
+		boost::lock_guard<boost::mutex> lock(
+			this->m_queueMutex);
+
+		linesToRender.swap(this->m_queuedLines);
+		droppedLines = this->m_droppedLines;
+		this->m_droppedLines = 0;
+		promptRequested = this->m_promptRequested;
+		this->m_promptRequested = false;
+	}
+
+	if(linesToRender.empty() && !promptRequested)
+	{
+		return;
+	}
+
+	// return to the start of the input line and erase it
+	std::string frame("\r\x1b[2K");
+
+	if(droppedLines > 0)
+	{
+		frame += "(" + std::to_string(droppedLines) + " lines not shown)\n";
+	}
+
+	for(const std::string& currentLine : linesToRender)
+	{
+		frame += currentLine;
+		frame += '\n';
+	}
+
+	boost::lock_guard<boost::mutex> lock(
+		this->m_outputMutex);
+
+	frame += this->m_prompt;
+	frame += this->m_pendingInput;
+
+	std::cout.write(frame.data(), frame.size());
+	std::cout.flush();
+};
+
+//---------------------------------------------------------------------- readKey
+// Implementation notes:
+//  Escape sequences and the two byte codes of Windows special keys, the
+//  arrows and the like, are read whole and dropped, there is no cursor to
+//  move within the line
+//------------------------------------------------------------------------------
+int consoleRenderer::readKey()
+{
+	while(true)
+	{
+#ifdef _WIN32
+		const int key = _getch();
+
+		if((key == 0) || (key == 224))
+		{
+			_getch();
+			continue;
+		}
+
+		// ctrl-z ends the input like it does for a line read
+		return (key == 26) ? -1 : key;
+#else
+		unsigned char key = 0;
+
+		if(read(STDIN_FILENO, &key, 1) != 1)
+		{
+			return -1;
+		}
+
+		if(key == 0x1b)
+		{
+			unsigned char sequence = 0;
+
+			if((read(STDIN_FILENO, &sequence, 1) == 1)
+				&& ((sequence == '[') || (sequence == 'O')))
+			{
+				// parameters up to the final byte of the sequence
+				while((read(STDIN_FILENO, &sequence, 1) == 1)
+					&& ((sequence < 0x40) || (sequence > 0x7e)))
+				{
+				}
+			}
+
+			continue;
+		}
+
+		// ctrl-d on an empty line ends the input like it does for a line read
+		if(key == 0x04)
+		{
+			boost::lock_guard<boost::mutex> lock(
+				this->m_outputMutex);
+
+			if(this->m_pendingInput.empty())
+			{
+				return -1;
+			}
+
+			continue;
+		}
+
+		return key;
+#endif
+	}
+};
+
+//-------------------------------------------------------------------- echoInput
+// Implementation notes:
+//  Backspace removes a whole UTF-8 character, its continuation bytes too.
+//  Other control keys are ignored.
+//------------------------------------------------------------------------------
+bool consoleRenderer::echoInput(
+	const int& inKey)
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_outputMutex);
+
+	std::string echo;
+
+	if((inKey == '\n') || (inKey == '\r'))
+	{
+		echo = "\r\n";
+	}
+	else if((inKey == 0x7f) || (inKey == '\b'))
+	{
+		if(!this->m_pendingInput.empty())
+		{
+			while(!this->m_pendingInput.empty()
+				&& ((this->m_pendingInput.back() & 0xC0) == 0x80))
+			{
+				this->m_pendingInput.pop_back();
+			}
+
+			if(!this->m_pendingInput.empty())
+			{
+				this->m_pendingInput.pop_back();
+			}
+
+			echo = "\b \b";
+		}
+	}
+	else if(inKey >= 0x20)
+	{
+		this->m_pendingInput += static_cast<char>(inKey);
+		echo = std::string(1, static_cast<char>(inKey));
+	}
+
+	std::cout.write(echo.data(), echo.size());
+	std::cout.flush();
+
+	return (inKey == '\n') || (inKey == '\r');
+};
+
+//--------------------------------------------------------------- setLineEditing
+// Implementation notes:
+//  The settings the terminal had when editing was turned off are put back
+//  as they were. There is one terminal per process, so they are kept with
+//  the function rather than in the header, which stays free of termios.
+//------------------------------------------------------------------------------
+void consoleRenderer::setLineEditing(
+	const bool& inEnabled)
+{
+	if(!this->m_inputIsTerminal
+		|| (inEnabled == !this->m_lineEditingDisabled))
+	{
+		return;
+	}
+
+#ifndef _WIN32
+	static struct termios originalSettings;
+
+	if(inEnabled)
+	{
+		tcsetattr(STDIN_FILENO, TCSANOW, &originalSettings);
+	}
+	else
+	{
+		tcgetattr(STDIN_FILENO, &originalSettings);
+
+		struct termios rawSettings = originalSettings;
+		rawSettings.c_lflag &= ~(ICANON | ECHO);
+		rawSettings.c_cc[VMIN] = 1;
+		rawSettings.c_cc[VTIME] = 0;
+
+		tcsetattr(STDIN_FILENO, TCSANOW, &rawSettings);
+	}
+#endif
+
+	this->m_lineEditingDisabled = !inEnabled;
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+// STL
+#include <string>
+#include <deque>
+#include <cstdint>
+
+// Boost
+#include <boost/thread.hpp>
+
+class consoleRenderer
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the console renderer
+	//
+	// Method:    consoleRenderer
+	// FullName:  consoleRenderer::consoleRenderer
+	// Access:    public 
+	// Returns:   
+	// Parameter: const std::string& inPrompt
+	//--------------------------------------------------------------------------
+	consoleRenderer(
+		const std::string& inPrompt);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Gives the terminal back its own line editing if a read left it off.
+	//
+	// Method:    ~consoleRenderer
+	// FullName:  consoleRenderer::~consoleRenderer
+	// Access:    public 
+	// Returns:   
+	//--------------------------------------------------------------------------
+	~consoleRenderer();
+
+	//----------------------------------------------------------------- readLine
+	// Brief Description
+	//  Reads a line of input from the user. On a terminal the renderer does
+	//  the echoing itself, so it knows what has been typed so far and can
+	//  draw it again below the lines of every frame. Returns false once the
+	//  input has ended.
+	//
+	// Method:    readLine
+	// FullName:  consoleRenderer::readLine
+	// Access:    public 
+	// Returns:   bool
+	// Parameter: std::string& outLine
+	//--------------------------------------------------------------------------
+	bool readLine(
+		std::string& outLine);
+
+	//---------------------------------------------------------------- queueLine
+	// Brief Description
+	//  Queues a line of output. Lines are not written immediately, they are
+	//  collected and written together on the next frame. Past the queue limit
+	//  the oldest queued line is dropped, and the frame says how many were.
+	//
+	// Method:    queueLine
+	// FullName:  consoleRenderer::queueLine
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::string& inLine
+	//--------------------------------------------------------------------------
+	void queueLine(
+		const std::string& inLine);
+
+	//------------------------------------------------------------ requestPrompt
+	// Brief Description
+	//  Asks for the prompt to be drawn again on the next frame, used after the
+	//  user submits a line of input.
+	//
+	// Method:    requestPrompt
+	// FullName:  consoleRenderer::requestPrompt
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void requestPrompt();
+
+	//--------------------------------------------------------------- renderLoop
+	// Brief Description
+	//  Writes the queued lines at most once per render interval, each frame as
+	//  a single write followed by a single flush. Loops until terminate.
+	//
+	// Method:    renderLoop
+	// FullName:  consoleRenderer::renderLoop
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void renderLoop();
+
+	//---------------------------------------------------------------- terminate
+	// Brief Description
+	//  Writes whatever is still queued and stops the render loop.
+	//
+	// Method:    terminate
+	// FullName:  consoleRenderer::terminate
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void terminate();
+
+private:
+
+	//-------------------------------------------------------------- renderFrame
+	// Brief Description
+	//  Takes everything queued so far and writes it as one frame.
+	//
+	// Method:    renderFrame
+	// FullName:  consoleRenderer::renderFrame
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void renderFrame();
+
+	//------------------------------------------------------------------ readKey
+	// Brief Description
+	//  Returns the next key the user pressed without waiting for enter, or
+	//  -1 once the input has ended.
+	//
+	// Method:    readKey
+	// FullName:  consoleRenderer::readKey
+	// Access:    private 
+	// Returns:   int
+	//--------------------------------------------------------------------------
+	int readKey();
+
+	//---------------------------------------------------------------- echoInput
+	// Brief Description
+	//  Applies a typed key to the pending input and echoes it. Returns true
+	//  once the key ends the line.
+	//
+	// Method:    echoInput
+	// FullName:  consoleRenderer::echoInput
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const int& inKey
+	//--------------------------------------------------------------------------
+	bool echoInput(
+		const int& inKey);
+
+	//----------------------------------------------------------- setLineEditing
+	// Brief Description
+	//  Turns the terminal's own line editing and echo on or off. Does
+	//  nothing when the input is not a terminal.
+	//
+	// Method:    setLineEditing
+	// FullName:  consoleRenderer::setLineEditing
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const bool& inEnabled
+	//--------------------------------------------------------------------------
+	void setLineEditing(
+		const bool& inEnabled);
+
+	// Member Variables
+	std::string m_prompt;
+	std::deque<std::string> m_queuedLines;
+	uint64_t m_droppedLines;
+	bool m_promptRequested;
+	bool m_terminate;
+	boost::mutex m_queueMutex;
+	boost::condition_variable m_queueCondition;
+
+	// the input typed so far, guarded by the output mutex like every write
+	// to the console, so an echo never lands in the middle of a frame
+	bool m_inputIsTerminal;
+	bool m_lineEditingDisabled;
+	std::string m_pendingInput;
+	boost::mutex m_outputMutex;
+};
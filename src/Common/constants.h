@@ -13,6 +13,230 @@ namespace constants
 	const uint16_t syncIntervalMilliseconds = 1500;
 	const uint16_t forwardIntervalMilliseconds = 5;
 
+	// caps how often the client redraws the console, about 30 frames a second,
+	// and how many lines may wait for the next frame before the oldest are
+	// dropped
+	const uint16_t renderIntervalMilliseconds = 33;
+	const uint16_t renderQueueMaximumLines = 1024;
+
+	// Client outbox. Sends are kept in an append-only file until the server
+	// acknowledges them, and drained in batches of several messages per
+	// datagram with a bounded number of unacknowledged messages in flight.
+	const std::string outboxFileExtension = ".outbox";
+	const uint16_t outboxFlushIntervalMilliseconds = 20;
+	const uint16_t outboxRetransmitIntervalMilliseconds = 1000;
+	const uint16_t outboxMaximumBatchLength = 8192;
+	const uint16_t outboxWindowMessages = 128;
+
+	// Adaptive polling. The client starts polling at the update interval,
+	// polls at the floor while messages flow and doubles the interval after
+	// every empty poll up to the ceiling. Servers hint at waiting messages in
+	// ping replies and get responses, which triggers an immediate poll. A get
+	// response is one batch of at most the given length.
+	const uint16_t getIntervalMinimumMilliseconds = 100;
+	const uint16_t getIntervalMaximumMilliseconds = 16000;
+	const uint16_t getResponseMaximumBatchLength = 8192;
+
+	// Client failover. Any datagram from the current server is a sign of
+	// life, it is only pinged once it has been silent for the failover timeout
+	// or the get interval, whichever is longer, and failed over if the ping
+	// goes unanswered for the failover timeout. The other servers are probed
+	// at the probe interval, or the get interval while it is backed off, to
+	// keep their round trip times and loads current. Candidates are ranked
+	// by round trip time plus a penalty per client's worth of load.
+	const uint16_t livenessCheckIntervalMilliseconds = 100;
+	const uint16_t candidateProbeIntervalMilliseconds = 1000;
+	const uint16_t failoverTimeoutMilliseconds = 300;
+	const uint16_t failoverLoadWeightMicroseconds = 100;
+
+	// Server load. Each server reports its connected clients, ingress packet
+	// rate and queue depth to the others on every sync round. Traffic and
+	// backlog are weighed as the number of clients that would cause them. A
+	// server redirects new clients to the lightest server whose report is
+	// still fresh if that one is lighter by more than the margin.
+	const uint16_t loadPacketsPerSecondPerClient = 20;
+	const uint16_t loadQueueDepthPerClient = 16;
+	const uint16_t redirectLoadMargin = 4;
+	const uint16_t loadReportMaximumAgeMilliseconds = 3 * syncIntervalMilliseconds;
+
+	// Connects and gets must carry a cookie the server issued to the
+	// sender's endpoint, proving the sender receives at that address. A
+	// cookie stays valid for one to two lifetimes. Clients that understand
+	// cookies announce the cookie capability in both. During the grace,
+	// connects and gets that announce nothing come from clients built
+	// before cookies and are served without one, as they were then. Ending
+	// the grace once every client is upgraded closes that way around them.
+	const uint16_t cookieLifetimeSeconds = 30;
+	const bool cookieGraceForLegacyClients = true;
+
+	// Sessions that have sent neither a get nor a ping for the expiry time
+	// are dropped on the next sync round, as if they had acknowledged their
+	// whole mailbox. Connected clients get at least every get interval
+	// ceiling, so only vanished ones come near it.
+	const uint16_t sessionExpiryMilliseconds = 4 * getIntervalMaximumMilliseconds;
+
+	// Memory budgets the memory benchmark holds a server to, in bytes
+	// allocated per connected user, per message waiting in a mailbox and
+	// per user another server reported in a sync.
+	const uint32_t memoryBudgetBytesPerUser = 1024;
+	const uint32_t memoryBudgetBytesPerPendingMessage = 1024;
+	const uint32_t memoryBudgetBytesPerRemoteUser = 128;
+
+	// largest payload a single UDP datagram can carry over IPv4
+	const uint16_t maximumDatagramLength = 65507;
+
+	// The server handles datagrams in a pipeline of threads: one receiving,
+	// several decoding, one acting on the messages and one sending the
+	// replies. Stages hand each other batches of up to the batch size over
+	// rings of fixed capacity. A stage whose input is empty spins for the
+	// spin window, then sleeps until the stage before it adds to it.
+	const uint16_t pipelineDecodeWorkers = 2;
+	const uint16_t pipelineRingCapacity = 1024;
+	const uint16_t pipelineBatchSize = 32;
+	const uint16_t pipelineIdleSpinMicroseconds = 20;
+
+	// On Linux the receive stage can also take datagrams for the listening
+	// port from an AF_XDP socket on one queue of the named interface, which
+	// skips the kernel's UDP stack. It runs in copy mode, so any driver and
+	// veth work, and needs CAP_NET_ADMIN. Its memory holds the given number
+	// of frames of the given length, half for receiving and half for
+	// replies, and each of its rings the given number of entries. Replies
+	// to senders it received from go back through it, for up to the route
+	// capacity of senders. An empty name leaves it off. Only one server may
+	// use an interface.
+	const std::string xdpInterfaceName = "";
+	const uint32_t xdpQueueIndex = 0;
+	const uint32_t xdpFrameCount = 4096;
+	const uint32_t xdpFrameLength = 2048;
+	const uint32_t xdpRingEntries = 2048;
+	const uint32_t xdpRouteCapacity = 65536;
+	const uint16_t xdpPollMilliseconds = 100;
+
+	// CPU heavy work is offloaded from the pipeline to a pool of workers that
+	// steal from each other's deques. Idle workers sleep until a task is
+	// submitted. On Linux they run at the given niceness so they never
+	// delay the network threads.
+	const uint16_t taskPoolWorkers = 2;
+	const uint32_t taskPoolDequeCapacity = 1024;
+	const int taskPoolNiceness = 10;
+
+	// The sampling profiler an admin command starts records the stacks of
+	// the server's threads at the given rate of its CPU time, each thread
+	// into a buffer of its own. Stacks deeper than the maximum are cut at
+	// the root, and samples that no longer fit a buffer are counted only.
+	// Stopping it writes the stacks folded for flame graph tools.
+	const uint16_t profilerSamplingHertz = 99;
+	const uint16_t profilerMaximumFrames = 64;
+	const uint16_t profilerThreadBuffers = 32;
+	const uint32_t profilerThreadBufferWords = 1 << 16;
+	const std::string profileFileExtension = ".folded";
+
+	// Every server thread records its latest events, packets in and out,
+	// ring depths, routes and syncs, into a ring of its own holding the
+	// given number. The rings are dumped to a file when the 99th percentile
+	// of arrival to dispatch over a window passes the threshold, a pipeline
+	// ring holds more batches than the limit, or the receive loop swallows
+	// an exception. Windows with fewer latencies than the minimum are not
+	// judged, dumps are at least the interval apart, and a pending dump is
+	// written within the check interval.
+	const uint32_t flightRecorderThreadEvents = 8192;
+	const uint32_t flightRecorderLatencyThresholdMicroseconds = 50000;
+	const uint16_t flightRecorderWindowMilliseconds = 1000;
+	const uint32_t flightRecorderWindowMinimumLatencies = 100;
+	const uint16_t flightRecorderQueueDepthLimit = 768;
+	const uint16_t flightRecorderDumpIntervalSeconds = 60;
+	const uint16_t flightRecorderCheckMilliseconds = 100;
+	const std::string flightRecorderFileExtension = ".flight";
+	const uint64_t flightRecorderMagic = 0x3130544847494C46ULL;
+
+	// Messages sent to the broadcast destination reach every connected user.
+	// A large fan-out is split into shards of at least the given number of
+	// recipients, which the state stage and its own shard workers fill in
+	// parallel. The shard workers keep the priority of the network threads,
+	// as the state stage waits for them.
+	const std::string broadcastDestination = "broadcast";
+	const uint32_t broadcastShardMinimumRecipients = 2048;
+	const uint16_t broadcastShardWorkers = 2;
+
+	// Messages sent with a delivery time wait on a hierarchical timer wheel of
+	// the given tick length and number of levels, and are kept in an append
+	// only file until they fire. The file is compacted once fired records
+	// outnumber both the waiting ones and the minimum. Delivery times further
+	// ahead than the maximum delay are refused.
+	const std::string scheduleFileExtension = ".schedule";
+	const uint16_t timerWheelTickMilliseconds = 10;
+	const uint16_t timerWheelLevels = 4;
+	const uint16_t scheduleMaximumDelayDays = 365;
+	const uint16_t scheduleCompactionMinimumRecords = 1024;
+
+	// Parked messages whose destination becomes reachable are handed to the
+	// next server in bulk. Each direction with at least the minimum number of
+	// messages gets compressed batches of at most the given length before
+	// compression, the rest are forwarded one by one as before.
+	const uint16_t handoffMinimumMessages = 4;
+	const uint32_t handoffMaximumBatchLength = 32768;
+
+	// Files of stored messages pack records into blocks of about the given
+	// length, each compressed and checksummed on its own. An optional filter
+	// and an index of the key range of every block sit at the end of the
+	// file, followed by a footer of fixed length that ends with the magic
+	// number.
+	const uint32_t storageBlockLength = 32768;
+	const uint16_t blockFileFooterLength = 32;
+	const uint64_t blockFileMagic = 0x31304B4C42435043ULL;
+
+	// Every message delivered to a mailbox is archived in the history store,
+	// and messages parked for users no server knows are kept in the offline
+	// store until they can be forwarded.
+	const std::string historyFileExtension = ".history";
+	const std::string offlineFileExtension = ".offline";
+
+	// Stores on disk are log structured merge trees. Writes are appended to
+	// a log in batches of up to the buffer length and kept in a memory
+	// table, which is written out as a level 0 segment once it reaches its
+	// length. Level 0 segments are merged into level 1 once there are enough
+	// of them, and every further level holds the growth factor times as much
+	// as the one above before a segment of it is merged down. Segments carry
+	// a Bloom filter of the key groups (users) they hold.
+	const uint32_t lsmMemtableLength = 4 * 1024 * 1024;
+	const uint32_t lsmSegmentLength = 4 * 1024 * 1024;
+	const uint16_t lsmLevel0Segments = 4;
+	const uint64_t lsmLevel1Length = 40 * 1024 * 1024;
+	const uint16_t lsmLevelGrowth = 10;
+	const uint16_t lsmMaximumLevels = 7;
+	const uint16_t lsmBloomBitsPerKey = 10;
+	const uint32_t lsmLogBufferLength = 65536;
+
+	// When every server shares a LAN segment, sync payloads and broadcasts
+	// can be sent once to a multicast group instead of hop by hop along the
+	// server chain.
+	const bool multicastSyncEnabled = false;
+	const std::string multicastGroupAddress = "239.255.37.80";
+	const uint16_t multicastPort = 8090;
+
+	// number of sent multicast frames kept for NACK based repair, which is
+	// also the most frames a receiver holds back waiting for a repair
+	const uint16_t multicastRepairHistoryLength = 64;
+
+	// how long a receiver holds frames back behind a gap before giving up
+	// on its repair, two sync rounds
+	const uint16_t multicastRepairWaitMilliseconds = 3000;
+
+	// When several servers run on one host they can share a single client
+	// directory in shared memory instead of each keeping and syncing a copy.
+	const bool sharedDirectoryEnabled = false;
+	const std::string sharedDirectoryName = "CPSC3780ClientDirectory";
+	const uint16_t sharedDirectoryMaximumClientsPerServer = 1024;
+	const uint16_t sharedDirectoryMaximumUsernameLength = 32;
+	const size_t sharedDirectorySegmentOverhead = 64 * 1024;
+
+	// A reader gives up on a slot it cannot find between two writes within
+	// the given number of attempts, and takes it as empty. A writer waits
+	// for a live writer of the same slot at most the lock timeout, and
+	// takes the slot over from one whose process is gone.
+	const uint16_t sharedDirectoryReadAttempts = 1024;
+	const uint16_t sharedDirectoryLockTimeoutMilliseconds = 100;
+
 	const std::vector<uint16_t> serverListeningPorts(
 	{8080, 8081, 8082, 8083, 8084});
 
@@ -148,6 +372,44 @@ namespace constants
 		return ',';
 	};
 
+	// Every encoded message ends in the CRC32C of everything before it,
+	// written as this many hex digits. Peers built before the trailer skip
+	// it, and their messages without one are still accepted unless they
+	// announced the checksum capability. The records of the schedule and
+	// outbox files start with the checksum of the rest of their line.
+	const uint16_t messageChecksumLength = 8;
+
+	//-------------------------------------------------------------- batchPrefix
+	// Brief Description
+	//  The character sequence a datagram starts with when it carries several
+	//  length prefixed messages instead of a single one. A single message
+	//  always starts with its sequence number, so the two can't be confused.
+	//
+	// Method:    batchPrefix
+	// FullName:  constants::batchPrefix
+	// Access:    public static 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	static inline std::string batchPrefix()
+	{
+		return "/#";
+	};
+
+	//---------------------------------------------------- compressedBatchPrefix
+	// Brief Description
+	//  The character sequence a datagram starts with when it carries a
+	//  compressed batch of messages.
+	//
+	// Method:    compressedBatchPrefix
+	// FullName:  constants::compressedBatchPrefix
+	// Access:    public static 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	static inline std::string compressedBatchPrefix()
+	{
+		return "/~";
+	};
+
 	enum MessageType
 	{
 		mt_UNDEFINED = 0,
@@ -160,5 +422,36 @@ namespace constants
 		mt_SERVER_ACK = 7,
 		mt_SERVER_SYNC = 8,
 		mt_PING = 9,
+		mt_SERVER_NACK = 10,
+		mt_SERVER_LOAD = 11,
+		mt_SERVER_REDIRECT = 12,
+		mt_SERVER_PENDING = 13,
+		mt_SERVER_COOKIE = 14,
+		mt_CLIENT_SCHEDULE = 15,
+		mt_SERVER_HELLO = 16,
+		mt_ADMIN = 17,
 	};
+
+	// one more than the highest message type, for tables indexed by type
+	const uint16_t messageTypeCount = mt_ADMIN + 1;
+
+	// Fast paths a peer can announce. A sender only takes a path the
+	// receiving end announced.
+	enum Capability
+	{
+		cap_BATCH = 0x1,
+		cap_COMPRESSED_BATCH = 0x2,
+		cap_CHECKSUM = 0x4,
+		cap_COOKIE = 0x8,
+	};
+
+	// Capabilities of this build. Clients announce theirs when they connect,
+	// servers in ping and cookie replies and to their neighbours in a hello
+	// whenever a link's capabilities are unknown. A peer that announced
+	// nothing gets single messages, and its messages are accepted without a
+	// checksum trailer. Get responses of at least the given length go out
+	// compressed to clients that accept it.
+	const uint32_t localCapabilities =
+		cap_BATCH | cap_COMPRESSED_BATCH | cap_CHECKSUM | cap_COOKIE;
+	const uint32_t compressedResponseMinimumLength = 1024;
 }
\ No newline at end of file
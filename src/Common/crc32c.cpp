@@ -0,0 +1,339 @@
+// STL
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#define CRC32C_X86
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARM
+#endif
+
+// GCC and Clang only emit SSE4.2 instructions in functions that ask for them
+#if defined(CRC32C_X86) && defined(__GNUC__)
+#define CRC32C_HARDWARE_TARGET __attribute__((target("sse4.2")))
+#else
+#define CRC32C_HARDWARE_TARGET
+#endif
+
+// Project
+#include "crc32c.h"
+
+//--------------------------------------------------------------------- checksum
+// Implementation notes:
+//  Picks the implementation once, the first time it is called
+//------------------------------------------------------------------------------
+uint32_t crc32c::checksum(
+	const char* inData,
+	const size_t& inLength,
+	const uint32_t& inPreviousChecksum)
+{
+	if(crc32c::hardwareAccelerated())
+	{
+		return crc32c::checksumHardware(
+			inData,
+			inLength,
+			inPreviousChecksum);
+	}
+
+	return crc32c::checksumSlicingBy8(
+		inData,
+		inLength,
+		inPreviousChecksum);
+};
+
+//----------------------------------------------------------- checksumSlicingBy8
+// Implementation notes:
+//  Eight table lookups per eight bytes, one per table, on the reflected
+//  polynomial. The words are assembled bytewise so the result does not
+//  depend on the byte order of the host.
+//------------------------------------------------------------------------------
+uint32_t crc32c::checksumSlicingBy8(
+	const char* inData,
+	const size_t& inLength,
+	const uint32_t& inPreviousChecksum)
+{
+	const uint32_t* tables = crc32c::table();
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(inData);
+
+	uint32_t crc = ~inPreviousChecksum;
+	size_t remaining = inLength;
+
+	while(remaining >= 8)
+	{
+		const uint32_t low = crc
+			^ (static_cast<uint32_t>(data[0])
+			| (static_cast<uint32_t>(data[1]) << 8)
+			| (static_cast<uint32_t>(data[2]) << 16)
+			| (static_cast<uint32_t>(data[3]) << 24));
+
+		const uint32_t high =
+			static_cast<uint32_t>(data[4])
+			| (static_cast<uint32_t>(data[5]) << 8)
+			| (static_cast<uint32_t>(data[6]) << 16)
+			| (static_cast<uint32_t>(data[7]) << 24);
+
+		crc = tables[(7 * 256) + (low & 0xFF)]
+			^ tables[(6 * 256) + ((low >> 8) & 0xFF)]
+			^ tables[(5 * 256) + ((low >> 16) & 0xFF)]
+			^ tables[(4 * 256) + (low >> 24)]
+			^ tables[(3 * 256) + (high & 0xFF)]
+			^ tables[(2 * 256) + ((high >> 8) & 0xFF)]
+			^ tables[(1 * 256) + ((high >> 16) & 0xFF)]
+			^ tables[high >> 24];
+
+		data += 8;
+		remaining -= 8;
+	}
+
+	while(remaining > 0)
+	{
+		crc = tables[(crc ^ *data) & 0xFF] ^ (crc >> 8);
+
+		data++;
+		remaining--;
+	}
+
+	return ~crc;
+};
+
+//---------------------------------------------------------- hardwareAccelerated
+// Implementation notes:
+//  Function local static, the processor is only asked once
+//------------------------------------------------------------------------------
+bool crc32c::hardwareAccelerated()
+{
+	static const bool hardware =
+		crc32c::detectHardware();
+
+	return hardware;
+};
+
+//------------------------------------------------------------------------ asHex
+// Implementation notes:
+//  Most significant digit first
+//------------------------------------------------------------------------------
+std::string crc32c::asHex(
+	const uint32_t& inChecksum)
+{
+	static const char digits[] = "0123456789abcdef";
+
+	std::string outHex(8, '0');
+
+	for(uint16_t i = 0; i < 8; i++)
+	{
+		outHex[7 - i] = digits[(inChecksum >> (4 * i)) & 0xF];
+	}
+
+	return outHex;
+};
+
+//--------------------------------------------------------------------- parseHex
+// Implementation notes:
+//  Uppercase is refused, asHex never writes it
+//------------------------------------------------------------------------------
+bool crc32c::parseHex(
+	const char* inText,
+	uint32_t& outChecksum)
+{
+	outChecksum = 0;
+
+	for(uint16_t i = 0; i < 8; i++)
+	{
+		const char digit = inText[i];
+
+		if((digit >= '0') && (digit <= '9'))
+		{
+			outChecksum = (outChecksum << 4) | static_cast<uint32_t>(digit - '0');
+		}
+		else if((digit >= 'a') && (digit <= 'f'))
+		{
+			outChecksum = (outChecksum << 4) | static_cast<uint32_t>(digit - 'a' + 10);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+};
+
+//--------------------------------------------------------------------- sealLine
+// Implementation notes:
+//  "<checksum> <record>", the checksum covers the record only
+//------------------------------------------------------------------------------
+std::string crc32c::sealLine(
+	const std::string& inRecord)
+{
+	return crc32c::asHex(crc32c::checksum(inRecord.data(), inRecord.size()))
+		+ ' ' + inRecord;
+};
+
+//--------------------------------------------------------------------- openLine
+// Implementation notes:
+//  A line cut short by a crash fails the checksum like a corrupt one
+//------------------------------------------------------------------------------
+bool crc32c::openLine(
+	const std::string& inLine,
+	std::string& outRecord)
+{
+	uint32_t storedChecksum = 0;
+
+	if((inLine.size() < 9)
+		|| (inLine[8] != ' ')
+		|| !crc32c::parseHex(inLine.data(), storedChecksum)
+		|| (crc32c::checksum(inLine.data() + 9, inLine.size() - 9) != storedChecksum))
+	{
+		return false;
+	}
+
+	outRecord = inLine.substr(9);
+	return true;
+};
+
+//------------------------------------------------------------- checksumHardware
+// Implementation notes:
+//  Bytes up to an 8 byte boundary one at a time, then a word per
+//  instruction. Without CRC instructions this is never called.
+//------------------------------------------------------------------------------
+CRC32C_HARDWARE_TARGET
+uint32_t crc32c::checksumHardware(
+	const char* inData,
+	const size_t& inLength,
+	const uint32_t& inPreviousChecksum)
+{
+#if defined(CRC32C_X86)
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(inData);
+	const unsigned char* end = data + inLength;
+
+	uint64_t crc = ~inPreviousChecksum;
+
+	while((data != end) && ((reinterpret_cast<uintptr_t>(data) & 7) != 0))
+	{
+		crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *data);
+		data++;
+	}
+
+	while(end - data >= 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, data, 8);
+
+		crc = _mm_crc32_u64(crc, word);
+		data += 8;
+	}
+
+	while(data != end)
+	{
+		crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *data);
+		data++;
+	}
+
+	return ~static_cast<uint32_t>(crc);
+#elif defined(CRC32C_ARM)
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(inData);
+	const unsigned char* end = data + inLength;
+
+	uint32_t crc = ~inPreviousChecksum;
+
+	while((data != end) && ((reinterpret_cast<uintptr_t>(data) & 7) != 0))
+	{
+		crc = __crc32cb(crc, *data);
+		data++;
+	}
+
+	while(end - data >= 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, data, 8);
+
+		crc = __crc32cd(crc, word);
+		data += 8;
+	}
+
+	while(data != end)
+	{
+		crc = __crc32cb(crc, *data);
+		data++;
+	}
+
+	return ~crc;
+#else
+	return crc32c::checksumSlicingBy8(
+		inData,
+		inLength,
+		inPreviousChecksum);
+#endif
+};
+
+//--------------------------------------------------------------- detectHardware
+// Implementation notes:
+//  SSE4.2 is bit 20 of ECX for CPUID leaf 1. On ARM the instructions are
+//  only used when the compiler was told the target has them.
+//------------------------------------------------------------------------------
+bool crc32c::detectHardware()
+{
+#if defined(CRC32C_X86) && defined(_MSC_VER)
+	int registers[4];
+	__cpuid(registers, 1);
+
+	return ((registers[2] >> 20) & 1) != 0;
+#elif defined(CRC32C_X86)
+	return __builtin_cpu_supports("sse4.2") != 0;
+#elif defined(CRC32C_ARM)
+	return true;
+#else
+	return false;
+#endif
+};
+
+//------------------------------------------------------------------------ table
+// Implementation notes:
+//  Function local static, so the tables are built once and thread safely
+//------------------------------------------------------------------------------
+const uint32_t* crc32c::table()
+{
+	static const std::vector<uint32_t> tables(
+		crc32c::buildTable());
+
+	return tables.data();
+};
+
+//------------------------------------------------------------------- buildTable
+// Implementation notes:
+//  The first table shifts each byte value through the reflected polynomial
+//  a bit at a time. Each further table is the one before advanced by a zero
+//  byte.
+//------------------------------------------------------------------------------
+std::vector<uint32_t> crc32c::buildTable()
+{
+	std::vector<uint32_t> outTable(8 * 256);
+
+	for(uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t crc = i;
+
+		for(uint16_t bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 1) ? ((crc >> 1) ^ 0x82F63B78U) : (crc >> 1);
+		}
+
+		outTable[i] = crc;
+	}
+
+	for(uint32_t i = 0; i < 256; i++)
+	{
+		for(uint16_t slice = 1; slice < 8; slice++)
+		{
+			const uint32_t previous = outTable[((slice - 1) * 256) + i];
+
+			outTable[(slice * 256) + i] = (previous >> 8) ^ outTable[previous & 0xFF];
+		}
+	}
+
+	return outTable;
+};
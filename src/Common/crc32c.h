@@ -0,0 +1,174 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class crc32c
+{
+public:
+
+	//----------------------------------------------------------------- checksum
+	// Brief Description
+	//  Returns the CRC32C (Castagnoli) checksum of a buffer. Passing the
+	//  checksum of the preceding data continues it over this buffer. Uses the
+	//  CRC instructions of the processor where it has them.
+	//
+	// Method:    checksum
+	// FullName:  crc32c::checksum
+	// Access:    public static 
+	// Returns:   uint32_t
+	// Parameter: const char* inData
+	// Parameter: const size_t& inLength
+	// Parameter: const uint32_t& inPreviousChecksum
+	//--------------------------------------------------------------------------
+	static uint32_t checksum(
+		const char* inData,
+		const size_t& inLength,
+		const uint32_t& inPreviousChecksum = 0);
+
+	//------------------------------------------------------- checksumSlicingBy8
+	// Brief Description
+	//  Returns the same checksum as checksum, always computed with tables
+	//  eight bytes at a time. This is what checksum falls back to, it is
+	//  public so the two can be compared.
+	//
+	// Method:    checksumSlicingBy8
+	// FullName:  crc32c::checksumSlicingBy8
+	// Access:    public static 
+	// Returns:   uint32_t
+	// Parameter: const char* inData
+	// Parameter: const size_t& inLength
+	// Parameter: const uint32_t& inPreviousChecksum
+	//--------------------------------------------------------------------------
+	static uint32_t checksumSlicingBy8(
+		const char* inData,
+		const size_t& inLength,
+		const uint32_t& inPreviousChecksum = 0);
+
+	//------------------------------------------------------ hardwareAccelerated
+	// Brief Description
+	//  Determines if checksum uses the CRC instructions of the processor.
+	//
+	// Method:    hardwareAccelerated
+	// FullName:  crc32c::hardwareAccelerated
+	// Access:    public static 
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	static bool hardwareAccelerated();
+
+	//-------------------------------------------------------------------- asHex
+	// Brief Description
+	//  Returns a checksum as the eight lowercase hex digits it is written as
+	//  in text formats.
+	//
+	// Method:    asHex
+	// FullName:  crc32c::asHex
+	// Access:    public static 
+	// Returns:   std::string
+	// Parameter: const uint32_t& inChecksum
+	//--------------------------------------------------------------------------
+	static std::string asHex(
+		const uint32_t& inChecksum);
+
+	//----------------------------------------------------------------- parseHex
+	// Brief Description
+	//  Reads a checksum written by asHex. Returns false if the text does not
+	//  start with eight lowercase hex digits.
+	//
+	// Method:    parseHex
+	// FullName:  crc32c::parseHex
+	// Access:    public static 
+	// Returns:   bool
+	// Parameter: const char* inText
+	// Parameter: uint32_t& outChecksum
+	//--------------------------------------------------------------------------
+	static bool parseHex(
+		const char* inText,
+		uint32_t& outChecksum);
+
+	//----------------------------------------------------------------- sealLine
+	// Brief Description
+	//  Returns a line of a text record file prefixed with its checksum.
+	//
+	// Method:    sealLine
+	// FullName:  crc32c::sealLine
+	// Access:    public static 
+	// Returns:   std::string
+	// Parameter: const std::string& inRecord
+	//--------------------------------------------------------------------------
+	static std::string sealLine(
+		const std::string& inRecord);
+
+	//----------------------------------------------------------------- openLine
+	// Brief Description
+	//  Checks a line written by sealLine and returns the record in it.
+	//  Returns false if the line is torn or corrupt.
+	//
+	// Method:    openLine
+	// FullName:  crc32c::openLine
+	// Access:    public static 
+	// Returns:   bool
+	// Parameter: const std::string& inLine
+	// Parameter: std::string& outRecord
+	//--------------------------------------------------------------------------
+	static bool openLine(
+		const std::string& inLine,
+		std::string& outRecord);
+
+private:
+
+	//--------------------------------------------------------- checksumHardware
+	// Brief Description
+	//  Computes the checksum with the CRC instructions of the processor.
+	//  Only called once hardwareAccelerated says they exist.
+	//
+	// Method:    checksumHardware
+	// FullName:  crc32c::checksumHardware
+	// Access:    private static 
+	// Returns:   uint32_t
+	// Parameter: const char* inData
+	// Parameter: const size_t& inLength
+	// Parameter: const uint32_t& inPreviousChecksum
+	//--------------------------------------------------------------------------
+	static uint32_t checksumHardware(
+		const char* inData,
+		const size_t& inLength,
+		const uint32_t& inPreviousChecksum);
+
+	//----------------------------------------------------------- detectHardware
+	// Brief Description
+	//  Asks the processor if it has the CRC32C instructions.
+	//
+	// Method:    detectHardware
+	// FullName:  crc32c::detectHardware
+	// Access:    private static 
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	static bool detectHardware();
+
+	//-------------------------------------------------------------------- table
+	// Brief Description
+	//  Returns the eight tables of slicing by 8, 256 entries each, built on
+	//  first use. The first is the checksum of every byte value.
+	//
+	// Method:    table
+	// FullName:  crc32c::table
+	// Access:    private static 
+	// Returns:   const uint32_t*
+	//--------------------------------------------------------------------------
+	static const uint32_t* table();
+
+	//--------------------------------------------------------------- buildTable
+	// Brief Description
+	//  Computes the eight tables of slicing by 8.
+	//
+	// Method:    buildTable
+	// FullName:  crc32c::buildTable
+	// Access:    private static 
+	// Returns:   std::vector<uint32_t>
+	//--------------------------------------------------------------------------
+	static std::vector<uint32_t> buildTable();
+};
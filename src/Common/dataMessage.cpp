@@ -1,10 +1,16 @@
 // STL
 #include <string>
 #include <iostream>
+#include <stdexcept>
+#include <cassert>
+#include <algorithm>
+#include <sstream>
 
 // Project
 #include "dataMessage.h"
 #include "constants.h"
+#include "lzCompressor.h"
+#include "crc32c.h"
 
 //------------------------------------------------------------------ constructor
 // Implementation notes:
@@ -23,6 +29,7 @@ dataMessage::dataMessage(
 	this->m_destinationIdentifier = inDestinationID;
 	this->m_payload = inPayload;
 	this->m_serverSyncPayloadOriginIndex = -1;
+	this->m_hasChecksum = true;
 };
 
 //------------------------------------------------------------------ constructor
@@ -43,18 +50,49 @@ dataMessage::dataMessage(
 	this->m_destinationIdentifier = inDestinationID;
 	this->m_payload = dataMessage::createServerSyncPayload(inServerSyncPayload);
 	this->m_serverSyncPayloadOriginIndex = inServerSyncPayloadOriginIndex;
+	this->m_hasChecksum = true;
 };
 
 //------------------------------------------------------------------ constructor
 // Implementation notes:
-//  Used to create a data message object from a received vector<char>
+//  Used to create a data message object from a received vector<char>. The
+//  checksum trailer is verified before anything is parsed. A message that
+//  ends in the delimiter after its last field has no trailer, it comes from
+//  a peer built before the trailer was added and is parsed unchecked.
+//  Whether that is acceptable depends on what the sender announced, which
+//  only the receiver knows.
 //------------------------------------------------------------------------------
 dataMessage::dataMessage(
 	const std::vector<char>& inCharVector)
 {
+	const std::string delimiter(constants::messageDelimiter());
+
+	this->m_hasChecksum = (inCharVector.size() < delimiter.size())
+		|| !std::equal(delimiter.begin(), delimiter.end(), inCharVector.end() - delimiter.size());
+
+	size_t bodyLength = inCharVector.size();
+
+	if(this->m_hasChecksum)
+	{
+		if(inCharVector.size() < constants::messageChecksumLength)
+		{
+			throw std::runtime_error("message too short for its checksum");
+		}
+
+		bodyLength -= constants::messageChecksumLength;
+
+		uint32_t storedChecksum = 0;
+
+		if(!crc32c::parseHex(inCharVector.data() + bodyLength, storedChecksum)
+			|| (crc32c::checksum(inCharVector.data(), bodyLength) != storedChecksum))
+		{
+			throw std::runtime_error("message checksum mismatch");
+		}
+	}
+
 	std::string asString(
 		inCharVector.begin(),
-		inCharVector.end());
+		inCharVector.begin() + bodyLength);
 
 	std::string sequenceNumberAsString = asString.substr(0, asString.find(constants::messageDelimiter()));
 	this->m_sequenceNumber = std::stoi(sequenceNumberAsString);
@@ -87,6 +125,16 @@ const int64_t& dataMessage::viewSequenceNumber() const
 	return this->m_sequenceNumber;
 };
 
+//------------------------------------------------------------ setSequenceNumber
+// Implementation notes:
+//  Sets the sequence number to the inSequenceNumber for this object
+//------------------------------------------------------------------------------
+void dataMessage::setSequenceNumber(
+	const int64_t& inSequenceNumber)
+{
+	this->m_sequenceNumber = inSequenceNumber;
+};
+
 //-------------------------------------------------------------- viewMessageType
 // Implementation notes:
 //  Returns a const reference to the message type
@@ -142,6 +190,25 @@ const int8_t& dataMessage::viewServerSyncPayloadOriginIndex() const
 	return this->m_serverSyncPayloadOriginIndex;
 };
 
+//-------------------------------------------------------------- viewHasChecksum
+// Implementation notes:
+//  Returns whether the message arrived with a checksum trailer
+//------------------------------------------------------------------------------
+bool dataMessage::viewHasChecksum() const
+{
+	return this->m_hasChecksum;
+};
+
+//---------------------------------------------- setServerSyncPayloadOriginIndex
+// Implementation notes:
+//  Sets the server sync payload origin index for this object
+//------------------------------------------------------------------------------
+void dataMessage::setServerSyncPayloadOriginIndex(
+	const int8_t& inServerSyncPayloadOriginIndex)
+{
+	this->m_serverSyncPayloadOriginIndex = inServerSyncPayloadOriginIndex;
+};
+
 //------------------------------------------------------ viewMessageTypeAsString
 // Implementation notes:
 //  Returns a const string reference to the message type
@@ -152,6 +219,12 @@ const std::string dataMessage::viewMessageTypeAsString() const
 
 	switch(this->m_messageType)
 	{
+		case constants::MessageType::mt_UNDEFINED:
+		{
+			// a type only newer peers know, never sent
+			messageTypeAsString = "undefined";
+			break;
+		}
 		case constants::MessageType::mt_CLIENT_CONNECT:
 		{
 			messageTypeAsString = "client connect";
@@ -197,6 +270,46 @@ const std::string dataMessage::viewMessageTypeAsString() const
 			messageTypeAsString = "ping";
 			break;
 		}
+		case constants::MessageType::mt_SERVER_NACK:
+		{
+			messageTypeAsString = "server nack";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_LOAD:
+		{
+			messageTypeAsString = "server load";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_REDIRECT:
+		{
+			messageTypeAsString = "server redirect";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_PENDING:
+		{
+			messageTypeAsString = "server pending";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_COOKIE:
+		{
+			messageTypeAsString = "server cookie";
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_SCHEDULE:
+		{
+			messageTypeAsString = "client schedule";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_HELLO:
+		{
+			messageTypeAsString = "server hello";
+			break;
+		}
+		case constants::MessageType::mt_ADMIN:
+		{
+			messageTypeAsString = "admin";
+			break;
+		}
 		default:
 		{
 			assert(false);
@@ -258,8 +371,47 @@ const constants::MessageType dataMessage::stringToMessageType(
 		return constants::mt_PING;
 	}
 
-	assert(false);
+	if(inMessageTypeAsString == "server nack")
+	{
+		return constants::MessageType::mt_SERVER_NACK;
+	}
+
+	if(inMessageTypeAsString == "server load")
+	{
+		return constants::MessageType::mt_SERVER_LOAD;
+	}
+
+	if(inMessageTypeAsString == "server redirect")
+	{
+		return constants::MessageType::mt_SERVER_REDIRECT;
+	}
+
+	if(inMessageTypeAsString == "server pending")
+	{
+		return constants::MessageType::mt_SERVER_PENDING;
+	}
+
+	if(inMessageTypeAsString == "server cookie")
+	{
+		return constants::MessageType::mt_SERVER_COOKIE;
+	}
+
+	if(inMessageTypeAsString == "client schedule")
+	{
+		return constants::MessageType::mt_CLIENT_SCHEDULE;
+	}
+
+	if(inMessageTypeAsString == "server hello")
+	{
+		return constants::MessageType::mt_SERVER_HELLO;
+	}
+
+	if(inMessageTypeAsString == "admin")
+	{
+		return constants::MessageType::mt_ADMIN;
+	}
 
+	// a type only newer peers know, which the receiver ignores
 	return constants::MessageType::mt_UNDEFINED;
 };
 
@@ -280,7 +432,7 @@ std::string dataMessage::createServerSyncPayload(
 	return constructedPayload;
 };
 
-//--------------------------------------------------------- viewServerSyncPayload
+//-------------------------------------------------------- viewServerSyncPayload
 // Implementation notes:
 //  Converts the string to the corresponding messageType enum
 //------------------------------------------------------------------------------
@@ -306,9 +458,62 @@ std::vector<std::string> dataMessage::viewServerSyncPayload() const
 	return outServerSyncPayload;
 };
 
+//------------------------------------------------------------- viewPayloadField
+// Implementation notes:
+//  Linear scan, control payloads only hold a handful of entries
+//------------------------------------------------------------------------------
+std::string dataMessage::viewPayloadField(
+	const std::string& inKey) const
+{
+	const std::string prefix(inKey + '=');
+
+	for(const std::string& currentField : this->viewServerSyncPayload())
+	{
+		if(currentField.compare(0, prefix.size(), prefix) == 0)
+		{
+			return currentField.substr(prefix.size());
+		}
+	}
+
+	return "";
+};
+
+//------------------------------------------------------ viewPayloadCapabilities
+// Implementation notes:
+//  A missing or garbled field means the peer announced nothing
+//------------------------------------------------------------------------------
+uint32_t dataMessage::viewPayloadCapabilities() const
+{
+	const std::string field(
+		this->viewPayloadField("caps"));
+
+	if(field.empty()
+		|| (field.size() > 8)
+		|| (field.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos))
+	{
+		return 0;
+	}
+
+	return uint32_t(std::stoul(field, nullptr, 16));
+};
+
+//------------------------------------------------------------ capabilitiesField
+// Implementation notes:
+//  Hexadecimal, so a mask of any width stays one short field
+//------------------------------------------------------------------------------
+std::string dataMessage::capabilitiesField(
+	const uint32_t& inCapabilities)
+{
+	std::ostringstream field;
+	field << "caps=" << std::hex << inCapabilities;
+
+	return field.str();
+};
+
 //----------------------------------------------------------------- asVectorChar
 // Implementation notes:
-//  Returns data message as a vector<char>
+//  Returns data message as a vector<char>, followed by the checksum of
+//  everything before it
 //------------------------------------------------------------------------------
 std::vector<char> dataMessage::asCharVector() const
 {
@@ -320,7 +525,174 @@ std::vector<char> dataMessage::asCharVector() const
 		+ this->m_payload + constants::messageDelimiter()
 		+ std::to_string(this->m_serverSyncPayloadOriginIndex) + constants::messageDelimiter());
 
-	return std::vector<char>(
-		messageAsString.begin(),
-		messageAsString.end());
+	const std::string checksum(crc32c::asHex(crc32c::checksum(
+		messageAsString.data(),
+		messageAsString.size())));
+
+	std::vector<char> outMessage;
+	outMessage.reserve(messageAsString.size() + checksum.size());
+
+	outMessage.insert(outMessage.end(), messageAsString.begin(), messageAsString.end());
+	outMessage.insert(outMessage.end(), checksum.begin(), checksum.end());
+
+	return outMessage;
+};
+
+//------------------------------------------------------------------ createBatch
+// Implementation notes:
+//  Layout is the batch prefix followed by <length>:<message> for each message
+//------------------------------------------------------------------------------
+std::vector<char> dataMessage::createBatch(
+	const std::vector<dataMessage>& inMessages)
+{
+	const std::string prefix(constants::batchPrefix());
+
+	std::vector<char> outBatch(
+		prefix.begin(),
+		prefix.end());
+
+	for(const dataMessage& currentMessage : inMessages)
+	{
+		dataMessage::appendToBatch(
+			outBatch,
+			currentMessage.asCharVector());
+	}
+
+	return outBatch;
+};
+
+//---------------------------------------------------------------- appendToBatch
+// Implementation notes:
+//  Same layout as createBatch
+//------------------------------------------------------------------------------
+void dataMessage::appendToBatch(
+	std::vector<char>& ioBatch,
+	const std::vector<char>& inEncodedMessage)
+{
+	if(ioBatch.empty())
+	{
+		const std::string prefix(constants::batchPrefix());
+
+		ioBatch.insert(ioBatch.end(), prefix.begin(), prefix.end());
+	}
+
+	const std::string lengthPrefix(
+		std::to_string(inEncodedMessage.size()) + ':');
+
+	ioBatch.insert(ioBatch.end(), lengthPrefix.begin(), lengthPrefix.end());
+	ioBatch.insert(ioBatch.end(), inEncodedMessage.begin(), inEncodedMessage.end());
+};
+
+//---------------------------------------------------------------------- isBatch
+// Implementation notes:
+//  Compares the start of the datagram with the batch prefix
+//------------------------------------------------------------------------------
+bool dataMessage::isBatch(
+	const std::vector<char>& inCharVector)
+{
+	const std::string prefix(constants::batchPrefix());
+
+	return (inCharVector.size() >= prefix.size())
+		&& std::equal(prefix.begin(), prefix.end(), inCharVector.begin());
+};
+
+//------------------------------------------------------------------- parseBatch
+// Implementation notes:
+//  Walks the length prefixes, a length running past the end of the datagram
+//  means it was truncated
+//------------------------------------------------------------------------------
+std::vector<dataMessage> dataMessage::parseBatch(
+	const std::vector<char>& inCharVector)
+{
+	std::vector<dataMessage> outMessages;
+
+	size_t position = constants::batchPrefix().size();
+
+	while(position < inCharVector.size())
+	{
+		size_t encodedLength = 0;
+
+		while((position < inCharVector.size()) && (inCharVector[position] != ':'))
+		{
+			if((inCharVector[position] < '0') || (inCharVector[position] > '9'))
+			{
+				throw std::runtime_error("malformed batch length");
+			}
+
+			encodedLength = (encodedLength * 10) + (inCharVector[position] - '0');
+			position++;
+		}
+
+		// skip the ':'
+		position++;
+
+		if((position > inCharVector.size())
+			|| (encodedLength > inCharVector.size() - position))
+		{
+			throw std::runtime_error("truncated batch");
+		}
+
+		outMessages.push_back(dataMessage(std::vector<char>(
+			inCharVector.begin() + position,
+			inCharVector.begin() + position + encodedLength)));
+
+		position += encodedLength;
+	}
+
+	return outMessages;
+};
+
+//-------------------------------------------------------- createCompressedBatch
+// Implementation notes:
+//  The prefix stays uncompressed so receivers can tell the datagrams apart
+//------------------------------------------------------------------------------
+std::vector<char> dataMessage::createCompressedBatch(
+	const std::vector<char>& inBatch)
+{
+	const std::string prefix(constants::compressedBatchPrefix());
+
+	const std::vector<char> compressedBatch(
+		lzCompressor::compress(inBatch));
+
+	std::vector<char> outDatagram;
+	outDatagram.reserve(prefix.size() + compressedBatch.size());
+
+	outDatagram.insert(outDatagram.end(), prefix.begin(), prefix.end());
+	outDatagram.insert(outDatagram.end(), compressedBatch.begin(), compressedBatch.end());
+
+	return outDatagram;
+};
+
+//------------------------------------------------------------ isCompressedBatch
+// Implementation notes:
+//  Compares the start of the datagram with the compressed batch prefix
+//------------------------------------------------------------------------------
+bool dataMessage::isCompressedBatch(
+	const std::vector<char>& inCharVector)
+{
+	const std::string prefix(constants::compressedBatchPrefix());
+
+	return (inCharVector.size() >= prefix.size())
+		&& std::equal(prefix.begin(), prefix.end(), inCharVector.begin());
+};
+
+//--------------------------------------------------------- parseCompressedBatch
+// Implementation notes:
+//  Senders never compress more than a handoff batch, so anything claiming
+//  to be longer is refused before it is decompressed
+//------------------------------------------------------------------------------
+std::vector<dataMessage> dataMessage::parseCompressedBatch(
+	const std::vector<char>& inCharVector)
+{
+	const std::vector<char> batch(lzCompressor::decompress(
+		inCharVector,
+		constants::compressedBatchPrefix().size(),
+		constants::handoffMaximumBatchLength));
+
+	if(!dataMessage::isBatch(batch))
+	{
+		throw std::runtime_error("compressed datagram is not a batch");
+	}
+
+	return dataMessage::parseBatch(batch);
 };
\ No newline at end of file
@@ -69,7 +69,8 @@ public:
 	// Brief Description
 	//  Constructor for the data message. Used primarily for receiving
 	//  messages. Messages arrive as a vector of chars, and this constructor 
-	//  turns it back to the more usable data message object.
+	//  turns it back to the more usable data message object. Throws if the
+	//  checksum trailer does not match, so corrupt messages are never parsed.
 	//
 	// Method:    dataMessage
 	// FullName:  dataMessage::dataMessage
@@ -94,6 +95,19 @@ public:
 	//--------------------------------------------------------------------------
 	const int64_t& viewSequenceNumber() const;
 
+	//-------------------------------------------------------- setSequenceNumber
+	// Brief Description
+	//  Sets the sequence number to the inSequenceNumber for this object.
+	//
+	// Method:    setSequenceNumber
+	// FullName:  dataMessage::setSequenceNumber
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int64_t& inSequenceNumber
+	//--------------------------------------------------------------------------
+	void setSequenceNumber(
+		const int64_t& inSequenceNumber);
+
 	//---------------------------------------------------------- viewMessageType
 	// Brief Description
 	//  Returns a const reference to the message type. This tells the server
@@ -172,6 +186,34 @@ public:
 	// Returns:   const int8_t&
 	//--------------------------------------------------------------------------
 	const int8_t& viewServerSyncPayloadOriginIndex() const;
+
+	//---------------------------------------------------------- viewHasChecksum
+	// Brief Description
+	//  Returns whether the message arrived with a checksum trailer. Peers
+	//  built before the trailer was added send messages without one, which
+	//  cannot be checked. Messages created to be sent always have one.
+	//
+	// Method:    viewHasChecksum
+	// FullName:  dataMessage::viewHasChecksum
+	// Access:    public 
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool viewHasChecksum() const;
+
+	//------------------------------------------ setServerSyncPayloadOriginIndex
+	// Brief Description
+	//  Sets the origin index for this object. Servers also use it on client
+	//  messages they forward, to record which server forwarded it, so the
+	//  next server keeps forwarding away from it.
+	//
+	// Method:    setServerSyncPayloadOriginIndex
+	// FullName:  dataMessage::setServerSyncPayloadOriginIndex
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int8_t& inServerSyncPayloadOriginIndex
+	//--------------------------------------------------------------------------
+	void setServerSyncPayloadOriginIndex(
+		const int8_t& inServerSyncPayloadOriginIndex);
 	
 	//------------------------------------------------------ stringToMessageType
 	// Brief Description
@@ -224,11 +266,53 @@ public:
 	//--------------------------------------------------------------------------
 	std::vector<std::string> viewServerSyncPayload() const;
 
+	//--------------------------------------------------------- viewPayloadField
+	// Brief Description
+	//  Control messages (connect, ping, ...) carry their parameters as a list
+	//  of key=value entries, built with createServerSyncPayload. Returns the
+	//  value stored under the given key, or an empty string if there is none.
+	//
+	// Method:    viewPayloadField
+	// FullName:  dataMessage::viewPayloadField
+	// Access:    public 
+	// Returns:   std::string
+	// Parameter: const std::string& inKey
+	//--------------------------------------------------------------------------
+	std::string viewPayloadField(
+		const std::string& inKey) const;
+
+	//-------------------------------------------------- viewPayloadCapabilities
+	// Brief Description
+	//  Returns the capability bits a control message announces in its caps
+	//  field, or none if it carries no such field.
+	//
+	// Method:    viewPayloadCapabilities
+	// FullName:  dataMessage::viewPayloadCapabilities
+	// Access:    public 
+	// Returns:   uint32_t
+	//--------------------------------------------------------------------------
+	uint32_t viewPayloadCapabilities() const;
+
+	//-------------------------------------------------------- capabilitiesField
+	// Brief Description
+	//  Creates the caps field announcing the given capability bits, to be
+	//  added to the fields of a control message.
+	//
+	// Method:    capabilitiesField
+	// FullName:  dataMessage::capabilitiesField
+	// Access:    public static 
+	// Returns:   std::string
+	// Parameter: const uint32_t& inCapabilities
+	//--------------------------------------------------------------------------
+	static std::string capabilitiesField(
+		const uint32_t& inCapabilities);
+
 	//------------------------------------------------------------- asCharVector
 	// Brief Description
 	//  Returns a vector of chars that represents this dataMessage object. This
 	//  is used to send messages both ways between the client and server through
-	//  the boost library functions.
+	//  the boost library functions. It ends in a CRC32C trailer, which peers
+	//  built before the trailer was added skip as it follows the last field.
 	//
 	// Method:    asCharVector
 	// FullName:  dataMessage::asCharVector
@@ -237,6 +321,107 @@ public:
 	//--------------------------------------------------------------------------
 	std::vector<char> asCharVector() const;
 
+	//-------------------------------------------------------------- createBatch
+	// Brief Description
+	//  Packs several messages into a single datagram. Each message is
+	//  prefixed with its encoded length, and the datagram with the batch
+	//  prefix.
+	//
+	// Method:    createBatch
+	// FullName:  dataMessage::createBatch
+	// Access:    public static 
+	// Returns:   std::vector<char>
+	// Parameter: const std::vector<dataMessage>& inMessages
+	//--------------------------------------------------------------------------
+	static std::vector<char> createBatch(
+		const std::vector<dataMessage>& inMessages);
+
+	//------------------------------------------------------------ appendToBatch
+	// Brief Description
+	//  Appends an already encoded message to a batch. An empty batch is
+	//  given the batch prefix first. Lets a sender build a batch from stored
+	//  encodings without encoding the messages again.
+	//
+	// Method:    appendToBatch
+	// FullName:  dataMessage::appendToBatch
+	// Access:    public static 
+	// Returns:   void
+	// Parameter: std::vector<char>& ioBatch
+	// Parameter: const std::vector<char>& inEncodedMessage
+	//--------------------------------------------------------------------------
+	static void appendToBatch(
+		std::vector<char>& ioBatch,
+		const std::vector<char>& inEncodedMessage);
+
+	//------------------------------------------------------------------ isBatch
+	// Brief Description
+	//  Determines if a received datagram is a batch of messages rather than a
+	//  single message.
+	//
+	// Method:    isBatch
+	// FullName:  dataMessage::isBatch
+	// Access:    public static 
+	// Returns:   bool
+	// Parameter: const std::vector<char>& inCharVector
+	//--------------------------------------------------------------------------
+	static bool isBatch(
+		const std::vector<char>& inCharVector);
+
+	//--------------------------------------------------------------- parseBatch
+	// Brief Description
+	//  Unpacks a datagram created with createBatch back into the messages it
+	//  carries. Throws if the datagram is truncated or malformed.
+	//
+	// Method:    parseBatch
+	// FullName:  dataMessage::parseBatch
+	// Access:    public static 
+	// Returns:   std::vector<dataMessage>
+	// Parameter: const std::vector<char>& inCharVector
+	//--------------------------------------------------------------------------
+	static std::vector<dataMessage> parseBatch(
+		const std::vector<char>& inCharVector);
+
+	//---------------------------------------------------- createCompressedBatch
+	// Brief Description
+	//  Compresses a batch built with createBatch or appendToBatch, and puts
+	//  the compressed batch prefix in front of it.
+	//
+	// Method:    createCompressedBatch
+	// FullName:  dataMessage::createCompressedBatch
+	// Access:    public static 
+	// Returns:   std::vector<char>
+	// Parameter: const std::vector<char>& inBatch
+	//--------------------------------------------------------------------------
+	static std::vector<char> createCompressedBatch(
+		const std::vector<char>& inBatch);
+
+	//-------------------------------------------------------- isCompressedBatch
+	// Brief Description
+	//  Determines if a received datagram is a compressed batch of messages.
+	//
+	// Method:    isCompressedBatch
+	// FullName:  dataMessage::isCompressedBatch
+	// Access:    public static 
+	// Returns:   bool
+	// Parameter: const std::vector<char>& inCharVector
+	//--------------------------------------------------------------------------
+	static bool isCompressedBatch(
+		const std::vector<char>& inCharVector);
+
+	//----------------------------------------------------- parseCompressedBatch
+	// Brief Description
+	//  Unpacks a datagram created with createCompressedBatch back into the
+	//  messages it carries. Throws if the datagram is malformed.
+	//
+	// Method:    parseCompressedBatch
+	// FullName:  dataMessage::parseCompressedBatch
+	// Access:    public static 
+	// Returns:   std::vector<dataMessage>
+	// Parameter: const std::vector<char>& inCharVector
+	//--------------------------------------------------------------------------
+	static std::vector<dataMessage> parseCompressedBatch(
+		const std::vector<char>& inCharVector);
+
 private:	
 	// Member Variables
 	int64_t m_sequenceNumber;
@@ -245,4 +430,5 @@ private:
 	std::string m_destinationIdentifier;
 	std::string m_payload;
 	int8_t m_serverSyncPayloadOriginIndex;
+	bool m_hasChecksum;
 };
\ No newline at end of file
@@ -0,0 +1,31 @@
+// Project
+#include "encodedMessage.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Encodes the message up front, it is never modified afterwards
+//------------------------------------------------------------------------------
+encodedMessage::encodedMessage(
+	const dataMessage& inMessage) :
+	m_message(inMessage),
+	m_encoded(inMessage.asCharVector())
+{
+};
+
+//------------------------------------------------------------------ viewMessage
+// Implementation notes:
+//  Returns a const reference to the message
+//------------------------------------------------------------------------------
+const dataMessage& encodedMessage::viewMessage() const
+{
+	return this->m_message;
+};
+
+//------------------------------------------------------------------ viewEncoded
+// Implementation notes:
+//  Returns a const reference to the encoded buffer
+//------------------------------------------------------------------------------
+const std::vector<char>& encodedMessage::viewEncoded() const
+{
+	return this->m_encoded;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// Project
+#include "dataMessage.h"
+
+class encodedMessage
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the encoded message. Encodes the data message once, so
+	//  every recipient it is delivered to can be sent the same buffer.
+	//
+	// Method:    encodedMessage
+	// FullName:  encodedMessage::encodedMessage
+	// Access:    public 
+	// Returns:   
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	encodedMessage(
+		const dataMessage& inMessage);
+
+	//-------------------------------------------------------------- viewMessage
+	// Brief Description
+	//  Returns a const reference to the data message that was encoded.
+	//
+	// Method:    viewMessage
+	// FullName:  encodedMessage::viewMessage
+	// Access:    public 
+	// Returns:   const dataMessage&
+	//--------------------------------------------------------------------------
+	const dataMessage& viewMessage() const;
+
+	//-------------------------------------------------------------- viewEncoded
+	// Brief Description
+	//  Returns a const reference to the encoded form of the message, ready to
+	//  be handed to a send call.
+	//
+	// Method:    viewEncoded
+	// FullName:  encodedMessage::viewEncoded
+	// Access:    public 
+	// Returns:   const std::vector<char>&
+	//--------------------------------------------------------------------------
+	const std::vector<char>& viewEncoded() const;
+
+private:
+	// Member Variables
+	dataMessage m_message;
+	std::vector<char> m_encoded;
+};
@@ -0,0 +1,286 @@
+// STL
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+// Project
+#include "lzCompressor.h"
+
+//--------------------------------------------------------------------- compress
+// Implementation notes:
+//  Greedy parse. A hash table of 4 byte sequences remembers where each was
+//  last seen, and a match is taken whenever the remembered position still
+//  holds the same bytes.
+//------------------------------------------------------------------------------
+std::vector<char> lzCompressor::compress(
+	const std::vector<char>& inData)
+{
+	std::vector<char> outData;
+	outData.reserve((inData.size() / 2) + 16);
+
+	uint64_t length = inData.size();
+
+	for(uint16_t i = 0; i < 8; i++)
+	{
+		outData.push_back(static_cast<char>(length & 0xFF));
+		length >>= 8;
+	}
+
+	std::vector<int64_t> lastSeen(size_t(1) << lzCompressor::hashBits, -1);
+
+	const char* data = inData.data();
+	size_t anchor = 0;
+	size_t position = 0;
+
+	while(position + lzCompressor::minimumMatchLength <= inData.size())
+	{
+		const uint32_t word = lzCompressor::readWord(data + position);
+		const size_t hash = (word * 2654435761U) >> (32 - lzCompressor::hashBits);
+
+		const int64_t candidate = lastSeen[hash];
+		lastSeen[hash] = position;
+
+		if((candidate < 0)
+			|| (position - static_cast<size_t>(candidate) > lzCompressor::maximumMatchOffset)
+			|| (lzCompressor::readWord(data + candidate) != word))
+		{
+			position++;
+			continue;
+		}
+
+		size_t matchLength = lzCompressor::minimumMatchLength;
+
+		while((position + matchLength < inData.size())
+			&& (data[candidate + matchLength] == data[position + matchLength]))
+		{
+			matchLength++;
+		}
+
+		lzCompressor::writeSequence(
+			outData,
+			data + anchor,
+			position - anchor,
+			position - candidate,
+			matchLength);
+
+		position += matchLength;
+		anchor = position;
+	}
+
+	lzCompressor::writeSequence(
+		outData,
+		data + anchor,
+		inData.size() - anchor,
+		0,
+		0);
+
+	return outData;
+};
+
+//------------------------------------------------------------------- decompress
+// Implementation notes:
+//  Every length and offset is checked against the input and the declared
+//  length, since the input arrives from the network. Matches may overlap
+//  their own output, so they are copied a byte at a time.
+//------------------------------------------------------------------------------
+std::vector<char> lzCompressor::decompress(
+	const std::vector<char>& inData,
+	const size_t& inOffset,
+	const size_t& inMaximumLength)
+{
+	if((inOffset > inData.size()) || (inData.size() - inOffset < 8))
+	{
+		throw std::runtime_error("truncated compressed data");
+	}
+
+	uint64_t length = 0;
+
+	for(uint16_t i = 0; i < 8; i++)
+	{
+		length |= uint64_t(static_cast<unsigned char>(inData[inOffset + i])) << (8 * i);
+	}
+
+	if(length > inMaximumLength)
+	{
+		throw std::runtime_error("compressed data too long");
+	}
+
+	std::vector<char> outData;
+	outData.reserve(static_cast<size_t>(length));
+
+	size_t position = inOffset + 8;
+
+	while(true)
+	{
+		if(position >= inData.size())
+		{
+			throw std::runtime_error("truncated compressed data");
+		}
+
+		const unsigned char token = static_cast<unsigned char>(inData[position++]);
+
+		const size_t literalLength = lzCompressor::readLength(
+			inData,
+			position,
+			token >> 4);
+
+		if((literalLength > inData.size() - position)
+			|| (literalLength > length - outData.size()))
+		{
+			throw std::runtime_error("malformed compressed data");
+		}
+
+		outData.insert(
+			outData.end(),
+			inData.begin() + position,
+			inData.begin() + position + literalLength);
+
+		position += literalLength;
+
+		if(outData.size() == length)
+		{
+			return outData;
+		}
+
+		if(inData.size() - position < 2)
+		{
+			throw std::runtime_error("truncated compressed data");
+		}
+
+		const size_t matchOffset =
+			static_cast<unsigned char>(inData[position])
+			| (size_t(static_cast<unsigned char>(inData[position + 1])) << 8);
+
+		position += 2;
+
+		const size_t matchLength = lzCompressor::minimumMatchLength + lzCompressor::readLength(
+			inData,
+			position,
+			token & 0x0F);
+
+		if((matchOffset == 0)
+			|| (matchOffset > outData.size())
+			|| (matchLength > length - outData.size()))
+		{
+			throw std::runtime_error("malformed compressed data");
+		}
+
+		const size_t matchBegin = outData.size() - matchOffset;
+
+		for(size_t i = 0; i < matchLength; i++)
+		{
+			outData.push_back(outData[matchBegin + i]);
+		}
+	}
+};
+
+//---------------------------------------------------------------- writeSequence
+// Implementation notes:
+//  Nibbles of 15 mean the length continues after the token
+//------------------------------------------------------------------------------
+void lzCompressor::writeSequence(
+	std::vector<char>& ioOutput,
+	const char* inLiterals,
+	const size_t& inLiteralLength,
+	const size_t& inMatchOffset,
+	const size_t& inMatchLength)
+{
+	const size_t matchNibbleValue =
+		(inMatchLength == 0) ? 0 : (inMatchLength - lzCompressor::minimumMatchLength);
+
+	const size_t literalNibble = std::min<size_t>(inLiteralLength, 15);
+	const size_t matchNibble = std::min<size_t>(matchNibbleValue, 15);
+
+	ioOutput.push_back(static_cast<char>((literalNibble << 4) | matchNibble));
+
+	if(literalNibble == 15)
+	{
+		lzCompressor::writeLength(
+			ioOutput,
+			inLiteralLength - 15);
+	}
+
+	ioOutput.insert(
+		ioOutput.end(),
+		inLiterals,
+		inLiterals + inLiteralLength);
+
+	if(inMatchLength == 0)
+	{
+		return;
+	}
+
+	ioOutput.push_back(static_cast<char>(inMatchOffset & 0xFF));
+	ioOutput.push_back(static_cast<char>(inMatchOffset >> 8));
+
+	if(matchNibble == 15)
+	{
+		lzCompressor::writeLength(
+			ioOutput,
+			matchNibbleValue - 15);
+	}
+};
+
+//------------------------------------------------------------------ writeLength
+// Implementation notes:
+//  A remainder of 255 is followed by a zero byte so the reader can stop
+//------------------------------------------------------------------------------
+void lzCompressor::writeLength(
+	std::vector<char>& ioOutput,
+	size_t inLength)
+{
+	while(inLength >= 255)
+	{
+		ioOutput.push_back(static_cast<char>(255));
+		inLength -= 255;
+	}
+
+	ioOutput.push_back(static_cast<char>(inLength));
+};
+
+//------------------------------------------------------------------- readLength
+// Implementation notes:
+//  Only a nibble of 15 has extension bytes
+//------------------------------------------------------------------------------
+size_t lzCompressor::readLength(
+	const std::vector<char>& inData,
+	size_t& ioPosition,
+	const size_t& inNibble)
+{
+	size_t outLength = inNibble;
+
+	if(inNibble != 15)
+	{
+		return outLength;
+	}
+
+	while(true)
+	{
+		if(ioPosition >= inData.size())
+		{
+			throw std::runtime_error("truncated compressed data");
+		}
+
+		const unsigned char extension = static_cast<unsigned char>(inData[ioPosition++]);
+
+		outLength += extension;
+
+		if(extension != 255)
+		{
+			return outLength;
+		}
+	}
+};
+
+//--------------------------------------------------------------------- readWord
+// Implementation notes:
+//  memcpy, since the position need not be aligned
+//------------------------------------------------------------------------------
+uint32_t lzCompressor::readWord(
+	const char* inPosition)
+{
+	uint32_t outWord;
+	std::memcpy(&outWord, inPosition, sizeof(outWord));
+
+	return outWord;
+};
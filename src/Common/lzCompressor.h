@@ -0,0 +1,125 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class lzCompressor
+{
+public:
+
+	//----------------------------------------------------------------- compress
+	// Brief Description
+	//  Compresses a buffer with a byte oriented LZ77 scheme. Fast enough for
+	//  batches of messages on their way between servers, where the same
+	//  usernames and field layout repeat in every message.
+	//
+	// Method:    compress
+	// FullName:  lzCompressor::compress
+	// Access:    public static 
+	// Returns:   std::vector<char>
+	// Parameter: const std::vector<char>& inData
+	//--------------------------------------------------------------------------
+	static std::vector<char> compress(
+		const std::vector<char>& inData);
+
+	//--------------------------------------------------------------- decompress
+	// Brief Description
+	//  Restores a buffer created with compress, starting at the given offset
+	//  of the input. Throws if the input is malformed or would decompress to
+	//  more than the maximum length.
+	//
+	// Method:    decompress
+	// FullName:  lzCompressor::decompress
+	// Access:    public static 
+	// Returns:   std::vector<char>
+	// Parameter: const std::vector<char>& inData
+	// Parameter: const size_t& inOffset
+	// Parameter: const size_t& inMaximumLength
+	//--------------------------------------------------------------------------
+	static std::vector<char> decompress(
+		const std::vector<char>& inData,
+		const size_t& inOffset,
+		const size_t& inMaximumLength);
+
+private:
+
+	// Layout: the decompressed length as 8 little endian bytes, then
+	// sequences of a token byte (literal length in the high nibble, match
+	// length minus the minimum in the low one), any extended literal length,
+	// the literals, a 2 byte little endian match offset and any extended
+	// match length. The last sequence has literals only.
+	static const size_t minimumMatchLength = 4;
+	static const size_t maximumMatchOffset = 65535;
+	static const uint16_t hashBits = 12;
+
+	//------------------------------------------------------------ writeSequence
+	// Brief Description
+	//  Appends a run of literals followed by a match. A match length of zero
+	//  ends the stream after the literals.
+	//
+	// Method:    writeSequence
+	// FullName:  lzCompressor::writeSequence
+	// Access:    private static 
+	// Returns:   void
+	// Parameter: std::vector<char>& ioOutput
+	// Parameter: const char* inLiterals
+	// Parameter: const size_t& inLiteralLength
+	// Parameter: const size_t& inMatchOffset
+	// Parameter: const size_t& inMatchLength
+	//--------------------------------------------------------------------------
+	static void writeSequence(
+		std::vector<char>& ioOutput,
+		const char* inLiterals,
+		const size_t& inLiteralLength,
+		const size_t& inMatchOffset,
+		const size_t& inMatchLength);
+
+	//-------------------------------------------------------------- writeLength
+	// Brief Description
+	//  Appends the part of a length that did not fit its token nibble, as
+	//  bytes of 255 followed by the remainder.
+	//
+	// Method:    writeLength
+	// FullName:  lzCompressor::writeLength
+	// Access:    private static 
+	// Returns:   void
+	// Parameter: std::vector<char>& ioOutput
+	// Parameter: size_t inLength
+	//--------------------------------------------------------------------------
+	static void writeLength(
+		std::vector<char>& ioOutput,
+		size_t inLength);
+
+	//--------------------------------------------------------------- readLength
+	// Brief Description
+	//  Reads a length written by writeLength and adds it to the nibble value.
+	//  Throws if the input ends first.
+	//
+	// Method:    readLength
+	// FullName:  lzCompressor::readLength
+	// Access:    private static 
+	// Returns:   size_t
+	// Parameter: const std::vector<char>& inData
+	// Parameter: size_t& ioPosition
+	// Parameter: const size_t& inNibble
+	//--------------------------------------------------------------------------
+	static size_t readLength(
+		const std::vector<char>& inData,
+		size_t& ioPosition,
+		const size_t& inNibble);
+
+	//----------------------------------------------------------------- readWord
+	// Brief Description
+	//  Reads four bytes starting at the given position.
+	//
+	// Method:    readWord
+	// FullName:  lzCompressor::readWord
+	// Access:    private static 
+	// Returns:   uint32_t
+	// Parameter: const char* inPosition
+	//--------------------------------------------------------------------------
+	static uint32_t readWord(
+		const char* inPosition);
+};
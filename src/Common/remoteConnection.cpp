@@ -1,8 +1,10 @@
 // STL
+#include <algorithm>
 #include <cassert>
 
 // Project
 #include "remoteConnection.h"
+#include "constants.h"
 
 //------------------------------------------------------------------ constructor
 // Implementation notes:
@@ -15,6 +17,8 @@ remoteConnection::remoteConnection(
 	this->m_identifier = inIdentifier;
 	this->m_endpoint = inEndpoint;
 	this->m_timeOfLastActivity = boost::chrono::system_clock::now();
+	this->m_acknowledgedMailboxEntry = 0;
+	this->m_capabilities = 0;
 };
 
 //--------------------------------------------------------------- viewIdentifier
@@ -51,4 +55,84 @@ const boost::chrono::system_clock::time_point& remoteConnection::viewTimeOfLastA
 void remoteConnection::refreshTimeOfLastActivity()
 {
 	this->m_timeOfLastActivity = boost::chrono::system_clock::now();
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------ setEndpoint
+// Implementation notes:
+//  Sets the endpoint to the inEndpoint for this connection
+//------------------------------------------------------------------------------
+void remoteConnection::setEndpoint(
+	const boost::asio::ip::udp::endpoint& inEndpoint)
+{
+	this->m_endpoint = inEndpoint;
+};
+
+//-------------------------------------------------------------- viewResumeToken
+// Implementation notes:
+//  Returns a const reference to the resume token
+//------------------------------------------------------------------------------
+const std::string& remoteConnection::viewResumeToken() const
+{
+	return this->m_resumeToken;
+};
+
+//--------------------------------------------------------------- setResumeToken
+// Implementation notes:
+//  Sets the resume token to the inResumeToken for this connection
+//------------------------------------------------------------------------------
+void remoteConnection::setResumeToken(
+	const std::string& inResumeToken)
+{
+	this->m_resumeToken = inResumeToken;
+};
+
+//------------------------------------------------------------- viewCapabilities
+// Implementation notes:
+//  Returns a const reference to the capabilities
+//------------------------------------------------------------------------------
+const uint32_t& remoteConnection::viewCapabilities() const
+{
+	return this->m_capabilities;
+};
+
+//-------------------------------------------------------------- setCapabilities
+// Implementation notes:
+//  Bits this build does not know are dropped, so they are never acted on
+//------------------------------------------------------------------------------
+void remoteConnection::setCapabilities(
+	const uint32_t& inCapabilities)
+{
+	this->m_capabilities = inCapabilities & constants::localCapabilities;
+};
+
+//------------------------------------------------------------------ acknowledge
+// Implementation notes:
+//  The cursor only moves forward, so late or repeated acknowledgements of
+//  earlier entries change nothing
+//------------------------------------------------------------------------------
+void remoteConnection::acknowledge(
+	const int64_t& inMailboxEntry)
+{
+	this->m_acknowledgedMailboxEntry = std::max(
+		this->m_acknowledgedMailboxEntry,
+		inMailboxEntry);
+};
+
+//-------------------------------------------------------------- hasAcknowledged
+// Implementation notes:
+//  Compares the id with the cursor
+//------------------------------------------------------------------------------
+bool remoteConnection::hasAcknowledged(
+	const int64_t& inMailboxEntry) const
+{
+	return inMailboxEntry <= this->m_acknowledgedMailboxEntry;
+};
+
+//------------------------------------------------- viewAcknowledgedMailboxEntry
+// Implementation notes:
+//  Returns a const reference to the cursor
+//------------------------------------------------------------------------------
+const int64_t& remoteConnection::viewAcknowledgedMailboxEntry() const
+{
+	return this->m_acknowledgedMailboxEntry;
+};
\ No newline at end of file
@@ -75,8 +75,118 @@ public:
 	//--------------------------------------------------------------------------
 	void refreshTimeOfLastActivity();
 
+	//-------------------------------------------------------------- setEndpoint
+	// Brief Description
+	//  Replaces the endpoint of this connection, used when a known session
+	//  reconnects from a different address or port.
+	//
+	// Method:    setEndpoint
+	// FullName:  remoteConnection::setEndpoint
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const boost::asio::ip::udp::endpoint& inEndpoint
+	//--------------------------------------------------------------------------
+	void setEndpoint(
+		const boost::asio::ip::udp::endpoint& inEndpoint);
+
+	//---------------------------------------------------------- viewResumeToken
+	// Brief Description
+	//  Returns a const reference to the resume token the client presented
+	//  when it connected. A connect carrying the same token continues this
+	//  session rather than starting a new one.
+	//
+	// Method:    viewResumeToken
+	// FullName:  remoteConnection::viewResumeToken
+	// Access:    public 
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewResumeToken() const;
+
+	//----------------------------------------------------------- setResumeToken
+	// Brief Description
+	//  Sets the resume token for this connection.
+	//
+	// Method:    setResumeToken
+	// FullName:  remoteConnection::setResumeToken
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::string& inResumeToken
+	//--------------------------------------------------------------------------
+	void setResumeToken(
+		const std::string& inResumeToken);
+
+	//--------------------------------------------------------- viewCapabilities
+	// Brief Description
+	//  Returns the capabilities the peer announced that this end shares,
+	//  none until it announces any.
+	//
+	// Method:    viewCapabilities
+	// FullName:  remoteConnection::viewCapabilities
+	// Access:    public 
+	// Returns:   const uint32_t&
+	//--------------------------------------------------------------------------
+	const uint32_t& viewCapabilities() const;
+
+	//---------------------------------------------------------- setCapabilities
+	// Brief Description
+	//  Sets the capabilities the peer announced, keeping only those this end
+	//  shares.
+	//
+	// Method:    setCapabilities
+	// FullName:  remoteConnection::setCapabilities
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const uint32_t& inCapabilities
+	//--------------------------------------------------------------------------
+	void setCapabilities(
+		const uint32_t& inCapabilities);
+
+	//-------------------------------------------------------------- acknowledge
+	// Brief Description
+	//  Records that this connection received the mailbox entry with the given
+	//  id and every entry before it. Each session of a user keeps its own
+	//  cursor, so an entry is only dropped once every one of them is past it.
+	//
+	// Method:    acknowledge
+	// FullName:  remoteConnection::acknowledge
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int64_t& inMailboxEntry
+	//--------------------------------------------------------------------------
+	void acknowledge(
+		const int64_t& inMailboxEntry);
+
+	//---------------------------------------------------------- hasAcknowledged
+	// Brief Description
+	//  Determines if this connection already acknowledged the mailbox entry
+	//  with the given id.
+	//
+	// Method:    hasAcknowledged
+	// FullName:  remoteConnection::hasAcknowledged
+	// Access:    public 
+	// Returns:   bool
+	// Parameter: const int64_t& inMailboxEntry
+	//--------------------------------------------------------------------------
+	bool hasAcknowledged(
+		const int64_t& inMailboxEntry) const;
+
+	//--------------------------------------------- viewAcknowledgedMailboxEntry
+	// Brief Description
+	//  Returns the id of the last mailbox entry this connection acknowledged,
+	//  zero if it acknowledged none.
+	//
+	// Method:    viewAcknowledgedMailboxEntry
+	// FullName:  remoteConnection::viewAcknowledgedMailboxEntry
+	// Access:    public 
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& viewAcknowledgedMailboxEntry() const;
+
 private:
 	std::string m_identifier;
 	boost::asio::ip::udp::endpoint m_endpoint;
 	boost::chrono::system_clock::time_point m_timeOfLastActivity;	
+	int64_t m_acknowledgedMailboxEntry;
+	std::string m_resumeToken;
+	uint32_t m_capabilities;
 };
\ No newline at end of file
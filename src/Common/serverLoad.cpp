@@ -0,0 +1,109 @@
+// Project
+#include "serverLoad.h"
+#include "constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Everything zero
+//------------------------------------------------------------------------------
+serverLoad::serverLoad() :
+	m_connectedClients(0),
+	m_ingressPacketsPerSecond(0),
+	m_queueDepth(0)
+{
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Used to create a load report to send
+//------------------------------------------------------------------------------
+serverLoad::serverLoad(
+	const int64_t& inConnectedClients,
+	const int64_t& inIngressPacketsPerSecond,
+	const int64_t& inQueueDepth) :
+	m_connectedClients(inConnectedClients),
+	m_ingressPacketsPerSecond(inIngressPacketsPerSecond),
+	m_queueDepth(inQueueDepth)
+{
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Used to read a load report from a received message
+//------------------------------------------------------------------------------
+serverLoad::serverLoad(
+	const dataMessage& inMessage) :
+	m_connectedClients(0),
+	m_ingressPacketsPerSecond(0),
+	m_queueDepth(0)
+{
+	const std::string connectedClients = inMessage.viewPayloadField("clients");
+	const std::string ingressPacketsPerSecond = inMessage.viewPayloadField("pps");
+	const std::string queueDepth = inMessage.viewPayloadField("queue");
+
+	if(!connectedClients.empty())
+	{
+		this->m_connectedClients = std::stoll(connectedClients);
+	}
+
+	if(!ingressPacketsPerSecond.empty())
+	{
+		this->m_ingressPacketsPerSecond = std::stoll(ingressPacketsPerSecond);
+	}
+
+	if(!queueDepth.empty())
+	{
+		this->m_queueDepth = std::stoll(queueDepth);
+	}
+};
+
+//--------------------------------------------------------- viewConnectedClients
+// Implementation notes:
+//  Returns a const reference to the number of connected clients
+//------------------------------------------------------------------------------
+const int64_t& serverLoad::viewConnectedClients() const
+{
+	return this->m_connectedClients;
+};
+
+//-------------------------------------------------- viewIngressPacketsPerSecond
+// Implementation notes:
+//  Returns a const reference to the ingress packet rate
+//------------------------------------------------------------------------------
+const int64_t& serverLoad::viewIngressPacketsPerSecond() const
+{
+	return this->m_ingressPacketsPerSecond;
+};
+
+//--------------------------------------------------------------- viewQueueDepth
+// Implementation notes:
+//  Returns a const reference to the queue depth
+//------------------------------------------------------------------------------
+const int64_t& serverLoad::viewQueueDepth() const
+{
+	return this->m_queueDepth;
+};
+
+//------------------------------------------------------------------------ score
+// Implementation notes:
+//  Traffic and backlog are converted to the number of idle clients that
+//  would cost the same, rounding down
+//------------------------------------------------------------------------------
+int64_t serverLoad::score() const
+{
+	return this->m_connectedClients
+		+ (this->m_ingressPacketsPerSecond / constants::loadPacketsPerSecondPerClient)
+		+ (this->m_queueDepth / constants::loadQueueDepthPerClient);
+};
+
+//-------------------------------------------------------------- asPayloadFields
+// Implementation notes:
+//  Field names match the ones read by the message constructor
+//------------------------------------------------------------------------------
+std::vector<std::string> serverLoad::asPayloadFields() const
+{
+	return std::vector<std::string>({
+		"clients=" + std::to_string(this->m_connectedClients),
+		"pps=" + std::to_string(this->m_ingressPacketsPerSecond),
+		"queue=" + std::to_string(this->m_queueDepth)});
+};
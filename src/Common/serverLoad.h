@@ -0,0 +1,121 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Project
+#include "dataMessage.h"
+
+class serverLoad
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for an empty load report, a server nothing is known about
+	//
+	// Method:    serverLoad
+	// FullName:  serverLoad::serverLoad
+	// Access:    public 
+	// Returns:   
+	//--------------------------------------------------------------------------
+	serverLoad();
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the load report of a server
+	//
+	// Method:    serverLoad
+	// FullName:  serverLoad::serverLoad
+	// Access:    public 
+	// Returns:   
+	// Parameter: const int64_t& inConnectedClients
+	// Parameter: const int64_t& inIngressPacketsPerSecond
+	// Parameter: const int64_t& inQueueDepth
+	//--------------------------------------------------------------------------
+	serverLoad(
+		const int64_t& inConnectedClients,
+		const int64_t& inIngressPacketsPerSecond,
+		const int64_t& inQueueDepth);
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor used to read the load report carried by a received load
+	//  frame or ping reply. Missing fields read as zero.
+	//
+	// Method:    serverLoad
+	// FullName:  serverLoad::serverLoad
+	// Access:    public 
+	// Returns:   
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	serverLoad(
+		const dataMessage& inMessage);
+
+	//----------------------------------------------------- viewConnectedClients
+	// Brief Description
+	//  Returns a const reference to the number of connected clients.
+	//
+	// Method:    viewConnectedClients
+	// FullName:  serverLoad::viewConnectedClients
+	// Access:    public 
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& viewConnectedClients() const;
+
+	//---------------------------------------------- viewIngressPacketsPerSecond
+	// Brief Description
+	//  Returns a const reference to the datagrams received per second over
+	//  the last sync interval.
+	//
+	// Method:    viewIngressPacketsPerSecond
+	// FullName:  serverLoad::viewIngressPacketsPerSecond
+	// Access:    public 
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& viewIngressPacketsPerSecond() const;
+
+	//----------------------------------------------------------- viewQueueDepth
+	// Brief Description
+	//  Returns a const reference to the number of messages waiting in the
+	//  server's mailboxes and forward queue.
+	//
+	// Method:    viewQueueDepth
+	// FullName:  serverLoad::viewQueueDepth
+	// Access:    public 
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& viewQueueDepth() const;
+
+	//-------------------------------------------------------------------- score
+	// Brief Description
+	//  Combines the load figures into one score measured in connected
+	//  clients, so servers can be compared. Lower is lighter.
+	//
+	// Method:    score
+	// FullName:  serverLoad::score
+	// Access:    public 
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	int64_t score() const;
+
+	//---------------------------------------------------------- asPayloadFields
+	// Brief Description
+	//  Returns the load report as key=value fields, to be encoded with
+	//  dataMessage::createServerSyncPayload.
+	//
+	// Method:    asPayloadFields
+	// FullName:  serverLoad::asPayloadFields
+	// Access:    public 
+	// Returns:   std::vector<std::string>
+	//--------------------------------------------------------------------------
+	std::vector<std::string> asPayloadFields() const;
+
+private:
+	// Member Variables
+	int64_t m_connectedClients;
+	int64_t m_ingressPacketsPerSecond;
+	int64_t m_queueDepth;
+};
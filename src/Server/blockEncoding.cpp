@@ -0,0 +1,113 @@
+// STL
+#include <stdexcept>
+
+// Project
+#include "blockEncoding.h"
+
+//------------------------------------------------------------------ appendFixed
+// Implementation notes:
+//  Little endian regardless of the host, so files move between hosts
+//------------------------------------------------------------------------------
+void blockEncoding::appendFixed(
+	std::vector<char>& ioBuffer,
+	uint64_t inValue,
+	const uint16_t& inBytes)
+{
+	for(uint16_t i = 0; i < inBytes; i++)
+	{
+		ioBuffer.push_back(static_cast<char>(inValue & 0xFF));
+		inValue >>= 8;
+	}
+};
+
+//-------------------------------------------------------------------- readFixed
+// Implementation notes:
+//  Inverse of appendFixed
+//------------------------------------------------------------------------------
+uint64_t blockEncoding::readFixed(
+	const std::vector<char>& inBuffer,
+	size_t& ioPosition,
+	const uint16_t& inBytes)
+{
+	if((ioPosition > inBuffer.size()) || (inBuffer.size() - ioPosition < inBytes))
+	{
+		throw std::runtime_error("truncated block data");
+	}
+
+	uint64_t outValue = 0;
+
+	for(uint16_t i = 0; i < inBytes; i++)
+	{
+		outValue |= uint64_t(static_cast<unsigned char>(inBuffer[ioPosition + i])) << (8 * i);
+	}
+
+	ioPosition += inBytes;
+
+	return outValue;
+};
+
+//----------------------------------------------------------------- appendString
+// Implementation notes:
+//  Keys and values are short, so the varint is usually a single byte
+//------------------------------------------------------------------------------
+void blockEncoding::appendString(
+	std::vector<char>& ioBuffer,
+	const char* inData,
+	const size_t& inLength)
+{
+	uint64_t length = inLength;
+
+	while(length >= 0x80)
+	{
+		ioBuffer.push_back(static_cast<char>((length & 0x7F) | 0x80));
+		length >>= 7;
+	}
+
+	ioBuffer.push_back(static_cast<char>(length));
+
+	ioBuffer.insert(
+		ioBuffer.end(),
+		inData,
+		inData + inLength);
+};
+
+//------------------------------------------------------------------- readString
+// Implementation notes:
+//  A varint longer than 64 bits, or a length past the end, is malformed
+//------------------------------------------------------------------------------
+std::string blockEncoding::readString(
+	const std::vector<char>& inBuffer,
+	size_t& ioPosition)
+{
+	uint64_t length = 0;
+
+	for(uint16_t shift = 0; ; shift += 7)
+	{
+		if((ioPosition >= inBuffer.size()) || (shift >= 64))
+		{
+			throw std::runtime_error("truncated block data");
+		}
+
+		const unsigned char currentByte = static_cast<unsigned char>(inBuffer[ioPosition++]);
+
+		length |= uint64_t(currentByte & 0x7F) << shift;
+
+		if((currentByte & 0x80) == 0)
+		{
+			break;
+		}
+	}
+
+	if(length > inBuffer.size() - ioPosition)
+	{
+		throw std::runtime_error("truncated block data");
+	}
+
+	const std::string outString(
+		inBuffer.begin() + ioPosition,
+		inBuffer.begin() + ioPosition + length);
+
+	ioPosition += length;
+
+	return outString;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class blockEncoding
+{
+public:
+
+	//-------------------------------------------------------------- appendFixed
+	// Brief Description
+	//  Appends the given number of low bytes of the value, little endian.
+	//
+	// Method:    appendFixed
+	// FullName:  blockEncoding::appendFixed
+	// Access:    public static 
+	// Returns:   void
+	// Parameter: std::vector<char>& ioBuffer
+	// Parameter: uint64_t inValue
+	// Parameter: const uint16_t& inBytes
+	//--------------------------------------------------------------------------
+	static void appendFixed(
+		std::vector<char>& ioBuffer,
+		uint64_t inValue,
+		const uint16_t& inBytes);
+
+	//---------------------------------------------------------------- readFixed
+	// Brief Description
+	//  Reads a value written by appendFixed and advances the position past
+	//  it. Throws if the buffer ends first.
+	//
+	// Method:    readFixed
+	// FullName:  blockEncoding::readFixed
+	// Access:    public static 
+	// Returns:   uint64_t
+	// Parameter: const std::vector<char>& inBuffer
+	// Parameter: size_t& ioPosition
+	// Parameter: const uint16_t& inBytes
+	//--------------------------------------------------------------------------
+	static uint64_t readFixed(
+		const std::vector<char>& inBuffer,
+		size_t& ioPosition,
+		const uint16_t& inBytes);
+
+	//------------------------------------------------------------- appendString
+	// Brief Description
+	//  Appends a length prefixed run of bytes. The length is a varint, 7 bits
+	//  per byte with the high bit set on every byte but the last.
+	//
+	// Method:    appendString
+	// FullName:  blockEncoding::appendString
+	// Access:    public static 
+	// Returns:   void
+	// Parameter: std::vector<char>& ioBuffer
+	// Parameter: const char* inData
+	// Parameter: const size_t& inLength
+	//--------------------------------------------------------------------------
+	static void appendString(
+		std::vector<char>& ioBuffer,
+		const char* inData,
+		const size_t& inLength);
+
+	//--------------------------------------------------------------- readString
+	// Brief Description
+	//  Reads a run of bytes written by appendString and advances the position
+	//  past it. Throws if the buffer ends first.
+	//
+	// Method:    readString
+	// FullName:  blockEncoding::readString
+	// Access:    public static 
+	// Returns:   std::string
+	// Parameter: const std::vector<char>& inBuffer
+	// Parameter: size_t& ioPosition
+	//--------------------------------------------------------------------------
+	static std::string readString(
+		const std::vector<char>& inBuffer,
+		size_t& ioPosition);
+};
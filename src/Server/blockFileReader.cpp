@@ -0,0 +1,248 @@
+// STL
+#include <stdexcept>
+#include <algorithm>
+
+// Project
+#include "blockFileReader.h"
+#include "blockEncoding.h"
+#include "../Common/constants.h"
+#include "../Common/lzCompressor.h"
+#include "../Common/crc32c.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Reads the footer from the end of the file, then the filter and index it
+//  points to. Only those are kept in memory, blocks are read when asked for.
+//------------------------------------------------------------------------------
+blockFileReader::blockFileReader(
+	const std::string& inFilePath) :
+	m_file(inFilePath, std::ios::in | std::ios::binary)
+{
+	if(!this->m_file.is_open())
+	{
+		throw std::runtime_error("unable to open " + inFilePath);
+	}
+
+	this->m_file.seekg(0, std::ios::end);
+	const uint64_t fileLength = static_cast<uint64_t>(this->m_file.tellg());
+
+	if(fileLength < constants::blockFileFooterLength)
+	{
+		throw std::runtime_error("block file is missing its footer");
+	}
+
+	const std::vector<char> footer(this->readBytes(
+		fileLength - constants::blockFileFooterLength,
+		constants::blockFileFooterLength));
+
+	size_t position = 0;
+
+	const uint64_t indexOffset = blockEncoding::readFixed(footer, position, 8);
+	const uint64_t indexLength = blockEncoding::readFixed(footer, position, 4);
+	const uint32_t indexChecksum = static_cast<uint32_t>(blockEncoding::readFixed(footer, position, 4));
+	const uint64_t filterLength = blockEncoding::readFixed(footer, position, 4);
+	const uint32_t filterChecksum = static_cast<uint32_t>(blockEncoding::readFixed(footer, position, 4));
+	const uint64_t magic = blockEncoding::readFixed(footer, position, 8);
+
+	if((magic != constants::blockFileMagic)
+		|| (indexOffset + indexLength + constants::blockFileFooterLength != fileLength)
+		|| (filterLength > indexOffset))
+	{
+		throw std::runtime_error("block file footer is corrupt");
+	}
+
+	const std::vector<char> filter(this->readBytes(
+		indexOffset - filterLength,
+		static_cast<size_t>(filterLength)));
+
+	if(crc32c::checksum(filter.data(), filter.size()) != filterChecksum)
+	{
+		throw std::runtime_error("block file filter is corrupt");
+	}
+
+	this->m_filter.assign(
+		filter.begin(),
+		filter.end());
+
+	const std::vector<char> index(this->readBytes(
+		indexOffset,
+		static_cast<size_t>(indexLength)));
+
+	if(crc32c::checksum(index.data(), index.size()) != indexChecksum)
+	{
+		throw std::runtime_error("block file index is corrupt");
+	}
+
+	position = 0;
+
+	const uint64_t blockCount = blockEncoding::readFixed(index, position, 4);
+
+	for(uint64_t i = 0; i < blockCount; i++)
+	{
+		blockHandle currentBlock;
+
+		currentBlock.firstKey = blockEncoding::readString(index, position);
+		currentBlock.lastKey = blockEncoding::readString(index, position);
+		currentBlock.offset = blockEncoding::readFixed(index, position, 8);
+		currentBlock.storedLength = static_cast<uint32_t>(blockEncoding::readFixed(index, position, 4));
+		currentBlock.rawLength = static_cast<uint32_t>(blockEncoding::readFixed(index, position, 4));
+		currentBlock.records = static_cast<uint32_t>(blockEncoding::readFixed(index, position, 4));
+		currentBlock.checksum = static_cast<uint32_t>(blockEncoding::readFixed(index, position, 4));
+
+		if(currentBlock.offset + currentBlock.storedLength > indexOffset - filterLength)
+		{
+			throw std::runtime_error("block file index is corrupt");
+		}
+
+		this->m_blocks.push_back(currentBlock);
+	}
+};
+
+//--------------------------------------------------------------- viewBlockCount
+// Implementation notes:
+//  Returns the number of blocks in the index
+//------------------------------------------------------------------------------
+size_t blockFileReader::viewBlockCount() const
+{
+	return this->m_blocks.size();
+};
+
+//------------------------------------------------------------------- viewFilter
+// Implementation notes:
+//  Returns a const reference to the filter
+//------------------------------------------------------------------------------
+const std::string& blockFileReader::viewFilter() const
+{
+	return this->m_filter;
+};
+
+//----------------------------------------------------------------- viewFirstKey
+// Implementation notes:
+//  The first key of the first block
+//------------------------------------------------------------------------------
+std::string blockFileReader::viewFirstKey() const
+{
+	return this->m_blocks.empty() ? std::string() : this->m_blocks.front().firstKey;
+};
+
+//------------------------------------------------------------------ viewLastKey
+// Implementation notes:
+//  The last key of the last block
+//------------------------------------------------------------------------------
+std::string blockFileReader::viewLastKey() const
+{
+	return this->m_blocks.empty() ? std::string() : this->m_blocks.back().lastKey;
+};
+
+//-------------------------------------------------------------------- readBlock
+// Implementation notes:
+//  The checksum is verified before decompressing, and the record count of
+//  the index after
+//------------------------------------------------------------------------------
+std::vector<blockFileReader::record> blockFileReader::readBlock(
+	const size_t& inBlock)
+{
+	const blockHandle& handle = this->m_blocks.at(inBlock);
+
+	const std::vector<char> storedBlock(this->readBytes(
+		handle.offset,
+		handle.storedLength));
+
+	if(crc32c::checksum(storedBlock.data(), storedBlock.size()) != handle.checksum)
+	{
+		throw std::runtime_error("block checksum mismatch");
+	}
+
+	const std::vector<char> rawBlock(lzCompressor::decompress(
+		storedBlock,
+		0,
+		handle.rawLength));
+
+	std::vector<record> outRecords;
+	outRecords.reserve(handle.records);
+
+	size_t position = 0;
+
+	while(position < rawBlock.size())
+	{
+		record currentRecord;
+
+		currentRecord.key = blockEncoding::readString(rawBlock, position);
+		currentRecord.value = blockEncoding::readString(rawBlock, position);
+
+		outRecords.push_back(currentRecord);
+	}
+
+	if(outRecords.size() != handle.records)
+	{
+		throw std::runtime_error("block record count mismatch");
+	}
+
+	return outRecords;
+};
+
+//------------------------------------------------------------------------- scan
+// Implementation notes:
+//  Binary search for the first block whose last key reaches the range, then
+//  reads blocks until one starts past it
+//------------------------------------------------------------------------------
+std::vector<blockFileReader::record> blockFileReader::scan(
+	const std::string& inFromKey,
+	const std::string& inToKey)
+{
+	std::vector<record> outRecords;
+
+	size_t low = 0;
+	size_t high = this->m_blocks.size();
+
+	while(low < high)
+	{
+		const size_t middle = low + ((high - low) / 2);
+
+		if(this->m_blocks[middle].lastKey < inFromKey)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	for(size_t block = low;
+		(block < this->m_blocks.size()) && (this->m_blocks[block].firstKey < inToKey);
+		block++)
+	{
+		for(const record& currentRecord : this->readBlock(block))
+		{
+			if((currentRecord.key >= inFromKey) && (currentRecord.key < inToKey))
+			{
+				outRecords.push_back(currentRecord);
+			}
+		}
+	}
+
+	return outRecords;
+};
+
+//-------------------------------------------------------------------- readBytes
+// Implementation notes:
+//  Clears the stream state first, so one failed read doesn't stop the next
+//------------------------------------------------------------------------------
+std::vector<char> blockFileReader::readBytes(
+	const uint64_t& inOffset,
+	const size_t& inLength)
+{
+	std::vector<char> outBytes(inLength);
+
+	this->m_file.clear();
+	this->m_file.seekg(static_cast<std::streamoff>(inOffset));
+	this->m_file.read(outBytes.data(), inLength);
+
+	if(static_cast<size_t>(this->m_file.gcount()) != inLength)
+	{
+		throw std::runtime_error("block file is truncated");
+	}
+
+	return outBytes;
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+class blockFileReader
+{
+public:
+
+	// A key and value as added to the file
+	struct record
+	{
+		std::string key;
+		std::string value;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Opens a block file written by blockFileWriter and reads its index and
+	//  filter. Throws if the file is missing, unfinished or either is corrupt.
+	//
+	// Method:    blockFileReader
+	// FullName:  blockFileReader::blockFileReader
+	// Access:    public 
+	// Returns:   
+	// Parameter: const std::string& inFilePath
+	//--------------------------------------------------------------------------
+	blockFileReader(
+		const std::string& inFilePath);
+
+	//----------------------------------------------------------- viewBlockCount
+	// Brief Description
+	//  Returns the number of blocks in the file.
+	//
+	// Method:    viewBlockCount
+	// FullName:  blockFileReader::viewBlockCount
+	// Access:    public 
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewBlockCount() const;
+
+	//--------------------------------------------------------------- viewFilter
+	// Brief Description
+	//  Returns the filter stored with the file, empty if there is none.
+	//
+	// Method:    viewFilter
+	// FullName:  blockFileReader::viewFilter
+	// Access:    public 
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewFilter() const;
+
+	//------------------------------------------------------------- viewFirstKey
+	// Brief Description
+	//  Returns the lowest key in the file, empty if the file has no records.
+	//
+	// Method:    viewFirstKey
+	// FullName:  blockFileReader::viewFirstKey
+	// Access:    public 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string viewFirstKey() const;
+
+	//-------------------------------------------------------------- viewLastKey
+	// Brief Description
+	//  Returns the highest key in the file, empty if the file has no records.
+	//
+	// Method:    viewLastKey
+	// FullName:  blockFileReader::viewLastKey
+	// Access:    public 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string viewLastKey() const;
+
+	//---------------------------------------------------------------- readBlock
+	// Brief Description
+	//  Reads, verifies and decompresses one block and returns its records in
+	//  key order. Throws if the block is corrupt.
+	//
+	// Method:    readBlock
+	// FullName:  blockFileReader::readBlock
+	// Access:    public 
+	// Returns:   std::vector<record>
+	// Parameter: const size_t& inBlock
+	//--------------------------------------------------------------------------
+	std::vector<record> readBlock(
+		const size_t& inBlock);
+
+	//--------------------------------------------------------------------- scan
+	// Brief Description
+	//  Returns the records with keys from the first key up to but excluding
+	//  the last, in key order. Only blocks that can hold such keys are read.
+	//
+	// Method:    scan
+	// FullName:  blockFileReader::scan
+	// Access:    public 
+	// Returns:   std::vector<record>
+	// Parameter: const std::string& inFromKey
+	// Parameter: const std::string& inToKey
+	//--------------------------------------------------------------------------
+	std::vector<record> scan(
+		const std::string& inFromKey,
+		const std::string& inToKey);
+
+private:
+
+	// Where a block is stored and what it holds, as kept in the index
+	struct blockHandle
+	{
+		std::string firstKey;
+		std::string lastKey;
+		uint64_t offset;
+		uint32_t storedLength;
+		uint32_t rawLength;
+		uint32_t records;
+		uint32_t checksum;
+	};
+
+	//---------------------------------------------------------------- readBytes
+	// Brief Description
+	//  Reads the given range of the file. Throws if the file is shorter.
+	//
+	// Method:    readBytes
+	// FullName:  blockFileReader::readBytes
+	// Access:    private 
+	// Returns:   std::vector<char>
+	// Parameter: const uint64_t& inOffset
+	// Parameter: const size_t& inLength
+	//--------------------------------------------------------------------------
+	std::vector<char> readBytes(
+		const uint64_t& inOffset,
+		const size_t& inLength);
+
+	// Member Variables
+	std::ifstream m_file;
+	std::vector<blockHandle> m_blocks;
+	std::string m_filter;
+};
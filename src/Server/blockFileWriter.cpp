@@ -0,0 +1,183 @@
+// STL
+#include <stdexcept>
+
+// Project
+#include "blockFileWriter.h"
+#include "blockEncoding.h"
+#include "../Common/constants.h"
+#include "../Common/lzCompressor.h"
+#include "../Common/crc32c.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Opens the file for writing, truncating any previous contents
+//------------------------------------------------------------------------------
+blockFileWriter::blockFileWriter(
+	const std::string& inFilePath) :
+	m_file(inFilePath, std::ios::out | std::ios::trunc | std::ios::binary),
+	m_blockRecords(0),
+	m_blockCount(0),
+	m_rawLength(0),
+	m_writtenLength(0),
+	m_finished(false)
+{
+	if(!this->m_file.is_open())
+	{
+		throw std::runtime_error("unable to create " + inFilePath);
+	}
+};
+
+//-------------------------------------------------------------------------- add
+// Implementation notes:
+//  A block is written once it reaches the block length, so blocks end on a
+//  record boundary and only exceed the length by their last record
+//------------------------------------------------------------------------------
+void blockFileWriter::add(
+	const std::string& inKey,
+	const std::string& inValue)
+{
+	if(this->m_finished || ((this->m_rawLength > 0) && (inKey < this->m_lastKey)))
+	{
+		throw std::logic_error("block file records must be added in key order");
+	}
+
+	if(this->m_blockRecords == 0)
+	{
+		this->m_blockFirstKey = inKey;
+	}
+
+	const size_t lengthBefore = this->m_block.size();
+
+	blockEncoding::appendString(
+		this->m_block,
+		inKey.data(),
+		inKey.size());
+
+	blockEncoding::appendString(
+		this->m_block,
+		inValue.data(),
+		inValue.size());
+
+	this->m_rawLength += this->m_block.size() - lengthBefore;
+	this->m_lastKey = inKey;
+	this->m_blockRecords++;
+
+	if(this->m_block.size() >= constants::storageBlockLength)
+	{
+		this->writeBlock();
+	}
+};
+
+//-------------------------------------------------------------------- setFilter
+// Implementation notes:
+//  Kept until the file is finished
+//------------------------------------------------------------------------------
+void blockFileWriter::setFilter(
+	const std::string& inFilter)
+{
+	this->m_filter = inFilter;
+};
+
+//----------------------------------------------------------------------- finish
+// Implementation notes:
+//  The filter and index are checksummed like blocks. The filter sits right
+//  before the index, and the footer says where the index is.
+//------------------------------------------------------------------------------
+void blockFileWriter::finish()
+{
+	if(this->m_finished)
+	{
+		return;
+	}
+
+	if(this->m_blockRecords > 0)
+	{
+		this->writeBlock();
+	}
+
+	std::vector<char> index;
+
+	blockEncoding::appendFixed(
+		index,
+		this->m_blockCount,
+		4);
+
+	index.insert(
+		index.end(),
+		this->m_index.begin(),
+		this->m_index.end());
+
+	std::vector<char> footer;
+
+	blockEncoding::appendFixed(footer, this->m_writtenLength + this->m_filter.size(), 8);
+	blockEncoding::appendFixed(footer, index.size(), 4);
+	blockEncoding::appendFixed(footer, crc32c::checksum(index.data(), index.size()), 4);
+	blockEncoding::appendFixed(footer, this->m_filter.size(), 4);
+	blockEncoding::appendFixed(footer, crc32c::checksum(this->m_filter.data(), this->m_filter.size()), 4);
+	blockEncoding::appendFixed(footer, constants::blockFileMagic, 8);
+
+	this->m_file.write(this->m_filter.data(), this->m_filter.size());
+	this->m_file.write(index.data(), index.size());
+	this->m_file.write(footer.data(), footer.size());
+	this->m_file.close();
+
+	if(this->m_file.fail())
+	{
+		throw std::runtime_error("unable to write block file");
+	}
+
+	this->m_writtenLength += this->m_filter.size() + index.size() + footer.size();
+	this->m_finished = true;
+};
+
+//---------------------------------------------------------------- viewRawLength
+// Implementation notes:
+//  Returns a const reference to the raw length
+//------------------------------------------------------------------------------
+const uint64_t& blockFileWriter::viewRawLength() const
+{
+	return this->m_rawLength;
+};
+
+//------------------------------------------------------------ viewWrittenLength
+// Implementation notes:
+//  Returns a const reference to the written length
+//------------------------------------------------------------------------------
+const uint64_t& blockFileWriter::viewWrittenLength() const
+{
+	return this->m_writtenLength;
+};
+
+//------------------------------------------------------------------- writeBlock
+// Implementation notes:
+//  The checksum covers the compressed bytes, so a reader verifies a block
+//  before decompressing it
+//------------------------------------------------------------------------------
+void blockFileWriter::writeBlock()
+{
+	const std::vector<char> storedBlock(
+		lzCompressor::compress(this->m_block));
+
+	blockEncoding::appendString(
+		this->m_index,
+		this->m_blockFirstKey.data(),
+		this->m_blockFirstKey.size());
+
+	blockEncoding::appendString(
+		this->m_index,
+		this->m_lastKey.data(),
+		this->m_lastKey.size());
+
+	blockEncoding::appendFixed(this->m_index, this->m_writtenLength, 8);
+	blockEncoding::appendFixed(this->m_index, storedBlock.size(), 4);
+	blockEncoding::appendFixed(this->m_index, this->m_block.size(), 4);
+	blockEncoding::appendFixed(this->m_index, this->m_blockRecords, 4);
+	blockEncoding::appendFixed(this->m_index, crc32c::checksum(storedBlock.data(), storedBlock.size()), 4);
+
+	this->m_file.write(storedBlock.data(), storedBlock.size());
+
+	this->m_writtenLength += storedBlock.size();
+	this->m_blockCount++;
+	this->m_blockRecords = 0;
+	this->m_block.clear();
+};
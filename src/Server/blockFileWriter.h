@@ -0,0 +1,117 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+class blockFileWriter
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Creates a block file, replacing any file at the path. Records added
+	//  are packed into blocks that are compressed and checksummed one by one.
+	//  Throws if the file can't be created.
+	//
+	// Method:    blockFileWriter
+	// FullName:  blockFileWriter::blockFileWriter
+	// Access:    public 
+	// Returns:   
+	// Parameter: const std::string& inFilePath
+	//--------------------------------------------------------------------------
+	blockFileWriter(
+		const std::string& inFilePath);
+
+	//---------------------------------------------------------------------- add
+	// Brief Description
+	//  Adds a record. Keys must be added in ascending order, which lets
+	//  readers find a key range from the first and last key of every block.
+	//
+	// Method:    add
+	// FullName:  blockFileWriter::add
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::string& inKey
+	// Parameter: const std::string& inValue
+	//--------------------------------------------------------------------------
+	void add(
+		const std::string& inKey,
+		const std::string& inValue);
+
+	//---------------------------------------------------------------- setFilter
+	// Brief Description
+	//  Sets a filter to store with the file, for readers to test before
+	//  reading any block.
+	//
+	// Method:    setFilter
+	// FullName:  blockFileWriter::setFilter
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::string& inFilter
+	//--------------------------------------------------------------------------
+	void setFilter(
+		const std::string& inFilter);
+
+	//------------------------------------------------------------------- finish
+	// Brief Description
+	//  Writes the last block, the filter, the block index and the footer, and
+	//  closes the file. Nothing can be added afterwards.
+	//
+	// Method:    finish
+	// FullName:  blockFileWriter::finish
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void finish();
+
+	//------------------------------------------------------------ viewRawLength
+	// Brief Description
+	//  Returns the length of the records added so far, before compression.
+	//
+	// Method:    viewRawLength
+	// FullName:  blockFileWriter::viewRawLength
+	// Access:    public 
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewRawLength() const;
+
+	//-------------------------------------------------------- viewWrittenLength
+	// Brief Description
+	//  Returns the number of bytes written to the file so far.
+	//
+	// Method:    viewWrittenLength
+	// FullName:  blockFileWriter::viewWrittenLength
+	// Access:    public 
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewWrittenLength() const;
+
+private:
+
+	//--------------------------------------------------------------- writeBlock
+	// Brief Description
+	//  Compresses the open block, writes it and adds it to the index.
+	//
+	// Method:    writeBlock
+	// FullName:  blockFileWriter::writeBlock
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void writeBlock();
+
+	// Member Variables
+	std::ofstream m_file;
+	std::vector<char> m_block;
+	std::string m_blockFirstKey;
+	std::string m_lastKey;
+	uint32_t m_blockRecords;
+	std::vector<char> m_index;
+	std::string m_filter;
+	uint32_t m_blockCount;
+	uint64_t m_rawLength;
+	uint64_t m_writtenLength;
+	bool m_finished;
+};
@@ -0,0 +1,133 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "bloomFilter.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  About 0.69 probes per bit per key minimizes false positives, which is
+//  1% at ten bits per key
+//------------------------------------------------------------------------------
+bloomFilter::bloomFilter(
+	const size_t& inExpectedKeys,
+	const uint16_t& inBitsPerKey) :
+	m_bits((std::max<size_t>(inExpectedKeys * inBitsPerKey, 64) + 7) / 8, 0),
+	m_probes(static_cast<uint16_t>(std::min(std::max(inBitsPerKey * 69 / 100, 1), 30)))
+{
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The probe count is the last byte, after the bits
+//------------------------------------------------------------------------------
+bloomFilter::bloomFilter(
+	const std::string& inStoredFilter) :
+	m_probes(0)
+{
+	if(inStoredFilter.size() < 2)
+	{
+		return;
+	}
+
+	this->m_bits.assign(
+		inStoredFilter.begin(),
+		inStoredFilter.end() - 1);
+
+	this->m_probes = static_cast<uint8_t>(inStoredFilter.back());
+};
+
+//-------------------------------------------------------------------------- add
+// Implementation notes:
+//  Double hashing, each probe adds the upper half of the hash to the lower
+//------------------------------------------------------------------------------
+void bloomFilter::add(
+	const std::string& inKey)
+{
+	const uint64_t bitCount = this->m_bits.size() * 8;
+	const uint64_t hash = bloomFilter::hashOfKey(inKey);
+	const uint64_t delta = (hash >> 32) | 1;
+
+	uint64_t probe = hash;
+
+	for(uint16_t i = 0; i < this->m_probes; i++)
+	{
+		const uint64_t bit = probe % bitCount;
+
+		this->m_bits[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8));
+
+		probe += delta;
+	}
+};
+
+//------------------------------------------------------------------- mayContain
+// Implementation notes:
+//  Same probes as add, an empty or malformed filter has none and matches
+//------------------------------------------------------------------------------
+bool bloomFilter::mayContain(
+	const std::string& inKey) const
+{
+	if(this->m_bits.empty())
+	{
+		return true;
+	}
+
+	const uint64_t bitCount = this->m_bits.size() * 8;
+	const uint64_t hash = bloomFilter::hashOfKey(inKey);
+	const uint64_t delta = (hash >> 32) | 1;
+
+	uint64_t probe = hash;
+
+	for(uint16_t i = 0; i < this->m_probes; i++)
+	{
+		const uint64_t bit = probe % bitCount;
+
+		if((this->m_bits[bit / 8] & (1 << (bit % 8))) == 0)
+		{
+			return false;
+		}
+
+		probe += delta;
+	}
+
+	return true;
+};
+
+//--------------------------------------------------------------------- asString
+// Implementation notes:
+//  The bits, then the probe count
+//------------------------------------------------------------------------------
+std::string bloomFilter::asString() const
+{
+	std::string outFilter(
+		this->m_bits.begin(),
+		this->m_bits.end());
+
+	outFilter.push_back(static_cast<char>(this->m_probes));
+
+	return outFilter;
+};
+
+//-------------------------------------------------------------------- hashOfKey
+// Implementation notes:
+//  FNV-1a over the bytes, then the MurmurHash3 finalizer to spread them
+//------------------------------------------------------------------------------
+uint64_t bloomFilter::hashOfKey(
+	const std::string& inKey)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+
+	for(const char currentByte : inKey)
+	{
+		hash ^= static_cast<unsigned char>(currentByte);
+		hash *= 0x100000001B3ULL;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ULL;
+	hash ^= hash >> 33;
+
+	return hash;
+};
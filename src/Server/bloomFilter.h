@@ -0,0 +1,97 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class bloomFilter
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for an empty filter sized for the expected number of keys.
+	//
+	// Method:    bloomFilter
+	// FullName:  bloomFilter::bloomFilter
+	// Access:    public 
+	// Returns:   
+	// Parameter: const size_t& inExpectedKeys
+	// Parameter: const uint16_t& inBitsPerKey
+	//--------------------------------------------------------------------------
+	bloomFilter(
+		const size_t& inExpectedKeys,
+		const uint16_t& inBitsPerKey);
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a filter stored with asString. A malformed filter
+	//  matches every key, so it can only cost a lookup.
+	//
+	// Method:    bloomFilter
+	// FullName:  bloomFilter::bloomFilter
+	// Access:    public 
+	// Returns:   
+	// Parameter: const std::string& inStoredFilter
+	//--------------------------------------------------------------------------
+	bloomFilter(
+		const std::string& inStoredFilter);
+
+	//---------------------------------------------------------------------- add
+	// Brief Description
+	//  Adds a key to the filter.
+	//
+	// Method:    add
+	// FullName:  bloomFilter::add
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::string& inKey
+	//--------------------------------------------------------------------------
+	void add(
+		const std::string& inKey);
+
+	//--------------------------------------------------------------- mayContain
+	// Brief Description
+	//  Determines if the key may have been added. Never false for a key that
+	//  was, rarely true for one that wasn't.
+	//
+	// Method:    mayContain
+	// FullName:  bloomFilter::mayContain
+	// Access:    public 
+	// Returns:   bool
+	// Parameter: const std::string& inKey
+	//--------------------------------------------------------------------------
+	bool mayContain(
+		const std::string& inKey) const;
+
+	//----------------------------------------------------------------- asString
+	// Brief Description
+	//  Returns the filter in the form stored alongside a segment.
+	//
+	// Method:    asString
+	// FullName:  bloomFilter::asString
+	// Access:    public 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string asString() const;
+
+private:
+
+	//---------------------------------------------------------------- hashOfKey
+	// Brief Description
+	//  Returns a 64 bit hash of the key, the same on every host and run.
+	//
+	// Method:    hashOfKey
+	// FullName:  bloomFilter::hashOfKey
+	// Access:    private static 
+	// Returns:   uint64_t
+	// Parameter: const std::string& inKey
+	//--------------------------------------------------------------------------
+	static uint64_t hashOfKey(
+		const std::string& inKey);
+
+	// Member Variables
+	std::vector<uint8_t> m_bits;
+	uint16_t m_probes;
+};
@@ -0,0 +1,219 @@
+// STL
+#include <random>
+#include <cstring>
+#include <cstdio>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Project
+#include "endpointCookie.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  random_device is only used here, never on the per datagram path
+//------------------------------------------------------------------------------
+endpointCookie::endpointCookie()
+{
+	std::random_device randomDevice;
+
+	for(uint64_t& keyHalf : this->m_key)
+	{
+		keyHalf = (static_cast<uint64_t>(randomDevice()) << 32) | randomDevice();
+	}
+};
+
+//----------------------------------------------------------------- createCookie
+// Implementation notes:
+//  Fixed width hex, so every cookie encodes to the same length
+//------------------------------------------------------------------------------
+std::string endpointCookie::createCookie(
+	const boost::asio::ip::udp::endpoint& inEndpoint) const
+{
+	char cookie[17];
+
+	std::snprintf(cookie, sizeof(cookie), "%016llx",
+		static_cast<unsigned long long>(this->cookieForPeriod(
+			inEndpoint,
+			endpointCookie::currentPeriod())));
+
+	return std::string(cookie);
+};
+
+//----------------------------------------------------------------- verifyCookie
+// Implementation notes:
+//  A cookie issued just before a period boundary stays valid through the
+//  next period, so every cookie lives between one and two lifetimes
+//------------------------------------------------------------------------------
+bool endpointCookie::verifyCookie(
+	const boost::asio::ip::udp::endpoint& inEndpoint,
+	const std::string& inCookie) const
+{
+	if(inCookie.size() != 16)
+	{
+		return false;
+	}
+
+	uint64_t presentedCookie = 0;
+
+	for(const char currentDigit : inCookie)
+	{
+		presentedCookie <<= 4;
+
+		if((currentDigit >= '0') && (currentDigit <= '9'))
+		{
+			presentedCookie |= currentDigit - '0';
+		}
+		else if((currentDigit >= 'a') && (currentDigit <= 'f'))
+		{
+			presentedCookie |= currentDigit - 'a' + 10;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	const uint64_t period = endpointCookie::currentPeriod();
+
+	return (presentedCookie == this->cookieForPeriod(inEndpoint, period))
+		|| (presentedCookie == this->cookieForPeriod(inEndpoint, period - 1));
+};
+
+//-------------------------------------------------------------- cookieForPeriod
+// Implementation notes:
+//  Hashes address bytes, then port and period, so IPv4 and IPv6 endpoints
+//  never share an input
+//------------------------------------------------------------------------------
+uint64_t endpointCookie::cookieForPeriod(
+	const boost::asio::ip::udp::endpoint& inEndpoint,
+	const uint64_t& inPeriod) const
+{
+	uint8_t input[16 + sizeof(uint16_t) + sizeof(uint64_t)];
+	size_t length = 0;
+
+	if(inEndpoint.address().is_v4())
+	{
+		const boost::asio::ip::address_v4::bytes_type address =
+			inEndpoint.address().to_v4().to_bytes();
+
+		std::memcpy(input, address.data(), address.size());
+		length += address.size();
+	}
+	else
+	{
+		const boost::asio::ip::address_v6::bytes_type address =
+			inEndpoint.address().to_v6().to_bytes();
+
+		std::memcpy(input, address.data(), address.size());
+		length += address.size();
+	}
+
+	const uint16_t port = inEndpoint.port();
+
+	std::memcpy(input + length, &port, sizeof(port));
+	length += sizeof(port);
+
+	std::memcpy(input + length, &inPeriod, sizeof(inPeriod));
+	length += sizeof(inPeriod);
+
+	return endpointCookie::sipHash(
+		this->m_key,
+		input,
+		length);
+};
+
+//---------------------------------------------------------------- currentPeriod
+// Implementation notes:
+//  Whole seconds since the epoch divided into cookie lifetimes
+//------------------------------------------------------------------------------
+uint64_t endpointCookie::currentPeriod()
+{
+	const int64_t seconds =
+		boost::chrono::duration_cast<boost::chrono::seconds>(
+			boost::chrono::system_clock::now().time_since_epoch()).count();
+
+	return static_cast<uint64_t>(seconds / constants::cookieLifetimeSeconds);
+};
+
+//---------------------------------------------------------------------- sipHash
+// Implementation notes:
+//  Reference SipHash-2-4, little endian word loads done byte by byte so the
+//  result does not depend on the host
+//------------------------------------------------------------------------------
+uint64_t endpointCookie::sipHash(
+	const uint64_t inKey[2],
+	const uint8_t* inData,
+	const size_t& inLength)
+{
+	uint64_t v0 = 0x736f6d6570736575ULL ^ inKey[0];
+	uint64_t v1 = 0x646f72616e646f6dULL ^ inKey[1];
+	uint64_t v2 = 0x6c7967656e657261ULL ^ inKey[0];
+	uint64_t v3 = 0x7465646279746573ULL ^ inKey[1];
+
+	const size_t wholeWords = inLength / 8;
+
+	for(size_t i = 0; i < wholeWords; i++)
+	{
+		uint64_t word = 0;
+
+		for(int j = 7; j >= 0; j--)
+		{
+			word = (word << 8) | inData[(i * 8) + j];
+		}
+
+		v3 ^= word;
+		endpointCookie::sipRound(v0, v1, v2, v3);
+		endpointCookie::sipRound(v0, v1, v2, v3);
+		v0 ^= word;
+	}
+
+	uint64_t lastWord = static_cast<uint64_t>(inLength) << 56;
+
+	for(size_t i = wholeWords * 8; i < inLength; i++)
+	{
+		lastWord |= static_cast<uint64_t>(inData[i]) << ((i % 8) * 8);
+	}
+
+	v3 ^= lastWord;
+	endpointCookie::sipRound(v0, v1, v2, v3);
+	endpointCookie::sipRound(v0, v1, v2, v3);
+	v0 ^= lastWord;
+
+	v2 ^= 0xff;
+
+	for(int i = 0; i < 4; i++)
+	{
+		endpointCookie::sipRound(v0, v1, v2, v3);
+	}
+
+	return v0 ^ v1 ^ v2 ^ v3;
+};
+
+//--------------------------------------------------------------------- sipRound
+// Implementation notes:
+//  One SipRound as given in the SipHash paper
+//------------------------------------------------------------------------------
+void endpointCookie::sipRound(
+	uint64_t& v0,
+	uint64_t& v1,
+	uint64_t& v2,
+	uint64_t& v3)
+{
+	v0 += v1; v1 = endpointCookie::rotateLeft(v1, 13); v1 ^= v0; v0 = endpointCookie::rotateLeft(v0, 32);
+	v2 += v3; v3 = endpointCookie::rotateLeft(v3, 16); v3 ^= v2;
+	v0 += v3; v3 = endpointCookie::rotateLeft(v3, 21); v3 ^= v0;
+	v2 += v1; v1 = endpointCookie::rotateLeft(v1, 17); v1 ^= v2; v2 = endpointCookie::rotateLeft(v2, 32);
+};
+
+//------------------------------------------------------------------- rotateLeft
+// Implementation notes:
+//  Compilers turn this into a single rotate instruction
+//------------------------------------------------------------------------------
+uint64_t endpointCookie::rotateLeft(
+	const uint64_t& inValue,
+	const int& inBits)
+{
+	return (inValue << inBits) | (inValue >> (64 - inBits));
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+// STL
+#include <string>
+#include <cstdint>
+
+// Boost
+#include <boost/asio.hpp>
+
+class endpointCookie
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the cookie generator. Picks a random secret key, so
+	//  cookies from a previous run of the server are not accepted.
+	//
+	// Method:    endpointCookie
+	// FullName:  endpointCookie::endpointCookie
+	// Access:    public 
+	// Returns:   
+	//--------------------------------------------------------------------------
+	endpointCookie();
+
+	//------------------------------------------------------------- createCookie
+	// Brief Description
+	//  Returns the cookie for the given endpoint at the current time. Only
+	//  someone receiving datagrams at the endpoint can learn it.
+	//
+	// Method:    createCookie
+	// FullName:  endpointCookie::createCookie
+	// Access:    public 
+	// Returns:   std::string
+	// Parameter: const boost::asio::ip::udp::endpoint& inEndpoint
+	//--------------------------------------------------------------------------
+	std::string createCookie(
+		const boost::asio::ip::udp::endpoint& inEndpoint) const;
+
+	//------------------------------------------------------------- verifyCookie
+	// Brief Description
+	//  Determines if the cookie was issued to the given endpoint within the
+	//  cookie lifetime. Keeps no state, so it can run for every datagram.
+	//
+	// Method:    verifyCookie
+	// FullName:  endpointCookie::verifyCookie
+	// Access:    public 
+	// Returns:   bool
+	// Parameter: const boost::asio::ip::udp::endpoint& inEndpoint
+	// Parameter: const std::string& inCookie
+	//--------------------------------------------------------------------------
+	bool verifyCookie(
+		const boost::asio::ip::udp::endpoint& inEndpoint,
+		const std::string& inCookie) const;
+
+private:
+
+	//---------------------------------------------------------- cookieForPeriod
+	// Brief Description
+	//  Returns the cookie for the given endpoint in the given lifetime
+	//  period, a keyed hash of the address, port and period.
+	//
+	// Method:    cookieForPeriod
+	// FullName:  endpointCookie::cookieForPeriod
+	// Access:    private 
+	// Returns:   uint64_t
+	// Parameter: const boost::asio::ip::udp::endpoint& inEndpoint
+	// Parameter: const uint64_t& inPeriod
+	//--------------------------------------------------------------------------
+	uint64_t cookieForPeriod(
+		const boost::asio::ip::udp::endpoint& inEndpoint,
+		const uint64_t& inPeriod) const;
+
+	//------------------------------------------------------------ currentPeriod
+	// Brief Description
+	//  Returns the number of cookie lifetimes since the epoch.
+	//
+	// Method:    currentPeriod
+	// FullName:  endpointCookie::currentPeriod
+	// Access:    private static
+	// Returns:   uint64_t
+	//--------------------------------------------------------------------------
+	static uint64_t currentPeriod();
+
+	//------------------------------------------------------------------ sipHash
+	// Brief Description
+	//  SipHash-2-4 of the given bytes under the given 128 bit key.
+	//
+	// Method:    sipHash
+	// FullName:  endpointCookie::sipHash
+	// Access:    private static
+	// Returns:   uint64_t
+	// Parameter: const uint64_t inKey[2]
+	// Parameter: const uint8_t* inData
+	// Parameter: const size_t& inLength
+	//--------------------------------------------------------------------------
+	static uint64_t sipHash(
+		const uint64_t inKey[2],
+		const uint8_t* inData,
+		const size_t& inLength);
+
+	//----------------------------------------------------------------- sipRound
+	// Brief Description
+	//  One round of the SipHash compression function.
+	//
+	// Method:    sipRound
+	// FullName:  endpointCookie::sipRound
+	// Access:    private static
+	// Returns:   void
+	// Parameter: uint64_t& v0
+	// Parameter: uint64_t& v1
+	// Parameter: uint64_t& v2
+	// Parameter: uint64_t& v3
+	//--------------------------------------------------------------------------
+	static void sipRound(
+		uint64_t& v0,
+		uint64_t& v1,
+		uint64_t& v2,
+		uint64_t& v3);
+
+	//--------------------------------------------------------------- rotateLeft
+	// Brief Description
+	//  Rotates a 64 bit value left by the given number of bits.
+	//
+	// Method:    rotateLeft
+	// FullName:  endpointCookie::rotateLeft
+	// Access:    private static
+	// Returns:   uint64_t
+	// Parameter: const uint64_t& inValue
+	// Parameter: const int& inBits
+	//--------------------------------------------------------------------------
+	static uint64_t rotateLeft(
+		const uint64_t& inValue,
+		const int& inBits);
+
+	// Member Variables
+	uint64_t m_key[2];
+};
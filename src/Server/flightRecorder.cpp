@@ -0,0 +1,432 @@
+// STL
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+
+// Project
+#include "flightRecorder.h"
+#include "blockEncoding.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Rings are created as threads first record
+//------------------------------------------------------------------------------
+flightRecorder::flightRecorder(
+	const std::string& inFilePrefix) :
+	m_filePrefix(inFilePrefix),
+	m_ringOfThread(&flightRecorder::keepRing),
+	m_dumpPending(false),
+	m_nextDumpNanoseconds(0),
+	m_window(new latencyHistogram()),
+	m_windowStartNanoseconds(0)
+{
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  The threads that recorded have stopped by now
+//------------------------------------------------------------------------------
+flightRecorder::~flightRecorder()
+{
+	for(threadRing* currentRing : this->m_rings)
+	{
+		delete[] currentRing->events;
+		delete currentRing;
+	}
+
+	delete this->m_window;
+};
+
+//------------------------------------------------------------------- nameThread
+// Implementation notes:
+//  Renaming a ring is guarded, a dump may be copying the name
+//------------------------------------------------------------------------------
+void flightRecorder::nameThread(
+	const std::string& inName)
+{
+	threadRing* ring = this->ringOfThread(inName);
+
+	boost::mutex::scoped_lock lock(this->m_mutex);
+
+	ring->name = inName;
+};
+
+//----------------------------------------------------------------------- record
+// Implementation notes:
+//  The slot is written before the count is raised, so a dump that sees
+//  the count sees the event
+//------------------------------------------------------------------------------
+void flightRecorder::record(
+	const EventKind& inKind,
+	const uint16_t& inMessageType,
+	const uint32_t& inLength,
+	const uint64_t& inDetail,
+	const int64_t& inNanoseconds)
+{
+	threadRing* ring = this->m_ringOfThread.get();
+
+	if(ring == nullptr)
+	{
+		std::ostringstream name;
+		name << "thread " << boost::this_thread::get_id();
+
+		ring = this->ringOfThread(name.str());
+	}
+
+	const uint64_t written = ring->written.load(std::memory_order_relaxed);
+
+	event& slot = ring->events[written % constants::flightRecorderThreadEvents];
+	slot.nanoseconds = inNanoseconds;
+	slot.kind = static_cast<uint16_t>(inKind);
+	slot.messageType = inMessageType;
+	slot.length = inLength;
+	slot.detail = inDetail;
+
+	ring->written.store(written + 1, std::memory_order_release);
+};
+
+//------------------------------------------------------------- recordQueueDepth
+// Implementation notes:
+//  The ring kind sits above the ring's index in the detail
+//------------------------------------------------------------------------------
+void flightRecorder::recordQueueDepth(
+	const QueueKind& inQueue,
+	const uint16_t& inIndex,
+	const size_t& inDepth,
+	const int64_t& inNanoseconds)
+{
+	this->record(
+		flightRecorder::ek_QUEUE_DEPTH,
+		0,
+		static_cast<uint32_t>(inDepth),
+		(static_cast<uint64_t>(inQueue) << 16) | inIndex,
+		inNanoseconds);
+
+	if(inDepth > constants::flightRecorderQueueDepthLimit)
+	{
+		const char* ringNames[] = {"decode", "state", "egress"};
+
+		this->trigger(
+			flightRecorder::tr_QUEUE_DEPTH,
+			inDepth,
+			std::string(ringNames[inQueue]) + " ring " + std::to_string(inIndex)
+				+ " holds " + std::to_string(inDepth) + " batches",
+			inNanoseconds);
+	}
+};
+
+//---------------------------------------------------------------- recordLatency
+// Implementation notes:
+//  A window is judged when the first latency after its end arrives, so a
+//  stall is caught as soon as traffic resumes. Windows with too few
+//  latencies for a 99th percentile are not judged.
+//------------------------------------------------------------------------------
+void flightRecorder::recordLatency(
+	const int64_t& inLatencyNanoseconds,
+	const int64_t& inNanoseconds)
+{
+	const int64_t windowNanoseconds =
+		int64_t(constants::flightRecorderWindowMilliseconds) * 1000000;
+
+	if(inNanoseconds - this->m_windowStartNanoseconds >= windowNanoseconds)
+	{
+		const int64_t percentile = this->m_window->viewPercentile(0.99);
+
+		if((this->m_window->viewCount() >= constants::flightRecorderWindowMinimumLatencies)
+			&& (percentile > int64_t(constants::flightRecorderLatencyThresholdMicroseconds) * 1000))
+		{
+			this->trigger(
+				flightRecorder::tr_LATENCY,
+				percentile,
+				"p99 arrival to dispatch " + std::to_string(percentile / 1000) + "us over "
+					+ std::to_string(this->m_window->viewCount()) + " messages",
+				inNanoseconds);
+		}
+
+		delete this->m_window;
+		this->m_window = new latencyHistogram();
+		this->m_windowStartNanoseconds = inNanoseconds;
+	}
+
+	this->m_window->record(
+		inLatencyNanoseconds);
+};
+
+//---------------------------------------------------------------------- trigger
+// Implementation notes:
+//  The rings are copied right away, before the events around the anomaly
+//  are overwritten, and written to disk later off the triggering thread.
+//  The cheap checks come first, an overfull ring triggers on every push.
+//------------------------------------------------------------------------------
+void flightRecorder::trigger(
+	const TriggerReason& inReason,
+	const uint64_t& inValue,
+	const std::string& inDescription,
+	const int64_t& inNanoseconds)
+{
+	this->record(
+		flightRecorder::ek_TRIGGER,
+		0,
+		static_cast<uint32_t>(inReason),
+		inValue,
+		inNanoseconds);
+
+	if(this->m_dumpPending.load()
+		|| (inNanoseconds < this->m_nextDumpNanoseconds.load()))
+	{
+		return;
+	}
+
+	boost::mutex::scoped_lock lock(this->m_mutex);
+
+	if(this->m_dumpPending.load()
+		|| (inNanoseconds < this->m_nextDumpNanoseconds.load()))
+	{
+		return;
+	}
+
+	this->m_pendingDump.triggerNanoseconds = inNanoseconds;
+	this->m_pendingDump.reason = inDescription;
+	this->m_pendingDump.threads.clear();
+
+	for(const threadRing* currentRing : this->m_rings)
+	{
+		threadEvents currentThread;
+		currentThread.name = currentRing->name;
+		currentThread.events = flightRecorder::copyRing(*currentRing);
+
+		this->m_pendingDump.threads.push_back(currentThread);
+	}
+
+	this->m_nextDumpNanoseconds.store(
+		inNanoseconds + int64_t(constants::flightRecorderDumpIntervalSeconds) * 1000000000);
+
+	this->m_dumpPending.store(true);
+};
+
+//------------------------------------------------------------- writePendingDump
+// Implementation notes:
+//  Fixed width fields are little endian, as in the storage files. The dump
+//  is the magic, the trigger time, the reason, and every thread's name and
+//  events.
+//------------------------------------------------------------------------------
+std::string flightRecorder::writePendingDump()
+{
+	if(!this->m_dumpPending.load())
+	{
+		return std::string();
+	}
+
+	std::vector<char> contents;
+	std::string path;
+	size_t eventCount = 0;
+
+	{
+		boost::mutex::scoped_lock lock(this->m_mutex);
+
+		const dump& pending = this->m_pendingDump;
+
+		path = this->m_filePrefix + "."
+			+ std::to_string(pending.triggerNanoseconds / 1000000000);
+
+		blockEncoding::appendFixed(contents, constants::flightRecorderMagic, 8);
+		blockEncoding::appendFixed(contents, pending.triggerNanoseconds, 8);
+		blockEncoding::appendString(contents, pending.reason.data(), pending.reason.size());
+		blockEncoding::appendFixed(contents, pending.threads.size(), 4);
+
+		for(const threadEvents& currentThread : pending.threads)
+		{
+			blockEncoding::appendString(contents, currentThread.name.data(), currentThread.name.size());
+			blockEncoding::appendFixed(contents, currentThread.events.size(), 4);
+
+			for(const event& currentEvent : currentThread.events)
+			{
+				blockEncoding::appendFixed(contents, currentEvent.nanoseconds, 8);
+				blockEncoding::appendFixed(contents, currentEvent.kind, 2);
+				blockEncoding::appendFixed(contents, currentEvent.messageType, 2);
+				blockEncoding::appendFixed(contents, currentEvent.length, 4);
+				blockEncoding::appendFixed(contents, currentEvent.detail, 8);
+			}
+
+			eventCount += currentThread.events.size();
+		}
+
+		this->m_pendingDump.threads.clear();
+		this->m_dumpPending.store(false);
+	}
+
+	std::ofstream dumpFile(path, std::ios::binary | std::ios::trunc);
+	dumpFile.write(contents.data(), contents.size());
+	dumpFile.close();
+
+	if(!dumpFile)
+	{
+		return "Flight recorder could not write " + path;
+	}
+
+	return "Flight recorder wrote " + std::to_string(eventCount)
+		+ " events to " + path;
+};
+
+//--------------------------------------------------------------------- readDump
+// Implementation notes:
+//  Inverse of writePendingDump. Truncation is found by readFixed and
+//  readString.
+//------------------------------------------------------------------------------
+flightRecorder::dump flightRecorder::readDump(
+	const std::string& inPath)
+{
+	std::ifstream dumpFile(inPath, std::ios::binary);
+
+	if(!dumpFile)
+	{
+		throw std::runtime_error("cannot open " + inPath);
+	}
+
+	const std::vector<char> contents(
+		(std::istreambuf_iterator<char>(dumpFile)),
+		std::istreambuf_iterator<char>());
+
+	size_t position = 0;
+
+	if((contents.size() < 8)
+		|| (blockEncoding::readFixed(contents, position, 8) != constants::flightRecorderMagic))
+	{
+		throw std::runtime_error(inPath + " is not a flight recorder dump");
+	}
+
+	dump outDump;
+	outDump.triggerNanoseconds = static_cast<int64_t>(
+		blockEncoding::readFixed(contents, position, 8));
+	outDump.reason = blockEncoding::readString(contents, position);
+
+	const uint64_t threadCount = blockEncoding::readFixed(contents, position, 4);
+
+	for(uint64_t i = 0; i < threadCount; i++)
+	{
+		threadEvents currentThread;
+		currentThread.name = blockEncoding::readString(contents, position);
+
+		const uint64_t eventCount = blockEncoding::readFixed(contents, position, 4);
+
+		for(uint64_t j = 0; j < eventCount; j++)
+		{
+			event currentEvent;
+			currentEvent.nanoseconds = static_cast<int64_t>(
+				blockEncoding::readFixed(contents, position, 8));
+			currentEvent.kind = static_cast<uint16_t>(
+				blockEncoding::readFixed(contents, position, 2));
+			currentEvent.messageType = static_cast<uint16_t>(
+				blockEncoding::readFixed(contents, position, 2));
+			currentEvent.length = static_cast<uint32_t>(
+				blockEncoding::readFixed(contents, position, 4));
+			currentEvent.detail = blockEncoding::readFixed(contents, position, 8);
+
+			currentThread.events.push_back(currentEvent);
+		}
+
+		outDump.threads.push_back(currentThread);
+	}
+
+	return outDump;
+};
+
+//--------------------------------------------------------------- endpointDetail
+// Implementation notes:
+//  Packed the same way the decode worker of an endpoint is picked
+//------------------------------------------------------------------------------
+uint64_t flightRecorder::endpointDetail(
+	const boost::asio::ip::udp::endpoint& inEndpoint)
+{
+	uint64_t outDetail = inEndpoint.port();
+
+	if(inEndpoint.address().is_v4())
+	{
+		outDetail |= static_cast<uint64_t>(inEndpoint.address().to_v4().to_ulong()) << 16;
+	}
+
+	return outDetail;
+};
+
+//----------------------------------------------------------------- ringOfThread
+// Implementation notes:
+//  Registering is guarded, every other event of the thread goes straight
+//  to its ring
+//------------------------------------------------------------------------------
+flightRecorder::threadRing* flightRecorder::ringOfThread(
+	const std::string& inName)
+{
+	threadRing* outRing = this->m_ringOfThread.get();
+
+	if(outRing != nullptr)
+	{
+		return outRing;
+	}
+
+	outRing = new threadRing();
+	outRing->name = inName;
+	outRing->events = new event[constants::flightRecorderThreadEvents];
+	outRing->written.store(0);
+
+	{
+		boost::mutex::scoped_lock lock(this->m_mutex);
+
+		this->m_rings.push_back(outRing);
+	}
+
+	this->m_ringOfThread.reset(outRing);
+
+	return outRing;
+};
+
+//--------------------------------------------------------------------- copyRing
+// Implementation notes:
+//  The owning thread keeps writing while the ring is copied. Any event
+//  written meanwhile, or being written as the copy ends, may have replaced
+//  one of the oldest copied, so that many of the oldest are dropped.
+//------------------------------------------------------------------------------
+std::vector<flightRecorder::event> flightRecorder::copyRing(
+	const threadRing& inRing)
+{
+	const uint64_t capacity = constants::flightRecorderThreadEvents;
+
+	const uint64_t writtenBefore = inRing.written.load(std::memory_order_acquire);
+	const uint64_t copied = std::min(writtenBefore, capacity);
+
+	std::vector<event> outEvents;
+	outEvents.reserve(copied);
+
+	for(uint64_t i = writtenBefore - copied; i < writtenBefore; i++)
+	{
+		outEvents.push_back(inRing.events[i % capacity]);
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	const uint64_t writtenAfter = inRing.written.load(std::memory_order_relaxed);
+
+	// the write of event n + capacity replaces event n
+	const int64_t overwritten = std::min<int64_t>(
+		std::max<int64_t>(
+			int64_t(writtenAfter + 1) - int64_t(capacity) - int64_t(writtenBefore - copied),
+			0),
+		copied);
+
+	outEvents.erase(
+		outEvents.begin(),
+		outEvents.begin() + overwritten);
+
+	return outEvents;
+};
+
+//--------------------------------------------------------------------- keepRing
+// Implementation notes:
+//  Nothing to do
+//------------------------------------------------------------------------------
+void flightRecorder::keepRing(
+	threadRing*)
+{
+};
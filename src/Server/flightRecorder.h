@@ -0,0 +1,313 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+// Project
+#include "latencyHistogram.h"
+
+class flightRecorder
+{
+public:
+
+	// What an event records, which decides what its fields mean
+	enum EventKind
+	{
+		ek_PACKET_IN = 1,   // length bytes received from the endpoint in detail
+		ek_PACKET_OUT = 2,  // length bytes sent to the endpoint in detail,
+		                    // answering a message of the message type
+		ek_QUEUE_DEPTH = 3, // length batches left on the ring in detail
+		ek_ROUTE = 4,       // a message of the message type took the routes
+		                    // in detail
+		ek_SYNC = 5,        // length clients synced from the server index in
+		                    // detail
+		ek_TRIGGER = 6,     // a dump was triggered for the reason in length,
+		                    // with the value in detail
+		ek_PARKED_SCAN = 7  // a scan of the parked messages found length of
+		                    // them routable, and left detail parked
+	};
+
+	// The pipeline rings a queue depth event can be for
+	enum QueueKind
+	{
+		qk_DECODE = 0,
+		qk_STATE = 1,
+		qk_EGRESS = 2
+	};
+
+	// The routes of a route event, any combination
+	enum RouteBit
+	{
+		rb_LOCAL = 1,
+		rb_LEFT = 2,
+		rb_RIGHT = 4
+	};
+
+	// Why a dump was triggered
+	enum TriggerReason
+	{
+		tr_LATENCY = 1,
+		tr_QUEUE_DEPTH = 2,
+		tr_EXCEPTION = 3
+	};
+
+	// One recorded event, 24 bytes in memory and in the dump
+	struct event
+	{
+		int64_t nanoseconds;
+		uint16_t kind;
+		uint16_t messageType;
+		uint32_t length;
+		uint64_t detail;
+	};
+
+	// The events one thread recorded, oldest first
+	struct threadEvents
+	{
+		std::string name;
+		std::vector<event> events;
+	};
+
+	// Everything a dump holds
+	struct dump
+	{
+		int64_t triggerNanoseconds;
+		std::string reason;
+		std::vector<threadEvents> threads;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the flight recorder of a server. Dumps are written
+	//  to files named by the prefix followed by the second they were
+	//  triggered at.
+	//
+	// Method:    flightRecorder
+	// FullName:  flightRecorder::flightRecorder
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inFilePrefix
+	//--------------------------------------------------------------------------
+	flightRecorder(
+		const std::string& inFilePrefix);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Frees the rings of every thread that recorded.
+	//
+	// Method:    ~flightRecorder
+	// FullName:  flightRecorder::~flightRecorder
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~flightRecorder();
+
+	//--------------------------------------------------------------- nameThread
+	// Brief Description
+	//  Names the ring of the calling thread as it appears in dumps. A thread
+	//  that records without being named is named by its id.
+	//
+	// Method:    nameThread
+	// FullName:  flightRecorder::nameThread
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	void nameThread(
+		const std::string& inName);
+
+	//------------------------------------------------------------------- record
+	// Brief Description
+	//  Adds an event to the ring of the calling thread, overwriting its
+	//  oldest once the ring is full. Any thread may call this.
+	//
+	// Method:    record
+	// FullName:  flightRecorder::record
+	// Access:    public
+	// Returns:   void
+	// Parameter: const EventKind& inKind
+	// Parameter: const uint16_t& inMessageType
+	// Parameter: const uint32_t& inLength
+	// Parameter: const uint64_t& inDetail
+	// Parameter: const int64_t& inNanoseconds
+	//--------------------------------------------------------------------------
+	void record(
+		const EventKind& inKind,
+		const uint16_t& inMessageType,
+		const uint32_t& inLength,
+		const uint64_t& inDetail,
+		const int64_t& inNanoseconds);
+
+	//--------------------------------------------------------- recordQueueDepth
+	// Brief Description
+	//  Records the number of batches on a pipeline ring, and triggers a
+	//  dump if it is over the limit.
+	//
+	// Method:    recordQueueDepth
+	// FullName:  flightRecorder::recordQueueDepth
+	// Access:    public
+	// Returns:   void
+	// Parameter: const QueueKind& inQueue
+	// Parameter: const uint16_t& inIndex
+	// Parameter: const size_t& inDepth
+	// Parameter: const int64_t& inNanoseconds
+	//--------------------------------------------------------------------------
+	void recordQueueDepth(
+		const QueueKind& inQueue,
+		const uint16_t& inIndex,
+		const size_t& inDepth,
+		const int64_t& inNanoseconds);
+
+	//------------------------------------------------------------ recordLatency
+	// Brief Description
+	//  Adds a latency from arrival to dispatch to the current window. Once
+	//  the window is over, a dump is triggered if its 99th percentile is
+	//  above the threshold. Only one thread may call this.
+	//
+	// Method:    recordLatency
+	// FullName:  flightRecorder::recordLatency
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int64_t& inLatencyNanoseconds
+	// Parameter: const int64_t& inNanoseconds
+	//--------------------------------------------------------------------------
+	void recordLatency(
+		const int64_t& inLatencyNanoseconds,
+		const int64_t& inNanoseconds);
+
+	//------------------------------------------------------------------ trigger
+	// Brief Description
+	//  Records a trigger event and, unless a dump is still waiting to be
+	//  written or the last one was triggered less than the dump interval
+	//  ago, copies the rings of every thread for the next dump.
+	//
+	// Method:    trigger
+	// FullName:  flightRecorder::trigger
+	// Access:    public
+	// Returns:   void
+	// Parameter: const TriggerReason& inReason
+	// Parameter: const uint64_t& inValue
+	// Parameter: const std::string& inDescription
+	// Parameter: const int64_t& inNanoseconds
+	//--------------------------------------------------------------------------
+	void trigger(
+		const TriggerReason& inReason,
+		const uint64_t& inValue,
+		const std::string& inDescription,
+		const int64_t& inNanoseconds);
+
+	//--------------------------------------------------------- writePendingDump
+	// Brief Description
+	//  Writes the rings copied by the last trigger to a dump file, if they
+	//  have not been written yet, and returns what was written. Returns an
+	//  empty string if nothing was pending.
+	//
+	// Method:    writePendingDump
+	// FullName:  flightRecorder::writePendingDump
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string writePendingDump();
+
+	//----------------------------------------------------------------- readDump
+	// Brief Description
+	//  Reads a dump file. Throws if it cannot be read or is not a dump.
+	//
+	// Method:    readDump
+	// FullName:  flightRecorder::readDump
+	// Access:    public static
+	// Returns:   flightRecorder::dump
+	// Parameter: const std::string& inPath
+	//--------------------------------------------------------------------------
+	static dump readDump(
+		const std::string& inPath);
+
+	//----------------------------------------------------------- endpointDetail
+	// Brief Description
+	//  Returns an IPv4 endpoint packed into the detail of a packet event,
+	//  the address above the port. Other endpoints only keep the port.
+	//
+	// Method:    endpointDetail
+	// FullName:  flightRecorder::endpointDetail
+	// Access:    public static
+	// Returns:   uint64_t
+	// Parameter: const boost::asio::ip::udp::endpoint& inEndpoint
+	//--------------------------------------------------------------------------
+	static uint64_t endpointDetail(
+		const boost::asio::ip::udp::endpoint& inEndpoint);
+
+private:
+
+	// The ring of one thread. Only that thread writes to it, the count of
+	// events ever written tells readers which slots hold the latest.
+	struct threadRing
+	{
+		std::string name;
+		event* events;
+		std::atomic<uint64_t> written;
+	};
+
+	//------------------------------------------------------------- ringOfThread
+	// Brief Description
+	//  Returns the ring of the calling thread, creating it with the given
+	//  name on the thread's first event.
+	//
+	// Method:    ringOfThread
+	// FullName:  flightRecorder::ringOfThread
+	// Access:    private
+	// Returns:   flightRecorder::threadRing*
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	threadRing* ringOfThread(
+		const std::string& inName);
+
+	//----------------------------------------------------------------- copyRing
+	// Brief Description
+	//  Returns the latest events of a ring, oldest first, leaving out any
+	//  its thread overwrote while they were copied.
+	//
+	// Method:    copyRing
+	// FullName:  flightRecorder::copyRing
+	// Access:    private static
+	// Returns:   std::vector<flightRecorder::event>
+	// Parameter: const threadRing& inRing
+	//--------------------------------------------------------------------------
+	static std::vector<event> copyRing(
+		const threadRing& inRing);
+
+	//----------------------------------------------------------------- keepRing
+	// Brief Description
+	//  Cleanup of the thread specific pointer to a ring, which does nothing
+	//  as the recorder owns the rings.
+	//
+	// Method:    keepRing
+	// FullName:  flightRecorder::keepRing
+	// Access:    private static
+	// Returns:   void
+	// Parameter: threadRing* inRing
+	//--------------------------------------------------------------------------
+	static void keepRing(
+		threadRing* inRing);
+
+	// Member Variables
+	std::string m_filePrefix;
+	boost::thread_specific_ptr<threadRing> m_ringOfThread;
+	std::vector<threadRing*> m_rings;
+	boost::mutex m_mutex;
+
+	// set while copied rings wait to be written, guarded by the mutex
+	std::atomic<bool> m_dumpPending;
+	std::atomic<int64_t> m_nextDumpNanoseconds;
+	dump m_pendingDump;
+
+	// only the thread recording latencies touches the window
+	latencyHistogram* m_window;
+	int64_t m_windowStartNanoseconds;
+};
@@ -0,0 +1,179 @@
+// STL
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+// Project
+#include "latencyHistogram.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Every bucket starts at zero
+//------------------------------------------------------------------------------
+latencyHistogram::latencyHistogram() :
+	m_count(0),
+	m_maximum(0)
+{
+	for(size_t i = 0; i < latencyHistogram::bucketCount; i++)
+	{
+		this->m_buckets[i].store(0);
+	}
+};
+
+//----------------------------------------------------------------------- record
+// Implementation notes:
+//  Relaxed counters, readers only want a rough current figure. The maximum
+//  is raised with a compare and swap, which only loops while another thread
+//  raises it at the same moment.
+//------------------------------------------------------------------------------
+void latencyHistogram::record(
+	const int64_t& inNanoseconds)
+{
+	const int64_t nanoseconds = std::max<int64_t>(inNanoseconds, 0);
+
+	this->m_buckets[latencyHistogram::bucketIndex(nanoseconds)].fetch_add(
+		1,
+		std::memory_order_relaxed);
+
+	this->m_count.fetch_add(1, std::memory_order_relaxed);
+
+	int64_t maximum = this->m_maximum.load(std::memory_order_relaxed);
+
+	while((nanoseconds > maximum)
+		&& !this->m_maximum.compare_exchange_weak(maximum, nanoseconds, std::memory_order_relaxed))
+	{
+
+	}
+};
+
+//-------------------------------------------------------------------- viewCount
+// Implementation notes:
+//  Reads the counter
+//------------------------------------------------------------------------------
+uint64_t latencyHistogram::viewCount() const
+{
+	return this->m_count.load(std::memory_order_relaxed);
+};
+
+//--------------------------------------------------------------- viewPercentile
+// Implementation notes:
+//  Walks the buckets until the running count reaches the rank. Buckets can
+//  be added to while they are walked, so the total is taken from them
+//  rather than from the counter.
+//------------------------------------------------------------------------------
+int64_t latencyHistogram::viewPercentile(
+	const double& inFraction) const
+{
+	uint64_t counts[latencyHistogram::bucketCount];
+	uint64_t total = 0;
+
+	for(size_t i = 0; i < latencyHistogram::bucketCount; i++)
+	{
+		counts[i] = this->m_buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	if(total == 0)
+	{
+		return 0;
+	}
+
+	const uint64_t rank = std::max<uint64_t>(
+		uint64_t(inFraction * total + 0.5),
+		1);
+
+	uint64_t seen = 0;
+
+	for(size_t i = 0; i < latencyHistogram::bucketCount; i++)
+	{
+		seen += counts[i];
+
+		if(seen >= rank)
+		{
+			return std::min(
+				latencyHistogram::bucketUpperBound(i),
+				this->viewMaximum());
+		}
+	}
+
+	return this->viewMaximum();
+};
+
+//------------------------------------------------------------------ viewMaximum
+// Implementation notes:
+//  Reads the maximum
+//------------------------------------------------------------------------------
+int64_t latencyHistogram::viewMaximum() const
+{
+	return this->m_maximum.load(std::memory_order_relaxed);
+};
+
+//-------------------------------------------------------------------- asSummary
+// Implementation notes:
+//  One decimal, sub-microsecond latencies still show
+//------------------------------------------------------------------------------
+std::string latencyHistogram::asSummary() const
+{
+	std::ostringstream summary;
+
+	summary << std::fixed << std::setprecision(1)
+		<< "n=" << this->viewCount()
+		<< " p50=" << (this->viewPercentile(0.5) / 1e3) << "us"
+		<< " p99=" << (this->viewPercentile(0.99) / 1e3) << "us"
+		<< " max=" << (this->viewMaximum() / 1e3) << "us";
+
+	return summary.str();
+};
+
+//------------------------------------------------------------------ bucketIndex
+// Implementation notes:
+//  Above the linear buckets the power of two picks a group of eight, and
+//  the three bits below the highest set bit pick the bucket within it
+//------------------------------------------------------------------------------
+size_t latencyHistogram::bucketIndex(
+	const uint64_t& inNanoseconds)
+{
+	if(inNanoseconds < latencyHistogram::linearBuckets)
+	{
+		return static_cast<size_t>(inNanoseconds);
+	}
+
+	size_t exponent = 0;
+
+	for(uint64_t rest = inNanoseconds; rest > 1; rest >>= 1)
+	{
+		exponent++;
+	}
+
+	const size_t subBucket = static_cast<size_t>(
+		(inNanoseconds >> (exponent - 3)) & (latencyHistogram::bucketsPerPowerOfTwo - 1));
+
+	return latencyHistogram::linearBuckets
+		+ (exponent - 4) * latencyHistogram::bucketsPerPowerOfTwo
+		+ subBucket;
+};
+
+//------------------------------------------------------------- bucketUpperBound
+// Implementation notes:
+//  The inverse of bucketIndex. The last bucket ends at the largest latency.
+//------------------------------------------------------------------------------
+int64_t latencyHistogram::bucketUpperBound(
+	const size_t& inIndex)
+{
+	if(inIndex < latencyHistogram::linearBuckets)
+	{
+		return static_cast<int64_t>(inIndex);
+	}
+
+	const size_t exponent =
+		(inIndex - latencyHistogram::linearBuckets) / latencyHistogram::bucketsPerPowerOfTwo + 4;
+
+	const uint64_t subBucket =
+		(inIndex - latencyHistogram::linearBuckets) % latencyHistogram::bucketsPerPowerOfTwo;
+
+	const uint64_t upperBound =
+		((latencyHistogram::bucketsPerPowerOfTwo + subBucket + 1) << (exponent - 3)) - 1;
+
+	return static_cast<int64_t>(
+		std::min<uint64_t>(upperBound, INT64_MAX));
+};
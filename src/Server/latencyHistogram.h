@@ -0,0 +1,126 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <atomic>
+
+class latencyHistogram
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for an empty histogram of latencies in nanoseconds.
+	//  Buckets grow with the latency, each one eighth of a power of two
+	//  wide, so any percentile is within an eighth of the true value.
+	//
+	// Method:    latencyHistogram
+	// FullName:  latencyHistogram::latencyHistogram
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	latencyHistogram();
+
+	//------------------------------------------------------------------- record
+	// Brief Description
+	//  Adds a latency. Any thread may call this, a negative latency left by
+	//  the clock being stepped counts as zero.
+	//
+	// Method:    record
+	// FullName:  latencyHistogram::record
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int64_t& inNanoseconds
+	//--------------------------------------------------------------------------
+	void record(
+		const int64_t& inNanoseconds);
+
+	//---------------------------------------------------------------- viewCount
+	// Brief Description
+	//  Returns the number of latencies recorded.
+	//
+	// Method:    viewCount
+	// FullName:  latencyHistogram::viewCount
+	// Access:    public
+	// Returns:   uint64_t
+	//--------------------------------------------------------------------------
+	uint64_t viewCount() const;
+
+	//----------------------------------------------------------- viewPercentile
+	// Brief Description
+	//  Returns the latency the given fraction of the recorded ones do not
+	//  exceed, rounded up to the end of its bucket.
+	//
+	// Method:    viewPercentile
+	// FullName:  latencyHistogram::viewPercentile
+	// Access:    public
+	// Returns:   int64_t
+	// Parameter: const double& inFraction
+	//--------------------------------------------------------------------------
+	int64_t viewPercentile(
+		const double& inFraction) const;
+
+	//-------------------------------------------------------------- viewMaximum
+	// Brief Description
+	//  Returns the largest latency recorded.
+	//
+	// Method:    viewMaximum
+	// FullName:  latencyHistogram::viewMaximum
+	// Access:    public
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	int64_t viewMaximum() const;
+
+	//---------------------------------------------------------------- asSummary
+	// Brief Description
+	//  Returns the count, median, 99th percentile and maximum on one line,
+	//  in microseconds.
+	//
+	// Method:    asSummary
+	// FullName:  latencyHistogram::asSummary
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string asSummary() const;
+
+private:
+
+	//-------------------------------------------------------------- bucketIndex
+	// Brief Description
+	//  Returns the bucket a latency falls into.
+	//
+	// Method:    bucketIndex
+	// FullName:  latencyHistogram::bucketIndex
+	// Access:    private static
+	// Returns:   size_t
+	// Parameter: const uint64_t& inNanoseconds
+	//--------------------------------------------------------------------------
+	static size_t bucketIndex(
+		const uint64_t& inNanoseconds);
+
+	//--------------------------------------------------------- bucketUpperBound
+	// Brief Description
+	//  Returns the largest latency that falls into a bucket.
+	//
+	// Method:    bucketUpperBound
+	// FullName:  latencyHistogram::bucketUpperBound
+	// Access:    private static
+	// Returns:   int64_t
+	// Parameter: const size_t& inIndex
+	//--------------------------------------------------------------------------
+	static int64_t bucketUpperBound(
+		const size_t& inIndex);
+
+	// buckets below 16ns hold a single value, above it eight per power of two
+	static const size_t linearBuckets = 16;
+	static const size_t bucketsPerPowerOfTwo = 8;
+	static const size_t bucketCount =
+		linearBuckets + (64 - 4) * bucketsPerPowerOfTwo;
+
+	// Member Variables
+	std::atomic<uint64_t> m_buckets[bucketCount];
+	std::atomic<uint64_t> m_count;
+	std::atomic<int64_t> m_maximum;
+};
@@ -0,0 +1,1050 @@
+// STL
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <cstdio>
+
+// Boost
+#include <boost/bind.hpp>
+
+// Project
+#include "lsmStore.h"
+#include "blockEncoding.h"
+#include "../Common/crc32c.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Logs are numbered without gaps, so replay probes forward from the first
+//  live one until a number has no file. The task pool is not used yet, it
+//  may still be under construction. A recovered memory table that is
+//  already full is sealed by the next write.
+//------------------------------------------------------------------------------
+lsmStore::lsmStore(
+	const std::string& inName,
+	taskPool& inTaskPool) :
+	m_name(inName),
+	m_taskPool(&inTaskPool),
+	m_memoryTableLength(0),
+	m_logNumber(0),
+	m_memoryTableFirstLog(0),
+	m_levels(constants::lsmMaximumLevels),
+	m_compactionCursors(constants::lsmMaximumLevels, 0),
+	m_nextSegmentNumber(0),
+	m_backgroundBusy(false)
+{
+	this->readManifest();
+
+	this->m_logNumber = this->m_memoryTableFirstLog;
+
+	while(this->replayLog(this->m_logNumber))
+	{
+		this->m_logNumber++;
+	}
+
+	this->m_log.open(
+		this->filePath("log", this->m_logNumber).c_str(),
+		std::ios::binary | std::ios::trunc);
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  The task pool is already stopped, so no background job is left running
+//------------------------------------------------------------------------------
+lsmStore::~lsmStore()
+{
+	this->flushLog();
+	this->m_log.close();
+};
+
+//-------------------------------------------------------------------------- put
+// Implementation notes:
+//  Logged before it is applied, like erase
+//------------------------------------------------------------------------------
+void lsmStore::put(
+	const std::string& inKey,
+	const std::string& inValue)
+{
+	const std::string taggedValue(
+		std::string(1, lsmStore::putTag) + inValue);
+
+	this->writeLog(inKey, taggedValue);
+	this->applyToMemoryTable(inKey, taggedValue);
+
+	if(this->m_memoryTableLength >= constants::lsmMemtableLength)
+	{
+		this->sealMemoryTable();
+	}
+};
+
+//------------------------------------------------------------------------ erase
+// Implementation notes:
+//  An erasure is stored like a value, it hides the key in older segments
+//  until a merge reaches the last level
+//------------------------------------------------------------------------------
+void lsmStore::erase(
+	const std::string& inKey)
+{
+	const std::string taggedValue(
+		1, lsmStore::eraseTag);
+
+	this->writeLog(inKey, taggedValue);
+	this->applyToMemoryTable(inKey, taggedValue);
+
+	if(this->m_memoryTableLength >= constants::lsmMemtableLength)
+	{
+		this->sealMemoryTable();
+	}
+};
+
+//--------------------------------------------------------------------- flushLog
+// Implementation notes:
+//  One write for the whole buffer, so the log is written sequentially in
+//  large pieces
+//------------------------------------------------------------------------------
+void lsmStore::flushLog()
+{
+	if(this->m_logBuffer.empty())
+	{
+		return;
+	}
+
+	this->m_log.write(
+		this->m_logBuffer.data(),
+		this->m_logBuffer.size());
+
+	this->m_log.flush();
+
+	if(this->m_log.fail())
+	{
+		std::cout << "Unable to write log of " << this->m_name << std::endl;
+		this->m_log.clear();
+	}
+
+	this->m_logBuffer.clear();
+};
+
+//------------------------------------------------------------------------- scan
+// Implementation notes:
+//  Sources are read newest first and a key is only taken from the first
+//  source that has it, so older values and erased keys stay hidden. The
+//  mutex keeps the background job from swapping segments mid scan.
+//------------------------------------------------------------------------------
+std::vector<lsmStore::record> lsmStore::scan(
+	const std::string& inFromKey,
+	const std::string& inToKey)
+{
+	std::map<std::string, std::string> newestValues;
+
+	for(memoryTable::const_iterator it = this->m_memoryTable.lower_bound(inFromKey);
+		(it != this->m_memoryTable.end()) && (it->first < inToKey);
+		it++)
+	{
+		newestValues.insert(*it);
+	}
+
+	{
+		boost::mutex::scoped_lock lock(this->m_mutex);
+
+		for(std::deque<sealedTable>::const_reverse_iterator table = this->m_sealedTables.rbegin();
+			table != this->m_sealedTables.rend();
+			table++)
+		{
+			for(memoryTable::const_iterator it = table->records->lower_bound(inFromKey);
+				(it != table->records->end()) && (it->first < inToKey);
+				it++)
+			{
+				newestValues.insert(*it);
+			}
+		}
+
+		// level 0 segments overlap, newest last, deeper levels are sorted
+		std::vector<const segmentFile*> segments;
+
+		for(std::vector<segmentFile>::const_reverse_iterator segment = this->m_levels[0].rbegin();
+			segment != this->m_levels[0].rend();
+			segment++)
+		{
+			segments.push_back(&*segment);
+		}
+
+		for(size_t level = 1; level < this->m_levels.size(); level++)
+		{
+			for(const segmentFile& currentSegment : this->m_levels[level])
+			{
+				segments.push_back(&currentSegment);
+			}
+		}
+
+		for(const segmentFile* currentSegment : segments)
+		{
+			if(!lsmStore::mayHoldRange(*currentSegment, inFromKey, inToKey))
+			{
+				continue;
+			}
+
+			try
+			{
+				for(const record& currentRecord : currentSegment->reader->scan(inFromKey, inToKey))
+				{
+					newestValues.insert(std::make_pair(
+						currentRecord.key,
+						currentRecord.value));
+				}
+			}
+			catch(const std::exception& e)
+			{
+				std::cout << "Unable to read segment " << currentSegment->number
+					<< " of " << this->m_name << ": " << e.what() << std::endl;
+			}
+		}
+	}
+
+	std::vector<record> outRecords;
+
+	for(const std::pair<const std::string, std::string>& currentValue : newestValues)
+	{
+		if(currentValue.second.empty() || (currentValue.second[0] != lsmStore::putTag))
+		{
+			continue;
+		}
+
+		record currentRecord;
+		currentRecord.key = currentValue.first;
+		currentRecord.value = currentValue.second.substr(1);
+
+		outRecords.push_back(currentRecord);
+	}
+
+	return outRecords;
+};
+
+//--------------------------------------------------------------- timeOrderedKey
+// Implementation notes:
+//  The group is terminated by a zero byte, which no username contains, and
+//  the numbers are big endian so they sort bytewise
+//------------------------------------------------------------------------------
+std::string lsmStore::timeOrderedKey(
+	const std::string& inGroup,
+	const int64_t& inTimeMilliseconds,
+	const uint64_t& inSequence)
+{
+	std::string outKey(inGroup);
+	outKey.push_back('\0');
+
+	for(int16_t shift = 56; shift >= 0; shift -= 8)
+	{
+		outKey.push_back(static_cast<char>((static_cast<uint64_t>(inTimeMilliseconds) >> shift) & 0xFF));
+	}
+
+	for(int16_t shift = 56; shift >= 0; shift -= 8)
+	{
+		outKey.push_back(static_cast<char>((inSequence >> shift) & 0xFF));
+	}
+
+	return outKey;
+};
+
+//--------------------------------------------------------------------- writeLog
+// Implementation notes:
+//  Each record is its length and checksum followed by the key and value,
+//  so replay can tell where a torn write at the end starts
+//------------------------------------------------------------------------------
+void lsmStore::writeLog(
+	const std::string& inKey,
+	const std::string& inTaggedValue)
+{
+	std::vector<char> payload;
+
+	blockEncoding::appendString(payload, inKey.data(), inKey.size());
+	blockEncoding::appendString(payload, inTaggedValue.data(), inTaggedValue.size());
+
+	blockEncoding::appendFixed(this->m_logBuffer, payload.size(), 4);
+	blockEncoding::appendFixed(this->m_logBuffer, crc32c::checksum(payload.data(), payload.size()), 4);
+
+	this->m_logBuffer.insert(
+		this->m_logBuffer.end(),
+		payload.begin(),
+		payload.end());
+
+	if(this->m_logBuffer.size() >= constants::lsmLogBufferLength)
+	{
+		this->flushLog();
+	}
+};
+
+//-------------------------------------------------------------------- replayLog
+// Implementation notes:
+//  Records past a bad one are dropped, they were written after it
+//------------------------------------------------------------------------------
+bool lsmStore::replayLog(
+	const uint64_t& inLogNumber)
+{
+	std::ifstream logFile(
+		this->filePath("log", inLogNumber).c_str(),
+		std::ios::binary);
+
+	if(!logFile.good())
+	{
+		return false;
+	}
+
+	const std::vector<char> contents(
+		(std::istreambuf_iterator<char>(logFile)),
+		std::istreambuf_iterator<char>());
+
+	size_t position = 0;
+	size_t replayedRecords = 0;
+
+	try
+	{
+		while(position + 8 <= contents.size())
+		{
+			const uint64_t payloadLength = blockEncoding::readFixed(contents, position, 4);
+			const uint32_t checksum = static_cast<uint32_t>(blockEncoding::readFixed(contents, position, 4));
+
+			if((payloadLength > contents.size() - position)
+				|| (crc32c::checksum(&contents[position], static_cast<size_t>(payloadLength)) != checksum))
+			{
+				break;
+			}
+
+			const std::vector<char> payload(
+				contents.begin() + position,
+				contents.begin() + position + static_cast<size_t>(payloadLength));
+
+			position += static_cast<size_t>(payloadLength);
+
+			size_t payloadPosition = 0;
+
+			const std::string key(blockEncoding::readString(payload, payloadPosition));
+			const std::string taggedValue(blockEncoding::readString(payload, payloadPosition));
+
+			this->applyToMemoryTable(key, taggedValue);
+			replayedRecords++;
+		}
+	}
+	catch(const std::runtime_error&)
+	{
+
+	}
+
+	if(replayedRecords != 0)
+	{
+		std::cout << "Replayed " << replayedRecords << " records of "
+			<< this->m_name << " from log " << inLogNumber << std::endl;
+	}
+
+	return true;
+};
+
+//----------------------------------------------------------- applyToMemoryTable
+// Implementation notes:
+//  The length counts replaced values too, it only decides when to seal
+//------------------------------------------------------------------------------
+void lsmStore::applyToMemoryTable(
+	const std::string& inKey,
+	const std::string& inTaggedValue)
+{
+	this->m_memoryTable[inKey] = inTaggedValue;
+	this->m_memoryTableLength += inKey.size() + inTaggedValue.size();
+};
+
+//-------------------------------------------------------------- sealMemoryTable
+// Implementation notes:
+//  The sealed table keeps the number of its first log, which has to stay
+//  until the table is in a segment
+//------------------------------------------------------------------------------
+void lsmStore::sealMemoryTable()
+{
+	this->flushLog();
+	this->m_log.close();
+
+	std::shared_ptr<memoryTable> sealedRecords(
+		new memoryTable());
+
+	sealedRecords->swap(
+		this->m_memoryTable);
+
+	this->m_memoryTableLength = 0;
+	this->m_logNumber++;
+
+	this->m_log.open(
+		this->filePath("log", this->m_logNumber).c_str(),
+		std::ios::binary | std::ios::trunc);
+
+	boost::mutex::scoped_lock lock(this->m_mutex);
+
+	sealedTable table;
+	table.records = sealedRecords;
+	table.firstLogNumber = this->m_memoryTableFirstLog;
+
+	this->m_sealedTables.push_back(table);
+	this->m_memoryTableFirstLog = this->m_logNumber;
+
+	this->scheduleBackground();
+};
+
+//----------------------------------------------------------- scheduleBackground
+// Implementation notes:
+//  The job itself finds out if there is anything to do
+//------------------------------------------------------------------------------
+void lsmStore::scheduleBackground()
+{
+	if(this->m_backgroundBusy)
+	{
+		return;
+	}
+
+	this->m_backgroundBusy = true;
+
+	this->m_taskPool->submit(boost::bind(
+		&lsmStore::backgroundWork,
+		this));
+};
+
+//--------------------------------------------------------------- backgroundWork
+// Implementation notes:
+//  One job at a time, so merges never race each other. Flushes go first,
+//  they are what frees memory and logs. A failed step ends the job and the
+//  next seal starts it again.
+//------------------------------------------------------------------------------
+void lsmStore::backgroundWork()
+{
+	while(true)
+	{
+		sealedTable table;
+		std::vector<segmentFile> inputs;
+		uint16_t level = 0;
+		bool flush = false;
+
+		{
+			boost::mutex::scoped_lock lock(this->m_mutex);
+
+			if(!this->m_sealedTables.empty())
+			{
+				table = this->m_sealedTables.front();
+				flush = true;
+			}
+			else if(!this->pickCompaction(inputs, level))
+			{
+				this->m_backgroundBusy = false;
+				return;
+			}
+		}
+
+		try
+		{
+			if(flush)
+			{
+				this->flushSealedTable(
+					table);
+			}
+			else
+			{
+				this->compact(
+					inputs,
+					level);
+			}
+		}
+		catch(const std::exception& e)
+		{
+			std::cout << "Background work on " << this->m_name
+				<< " failed: " << e.what() << std::endl;
+
+			boost::mutex::scoped_lock lock(this->m_mutex);
+			this->m_backgroundBusy = false;
+			return;
+		}
+	}
+};
+
+//------------------------------------------------------------- flushSealedTable
+// Implementation notes:
+//  Erasures are kept, older segments may still hold the keys
+//------------------------------------------------------------------------------
+void lsmStore::flushSealedTable(
+	const sealedTable& inTable)
+{
+	segmentOutput output;
+	output.writer = nullptr;
+	output.number = 0;
+
+	for(const std::pair<const std::string, std::string>& currentRecord : *inTable.records)
+	{
+		this->addToOutput(
+			output,
+			currentRecord.first,
+			currentRecord.second,
+			false);
+	}
+
+	this->finishOutput(
+		output);
+
+	boost::mutex::scoped_lock lock(this->m_mutex);
+
+	this->install(
+		std::vector<segmentFile>(),
+		output.files,
+		0,
+		true);
+
+	for(const segmentFile& currentSegment : output.files)
+	{
+		std::cout << "Wrote " << this->m_name << " segment " << currentSegment.number
+			<< ": " << inTable.records->size() << " records in "
+			<< currentSegment.length << " bytes" << std::endl;
+	}
+};
+
+//--------------------------------------------------------------- pickCompaction
+// Implementation notes:
+//  Level 0 is merged whole once it has enough segments, since its segments
+//  overlap. A deeper level over its length gives up one segment at a time,
+//  taken round robin so every key range gets its turn.
+//------------------------------------------------------------------------------
+bool lsmStore::pickCompaction(
+	std::vector<segmentFile>& outInputs,
+	uint16_t& outLevel)
+{
+	outInputs.clear();
+
+	uint16_t sourceLevel = 0;
+
+	if(this->m_levels[0].size() >= constants::lsmLevel0Segments)
+	{
+		outInputs.assign(
+			this->m_levels[0].rbegin(),
+			this->m_levels[0].rend());
+	}
+	else
+	{
+		uint64_t levelLimit = constants::lsmLevel1Length;
+
+		for(uint16_t level = 1; level < constants::lsmMaximumLevels - 1; level++)
+		{
+			uint64_t levelLength = 0;
+
+			for(const segmentFile& currentSegment : this->m_levels[level])
+			{
+				levelLength += currentSegment.length;
+			}
+
+			if(levelLength > levelLimit)
+			{
+				const size_t chosen =
+					this->m_compactionCursors[level] % this->m_levels[level].size();
+
+				this->m_compactionCursors[level] = chosen + 1;
+
+				outInputs.push_back(
+					this->m_levels[level][chosen]);
+
+				sourceLevel = level;
+				break;
+			}
+
+			levelLimit *= constants::lsmLevelGrowth;
+		}
+
+		if(outInputs.empty())
+		{
+			return false;
+		}
+	}
+
+	std::string firstKey(outInputs.front().firstKey);
+	std::string lastKey(outInputs.front().lastKey);
+
+	for(const segmentFile& currentInput : outInputs)
+	{
+		firstKey = std::min(firstKey, currentInput.firstKey);
+		lastKey = std::max(lastKey, currentInput.lastKey);
+	}
+
+	outLevel = sourceLevel + 1;
+
+	for(const segmentFile& currentSegment : this->m_levels[outLevel])
+	{
+		if((currentSegment.lastKey >= firstKey) && (currentSegment.firstKey <= lastKey))
+		{
+			outInputs.push_back(
+				currentSegment);
+		}
+	}
+
+	return true;
+};
+
+//---------------------------------------------------------------------- compact
+// Implementation notes:
+//  A streaming merge, each input holds one block in memory. The inputs are
+//  opened again rather than sharing the readers scans use, a reader is not
+//  safe to use from two threads.
+//------------------------------------------------------------------------------
+void lsmStore::compact(
+	const std::vector<segmentFile>& inInputs,
+	const uint16_t& inLevel)
+{
+	bool dropErasures = true;
+
+	{
+		boost::mutex::scoped_lock lock(this->m_mutex);
+
+		for(size_t level = inLevel + 1; level < this->m_levels.size(); level++)
+		{
+			dropErasures = dropErasures && this->m_levels[level].empty();
+		}
+	}
+
+	std::vector<mergeInput> sources;
+
+	for(const segmentFile& currentInput : inInputs)
+	{
+		mergeInput source;
+		source.reader = std::make_shared<blockFileReader>(
+			this->filePath("", currentInput.number));
+		source.nextBlock = 0;
+		source.position = 0;
+
+		if(lsmStore::advanceInput(source))
+		{
+			sources.push_back(source);
+		}
+	}
+
+	segmentOutput output;
+	output.writer = nullptr;
+	output.number = 0;
+
+	uint64_t mergedRecords = 0;
+
+	while(!sources.empty())
+	{
+		// the earliest source is the newest, it wins ties
+		size_t smallest = 0;
+
+		for(size_t i = 1; i < sources.size(); i++)
+		{
+			if(sources[i].records[sources[i].position].key
+				< sources[smallest].records[sources[smallest].position].key)
+			{
+				smallest = i;
+			}
+		}
+
+		const record current(
+			sources[smallest].records[sources[smallest].position]);
+
+		for(size_t i = sources.size(); i-- > 0;)
+		{
+			if((sources[i].records[sources[i].position].key == current.key)
+				&& !lsmStore::advanceInput(sources[i]))
+			{
+				sources.erase(sources.begin() + i);
+			}
+		}
+
+		if(dropErasures && (current.value.empty() || (current.value[0] == lsmStore::eraseTag)))
+		{
+			continue;
+		}
+
+		this->addToOutput(
+			output,
+			current.key,
+			current.value,
+			true);
+
+		mergedRecords++;
+	}
+
+	this->finishOutput(
+		output);
+
+	boost::mutex::scoped_lock lock(this->m_mutex);
+
+	this->install(
+		inInputs,
+		output.files,
+		inLevel,
+		false);
+
+	std::cout << "Merged " << inInputs.size() << " segments of " << this->m_name
+		<< " into " << output.files.size() << " at level " << inLevel
+		<< ": " << mergedRecords << " records" << std::endl;
+};
+
+//----------------------------------------------------------------- advanceInput
+// Implementation notes:
+//  A fresh input has no records and is moved to the first one
+//------------------------------------------------------------------------------
+bool lsmStore::advanceInput(
+	mergeInput& ioInput)
+{
+	if(!ioInput.records.empty())
+	{
+		ioInput.position++;
+	}
+
+	while(ioInput.position >= ioInput.records.size())
+	{
+		if(ioInput.nextBlock == ioInput.reader->viewBlockCount())
+		{
+			return false;
+		}
+
+		ioInput.records = ioInput.reader->readBlock(
+			ioInput.nextBlock);
+
+		ioInput.nextBlock++;
+		ioInput.position = 0;
+	}
+
+	return true;
+};
+
+//------------------------------------------------------------------ addToOutput
+// Implementation notes:
+//  Keys arrive in order, so a group only needs comparing with the last one
+//  to be collected once for the filter
+//------------------------------------------------------------------------------
+void lsmStore::addToOutput(
+	segmentOutput& ioOutput,
+	const std::string& inKey,
+	const std::string& inTaggedValue,
+	const bool& inSplit)
+{
+	if(inSplit
+		&& (ioOutput.writer != nullptr)
+		&& (ioOutput.writer->viewRawLength() >= constants::lsmSegmentLength))
+	{
+		this->finishOutput(
+			ioOutput);
+	}
+
+	if(ioOutput.writer == nullptr)
+	{
+		{
+			boost::mutex::scoped_lock lock(this->m_mutex);
+			ioOutput.number = this->m_nextSegmentNumber++;
+		}
+
+		ioOutput.writer = new blockFileWriter(
+			this->filePath("", ioOutput.number));
+	}
+
+	const std::string group(
+		lsmStore::groupOfKey(inKey));
+
+	if(ioOutput.groups.empty() || (ioOutput.groups.back() != group))
+	{
+		ioOutput.groups.push_back(
+			group);
+	}
+
+	ioOutput.writer->add(
+		inKey,
+		inTaggedValue);
+};
+
+//----------------------------------------------------------------- finishOutput
+// Implementation notes:
+//  The filter is sized once the number of groups is known
+//------------------------------------------------------------------------------
+void lsmStore::finishOutput(
+	segmentOutput& ioOutput)
+{
+	if(ioOutput.writer == nullptr)
+	{
+		return;
+	}
+
+	bloomFilter filter(
+		ioOutput.groups.size(),
+		constants::lsmBloomBitsPerKey);
+
+	for(const std::string& currentGroup : ioOutput.groups)
+	{
+		filter.add(
+			currentGroup);
+	}
+
+	ioOutput.writer->setFilter(
+		filter.asString());
+
+	ioOutput.writer->finish();
+
+	delete ioOutput.writer;
+	ioOutput.writer = nullptr;
+	ioOutput.groups.clear();
+
+	ioOutput.files.push_back(
+		this->openSegment(ioOutput.number));
+};
+
+//------------------------------------------------------------------ openSegment
+// Implementation notes:
+//  The length on disk is what level lengths are measured in
+//------------------------------------------------------------------------------
+lsmStore::segmentFile lsmStore::openSegment(
+	const uint64_t& inNumber) const
+{
+	const std::string path(
+		this->filePath("", inNumber));
+
+	segmentFile outSegment;
+	outSegment.number = inNumber;
+	outSegment.reader = std::make_shared<blockFileReader>(path);
+	outSegment.filter = std::make_shared<const bloomFilter>(outSegment.reader->viewFilter());
+	outSegment.firstKey = outSegment.reader->viewFirstKey();
+	outSegment.lastKey = outSegment.reader->viewLastKey();
+
+	std::ifstream segmentFile(
+		path.c_str(),
+		std::ios::binary | std::ios::ate);
+
+	outSegment.length = static_cast<uint64_t>(segmentFile.tellg());
+
+	return outSegment;
+};
+
+//---------------------------------------------------------------------- install
+// Implementation notes:
+//  Inputs are only deleted once the manifest no longer lists them, so a
+//  crash at any point leaves a manifest whose files all exist. Files left
+//  over by a crash are never listed and are overwritten later.
+//------------------------------------------------------------------------------
+void lsmStore::install(
+	const std::vector<segmentFile>& inInputs,
+	const std::vector<segmentFile>& inOutputs,
+	const uint16_t& inLevel,
+	const bool& inFlushedTable)
+{
+	for(const segmentFile& currentInput : inInputs)
+	{
+		for(std::vector<segmentFile>& currentLevel : this->m_levels)
+		{
+			for(std::vector<segmentFile>::iterator it = currentLevel.begin(); it != currentLevel.end(); it++)
+			{
+				if(it->number == currentInput.number)
+				{
+					currentLevel.erase(it);
+					break;
+				}
+			}
+		}
+	}
+
+	std::vector<segmentFile>& outputLevel =
+		this->m_levels[inLevel];
+
+	outputLevel.insert(
+		outputLevel.end(),
+		inOutputs.begin(),
+		inOutputs.end());
+
+	if(inLevel != 0)
+	{
+		std::sort(
+			outputLevel.begin(),
+			outputLevel.end(),
+			&lsmStore::segmentStartsBefore);
+	}
+
+	const uint64_t oldFirstLiveLog =
+		this->firstLiveLog();
+
+	if(inFlushedTable)
+	{
+		this->m_sealedTables.pop_front();
+	}
+
+	this->writeManifest();
+
+	for(const segmentFile& currentInput : inInputs)
+	{
+		std::remove(this->filePath("", currentInput.number).c_str());
+	}
+
+	for(uint64_t log = oldFirstLiveLog; log < this->firstLiveLog(); log++)
+	{
+		std::remove(this->filePath("log", log).c_str());
+	}
+};
+
+//---------------------------------------------------------------- writeManifest
+// Implementation notes:
+//  Written under a temporary name and renamed, so the manifest on disk is
+//  always a complete one. Level 0 is listed oldest first.
+//------------------------------------------------------------------------------
+void lsmStore::writeManifest() const
+{
+	const std::string manifestPath(
+		this->m_name + ".manifest");
+
+	const std::string temporaryPath(
+		manifestPath + ".tmp");
+
+	{
+		std::ofstream manifest(
+			temporaryPath.c_str(),
+			std::ios::trunc);
+
+		manifest << "next " << this->m_nextSegmentNumber << "\n";
+		manifest << "log " << this->firstLiveLog() << "\n";
+
+		for(size_t level = 0; level < this->m_levels.size(); level++)
+		{
+			for(const segmentFile& currentSegment : this->m_levels[level])
+			{
+				manifest << "file " << level << " " << currentSegment.number << "\n";
+			}
+		}
+	}
+
+	if(std::rename(temporaryPath.c_str(), manifestPath.c_str()) != 0)
+	{
+		std::cout << "Unable to write manifest of " << this->m_name << std::endl;
+	}
+};
+
+//----------------------------------------------------------------- readManifest
+// Implementation notes:
+//  A segment that cannot be opened is reported and left out rather than
+//  keeping the server from starting
+//------------------------------------------------------------------------------
+void lsmStore::readManifest()
+{
+	std::ifstream manifest(
+		(this->m_name + ".manifest").c_str());
+
+	std::string field;
+
+	while(manifest >> field)
+	{
+		if(field == "next")
+		{
+			manifest >> this->m_nextSegmentNumber;
+		}
+		else if(field == "log")
+		{
+			manifest >> this->m_memoryTableFirstLog;
+		}
+		else if(field == "file")
+		{
+			size_t level = 0;
+			uint64_t number = 0;
+
+			manifest >> level >> number;
+
+			if(level >= this->m_levels.size())
+			{
+				continue;
+			}
+
+			try
+			{
+				this->m_levels[level].push_back(
+					this->openSegment(number));
+			}
+			catch(const std::exception& e)
+			{
+				std::cout << "Unable to open segment " << number
+					<< " of " << this->m_name << ": " << e.what() << std::endl;
+			}
+		}
+	}
+};
+
+//----------------------------------------------------------------- firstLiveLog
+// Implementation notes:
+//  The oldest sealed table's, or the open table's if none is waiting
+//------------------------------------------------------------------------------
+uint64_t lsmStore::firstLiveLog() const
+{
+	return this->m_sealedTables.empty()
+		? this->m_memoryTableFirstLog
+		: this->m_sealedTables.front().firstLogNumber;
+};
+
+//----------------------------------------------------------------- mayHoldRange
+// Implementation notes:
+//  The filter only knows groups, so it is only asked when the range ends
+//  before the next group starts
+//------------------------------------------------------------------------------
+bool lsmStore::mayHoldRange(
+	const segmentFile& inSegment,
+	const std::string& inFromKey,
+	const std::string& inToKey)
+{
+	if((inSegment.lastKey < inFromKey) || (inSegment.firstKey >= inToKey))
+	{
+		return false;
+	}
+
+	const std::string group(
+		lsmStore::groupOfKey(inFromKey));
+
+	if(group.empty())
+	{
+		return true;
+	}
+
+	// the first key past the group, the zero byte that ends it bumped by one
+	std::string groupEnd(group);
+	groupEnd[groupEnd.size() - 1] = '\1';
+
+	if(inToKey > groupEnd)
+	{
+		return true;
+	}
+
+	return inSegment.filter->mayContain(
+		group);
+};
+
+//---------------------------------------------------------- segmentStartsBefore
+// Implementation notes:
+//  Segments of a level below 0 do not overlap, so their first keys order them
+//------------------------------------------------------------------------------
+bool lsmStore::segmentStartsBefore(
+	const segmentFile& inFirst,
+	const segmentFile& inSecond)
+{
+	return inFirst.firstKey < inSecond.firstKey;
+};
+
+//------------------------------------------------------------------- groupOfKey
+// Implementation notes:
+//  Includes the zero byte, so no group is a prefix of another
+//------------------------------------------------------------------------------
+std::string lsmStore::groupOfKey(
+	const std::string& inKey)
+{
+	const size_t end = inKey.find('\0');
+
+	if(end == std::string::npos)
+	{
+		return std::string();
+	}
+
+	return inKey.substr(0, end + 1);
+};
+
+//--------------------------------------------------------------------- filePath
+// Implementation notes:
+//  <name>.<number> for segments, <name>.<kind>.<number> for the rest
+//------------------------------------------------------------------------------
+std::string lsmStore::filePath(
+	const std::string& inKind,
+	const uint64_t& inNumber) const
+{
+	if(inKind.empty())
+	{
+		return this->m_name + "." + std::to_string(inNumber);
+	}
+
+	return this->m_name + "." + inKind + "." + std::to_string(inNumber);
+};
@@ -0,0 +1,505 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+// Boost
+#include <boost/thread.hpp>
+
+// Project
+#include "taskPool.h"
+#include "blockFileReader.h"
+#include "blockFileWriter.h"
+#include "bloomFilter.h"
+
+class lsmStore
+{
+public:
+
+	// A key and value as put in the store
+	typedef blockFileReader::record record;
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Opens the store with the given name, loading the segments listed in
+	//  its manifest and replaying the logs of writes not yet in a segment.
+	//  Segments are written and merged on the task pool from the first
+	//  write on. The owner must stop the pool before destroying the store.
+	//
+	// Method:    lsmStore
+	// FullName:  lsmStore::lsmStore
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inName
+	// Parameter: taskPool& inTaskPool
+	//--------------------------------------------------------------------------
+	lsmStore(
+		const std::string& inName,
+		taskPool& inTaskPool);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Writes the buffered log records. The memory table is not written out,
+	//  the next run replays it from the log.
+	//
+	// Method:    ~lsmStore
+	// FullName:  lsmStore::~lsmStore
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~lsmStore();
+
+	//---------------------------------------------------------------------- put
+	// Brief Description
+	//  Stores the value under the key, replacing any earlier value. Only one
+	//  thread may write to and scan a store.
+	//
+	// Method:    put
+	// FullName:  lsmStore::put
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inKey
+	// Parameter: const std::string& inValue
+	//--------------------------------------------------------------------------
+	void put(
+		const std::string& inKey,
+		const std::string& inValue);
+
+	//-------------------------------------------------------------------- erase
+	// Brief Description
+	//  Removes the key from the store.
+	//
+	// Method:    erase
+	// FullName:  lsmStore::erase
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inKey
+	//--------------------------------------------------------------------------
+	void erase(
+		const std::string& inKey);
+
+	//----------------------------------------------------------------- flushLog
+	// Brief Description
+	//  Writes the buffered log records to the log file. Writes since the
+	//  last flush are lost if the process dies.
+	//
+	// Method:    flushLog
+	// FullName:  lsmStore::flushLog
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushLog();
+
+	//--------------------------------------------------------------------- scan
+	// Brief Description
+	//  Returns the records with keys from the first key up to but excluding
+	//  the last key, in key order.
+	//
+	// Method:    scan
+	// FullName:  lsmStore::scan
+	// Access:    public
+	// Returns:   std::vector<record>
+	// Parameter: const std::string& inFromKey
+	// Parameter: const std::string& inToKey
+	//--------------------------------------------------------------------------
+	std::vector<record> scan(
+		const std::string& inFromKey,
+		const std::string& inToKey);
+
+	//----------------------------------------------------------- timeOrderedKey
+	// Brief Description
+	//  Returns a key that sorts by group, then by time, then by sequence, so
+	//  the records of a group are one key range. The group is what segment
+	//  filters are built from.
+	//
+	// Method:    timeOrderedKey
+	// FullName:  lsmStore::timeOrderedKey
+	// Access:    public static
+	// Returns:   std::string
+	// Parameter: const std::string& inGroup
+	// Parameter: const int64_t& inTimeMilliseconds
+	// Parameter: const uint64_t& inSequence
+	//--------------------------------------------------------------------------
+	static std::string timeOrderedKey(
+		const std::string& inGroup,
+		const int64_t& inTimeMilliseconds,
+		const uint64_t& inSequence);
+
+private:
+
+	// Stored values start with a tag saying if they are puts or erasures
+	static const char putTag = 'P';
+	static const char eraseTag = 'D';
+
+	// Records in memory, values tagged as puts or erasures
+	typedef std::map<std::string, std::string> memoryTable;
+
+	// A memory table no longer written to, waiting to become a segment
+	struct sealedTable
+	{
+		std::shared_ptr<const memoryTable> records;
+		uint64_t firstLogNumber;
+	};
+
+	// A segment file on disk
+	struct segmentFile
+	{
+		uint64_t number;
+		uint64_t length;
+		std::string firstKey;
+		std::string lastKey;
+		std::shared_ptr<blockFileReader> reader;
+		std::shared_ptr<const bloomFilter> filter;
+	};
+
+	// A segment being written by a background job
+	struct segmentOutput
+	{
+		blockFileWriter* writer;
+		uint64_t number;
+		std::vector<std::string> groups;
+		std::vector<segmentFile> files;
+	};
+
+	// The input of a merge, read one block at a time
+	struct mergeInput
+	{
+		std::shared_ptr<blockFileReader> reader;
+		size_t nextBlock;
+		std::vector<record> records;
+		size_t position;
+	};
+
+	//----------------------------------------------------------------- writeLog
+	// Brief Description
+	//  Appends a put or erasure to the log buffer, and the buffer to the log
+	//  file once it is full.
+	//
+	// Method:    writeLog
+	// FullName:  lsmStore::writeLog
+	// Access:    private
+	// Returns:   void
+	// Parameter: const std::string& inKey
+	// Parameter: const std::string& inTaggedValue
+	//--------------------------------------------------------------------------
+	void writeLog(
+		const std::string& inKey,
+		const std::string& inTaggedValue);
+
+	//---------------------------------------------------------------- replayLog
+	// Brief Description
+	//  Reads the records of a log file into the memory table, stopping at
+	//  the first one that is torn or corrupt. Returns false if there is no
+	//  such log.
+	//
+	// Method:    replayLog
+	// FullName:  lsmStore::replayLog
+	// Access:    private
+	// Returns:   bool
+	// Parameter: const uint64_t& inLogNumber
+	//--------------------------------------------------------------------------
+	bool replayLog(
+		const uint64_t& inLogNumber);
+
+	//------------------------------------------------------- applyToMemoryTable
+	// Brief Description
+	//  Adds a tagged value to the memory table.
+	//
+	// Method:    applyToMemoryTable
+	// FullName:  lsmStore::applyToMemoryTable
+	// Access:    private
+	// Returns:   void
+	// Parameter: const std::string& inKey
+	// Parameter: const std::string& inTaggedValue
+	//--------------------------------------------------------------------------
+	void applyToMemoryTable(
+		const std::string& inKey,
+		const std::string& inTaggedValue);
+
+	//---------------------------------------------------------- sealMemoryTable
+	// Brief Description
+	//  Queues the memory table to be written as a segment and starts a new
+	//  table and log.
+	//
+	// Method:    sealMemoryTable
+	// FullName:  lsmStore::sealMemoryTable
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void sealMemoryTable();
+
+	//------------------------------------------------------- scheduleBackground
+	// Brief Description
+	//  Submits the background job to the task pool unless it is already
+	//  running. The mutex must be held.
+	//
+	// Method:    scheduleBackground
+	// FullName:  lsmStore::scheduleBackground
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void scheduleBackground();
+
+	//----------------------------------------------------------- backgroundWork
+	// Brief Description
+	//  Writes sealed memory tables as level 0 segments, then merges levels
+	//  that are over their length, until there is nothing left to do.
+	//
+	// Method:    backgroundWork
+	// FullName:  lsmStore::backgroundWork
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void backgroundWork();
+
+	//--------------------------------------------------------- flushSealedTable
+	// Brief Description
+	//  Writes the oldest sealed memory table as a level 0 segment.
+	//
+	// Method:    flushSealedTable
+	// FullName:  lsmStore::flushSealedTable
+	// Access:    private
+	// Returns:   void
+	// Parameter: const sealedTable& inTable
+	//--------------------------------------------------------------------------
+	void flushSealedTable(
+		const sealedTable& inTable);
+
+	//----------------------------------------------------------- pickCompaction
+	// Brief Description
+	//  Chooses the segments of the next merge, newest first, and the level
+	//  they are merged into. Returns false if no level needs merging. The
+	//  mutex must be held.
+	//
+	// Method:    pickCompaction
+	// FullName:  lsmStore::pickCompaction
+	// Access:    private
+	// Returns:   bool
+	// Parameter: std::vector<segmentFile>& outInputs
+	// Parameter: uint16_t& outLevel
+	//--------------------------------------------------------------------------
+	bool pickCompaction(
+		std::vector<segmentFile>& outInputs,
+		uint16_t& outLevel);
+
+	//------------------------------------------------------------------ compact
+	// Brief Description
+	//  Merges the segments into the given level. Where keys repeat, the
+	//  earliest input wins. Erasures are dropped if no deeper level holds
+	//  anything they could hide.
+	//
+	// Method:    compact
+	// FullName:  lsmStore::compact
+	// Access:    private
+	// Returns:   void
+	// Parameter: const std::vector<segmentFile>& inInputs
+	// Parameter: const uint16_t& inLevel
+	//--------------------------------------------------------------------------
+	void compact(
+		const std::vector<segmentFile>& inInputs,
+		const uint16_t& inLevel);
+
+	//------------------------------------------------------------- advanceInput
+	// Brief Description
+	//  Moves a merge input to its next record, reading the next block when
+	//  the current one is used up. Returns false at the end of the input.
+	//
+	// Method:    advanceInput
+	// FullName:  lsmStore::advanceInput
+	// Access:    private static
+	// Returns:   bool
+	// Parameter: mergeInput& ioInput
+	//--------------------------------------------------------------------------
+	static bool advanceInput(
+		mergeInput& ioInput);
+
+	//-------------------------------------------------------------- addToOutput
+	// Brief Description
+	//  Adds a record to the segment being written, starting a new segment
+	//  when there is none or the current one is full.
+	//
+	// Method:    addToOutput
+	// FullName:  lsmStore::addToOutput
+	// Access:    private
+	// Returns:   void
+	// Parameter: segmentOutput& ioOutput
+	// Parameter: const std::string& inKey
+	// Parameter: const std::string& inTaggedValue
+	// Parameter: const bool& inSplit
+	//--------------------------------------------------------------------------
+	void addToOutput(
+		segmentOutput& ioOutput,
+		const std::string& inKey,
+		const std::string& inTaggedValue,
+		const bool& inSplit);
+
+	//------------------------------------------------------------- finishOutput
+	// Brief Description
+	//  Finishes the segment being written and opens it for reading.
+	//
+	// Method:    finishOutput
+	// FullName:  lsmStore::finishOutput
+	// Access:    private
+	// Returns:   void
+	// Parameter: segmentOutput& ioOutput
+	//--------------------------------------------------------------------------
+	void finishOutput(
+		segmentOutput& ioOutput);
+
+	//-------------------------------------------------------------- openSegment
+	// Brief Description
+	//  Opens the segment with the given number. Throws if it is missing or
+	//  corrupt.
+	//
+	// Method:    openSegment
+	// FullName:  lsmStore::openSegment
+	// Access:    private
+	// Returns:   segmentFile
+	// Parameter: const uint64_t& inNumber
+	//--------------------------------------------------------------------------
+	segmentFile openSegment(
+		const uint64_t& inNumber) const;
+
+	//------------------------------------------------------------------ install
+	// Brief Description
+	//  Replaces the input segments of a job with its outputs, records the
+	//  change in the manifest and deletes the files no longer needed. The
+	//  mutex must be held.
+	//
+	// Method:    install
+	// FullName:  lsmStore::install
+	// Access:    private
+	// Returns:   void
+	// Parameter: const std::vector<segmentFile>& inInputs
+	// Parameter: const std::vector<segmentFile>& inOutputs
+	// Parameter: const uint16_t& inLevel
+	// Parameter: const bool& inFlushedTable
+	//--------------------------------------------------------------------------
+	void install(
+		const std::vector<segmentFile>& inInputs,
+		const std::vector<segmentFile>& inOutputs,
+		const uint16_t& inLevel,
+		const bool& inFlushedTable);
+
+	//------------------------------------------------------------ writeManifest
+	// Brief Description
+	//  Writes the list of live segments and logs. The mutex must be held.
+	//
+	// Method:    writeManifest
+	// FullName:  lsmStore::writeManifest
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void writeManifest() const;
+
+	//------------------------------------------------------------- readManifest
+	// Brief Description
+	//  Loads the segments and first live log from the manifest, if there is
+	//  one.
+	//
+	// Method:    readManifest
+	// FullName:  lsmStore::readManifest
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void readManifest();
+
+	//------------------------------------------------------------- firstLiveLog
+	// Brief Description
+	//  Returns the number of the oldest log holding writes not yet in a
+	//  segment. The mutex must be held.
+	//
+	// Method:    firstLiveLog
+	// FullName:  lsmStore::firstLiveLog
+	// Access:    private
+	// Returns:   uint64_t
+	//--------------------------------------------------------------------------
+	uint64_t firstLiveLog() const;
+
+	//------------------------------------------------------------- mayHoldRange
+	// Brief Description
+	//  Determines if a segment may hold keys in the range, by its key range
+	//  and, when the range is within one group, by its filter.
+	//
+	// Method:    mayHoldRange
+	// FullName:  lsmStore::mayHoldRange
+	// Access:    private static
+	// Returns:   bool
+	// Parameter: const segmentFile& inSegment
+	// Parameter: const std::string& inFromKey
+	// Parameter: const std::string& inToKey
+	//--------------------------------------------------------------------------
+	static bool mayHoldRange(
+		const segmentFile& inSegment,
+		const std::string& inFromKey,
+		const std::string& inToKey);
+
+	//------------------------------------------------------ segmentStartsBefore
+	// Brief Description
+	//  Orders the segments of a level by their first key.
+	//
+	// Method:    segmentStartsBefore
+	// FullName:  lsmStore::segmentStartsBefore
+	// Access:    private static
+	// Returns:   bool
+	// Parameter: const segmentFile& inFirst
+	// Parameter: const segmentFile& inSecond
+	//--------------------------------------------------------------------------
+	static bool segmentStartsBefore(
+		const segmentFile& inFirst,
+		const segmentFile& inSecond);
+
+	//--------------------------------------------------------------- groupOfKey
+	// Brief Description
+	//  Returns the group of a key, everything up to and including its first
+	//  zero byte, or an empty string if it has none.
+	//
+	// Method:    groupOfKey
+	// FullName:  lsmStore::groupOfKey
+	// Access:    private static
+	// Returns:   std::string
+	// Parameter: const std::string& inKey
+	//--------------------------------------------------------------------------
+	static std::string groupOfKey(
+		const std::string& inKey);
+
+	//----------------------------------------------------------------- filePath
+	// Brief Description
+	//  Returns the path of a file of the store, given its kind and number.
+	//
+	// Method:    filePath
+	// FullName:  lsmStore::filePath
+	// Access:    private
+	// Returns:   std::string
+	// Parameter: const std::string& inKind
+	// Parameter: const uint64_t& inNumber
+	//--------------------------------------------------------------------------
+	std::string filePath(
+		const std::string& inKind,
+		const uint64_t& inNumber) const;
+
+	// Member Variables
+	std::string m_name;
+	taskPool* m_taskPool;
+
+	memoryTable m_memoryTable;
+	size_t m_memoryTableLength;
+	std::vector<char> m_logBuffer;
+	std::ofstream m_log;
+	uint64_t m_logNumber;
+
+	// guarded by m_mutex, the background job changes them
+	boost::mutex m_mutex;
+	std::deque<sealedTable> m_sealedTables;
+	uint64_t m_memoryTableFirstLog;
+	std::vector<std::vector<segmentFile>> m_levels;
+	std::vector<size_t> m_compactionCursors;
+	uint64_t m_nextSegmentNumber;
+	bool m_backgroundBusy;
+};
@@ -0,0 +1,86 @@
+// STL
+#include <iostream>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Project
+#include "messageHistory.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The store recovers whatever an earlier run archived
+//------------------------------------------------------------------------------
+messageHistory::messageHistory(
+	const std::string& inFilePrefix,
+	taskPool& inTaskPool) :
+	m_store(
+		inFilePrefix + constants::historyFileExtension,
+		inTaskPool),
+	m_sequence(0)
+{
+};
+
+//----------------------------------------------------------------------- append
+// Implementation notes:
+//  Keyed by user and time, so a user's history is one range of the store.
+//  The sequence tells apart messages archived in the same millisecond.
+//------------------------------------------------------------------------------
+void messageHistory::append(
+	const std::string& inUser,
+	const dataMessage& inMessage)
+{
+	const std::vector<char> encodedMessage(
+		inMessage.asCharVector());
+
+	this->m_store.put(
+		lsmStore::timeOrderedKey(
+			inUser,
+			messageHistory::currentTimeMilliseconds(),
+			this->m_sequence++),
+		std::string(encodedMessage.begin(), encodedMessage.end()));
+};
+
+//--------------------------------------------------------------- viewMessagesOf
+// Implementation notes:
+//  Sequence 0 is the lowest key of a millisecond, so the range ends right
+//  before the last time
+//------------------------------------------------------------------------------
+std::vector<dataMessage> messageHistory::viewMessagesOf(
+	const std::string& inUser,
+	const int64_t& inFromMilliseconds,
+	const int64_t& inToMilliseconds)
+{
+	std::vector<dataMessage> outMessages;
+
+	for(const lsmStore::record& currentRecord : this->m_store.scan(
+		lsmStore::timeOrderedKey(inUser, inFromMilliseconds, 0),
+		lsmStore::timeOrderedKey(inUser, inToMilliseconds, 0)))
+	{
+		outMessages.push_back(dataMessage(std::vector<char>(
+			currentRecord.value.begin(),
+			currentRecord.value.end())));
+	}
+
+	return outMessages;
+};
+
+//--------------------------------------------------------------------- flushLog
+// Implementation notes:
+//  Passed through to the store
+//------------------------------------------------------------------------------
+void messageHistory::flushLog()
+{
+	this->m_store.flushLog();
+};
+
+//------------------------------------------------------ currentTimeMilliseconds
+// Implementation notes:
+//  system_clock, archive times are kept across runs
+//------------------------------------------------------------------------------
+int64_t messageHistory::currentTimeMilliseconds()
+{
+	return boost::chrono::duration_cast<boost::chrono::milliseconds>(
+		boost::chrono::system_clock::now().time_since_epoch()).count();
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Project
+#include "../Common/dataMessage.h"
+#include "taskPool.h"
+#include "lsmStore.h"
+
+class messageHistory
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the archive of delivered messages, kept in a store
+	//  named after the given prefix.
+	//
+	// Method:    messageHistory
+	// FullName:  messageHistory::messageHistory
+	// Access:    public 
+	// Returns:   
+	// Parameter: const std::string& inFilePrefix
+	// Parameter: taskPool& inTaskPool
+	//--------------------------------------------------------------------------
+	messageHistory(
+		const std::string& inFilePrefix,
+		taskPool& inTaskPool);
+
+	//------------------------------------------------------------------- append
+	// Brief Description
+	//  Archives a message delivered to the given user. Only the state stage
+	//  calls this.
+	//
+	// Method:    append
+	// FullName:  messageHistory::append
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::string& inUser
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void append(
+		const std::string& inUser,
+		const dataMessage& inMessage);
+
+	//----------------------------------------------------------- viewMessagesOf
+	// Brief Description
+	//  Returns the messages archived for the user from the first time up to
+	//  but excluding the last, oldest first.
+	//
+	// Method:    viewMessagesOf
+	// FullName:  messageHistory::viewMessagesOf
+	// Access:    public 
+	// Returns:   std::vector<dataMessage>
+	// Parameter: const std::string& inUser
+	// Parameter: const int64_t& inFromMilliseconds
+	// Parameter: const int64_t& inToMilliseconds
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> viewMessagesOf(
+		const std::string& inUser,
+		const int64_t& inFromMilliseconds,
+		const int64_t& inToMilliseconds);
+
+	//----------------------------------------------------------------- flushLog
+	// Brief Description
+	//  Writes the messages archived since the last flush to the store's log.
+	//
+	// Method:    flushLog
+	// FullName:  messageHistory::flushLog
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushLog();
+
+private:
+
+	//-------------------------------------------------- currentTimeMilliseconds
+	// Brief Description
+	//  Milliseconds since the epoch, the time messages are archived at.
+	//
+	// Method:    currentTimeMilliseconds
+	// FullName:  messageHistory::currentTimeMilliseconds
+	// Access:    private static
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	static int64_t currentTimeMilliseconds();
+
+	// Member Variables
+	lsmStore m_store;
+	uint64_t m_sequence;
+};
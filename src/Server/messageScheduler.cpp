@@ -0,0 +1,256 @@
+// STL
+#include <map>
+#include <limits>
+#include <algorithm>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Project
+#include "messageScheduler.h"
+#include "../Common/constants.h"
+#include "../Common/crc32c.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Each line of the file is either "S <id> <due> <encoded message>" when a
+//  message is scheduled or "F <id>" when it fires, prefixed with its
+//  checksum as in the client outbox. Replaying the lines in order leaves
+//  exactly the waiting messages.
+//------------------------------------------------------------------------------
+messageScheduler::messageScheduler(
+	const std::string& inFilePath) :
+	m_filePath(inFilePath),
+	m_wheel(
+		messageScheduler::tickOfMoment(messageScheduler::currentTimeMilliseconds()),
+		constants::timerWheelLevels),
+	m_nextIdentifier(0),
+	m_firedRecords(0),
+	m_wakeTick(std::numeric_limits<int64_t>::max())
+{
+	std::map<int64_t, timerWheel::entry> waitingEntries;
+
+	std::ifstream existingFile(inFilePath);
+	std::string line;
+	std::string record;
+
+	while(std::getline(existingFile, line))
+	{
+		if(!crc32c::openLine(line, record))
+		{
+			// a torn last record from a crash, nothing after it was written
+			break;
+		}
+
+		if(record.size() < 2)
+		{
+			continue;
+		}
+
+		try
+		{
+			if(record[0] == 'S')
+			{
+				const size_t dueBegin = record.find(' ', 2) + 1;
+				const size_t messageBegin = record.find(' ', dueBegin) + 1;
+
+				if((dueBegin == 0) || (messageBegin == 0))
+				{
+					break;
+				}
+
+				const std::string encodedMessage(
+					record.substr(messageBegin));
+
+				const timerWheel::entry storedEntry = {
+					std::stoll(record.substr(2, dueBegin - 3)),
+					messageScheduler::tickOfMoment(
+						std::stoll(record.substr(dueBegin, messageBegin - dueBegin - 1))),
+					dataMessage(std::vector<char>(encodedMessage.begin(), encodedMessage.end()))};
+
+				waitingEntries.insert(
+					std::make_pair(storedEntry.identifier, storedEntry));
+
+				this->m_nextIdentifier =
+					std::max(this->m_nextIdentifier, storedEntry.identifier + 1);
+			}
+			else if(record[0] == 'F')
+			{
+				waitingEntries.erase(
+					std::stoll(record.substr(2)));
+			}
+		}
+		catch(std::exception& exception)
+		{
+			// intact but unreadable, the records after it cannot be trusted
+			break;
+		}
+	}
+
+	existingFile.close();
+
+	for(const std::pair<const int64_t, timerWheel::entry>& currentEntry : waitingEntries)
+	{
+		this->m_wheel.insert(
+			currentEntry.second);
+	}
+
+	this->rewriteFile();
+};
+
+//--------------------------------------------------------------------- schedule
+// Implementation notes:
+//  Flushed straight away so the message survives the server being closed.
+//  The waiting thread is only woken if it would otherwise sleep past the
+//  new message.
+//------------------------------------------------------------------------------
+void messageScheduler::schedule(
+	const int64_t& inDueMilliseconds,
+	const dataMessage& inMessage)
+{
+	boost::lock_guard<boost::mutex> lock(
+		this->m_mutex);
+
+	const timerWheel::entry newEntry = {
+		this->m_nextIdentifier++,
+		messageScheduler::tickOfMoment(inDueMilliseconds),
+		inMessage};
+
+	this->writeRecord(newEntry);
+	this->m_file.flush();
+
+	this->m_wheel.insert(newEntry);
+
+	if(newEntry.dueTick < this->m_wakeTick)
+	{
+		this->m_condition.notify_one();
+	}
+};
+
+//----------------------------------------------------------- waitForDueMessages
+// Implementation notes:
+//  An event of the wheel can be entries moving down a level without any
+//  firing, so the loop goes around until something does. Once fired
+//  records outnumber the waiting ones the file is compacted.
+//------------------------------------------------------------------------------
+std::vector<dataMessage> messageScheduler::waitForDueMessages()
+{
+	boost::unique_lock<boost::mutex> lock(
+		this->m_mutex);
+
+	while(true)
+	{
+		const int64_t now = messageScheduler::currentTimeMilliseconds();
+
+		const std::vector<timerWheel::entry> dueEntries =
+			this->m_wheel.advance(now / constants::timerWheelTickMilliseconds);
+
+		if(!dueEntries.empty())
+		{
+			this->m_wakeTick = std::numeric_limits<int64_t>::max();
+
+			std::vector<dataMessage> outMessages;
+			outMessages.reserve(dueEntries.size());
+
+			for(const timerWheel::entry& currentEntry : dueEntries)
+			{
+				this->m_file << crc32c::sealLine(
+					"F " + std::to_string(currentEntry.identifier)) << '\n';
+
+				outMessages.push_back(currentEntry.message);
+			}
+
+			this->m_firedRecords += dueEntries.size();
+
+			if(this->m_firedRecords >= std::max<size_t>(
+				constants::scheduleCompactionMinimumRecords,
+				this->m_wheel.size()))
+			{
+				this->rewriteFile();
+			}
+			else
+			{
+				this->m_file.flush();
+			}
+
+			return outMessages;
+		}
+
+		this->m_wakeTick = this->m_wheel.nextEventTick();
+
+		if(this->m_wakeTick == std::numeric_limits<int64_t>::max())
+		{
+			this->m_condition.wait(lock);
+		}
+		else
+		{
+			this->m_condition.wait_for(
+				lock,
+				boost::chrono::milliseconds(
+					this->m_wakeTick * constants::timerWheelTickMilliseconds - now));
+		}
+	}
+};
+
+//------------------------------------------------------ currentTimeMilliseconds
+// Implementation notes:
+//  system_clock, since scheduled times come from clients and the file
+//------------------------------------------------------------------------------
+int64_t messageScheduler::currentTimeMilliseconds()
+{
+	return boost::chrono::duration_cast<boost::chrono::milliseconds>(
+		boost::chrono::system_clock::now().time_since_epoch()).count();
+};
+
+//----------------------------------------------------------------- tickOfMoment
+// Implementation notes:
+//  Rounds up, so a message never fires before its time
+//------------------------------------------------------------------------------
+int64_t messageScheduler::tickOfMoment(
+	const int64_t& inMilliseconds)
+{
+	return (inMilliseconds + constants::timerWheelTickMilliseconds - 1)
+		/ constants::timerWheelTickMilliseconds;
+};
+
+//------------------------------------------------------------------ writeRecord
+// Implementation notes:
+//  The due time is stored in milliseconds so the tick length can change
+//  between runs
+//------------------------------------------------------------------------------
+void messageScheduler::writeRecord(
+	const timerWheel::entry& inEntry)
+{
+	const std::vector<char> encodedMessage(
+		inEntry.message.asCharVector());
+
+	this->m_file << crc32c::sealLine(
+		"S " + std::to_string(inEntry.identifier)
+		+ ' ' + std::to_string(inEntry.dueTick * constants::timerWheelTickMilliseconds)
+		+ ' ' + std::string(encodedMessage.begin(), encodedMessage.end())) << '\n';
+};
+
+//------------------------------------------------------------------ rewriteFile
+// Implementation notes:
+//  Truncates the file and stores every waiting message again
+//------------------------------------------------------------------------------
+void messageScheduler::rewriteFile()
+{
+	if(this->m_file.is_open())
+	{
+		this->m_file.close();
+	}
+
+	this->m_file.open(
+		this->m_filePath,
+		std::ios::out | std::ios::trunc | std::ios::binary);
+
+	for(const timerWheel::entry& currentEntry : this->m_wheel.viewAllEntries())
+	{
+		this->writeRecord(currentEntry);
+	}
+
+	this->m_file.flush();
+
+	this->m_firedRecords = 0;
+};
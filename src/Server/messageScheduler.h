@@ -0,0 +1,123 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+// Boost
+#include <boost/thread.hpp>
+
+// Project
+#include "../Common/dataMessage.h"
+#include "timerWheel.h"
+
+class messageScheduler
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the scheduler of messages to be delivered later.
+	//  Messages left in the file by a previous run are scheduled again, and
+	//  those whose time has passed become due straight away.
+	//
+	// Method:    messageScheduler
+	// FullName:  messageScheduler::messageScheduler
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inFilePath
+	//--------------------------------------------------------------------------
+	messageScheduler(
+		const std::string& inFilePath);
+
+	//----------------------------------------------------------------- schedule
+	// Brief Description
+	//  Stores a message to become due at the given time, in milliseconds
+	//  since the epoch.
+	//
+	// Method:    schedule
+	// FullName:  messageScheduler::schedule
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int64_t& inDueMilliseconds
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void schedule(
+		const int64_t& inDueMilliseconds,
+		const dataMessage& inMessage);
+
+	//------------------------------------------------------- waitForDueMessages
+	// Brief Description
+	//  Blocks until at least one message is due and returns every message
+	//  that is. The caller sleeps until the next message is due, or until
+	//  one is scheduled, and never wakes otherwise.
+	//
+	// Method:    waitForDueMessages
+	// FullName:  messageScheduler::waitForDueMessages
+	// Access:    public
+	// Returns:   std::vector<dataMessage>
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> waitForDueMessages();
+
+	//-------------------------------------------------- currentTimeMilliseconds
+	// Brief Description
+	//  Milliseconds since the epoch, the clock scheduled times refer to.
+	//
+	// Method:    currentTimeMilliseconds
+	// FullName:  messageScheduler::currentTimeMilliseconds
+	// Access:    public static
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	static int64_t currentTimeMilliseconds();
+
+private:
+
+	//------------------------------------------------------------- tickOfMoment
+	// Brief Description
+	//  Returns the first wheel tick at or after the given time.
+	//
+	// Method:    tickOfMoment
+	// FullName:  messageScheduler::tickOfMoment
+	// Access:    private static
+	// Returns:   int64_t
+	// Parameter: const int64_t& inMilliseconds
+	//--------------------------------------------------------------------------
+	static int64_t tickOfMoment(
+		const int64_t& inMilliseconds);
+
+	//-------------------------------------------------------------- writeRecord
+	// Brief Description
+	//  Writes the record storing a scheduled entry, without flushing.
+	//
+	// Method:    writeRecord
+	// FullName:  messageScheduler::writeRecord
+	// Access:    private
+	// Returns:   void
+	// Parameter: const timerWheel::entry& inEntry
+	//--------------------------------------------------------------------------
+	void writeRecord(
+		const timerWheel::entry& inEntry);
+
+	//-------------------------------------------------------------- rewriteFile
+	// Brief Description
+	//  Truncates the file and stores every waiting message again.
+	//
+	// Method:    rewriteFile
+	// FullName:  messageScheduler::rewriteFile
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void rewriteFile();
+
+	// Member Variables
+	std::string m_filePath;
+	std::ofstream m_file;
+	timerWheel m_wheel;
+	int64_t m_nextIdentifier;
+	size_t m_firedRecords;
+	int64_t m_wakeTick;
+	boost::mutex m_mutex;
+	boost::condition_variable m_condition;
+};
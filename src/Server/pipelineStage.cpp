@@ -0,0 +1,97 @@
+// Project
+#include "pipelineStage.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Counters start at zero
+//------------------------------------------------------------------------------
+pipelineStage::pipelineStage(
+	const std::string& inName) :
+	m_name(inName),
+	m_timeCreated(boost::chrono::steady_clock::now()),
+	m_timeWorkBegan(m_timeCreated),
+	m_busyNanoseconds(0),
+	m_items(0),
+	m_batches(0)
+{
+};
+
+//-------------------------------------------------------------------- beginWork
+// Implementation notes:
+//  The start time is only read by the same thread in endWork
+//------------------------------------------------------------------------------
+void pipelineStage::beginWork()
+{
+	this->m_timeWorkBegan = boost::chrono::steady_clock::now();
+};
+
+//---------------------------------------------------------------------- endWork
+// Implementation notes:
+//  Relaxed counters, readers only want a rough current figure
+//------------------------------------------------------------------------------
+void pipelineStage::endWork(
+	const uint64_t& inItems)
+{
+	const int64_t busyNanoseconds =
+		boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+			boost::chrono::steady_clock::now() - this->m_timeWorkBegan).count();
+
+	this->m_busyNanoseconds.fetch_add(busyNanoseconds, std::memory_order_relaxed);
+	this->m_items.fetch_add(inItems, std::memory_order_relaxed);
+	this->m_batches.fetch_add(1, std::memory_order_relaxed);
+};
+
+//--------------------------------------------------------------------- viewName
+// Implementation notes:
+//  Returns a const reference to the name
+//------------------------------------------------------------------------------
+const std::string& pipelineStage::viewName() const
+{
+	return this->m_name;
+};
+
+//-------------------------------------------------------------------- viewItems
+// Implementation notes:
+//  Returns the item count
+//------------------------------------------------------------------------------
+uint64_t pipelineStage::viewItems() const
+{
+	return this->m_items.load(std::memory_order_relaxed);
+};
+
+//------------------------------------------------------------------ viewBatches
+// Implementation notes:
+//  Returns the batch count
+//------------------------------------------------------------------------------
+uint64_t pipelineStage::viewBatches() const
+{
+	return this->m_batches.load(std::memory_order_relaxed);
+};
+
+//---------------------------------------------------------- viewBusyNanoseconds
+// Implementation notes:
+//  Returns the busy time
+//------------------------------------------------------------------------------
+int64_t pipelineStage::viewBusyNanoseconds() const
+{
+	return this->m_busyNanoseconds.load(std::memory_order_relaxed);
+};
+
+//-------------------------------------------------------------- viewUtilization
+// Implementation notes:
+//  Busy time over wall time since construction
+//------------------------------------------------------------------------------
+double pipelineStage::viewUtilization() const
+{
+	const int64_t elapsedNanoseconds =
+		boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+			boost::chrono::steady_clock::now() - this->m_timeCreated).count();
+
+	if(elapsedNanoseconds <= 0)
+	{
+		return 0.0;
+	}
+
+	return static_cast<double>(this->m_busyNanoseconds.load(std::memory_order_relaxed))
+		/ static_cast<double>(elapsedNanoseconds);
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+// STL
+#include <string>
+#include <cstdint>
+#include <atomic>
+
+// Boost
+#include <boost/chrono.hpp>
+
+class pipelineStage
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the statistics of one stage of the server's receive
+	//  pipeline. Utilization is measured from the moment of construction.
+	//
+	// Method:    pipelineStage
+	// FullName:  pipelineStage::pipelineStage
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	pipelineStage(
+		const std::string& inName);
+
+	//---------------------------------------------------------------- beginWork
+	// Brief Description
+	//  Marks the start of a batch of work. Only the stage's own thread calls
+	//  this.
+	//
+	// Method:    beginWork
+	// FullName:  pipelineStage::beginWork
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void beginWork();
+
+	//------------------------------------------------------------------ endWork
+	// Brief Description
+	//  Marks the end of the batch of work started last, which handled the
+	//  given number of items.
+	//
+	// Method:    endWork
+	// FullName:  pipelineStage::endWork
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint64_t& inItems
+	//--------------------------------------------------------------------------
+	void endWork(
+		const uint64_t& inItems);
+
+	//----------------------------------------------------------------- viewName
+	// Brief Description
+	//  Returns a const reference to the name of the stage.
+	//
+	// Method:    viewName
+	// FullName:  pipelineStage::viewName
+	// Access:    public
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewName() const;
+
+	//---------------------------------------------------------------- viewItems
+	// Brief Description
+	//  Returns the number of items the stage has handled.
+	//
+	// Method:    viewItems
+	// FullName:  pipelineStage::viewItems
+	// Access:    public
+	// Returns:   uint64_t
+	//--------------------------------------------------------------------------
+	uint64_t viewItems() const;
+
+	//-------------------------------------------------------------- viewBatches
+	// Brief Description
+	//  Returns the number of batches the stage has handled.
+	//
+	// Method:    viewBatches
+	// FullName:  pipelineStage::viewBatches
+	// Access:    public
+	// Returns:   uint64_t
+	//--------------------------------------------------------------------------
+	uint64_t viewBatches() const;
+
+	//------------------------------------------------------ viewBusyNanoseconds
+	// Brief Description
+	//  Returns the total time the stage has spent working, which can be
+	//  sampled twice to get the utilization over a window.
+	//
+	// Method:    viewBusyNanoseconds
+	// FullName:  pipelineStage::viewBusyNanoseconds
+	// Access:    public
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	int64_t viewBusyNanoseconds() const;
+
+	//---------------------------------------------------------- viewUtilization
+	// Brief Description
+	//  Returns the fraction of time since construction the stage spent
+	//  working rather than waiting for input. A stage close to 1 is the
+	//  bottleneck and should be given more cores.
+	//
+	// Method:    viewUtilization
+	// FullName:  pipelineStage::viewUtilization
+	// Access:    public
+	// Returns:   double
+	//--------------------------------------------------------------------------
+	double viewUtilization() const;
+
+private:
+	// Member Variables
+	std::string m_name;
+	boost::chrono::steady_clock::time_point m_timeCreated;
+	boost::chrono::steady_clock::time_point m_timeWorkBegan;
+	std::atomic<int64_t> m_busyNanoseconds;
+	std::atomic<uint64_t> m_items;
+	std::atomic<uint64_t> m_batches;
+};
@@ -0,0 +1,443 @@
+// STL
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <signal.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <cxxabi.h>
+#include <sys/time.h>
+#include <sys/syscall.h>
+#endif
+
+// Boost
+#include <boost/thread.hpp>
+
+// Project
+#include "sampleProfiler.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The buffers are allocated by start
+//------------------------------------------------------------------------------
+sampleProfiler::sampleProfiler() :
+	m_buffers(nullptr),
+	m_busy(false),
+	m_unbufferedSamples(0),
+	m_hertz(0)
+{
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  The signal handler stays installed, it does nothing without an active
+//  profiler
+//------------------------------------------------------------------------------
+sampleProfiler::~sampleProfiler()
+{
+	this->stop();
+	this->freeBuffers();
+};
+
+//------------------------------------------------------------------------ start
+// Implementation notes:
+//  Stacks are captured with the unwinder behind backtrace, which works
+//  without frame pointers. Its first call loads the unwinder, which is not
+//  safe inside a signal handler, so it is called once here. The handler is
+//  made active only once the buffers exist, and the timer armed last.
+//------------------------------------------------------------------------------
+bool sampleProfiler::start(
+	const uint16_t& inHertz)
+{
+#ifdef __linux__
+	bool wasBusy = false;
+
+	if((inHertz == 0)
+		|| !this->m_busy.compare_exchange_strong(wasBusy, true))
+	{
+		return false;
+	}
+
+	this->m_buffers = new threadBuffer[constants::profilerThreadBuffers];
+
+	for(uint16_t i = 0; i < constants::profilerThreadBuffers; i++)
+	{
+		this->m_buffers[i].threadId.store(0);
+		this->m_buffers[i].words = new uintptr_t[constants::profilerThreadBufferWords];
+		this->m_buffers[i].usedWords = 0;
+		this->m_buffers[i].samples = 0;
+		this->m_buffers[i].droppedSamples = 0;
+	}
+
+	this->m_unbufferedSamples.store(0);
+	this->m_hertz = inHertz;
+
+	void* primingFrame[1];
+	backtrace(primingFrame, 1);
+
+	struct sigaction action;
+	std::memset(&action, 0, sizeof(action));
+	action.sa_handler = &sampleProfiler::handleSignal;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+
+	sampleProfiler* noProfiler = nullptr;
+
+	if((sigaction(SIGPROF, &action, nullptr) != 0)
+		|| !sampleProfiler::activeProfiler().compare_exchange_strong(noProfiler, this))
+	{
+		this->freeBuffers();
+		this->m_busy.store(false);
+		return false;
+	}
+
+	const long intervalMicroseconds = 1000000 / inHertz;
+
+	struct itimerval timer;
+	timer.it_interval.tv_sec = intervalMicroseconds / 1000000;
+	timer.it_interval.tv_usec = intervalMicroseconds % 1000000;
+	timer.it_value = timer.it_interval;
+
+	this->m_timeStarted = boost::chrono::steady_clock::now();
+
+	setitimer(ITIMER_PROF, &timer, nullptr);
+
+	return true;
+#else
+	return false;
+#endif
+};
+
+//------------------------------------------------------------------------- stop
+// Implementation notes:
+//  A handler counts itself running before it looks for the active
+//  profiler, so once the profiler is no longer active and no handler is
+//  running, none can still be writing to the buffers
+//------------------------------------------------------------------------------
+bool sampleProfiler::stop()
+{
+#ifdef __linux__
+	if(sampleProfiler::activeProfiler().load() != this)
+	{
+		return false;
+	}
+
+	struct itimerval timer;
+	std::memset(&timer, 0, sizeof(timer));
+
+	setitimer(ITIMER_PROF, &timer, nullptr);
+
+	sampleProfiler::activeProfiler().store(nullptr);
+
+	while(sampleProfiler::runningHandlers().load() != 0)
+	{
+		boost::this_thread::yield();
+	}
+
+	this->m_timeStopped = boost::chrono::steady_clock::now();
+
+	return true;
+#else
+	return false;
+#endif
+};
+
+//------------------------------------------------------------ writeFoldedStacks
+// Implementation notes:
+//  Every address but the leaf's is a return address, which can already be
+//  past the end of the calling function, so the byte before it is named.
+//  Names are looked up once per address. Lines are sorted by stack, as
+//  flame graph tools expect. The profiler can be started again as soon as
+//  the samples are folded.
+//------------------------------------------------------------------------------
+std::string sampleProfiler::writeFoldedStacks(
+	const std::string& inPath)
+{
+	if((this->m_buffers == nullptr)
+		|| (sampleProfiler::activeProfiler().load() == this))
+	{
+		return "the profiler has no samples to write";
+	}
+
+	std::map<std::string, uint64_t> foldedStacks;
+	std::map<uintptr_t, std::string> frameNames;
+	uint64_t samples = 0;
+	uint64_t droppedSamples = this->m_unbufferedSamples.load();
+	uint16_t threads = 0;
+
+	for(uint16_t i = 0; i < constants::profilerThreadBuffers; i++)
+	{
+		const threadBuffer& currentBuffer = this->m_buffers[i];
+
+		if(currentBuffer.threadId.load() == 0)
+		{
+			continue;
+		}
+
+		threads++;
+		samples += currentBuffer.samples;
+		droppedSamples += currentBuffer.droppedSamples;
+
+		size_t position = 0;
+
+		while(position < currentBuffer.usedWords)
+		{
+			const size_t frames = currentBuffer.words[position];
+			std::string stack;
+
+			for(size_t frame = frames; frame > 0; frame--)
+			{
+				const uintptr_t address = currentBuffer.words[position + frame]
+					- ((frame > 1) ? 1 : 0);
+
+				std::map<uintptr_t, std::string>::iterator name =
+					frameNames.find(address);
+
+				if(name == frameNames.end())
+				{
+					name = frameNames.insert(std::make_pair(
+						address,
+						sampleProfiler::frameName(address))).first;
+				}
+
+				stack += (stack.empty() ? "" : ";") + name->second;
+			}
+
+			foldedStacks[stack]++;
+			position += frames + 1;
+		}
+	}
+
+	const double seconds = boost::chrono::duration<double>(
+		this->m_timeStopped - this->m_timeStarted).count();
+
+	const uint16_t hertz = this->m_hertz;
+
+	this->freeBuffers();
+	this->m_busy.store(false);
+
+	std::ofstream profileFile(inPath, std::ios::trunc);
+
+	for(const std::pair<const std::string, uint64_t>& currentStack : foldedStacks)
+	{
+		profileFile << currentStack.first << " " << currentStack.second << "\n";
+	}
+
+	profileFile.close();
+
+	if(!profileFile)
+	{
+		return "could not write the profile to " + inPath;
+	}
+
+	std::ostringstream summary;
+	summary << "wrote " << samples << " samples of " << threads << " threads over "
+		<< int64_t(seconds) << "s at " << hertz << " Hz, "
+		<< foldedStacks.size() << " distinct stacks, to " << inPath;
+
+	if(droppedSamples > 0)
+	{
+		summary << " (" << droppedSamples << " samples did not fit the buffers)";
+	}
+
+	return summary.str();
+};
+
+//----------------------------------------------------------------- handleSignal
+// Implementation notes:
+//  The stack is captured here rather than in recordSample, which may or
+//  may not be inlined, so the first two frames are always this handler and
+//  the signal trampoline, and the third the instruction the thread was
+//  interrupted at. A handler must leave errno as it found it. The signal
+//  number is always SIGPROF, so it goes unnamed.
+//------------------------------------------------------------------------------
+void sampleProfiler::handleSignal(
+	int)
+{
+	const int savedErrno = errno;
+
+	sampleProfiler::runningHandlers().fetch_add(1);
+
+	sampleProfiler* profiler =
+		sampleProfiler::activeProfiler().load();
+
+#ifdef __linux__
+	if(profiler != nullptr)
+	{
+		const int skippedFrames = 2;
+
+		void* frames[constants::profilerMaximumFrames + skippedFrames];
+
+		const int capturedFrames = backtrace(
+			frames,
+			constants::profilerMaximumFrames + skippedFrames);
+
+		if(capturedFrames > skippedFrames)
+		{
+			profiler->recordSample(
+				frames + skippedFrames,
+				capturedFrames - skippedFrames);
+		}
+	}
+#endif
+
+	sampleProfiler::runningHandlers().fetch_sub(1);
+
+	errno = savedErrno;
+};
+
+//----------------------------------------------------------------- recordSample
+// Implementation notes:
+//  A thread's buffer is found by probing from its thread id, and claimed
+//  with a compare and swap, as two threads can be sampled at once
+//------------------------------------------------------------------------------
+void sampleProfiler::recordSample(
+	void* const* inFrames,
+	const int& inFrameCount)
+{
+#ifdef __linux__
+	const int32_t threadId = static_cast<int32_t>(syscall(SYS_gettid));
+
+	threadBuffer* buffer = nullptr;
+
+	for(uint16_t i = 0; (i < constants::profilerThreadBuffers) && (buffer == nullptr); i++)
+	{
+		threadBuffer& candidate =
+			this->m_buffers[(threadId + i) % constants::profilerThreadBuffers];
+
+		int32_t owner = candidate.threadId.load();
+
+		if((owner == 0)
+			&& candidate.threadId.compare_exchange_strong(owner, threadId))
+		{
+			owner = threadId;
+		}
+
+		if(owner == threadId)
+		{
+			buffer = &candidate;
+		}
+	}
+
+	if(buffer == nullptr)
+	{
+		this->m_unbufferedSamples.fetch_add(1);
+		return;
+	}
+
+	const size_t sampleFrames = inFrameCount;
+
+	if(buffer->usedWords + sampleFrames + 1 > constants::profilerThreadBufferWords)
+	{
+		buffer->droppedSamples++;
+		return;
+	}
+
+	buffer->words[buffer->usedWords] = sampleFrames;
+
+	for(size_t i = 0; i < sampleFrames; i++)
+	{
+		buffer->words[buffer->usedWords + 1 + i] =
+			reinterpret_cast<uintptr_t>(inFrames[i]);
+	}
+
+	buffer->usedWords += sampleFrames + 1;
+	buffer->samples++;
+#endif
+};
+
+//------------------------------------------------------------------ freeBuffers
+// Implementation notes:
+//  Safe to call with no buffers allocated
+//------------------------------------------------------------------------------
+void sampleProfiler::freeBuffers()
+{
+	if(this->m_buffers == nullptr)
+	{
+		return;
+	}
+
+	for(uint16_t i = 0; i < constants::profilerThreadBuffers; i++)
+	{
+		delete[] this->m_buffers[i].words;
+	}
+
+	delete[] this->m_buffers;
+	this->m_buffers = nullptr;
+};
+
+//-------------------------------------------------------------------- frameName
+// Implementation notes:
+//  Functions of the executable itself only have a name if it was linked
+//  with its symbols exported (-rdynamic), otherwise the offset can be
+//  resolved offline with addr2line
+//------------------------------------------------------------------------------
+std::string sampleProfiler::frameName(
+	const uintptr_t& inAddress)
+{
+	std::ostringstream outName;
+
+#ifdef __linux__
+	Dl_info symbol;
+
+	if((dladdr(reinterpret_cast<void*>(inAddress), &symbol) != 0)
+		&& (symbol.dli_fname != nullptr))
+	{
+		if(symbol.dli_sname != nullptr)
+		{
+			int status = 0;
+
+			char* demangledName = abi::__cxa_demangle(
+				symbol.dli_sname, nullptr, nullptr, &status);
+
+			outName << ((status == 0) ? demangledName : symbol.dli_sname);
+
+			std::free(demangledName);
+
+			return outName.str();
+		}
+
+		const std::string fileName(symbol.dli_fname);
+
+		outName << fileName.substr(fileName.find_last_of('/') + 1)
+			<< "+0x" << std::hex
+			<< (inAddress - reinterpret_cast<uintptr_t>(symbol.dli_fbase));
+
+		return outName.str();
+	}
+#endif
+
+	outName << "0x" << std::hex << inAddress;
+
+	return outName.str();
+};
+
+//--------------------------------------------------------------- activeProfiler
+// Implementation notes:
+//  Constant initialized, so reading it from the signal handler needs no
+//  guard
+//------------------------------------------------------------------------------
+std::atomic<sampleProfiler*>& sampleProfiler::activeProfiler()
+{
+	static std::atomic<sampleProfiler*> activeProfiler(nullptr);
+
+	return activeProfiler;
+};
+
+//-------------------------------------------------------------- runningHandlers
+// Implementation notes:
+//  Constant initialized, as activeProfiler
+//------------------------------------------------------------------------------
+std::atomic<int32_t>& sampleProfiler::runningHandlers()
+{
+	static std::atomic<int32_t> runningHandlers(0);
+
+	return runningHandlers;
+};
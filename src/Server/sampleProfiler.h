@@ -0,0 +1,188 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <atomic>
+
+// Boost
+#include <boost/chrono.hpp>
+
+class sampleProfiler
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the in-process sampling profiler. Nothing is
+	//  allocated and no signal is taken until it is started.
+	//
+	// Method:    sampleProfiler
+	// FullName:  sampleProfiler::sampleProfiler
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	sampleProfiler();
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Stops sampling if it still is and frees the buffers.
+	//
+	// Method:    ~sampleProfiler
+	// FullName:  sampleProfiler::~sampleProfiler
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~sampleProfiler();
+
+	//-------------------------------------------------------------------- start
+	// Brief Description
+	//  Allocates the per-thread buffers and starts recording the stack of
+	//  whichever thread is running at the given rate of the process's CPU
+	//  time. Returns false if it is already sampling, its last samples have
+	//  not been written yet, another profiler is sampling this process, or
+	//  the system has no SIGPROF.
+	//
+	// Method:    start
+	// FullName:  sampleProfiler::start
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const uint16_t& inHertz
+	//--------------------------------------------------------------------------
+	bool start(
+		const uint16_t& inHertz);
+
+	//--------------------------------------------------------------------- stop
+	// Brief Description
+	//  Stops sampling and waits for samples being recorded to finish.
+	//  Returns false if it was not sampling. The samples are kept until
+	//  they are written.
+	//
+	// Method:    stop
+	// FullName:  sampleProfiler::stop
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool stop();
+
+	//-------------------------------------------------------- writeFoldedStacks
+	// Brief Description
+	//  Writes the samples of the last run to the given file as folded
+	//  stacks, one line per distinct stack from the root to the leaf with
+	//  the frames separated by semicolons, followed by the number of
+	//  samples. Frees the buffers, so the profiler can be started again,
+	//  and returns a summary of what was written. Takes long enough to
+	//  belong on a worker thread.
+	//
+	// Method:    writeFoldedStacks
+	// FullName:  sampleProfiler::writeFoldedStacks
+	// Access:    public
+	// Returns:   std::string
+	// Parameter: const std::string& inPath
+	//--------------------------------------------------------------------------
+	std::string writeFoldedStacks(
+		const std::string& inPath);
+
+private:
+
+	// Samples recorded on one thread. Only that thread writes to it, from
+	// the signal handler, and the words hold each sample as its number of
+	// frames followed by the frames from the leaf to the root.
+	struct threadBuffer
+	{
+		std::atomic<int32_t> threadId;
+		uintptr_t* words;
+		size_t usedWords;
+		uint64_t samples;
+		uint64_t droppedSamples;
+	};
+
+	//------------------------------------------------------------- handleSignal
+	// Brief Description
+	//  SIGPROF handler. Captures the stack of the interrupted thread and
+	//  records it if a profiler is sampling.
+	//
+	// Method:    handleSignal
+	// FullName:  sampleProfiler::handleSignal
+	// Access:    private static
+	// Returns:   void
+	// Parameter: int inSignal
+	//--------------------------------------------------------------------------
+	static void handleSignal(
+		int inSignal);
+
+	//------------------------------------------------------------- recordSample
+	// Brief Description
+	//  Copies a stack of the calling thread, from the leaf, into its buffer,
+	//  claiming a buffer on the thread's first sample. Only does what is
+	//  safe inside a signal handler.
+	//
+	// Method:    recordSample
+	// FullName:  sampleProfiler::recordSample
+	// Access:    private
+	// Returns:   void
+	// Parameter: void* const* inFrames
+	// Parameter: const int& inFrameCount
+	//--------------------------------------------------------------------------
+	void recordSample(
+		void* const* inFrames,
+		const int& inFrameCount);
+
+	//-------------------------------------------------------------- freeBuffers
+	// Brief Description
+	//  Frees the per-thread buffers.
+	//
+	// Method:    freeBuffers
+	// FullName:  sampleProfiler::freeBuffers
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void freeBuffers();
+
+	//---------------------------------------------------------------- frameName
+	// Brief Description
+	//  Returns the demangled name of the function containing the address,
+	//  or the file it was loaded from and the offset into it if the symbol
+	//  is not exported.
+	//
+	// Method:    frameName
+	// FullName:  sampleProfiler::frameName
+	// Access:    private static
+	// Returns:   std::string
+	// Parameter: const uintptr_t& inAddress
+	//--------------------------------------------------------------------------
+	static std::string frameName(
+		const uintptr_t& inAddress);
+
+	//----------------------------------------------------------- activeProfiler
+	// Brief Description
+	//  Returns the profiler sampling this process, which the signal handler
+	//  records into, or null.
+	//
+	// Method:    activeProfiler
+	// FullName:  sampleProfiler::activeProfiler
+	// Access:    private static
+	// Returns:   std::atomic<sampleProfiler*>&
+	//--------------------------------------------------------------------------
+	static std::atomic<sampleProfiler*>& activeProfiler();
+
+	//---------------------------------------------------------- runningHandlers
+	// Brief Description
+	//  Returns the number of signal handlers running right now, which
+	//  stopping waits to drop to zero.
+	//
+	// Method:    runningHandlers
+	// FullName:  sampleProfiler::runningHandlers
+	// Access:    private static
+	// Returns:   std::atomic<int32_t>&
+	//--------------------------------------------------------------------------
+	static std::atomic<int32_t>& runningHandlers();
+
+	// Member Variables
+	threadBuffer* m_buffers;
+	std::atomic<bool> m_busy;
+	std::atomic<uint64_t> m_unbufferedSamples;
+	uint16_t m_hertz;
+	boost::chrono::steady_clock::time_point m_timeStarted;
+	boost::chrono::steady_clock::time_point m_timeStopped;
+};
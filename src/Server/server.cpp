@@ -1,6 +1,16 @@
 // STL
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <algorithm>
+#include <limits>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <time.h>
+#endif
 
 // Boost
 #include <boost/array.hpp>
@@ -18,7 +28,8 @@
 server::server(
 	const uint16_t& inListeningPort,
 	const int8_t& inServerIndex,
-	boost::asio::io_service& ioService) :
+	boost::asio::io_service& ioService,
+	const uint16_t& inDecodeWorkers) :
 	m_resolver(ioService),
 	m_ioService(&ioService),
 	m_UDPsocket(
@@ -28,10 +39,43 @@ server::server(
 	m_index(inServerIndex),
 	m_terminate(false),
 	m_sequenceNumber(0),
+	m_lastMailboxEntry(0),
+	m_parkedSequenceNumber(0),
 	m_leftAdjacentServerIndex(inServerIndex - 1),
 	m_leftAdjacentServerConnection(nullptr),
 	m_rightAdjacentServerIndex(inServerIndex + 1),
-	m_rightAdjacentServerConnection(nullptr)
+	m_rightAdjacentServerConnection(nullptr),
+	m_multicastSocket(ioService),
+	m_multicastSequenceNumber(0),
+	m_sharedDirectory(nullptr),
+	m_ingressPacketCount(0),
+	m_ingressPacketCountAtLastMeasurement(0),
+	m_timeOfLastLoadMeasurement(boost::chrono::steady_clock::now()),
+	m_decodeWorkers(std::max<uint16_t>(inDecodeWorkers, 1)),
+	m_egressRing(new pipelineRing(constants::pipelineRingCapacity)),
+	m_pendingEgress(nullptr),
+	m_receiveStage(new pipelineStage("receive")),
+	m_stateStage(new pipelineStage("state")),
+	m_egressStage(new pipelineStage("egress")),
+	m_receivedNanoseconds(0),
+	m_dispatchedNanoseconds(0),
+	m_dispatchedType(constants::MessageType::mt_UNDEFINED),
+	m_scheduler(
+		constants::serverIndexToServerName(inServerIndex) + constants::scheduleFileExtension),
+	m_history(
+		constants::serverIndexToServerName(inServerIndex),
+		m_taskPool),
+	m_offlineMailboxes(
+		constants::serverIndexToServerName(inServerIndex) + constants::offlineFileExtension,
+		m_taskPool),
+	m_flightRecorder(
+		constants::serverIndexToServerName(inServerIndex) + constants::flightRecorderFileExtension),
+	m_taskPool(
+		constants::taskPoolWorkers,
+		constants::taskPoolNiceness),
+	m_shardPool(
+		constants::broadcastShardWorkers,
+		0)
 {
 	const std::string serverName(
 		constants::serverIndexToServerName(inServerIndex));
@@ -86,6 +130,133 @@ server::server(
 			constants::serverIndexToServerName(this->m_rightAdjacentServerIndex),
 			rightAdjacentServerEndPoint);
 	}
+
+	for(int8_t i = 0; i < constants::numberOfServers; i++)
+	{
+		this->m_highestMulticastSequenceNumberByServerIndex[i] = 0;
+	}
+
+	// Multicast group setup, every server on the host binds the same port
+	if(constants::multicastSyncEnabled)
+	{
+		const boost::asio::ip::address groupAddress(
+			boost::asio::ip::address::from_string(
+				constants::multicastGroupAddress));
+
+		this->m_multicastGroupEndpoint = boost::asio::ip::udp::endpoint(
+			groupAddress,
+			constants::multicastPort);
+
+		this->m_multicastSocket.open(
+			boost::asio::ip::udp::v4());
+
+		this->m_multicastSocket.set_option(
+			boost::asio::ip::udp::socket::reuse_address(true));
+
+		this->m_multicastSocket.bind(
+			boost::asio::ip::udp::endpoint(
+				boost::asio::ip::udp::v4(),
+				constants::multicastPort));
+
+		// loopback lets servers sharing one host hear each other
+		this->m_multicastSocket.set_option(
+			boost::asio::ip::multicast::enable_loopback(true));
+
+		this->m_multicastSocket.set_option(
+			boost::asio::ip::multicast::join_group(groupAddress));
+
+		std::cout << "Joined multicast group: " << constants::multicastGroupAddress
+			<< ":" << constants::multicastPort << std::endl;
+	}
+
+	// Shared client directory setup, one per host
+	if(constants::sharedDirectoryEnabled)
+	{
+		this->m_sharedDirectory = new sharedClientDirectory(
+			this->m_index);
+
+		std::cout << "Attached to shared client directory: "
+			<< constants::sharedDirectoryName << std::endl;
+	}
+
+#ifdef __linux__
+	// AF_XDP setup, the UDP socket alone serves the port if it fails
+	this->m_xdpSocket = nullptr;
+
+	if(!constants::xdpInterfaceName.empty())
+	{
+		try
+		{
+			this->m_xdpSocket = new xdpSocket(
+				constants::xdpInterfaceName,
+				constants::xdpQueueIndex,
+				inListeningPort);
+
+			std::cout << "Receiving through AF_XDP on: " << constants::xdpInterfaceName
+				<< " queue " << constants::xdpQueueIndex << std::endl;
+		}
+		catch(std::exception& exception)
+		{
+			std::cout << "AF_XDP unavailable, receiving through the UDP socket only: "
+				<< exception.what() << std::endl;
+		}
+	}
+#endif
+
+	// Pipeline setup, a pair of rings and a stage per decode worker
+	for(uint16_t i = 0; i < this->m_decodeWorkers; i++)
+	{
+		this->m_decodeRings.push_back(
+			new pipelineRing(constants::pipelineRingCapacity));
+
+		this->m_stateRings.push_back(
+			new pipelineRing(constants::pipelineRingCapacity));
+
+		this->m_decodeWakeups.push_back(
+			new stageWakeup());
+
+		this->m_decodeStages.push_back(
+			new pipelineStage("decode " + std::to_string(i)));
+	}
+
+	// Latency histograms, and the kernel stamping every datagram with the
+	// time it arrived so the wait in the socket buffer is counted too
+	for(uint16_t i = 0; i < constants::messageTypeCount; i++)
+	{
+		this->m_arrivalToDispatch.push_back(
+			new latencyHistogram());
+
+		this->m_dispatchToSend.push_back(
+			new latencyHistogram());
+	}
+
+#ifdef __linux__
+	const int timestampsEnabled = 1;
+
+	setsockopt(
+		this->m_UDPsocket.native_handle(),
+		SOL_SOCKET,
+		SO_TIMESTAMPNS,
+		&timestampsEnabled,
+		sizeof(timestampsEnabled));
+#endif
+
+	// Messages parked by an earlier run, every key sorts below 0xFF since
+	// usernames are plain ASCII
+	for(const lsmStore::record& currentRecord : this->m_offlineMailboxes.scan(
+		std::string(),
+		std::string(1, '\xFF')))
+	{
+		this->m_messageListOfUnassociatedClients.insert(std::make_pair(
+			currentRecord.key,
+			dataMessage(std::vector<char>(currentRecord.value.begin(), currentRecord.value.end()))));
+	}
+
+	if(!this->m_messageListOfUnassociatedClients.empty())
+	{
+		std::cout << "Restored " << this->m_messageListOfUnassociatedClients.size()
+			<< " parked messages" << std::endl;
+	}
 };
 
 //------------------------------------------------------------------- destructor
@@ -96,8 +267,38 @@ server::~server()
 {
 	delete this->m_leftAdjacentServerConnection;
 	delete this->m_rightAdjacentServerConnection;
+	delete this->m_sharedDirectory;
+
+#ifdef __linux__
+	delete this->m_xdpSocket;
+#endif
+
+	for(uint16_t i = 0; i < this->m_decodeWorkers; i++)
+	{
+		server::deleteRing(this->m_decodeRings[i]);
+		server::deleteRing(this->m_stateRings[i]);
+		delete this->m_decodeWakeups[i];
+		delete this->m_decodeStages[i];
+	}
+
+	server::deleteRing(this->m_egressRing);
+	delete this->m_pendingEgress;
+	delete this->m_receiveStage;
+	delete this->m_stateStage;
+	delete this->m_egressStage;
+
+	for(uint16_t i = 0; i < constants::messageTypeCount; i++)
+	{
+		delete this->m_arrivalToDispatch[i];
+		delete this->m_dispatchToSend[i];
+	}
 
 	this->m_UDPsocket.close();
+
+	if(this->m_multicastSocket.is_open())
+	{
+		this->m_multicastSocket.close();
+	}
 };
 
 //-------------------------------------------------------------------------- run
@@ -107,14 +308,44 @@ server::~server()
 //------------------------------------------------------------------------------
 void server::run()
 {
-	// thread for listening/acting via UDP
+	// UDP pipeline threads, the state stage first so its id is known before
+	// anything can send through it
+	this->m_stateThreadId = this->m_threads.create_thread(
+		boost::bind(&server::stateLoop, this))->get_id();
+
 	this->m_threads.create_thread(
-		boost::bind(&server::listenLoopUDP, this));
+		boost::bind(&server::egressLoop, this));
+
+	for(uint16_t i = 0; i < this->m_decodeWorkers; i++)
+	{
+		this->m_threads.create_thread(
+			boost::bind(&server::decodeLoop, this, i));
+	}
+
+#ifdef __linux__
+	if(this->m_xdpSocket != nullptr)
+	{
+		this->m_threads.create_thread(
+			boost::bind(&server::listenLoopXDP, this));
+	}
+	else
+#endif
+	{
+		this->m_threads.create_thread(
+			boost::bind(&server::listenLoopUDP, this));
+	}
 
 	// thread for listening/acting via Bluetooth
 	this->m_threads.create_thread(
 		boost::bind(&server::listenLoopBluetooth, this));
 
+	// thread for receiving syncs published to the multicast group
+	if(constants::multicastSyncEnabled)
+	{
+		this->m_threads.create_thread(
+			boost::bind(&server::listenLoopMulticast, this));
+	}
+
 	// thread for syncing adjacent servers
 	this->m_threads.create_thread(
 		boost::bind(&server::sendSyncPayloads, this));
@@ -124,598 +355,3869 @@ void server::run()
 	this->m_threads.create_thread(
 		boost::bind(&server::attemptForward, this));
 
+	// thread that hands scheduled messages to the state stage once due
+	this->m_threads.create_thread(
+		boost::bind(&server::scheduleLoop, this));
+
+	// thread that writes the flight recorder's dumps off the pipeline
+	this->m_threads.create_thread(
+		boost::bind(&server::flightRecorderLoop, this));
+
 	this->m_threads.join_all();
 };
 
+//------------------------------------------------------------------------- stop
+// Implementation notes:
+//  Sleeping loops and stages waiting for input are interrupted, and the
+//  loops blocked receiving are sent an empty datagram, which they drop like
+//  any other that does not decode
+//------------------------------------------------------------------------------
+void server::stop()
+{
+	this->m_terminate = true;
+
+	this->m_threads.interrupt_all();
+
+	const std::vector<char> wakeDatagram;
+	boost::system::error_code ignoredError;
+
+	this->m_UDPsocket.send_to(
+		boost::asio::buffer(wakeDatagram),
+		boost::asio::ip::udp::endpoint(
+			boost::asio::ip::address_v4::loopback(),
+			this->m_UDPsocket.local_endpoint(ignoredError).port()),
+		0, ignoredError);
+
+	if(this->m_multicastSocket.is_open())
+	{
+		this->m_multicastSocket.send_to(
+			boost::asio::buffer(wakeDatagram),
+			this->m_multicastGroupEndpoint,
+			0, ignoredError);
+	}
+};
+
+//----------------------------------------------------------- viewPipelineStages
+// Implementation notes:
+//  Stages in the order datagrams pass through them
+//------------------------------------------------------------------------------
+std::vector<const pipelineStage*> server::viewPipelineStages() const
+{
+	std::vector<const pipelineStage*> outStages;
+
+	outStages.push_back(this->m_receiveStage);
+
+	for(const pipelineStage* currentStage : this->m_decodeStages)
+	{
+		outStages.push_back(currentStage);
+	}
+
+	outStages.push_back(this->m_stateStage);
+	outStages.push_back(this->m_egressStage);
+
+	return outStages;
+};
+
+//-------------------------------------------------------- viewLatencyStatistics
+// Implementation notes:
+//  The type names are the ones messages carry on the wire. Types nothing
+//  was received for are left out.
+//------------------------------------------------------------------------------
+std::string server::viewLatencyStatistics() const
+{
+	std::string outStatistics;
+
+	for(uint16_t i = 0; i < constants::messageTypeCount; i++)
+	{
+		if((this->m_arrivalToDispatch[i]->viewCount() == 0)
+			&& (this->m_dispatchToSend[i]->viewCount() == 0))
+		{
+			continue;
+		}
+
+		const dataMessage typeName(
+			0,
+			static_cast<constants::MessageType>(i),
+			"",
+			"",
+			"");
+
+		outStatistics += (outStatistics.empty() ? "" : "\n")
+			+ typeName.viewMessageTypeAsString()
+			+ ": arrival to dispatch " + this->m_arrivalToDispatch[i]->asSummary()
+			+ ", dispatch to send " + this->m_dispatchToSend[i]->asSummary();
+	}
+
+	return outStatistics.empty()
+		? "no messages received yet"
+		: outStatistics;
+};
+
 //------------------------------------------------------------------- listenLoop
 // Implementation notes:
-//  Listen and acts via UDP
+//  Receive stage of the pipeline. Blocks for one datagram, then takes
+//  whatever else is already queued on the socket without blocking, up to a
+//  batch.
 //------------------------------------------------------------------------------
 void server::listenLoopUDP()
 {
+	// reused for every datagram, only the received bytes are copied out
+	std::vector<char> receiveBuffer(constants::maximumDatagramLength);
+
+	std::vector<pipelineBatch*> batchByWorker(this->m_decodeWorkers, nullptr);
+
+	this->m_flightRecorder.nameThread("receive");
+
 	while(!this->m_terminate)
 	{
 		try
 		{
-			const uint16_t arbitraryLength = 256;
+			boost::system::error_code error;
 
-			std::vector<char> receivedPayload(arbitraryLength);
+			boost::asio::ip::udp::endpoint senderEndpoint;
+			int64_t receivedNanoseconds = 0;
 
-			boost::system::error_code error;
+			size_t receivedLength = this->receiveDatagram(
+				receiveBuffer,
+				senderEndpoint,
+				receivedNanoseconds,
+				error);
 
-			boost::asio::ip::udp::endpoint clientEndpoint;
+			this->m_receiveStage->beginWork();
 
-			// receive_from() populates the client endpoint
-			this->m_UDPsocket.receive_from(
-				boost::asio::buffer(receivedPayload),
-				clientEndpoint, 0, error);
+			uint64_t receivedCount = 0;
 
-			if(error && error != boost::asio::error::message_size)
+			while(!error || (error == boost::asio::error::message_size))
 			{
-				throw boost::system::system_error(error);
-			}
+				receivedCount++;
 
-			dataMessage message(
-				receivedPayload);
+				this->batchDatagram(
+					batchByWorker,
+					receiveBuffer,
+					receivedLength,
+					senderEndpoint,
+					receivedNanoseconds,
+					false);
 
-			std::cout << "Received " << message.viewMessageTypeAsString();
-			std::cout << " message from " << message.viewSourceIdentifier();
-
-			switch(message.viewMessageType())
-			{
-				case constants::MessageType::mt_CLIENT_CONNECT:
-				{
-					this->addClientConnection(
-						message.viewSourceIdentifier(),
-						clientEndpoint);
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_DISCONNECT:
-				{
-					this->removeClientConnection(
-						message.viewSourceIdentifier());
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_SEND:
-				{
-					this->processClientSendMessage(
-						message);
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_GET:
-				{
-					this->sendMessagesToClient(
-						message.viewSourceIdentifier());
-					break;
-				}
-				case constants::MessageType::mt_CLIENT_ACK:
-				{
-					this->removeReceivedMessageFromList(
-						message);
-					break;
-				}
-				case constants::MessageType::mt_SERVER_SEND:
-				{
-					this->processServerRelayMessage(
-						message);
-					break;
-				}
-				case constants::MessageType::mt_SERVER_ACK:
+				if((receivedCount == constants::pipelineBatchSize)
+					|| (this->m_UDPsocket.available() == 0))
 				{
-					// #TODO necessary?
 					break;
 				}
-				case constants::MessageType::mt_SERVER_SYNC:
-				{
-					this->receiveClientsFromAdjacentServers(
-						message);
 
-					std::cout << " (Origin: " << constants::serverIndexToServerName(
-						message.viewServerSyncPayloadOriginIndex()) << ")" << std::endl;
-					continue;
-					break;
-				}
-				case constants::MessageType::mt_PING:
-				{
-					// Do nothing
-					break;
-				}
-				default:
-				{
-					assert(false);
-				}
+				receivedLength = this->receiveDatagram(
+					receiveBuffer,
+					senderEndpoint,
+					receivedNanoseconds,
+					error);
 			}
 
-			std::cout << std::endl;
+			this->pushBatches(
+				batchByWorker);
+
+			this->m_receiveStage->endWork(receivedCount);
+		}
+		catch(std::exception& exception)
+		{
+			this->m_flightRecorder.trigger(
+				flightRecorder::tr_EXCEPTION,
+				0,
+				std::string("exception in the receive loop: ") + exception.what(),
+				server::realtimeNanoseconds());
 		}
 		catch(...)
 		{
-
+			this->m_flightRecorder.trigger(
+				flightRecorder::tr_EXCEPTION,
+				0,
+				"unknown exception in the receive loop",
+				server::realtimeNanoseconds());
 		}
 	}
 };
 
-//---------------------------------------------------------- sendMessageToClient
+#ifdef __linux__
+//---------------------------------------------------------------- listenLoopXDP
 // Implementation notes:
-//  Sends all messages destined for the client who sent the get request
+//  Waits for either socket, or the poll interval so termination is seen,
+//  then takes a batch from the AF_XDP socket before the UDP socket. The UDP
+//  socket is read once whenever it polls readable, as an empty datagram
+//  leaves nothing available, and then while anything is.
 //------------------------------------------------------------------------------
-void server::sendMessagesToClient(
-	const std::string& inClientIdentifier)
+void server::listenLoopXDP()
 {
-	boost::system::error_code ignoredError;
+	std::vector<char> receiveBuffer(constants::maximumDatagramLength);
+
+	std::vector<pipelineBatch*> batchByWorker(this->m_decodeWorkers, nullptr);
 
-	for(const remoteConnection& targetClient : this->m_connectedClients)
+	this->m_flightRecorder.nameThread("receive");
+
+	while(!this->m_terminate)
 	{
-		if(targetClient.viewIdentifier() == inClientIdentifier)
+		try
 		{
-			for(const dataMessage& currentMessage : this->m_messageList)
+			pollfd descriptors[2];
+			descriptors[0].fd = this->m_xdpSocket->viewDescriptor();
+			descriptors[0].events = POLLIN;
+			descriptors[1].fd = this->m_UDPsocket.native_handle();
+			descriptors[1].events = POLLIN;
+
+			if(poll(descriptors, 2, constants::xdpPollMilliseconds) <= 0)
 			{
-				if(currentMessage.viewDestinationIdentifier() == inClientIdentifier)
-				{
-					try
-					{
-						this->m_UDPsocket.send_to(
-							boost::asio::buffer(currentMessage.asCharVector()),
-							targetClient.viewEndpoint(), 0, ignoredError);
-					}
-					catch(std::exception& exception)
-					{
-						// std::cout << exception.what() << std::endl;
-					}
-				}
-				else
+				continue;
+			}
+
+			this->m_receiveStage->beginWork();
+
+			uint64_t receivedCount = 0;
+			size_t receivedLength = 0;
+			boost::asio::ip::udp::endpoint senderEndpoint;
+
+			while((receivedCount < constants::pipelineBatchSize)
+				&& this->m_xdpSocket->receive(receiveBuffer, receivedLength, senderEndpoint))
+			{
+				receivedCount++;
+
+				this->batchDatagram(
+					batchByWorker,
+					receiveBuffer,
+					receivedLength,
+					senderEndpoint,
+					server::realtimeNanoseconds(),
+					true);
+			}
+
+			bool socketIsReadable = ((descriptors[1].revents & POLLIN) != 0);
+
+			while(socketIsReadable && (receivedCount < constants::pipelineBatchSize))
+			{
+				boost::system::error_code error;
+				int64_t receivedNanoseconds = 0;
+
+				receivedLength = this->receiveDatagram(
+					receiveBuffer,
+					senderEndpoint,
+					receivedNanoseconds,
+					error);
+
+				if(!error || (error == boost::asio::error::message_size))
 				{
-					// Do nothing, message is not destined for the 
-					// client that issued the get
+					receivedCount++;
+
+					this->batchDatagram(
+						batchByWorker,
+						receiveBuffer,
+						receivedLength,
+						senderEndpoint,
+						receivedNanoseconds,
+						false);
 				}
+
+				socketIsReadable = (this->m_UDPsocket.available() > 0);
 			}
 
-			break;
+			this->pushBatches(
+				batchByWorker);
+
+			this->m_receiveStage->endWork(receivedCount);
 		}
-		else
+		catch(std::exception& exception)
+		{
+			this->m_flightRecorder.trigger(
+				flightRecorder::tr_EXCEPTION,
+				0,
+				std::string("exception in the receive loop: ") + exception.what(),
+				server::realtimeNanoseconds());
+		}
+		catch(...)
 		{
-			// Do nothing, target client is not the one we want
+			this->m_flightRecorder.trigger(
+				flightRecorder::tr_EXCEPTION,
+				0,
+				"unknown exception in the receive loop",
+				server::realtimeNanoseconds());
 		}
 	}
 };
+#endif
 
-//------------------------------------------------ removeReceivedMessageFromList
+//---------------------------------------------------------------- batchDatagram
 // Implementation notes:
-//  Removes the message the client confirmed to have received from the list
+//  Datagrams are spread over the decode workers by sender, so the messages
+//  of one sender still reach the state stage in order. Only the received
+//  bytes are copied out of the buffer.
 //------------------------------------------------------------------------------
-void server::removeReceivedMessageFromList(
-	const dataMessage& inMessage)
+void server::batchDatagram(
+	std::vector<pipelineBatch*>& ioBatchByWorker,
+	const std::vector<char>& inBuffer,
+	const size_t& inLength,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint,
+	const int64_t& inReceivedNanoseconds,
+	const bool& inBypassedKernel)
 {
-	for(std::list<dataMessage>::iterator it = this->m_messageList.begin();
-		it != this->m_messageList.end();
-		it++)
+	this->m_ingressPacketCount++;
+
+	pipelineBatch*& batch = ioBatchByWorker[
+		server::decodeWorkerForEndpoint(inSenderEndpoint, this->m_decodeWorkers)];
+
+	if(batch == nullptr)
 	{
-		if(it->viewSequenceNumber() == inMessage.viewSequenceNumber())
-		{
-			this->m_messageList.erase(it);
-			break;
-		}
-		else
-		{
-			continue;
-		}
+		batch = new pipelineBatch();
+		batch->reserve(constants::pipelineBatchSize);
 	}
+
+	batch->push_back(pipelineDatagram());
+	batch->back().payload.assign(
+		inBuffer.begin(),
+		inBuffer.begin() + inLength);
+	batch->back().endpoint = inSenderEndpoint;
+	batch->back().receivedNanoseconds = inReceivedNanoseconds;
+	batch->back().bypassedKernel = inBypassedKernel;
+
+	this->m_flightRecorder.record(
+		flightRecorder::ek_PACKET_IN,
+		constants::MessageType::mt_UNDEFINED,
+		static_cast<uint32_t>(inLength),
+		flightRecorder::endpointDetail(inSenderEndpoint),
+		inReceivedNanoseconds);
 };
 
-//----------------------------------------------------- processClientSendMessage
+//------------------------------------------------------------------ pushBatches
 // Implementation notes:
-//  Determines if the message the client sent should be kept on this server
-//  or if it should be forwarded to another server
+//  The batches are left empty for the next round
 //------------------------------------------------------------------------------
-void server::processClientSendMessage(
-	const dataMessage& inMessage)
+void server::pushBatches(
+	std::vector<pipelineBatch*>& ioBatchByWorker)
 {
-	const std::string destinationID(
-		inMessage.viewDestinationIdentifier());
-
-	// check this server's client list first
-	for(const remoteConnection& currentClient : this->m_connectedClients)
+	for(uint16_t i = 0; i < this->m_decodeWorkers; i++)
 	{
-		if(currentClient.viewIdentifier() == destinationID)
+		if(ioBatchByWorker[i] != nullptr)
 		{
-			// destination client was found on this server, stop searching
-			// and add to the message list of this server
-			this->addToMessageList(
-				inMessage);
+			const size_t depth = server::pushToRing(
+				*this->m_decodeRings[i],
+				ioBatchByWorker[i],
+				*this->m_decodeWakeups[i]);
 
-			return;
-		}
-		else
-		{
-			// client does not match, continue searching
-			continue;
+			ioBatchByWorker[i] = nullptr;
+
+			this->m_flightRecorder.recordQueueDepth(
+				flightRecorder::qk_DECODE,
+				i,
+				depth,
+				server::realtimeNanoseconds());
 		}
 	}
+};
 
-	// check clients on servers to the left
-	for(int8_t serverIndex = 0;
-		serverIndex < this->m_index;
-		serverIndex++)
+//-------------------------------------------------------------- receiveDatagram
+// Implementation notes:
+//  On Linux the datagram is read with recvmsg, which also returns the
+//  kernel's receive timestamp. A read interrupted by a signal, such as the
+//  profiler's, is retried. Elsewhere the time it was read stands in for
+//  the time it arrived, which leaves the wait in the socket buffer out.
+//------------------------------------------------------------------------------
+size_t server::receiveDatagram(
+	std::vector<char>& outBuffer,
+	boost::asio::ip::udp::endpoint& outSenderEndpoint,
+	int64_t& outReceivedNanoseconds,
+	boost::system::error_code& outError)
+{
+#ifdef __linux__
+	iovec buffer;
+	buffer.iov_base = outBuffer.data();
+	buffer.iov_len = outBuffer.size();
+
+	char control[CMSG_SPACE(sizeof(timespec))];
+
+	msghdr header;
+	std::memset(&header, 0, sizeof(header));
+	header.msg_name = outSenderEndpoint.data();
+	header.msg_iov = &buffer;
+	header.msg_iovlen = 1;
+	header.msg_control = control;
+
+	ssize_t receivedLength = -1;
+
+	do
 	{
-		for(size_t i = 0;
-			i < this->m_clientsServedByServerIndex[serverIndex].size();
-			i++)
-		{
-			if(this->m_clientsServedByServerIndex[serverIndex][i] == destinationID)
-			{
+		header.msg_namelen = outSenderEndpoint.capacity();
+		header.msg_controllen = sizeof(control);
 
-				if(this->m_leftAdjacentServerConnection != nullptr)
-				{
-					try
-					{
-						boost::system::error_code ignoredError;
-
-						this->m_UDPsocket.send_to(
-							boost::asio::buffer(inMessage.asCharVector()),
-							this->m_leftAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
-
-					}
-					catch(std::exception& exception)
-					{
-						// std::cout << exception.what() << std::endl;
-					}
-				}
-				else
-				{
-					// programming error, should never make it here
-					assert(false);
-				}
+		receivedLength = recvmsg(
+			this->m_UDPsocket.native_handle(),
+			&header,
+			0);
+	} while((receivedLength < 0) && (errno == EINTR));
 
-				return;
-			}
-			else
-			{
-				// client does not match, continue searching
-				continue;
-			}
-		}
+	if(receivedLength < 0)
+	{
+		outError = boost::system::error_code(
+			errno,
+			boost::system::system_category());
+		return 0;
 	}
 
-	// check clients on servers to the right
-	for(int8_t serverIndex = constants::highestServerIndex;
-		serverIndex > this->m_index;
-		serverIndex--)
+	outError = boost::system::error_code();
+	outSenderEndpoint.resize(header.msg_namelen);
+	outReceivedNanoseconds = 0;
+
+	for(cmsghdr* message = CMSG_FIRSTHDR(&header);
+		message != nullptr;
+		message = CMSG_NXTHDR(&header, message))
 	{
-		for(size_t i = 0;
-			i < this->m_clientsServedByServerIndex[serverIndex].size();
-			i++)
+		if((message->cmsg_level == SOL_SOCKET)
+			&& (message->cmsg_type == SCM_TIMESTAMPNS))
 		{
-			if(this->m_clientsServedByServerIndex[serverIndex][i] == destinationID)
-			{
-
-				if(this->m_rightAdjacentServerConnection != nullptr)
-				{
-					try
-					{
-						boost::system::error_code ignoredError;
-
-						this->m_UDPsocket.send_to(
-							boost::asio::buffer(inMessage.asCharVector()),
-							this->m_rightAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
-
-					}
-					catch(std::exception& exception)
-					{
-						// std::cout << exception.what() << std::endl;
-					}
-				}
-				else
-				{
-					// programming error, should never make it here
-					assert(false);
-				}
+			timespec timestamp;
+			std::memcpy(&timestamp, CMSG_DATA(message), sizeof(timestamp));
 
-				return;
-			}
-			else
-			{
-				// client does not match, continue searching
-				continue;
-			}
+			outReceivedNanoseconds =
+				int64_t(timestamp.tv_sec) * 1000000000 + timestamp.tv_nsec;
 		}
 	}
 
-	// if we make it here, as per the requirements, we hold on to the message
-	this->addToMessageListOfUnassociatedClients(
-		inMessage);
-};
+	if(outReceivedNanoseconds == 0)
+	{
+		outReceivedNanoseconds = server::realtimeNanoseconds();
+	}
+
+	return static_cast<size_t>(receivedLength);
+#else
+	const size_t receivedLength = this->m_UDPsocket.receive_from(
+		boost::asio::buffer(outBuffer),
+		outSenderEndpoint, 0, outError);
+
+	outReceivedNanoseconds = server::realtimeNanoseconds();
+
+	return receivedLength;
+#endif
+};
+
+//---------------------------------------------------------- realtimeNanoseconds
+// Implementation notes:
+//  Kernel timestamps are on the realtime clock, so dispatch and send times
+//  are too
+//------------------------------------------------------------------------------
+int64_t server::realtimeNanoseconds()
+{
+#ifdef __linux__
+	timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+
+	return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+	return boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+		boost::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+};
+
+//------------------------------------------------------------------- decodeLoop
+// Implementation notes:
+//  Decode stage of the pipeline. Parsing is the only work here that needs
+//  no server state, so it is the part spread over several cores. A
+//  malformed datagram is left without messages and ignored downstream.
+//------------------------------------------------------------------------------
+void server::decodeLoop(
+	const uint16_t& inWorkerIndex)
+{
+	pipelineRing& inputRing = *this->m_decodeRings[inWorkerIndex];
+	pipelineRing& outputRing = *this->m_stateRings[inWorkerIndex];
+	pipelineStage& stage = *this->m_decodeStages[inWorkerIndex];
+	stageWakeup& wakeup = *this->m_decodeWakeups[inWorkerIndex];
+
+	const std::vector<pipelineRing*> inputRings(
+		1,
+		&inputRing);
+
+	this->m_flightRecorder.nameThread(
+		"decode " + std::to_string(inWorkerIndex));
+
+	while(!this->m_terminate)
+	{
+		pipelineBatch* batch = nullptr;
+
+		if(!inputRing.pop(batch))
+		{
+			this->waitForInput(
+				wakeup,
+				inputRings,
+				false);
+			continue;
+		}
+
+		stage.beginWork();
+
+		for(pipelineDatagram& currentDatagram : *batch)
+		{
+			try
+			{
+				if(dataMessage::isCompressedBatch(currentDatagram.payload))
+				{
+					currentDatagram.messages =
+						dataMessage::parseCompressedBatch(currentDatagram.payload);
+
+					currentDatagram.handoff = true;
+				}
+				else if(dataMessage::isBatch(currentDatagram.payload))
+				{
+					currentDatagram.messages =
+						dataMessage::parseBatch(currentDatagram.payload);
+				}
+				else
+				{
+					currentDatagram.messages.push_back(
+						dataMessage(currentDatagram.payload));
+				}
+			}
+			catch(...)
+			{
+				currentDatagram.messages.clear();
+			}
+
+			if(currentDatagram.bypassedKernel)
+			{
+				// admin commands trust a loopback source, which only the
+				// kernel's checks make trustworthy
+				currentDatagram.messages.erase(
+					std::remove_if(
+						currentDatagram.messages.begin(),
+						currentDatagram.messages.end(),
+						server::isAdminMessage),
+					currentDatagram.messages.end());
+			}
+
+			currentDatagram.payload.clear();
+		}
+
+		stage.endWork(batch->size());
+
+		const size_t depth = server::pushToRing(
+			outputRing,
+			batch,
+			this->m_stateWakeup);
+
+		this->m_flightRecorder.recordQueueDepth(
+			flightRecorder::qk_STATE,
+			inWorkerIndex,
+			depth,
+			server::realtimeNanoseconds());
+	}
+};
+
+//-------------------------------------------------------------------- stateLoop
+// Implementation notes:
+//  State stage of the pipeline, the only pipeline thread that touches the
+//  sessions and mailboxes. Takes a batch from each decode worker in turn,
+//  and hands everything it sent while handling the batch to the egress
+//  stage as one batch. Completions of offloaded tasks run between batches.
+//------------------------------------------------------------------------------
+void server::stateLoop()
+{
+	uint16_t nextWorkerIndex = 0;
+
+	this->m_flightRecorder.nameThread("state");
+
+	while(!this->m_terminate)
+	{
+		const size_t completionCount = this->runCompletions();
+
+		if((completionCount > 0) && (this->m_pendingEgress != nullptr))
+		{
+			const size_t depth = server::pushToRing(
+				*this->m_egressRing,
+				this->m_pendingEgress,
+				this->m_egressWakeup);
+
+			this->m_pendingEgress = nullptr;
+
+			this->m_flightRecorder.recordQueueDepth(
+				flightRecorder::qk_EGRESS,
+				0,
+				depth,
+				server::realtimeNanoseconds());
+		}
+
+		pipelineBatch* batch = nullptr;
+
+		for(uint16_t i = 0; (i < this->m_decodeWorkers) && (batch == nullptr); i++)
+		{
+			this->m_stateRings[nextWorkerIndex]->pop(batch);
+
+			nextWorkerIndex = (nextWorkerIndex + 1) % this->m_decodeWorkers;
+		}
+
+		if(batch == nullptr)
+		{
+			this->waitForInput(
+				this->m_stateWakeup,
+				this->m_stateRings,
+				true);
+			continue;
+		}
+
+		this->m_stateStage->beginWork();
+
+		uint64_t messageCount = 0;
+
+		for(const pipelineDatagram& currentDatagram : *batch)
+		{
+			if(currentDatagram.messages.empty())
+			{
+				// Do nothing, the datagram did not decode
+				continue;
+			}
+
+			this->m_receivedNanoseconds = currentDatagram.receivedNanoseconds;
+
+			try
+			{
+				if(currentDatagram.handoff)
+				{
+					this->receiveHandoff(
+						currentDatagram.messages,
+						currentDatagram.endpoint);
+				}
+				else
+				{
+					this->dispatchDatagram(
+						currentDatagram.messages,
+						currentDatagram.endpoint);
+				}
+			}
+			catch(...)
+			{
+
+			}
+
+			// replies sent between datagrams answer no message
+			this->m_receivedNanoseconds = 0;
+			this->m_dispatchedNanoseconds = 0;
+			this->m_dispatchedType = constants::MessageType::mt_UNDEFINED;
+
+			messageCount += currentDatagram.messages.size();
+		}
+
+		delete batch;
+
+		if(this->m_pendingEgress != nullptr)
+		{
+			const size_t depth = server::pushToRing(
+				*this->m_egressRing,
+				this->m_pendingEgress,
+				this->m_egressWakeup);
+
+			this->m_pendingEgress = nullptr;
+
+			this->m_flightRecorder.recordQueueDepth(
+				flightRecorder::qk_EGRESS,
+				0,
+				depth,
+				server::realtimeNanoseconds());
+		}
+
+		this->m_stateStage->endWork(messageCount);
+	}
+};
+
+//------------------------------------------------------------------- egressLoop
+// Implementation notes:
+//  Egress stage of the pipeline, sends the replies of each state batch
+//------------------------------------------------------------------------------
+void server::egressLoop()
+{
+	this->m_flightRecorder.nameThread("egress");
+
+	const std::vector<pipelineRing*> inputRings(
+		1,
+		this->m_egressRing);
+
+	while(!this->m_terminate)
+	{
+		pipelineBatch* batch = nullptr;
+
+		if(!this->m_egressRing->pop(batch))
+		{
+			this->waitForInput(
+				this->m_egressWakeup,
+				inputRings,
+				false);
+			continue;
+		}
+
+		this->m_egressStage->beginWork();
+
+		this->sendBatch(*batch);
+
+		const int64_t sentNanoseconds = server::realtimeNanoseconds();
+
+		for(const pipelineDatagram& currentDatagram : *batch)
+		{
+			if(currentDatagram.dispatchedNanoseconds != 0)
+			{
+				this->m_dispatchToSend[currentDatagram.dispatchedType]->record(
+					sentNanoseconds - currentDatagram.dispatchedNanoseconds);
+			}
+
+			this->m_flightRecorder.record(
+				flightRecorder::ek_PACKET_OUT,
+				currentDatagram.dispatchedType,
+				static_cast<uint32_t>(currentDatagram.payload.size()),
+				flightRecorder::endpointDetail(currentDatagram.endpoint),
+				sentNanoseconds);
+		}
+
+		this->m_egressStage->endWork(batch->size());
+
+		delete batch;
+	}
+};
+
+//-------------------------------------------------------------------- sendBatch
+// Implementation notes:
+//  On Linux the whole batch goes out in as few sendmmsg calls as the kernel
+//  allows, less what the AF_XDP socket takes
+//------------------------------------------------------------------------------
+void server::sendBatch(
+	const pipelineBatch& inBatch)
+{
+#ifdef __linux__
+	std::vector<mmsghdr> headers;
+	std::vector<iovec> buffers(inBatch.size());
+
+	headers.reserve(inBatch.size());
+
+	for(size_t i = 0; i < inBatch.size(); i++)
+	{
+		if((this->m_xdpSocket != nullptr)
+			&& this->m_xdpSocket->send(inBatch[i].payload, inBatch[i].endpoint))
+		{
+			continue;
+		}
+
+		buffers[i].iov_base = const_cast<char*>(inBatch[i].payload.data());
+		buffers[i].iov_len = inBatch[i].payload.size();
+
+		headers.push_back(mmsghdr());
+		std::memset(&headers.back(), 0, sizeof(mmsghdr));
+		headers.back().msg_hdr.msg_name = const_cast<sockaddr*>(inBatch[i].endpoint.data());
+		headers.back().msg_hdr.msg_namelen = inBatch[i].endpoint.size();
+		headers.back().msg_hdr.msg_iov = &buffers[i];
+		headers.back().msg_hdr.msg_iovlen = 1;
+	}
+
+	if(this->m_xdpSocket != nullptr)
+	{
+		this->m_xdpSocket->flush();
+	}
+
+	this->sendHeaders(
+		headers);
+#else
+	for(const pipelineDatagram& currentDatagram : inBatch)
+	{
+		boost::system::error_code ignoredError;
+
+		this->m_UDPsocket.send_to(
+			boost::asio::buffer(currentDatagram.payload),
+			currentDatagram.endpoint, 0, ignoredError);
+	}
+#endif
+};
+
+//-------------------------------------------------------------- sendToEndpoints
+// Implementation notes:
+//  Every header points at the same buffer, so the payload is never copied
+//------------------------------------------------------------------------------
+void server::sendToEndpoints(
+	const std::vector<char>& inDatagram,
+	const std::vector<boost::asio::ip::udp::endpoint>& inDestinations)
+{
+#ifdef __linux__
+	std::vector<mmsghdr> headers(inDestinations.size());
+
+	iovec buffer;
+	buffer.iov_base = const_cast<char*>(inDatagram.data());
+	buffer.iov_len = inDatagram.size();
+
+	for(size_t i = 0; i < inDestinations.size(); i++)
+	{
+		std::memset(&headers[i], 0, sizeof(mmsghdr));
+		headers[i].msg_hdr.msg_name = const_cast<sockaddr*>(inDestinations[i].data());
+		headers[i].msg_hdr.msg_namelen = inDestinations[i].size();
+		headers[i].msg_hdr.msg_iov = &buffer;
+		headers[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	this->sendHeaders(
+		headers);
+#else
+	for(const boost::asio::ip::udp::endpoint& currentDestination : inDestinations)
+	{
+		boost::system::error_code ignoredError;
+
+		this->m_UDPsocket.send_to(
+			boost::asio::buffer(inDatagram),
+			currentDestination, 0, ignoredError);
+	}
+#endif
+};
+
+#ifdef __linux__
+//------------------------------------------------------------------ sendHeaders
+// Implementation notes:
+//  sendmmsg may send fewer datagrams than asked, so it is called until all
+//  are out. A datagram the kernel refuses is skipped, the same as an ignored
+//  send_to error elsewhere.
+//------------------------------------------------------------------------------
+void server::sendHeaders(
+	std::vector<mmsghdr>& ioHeaders)
+{
+	size_t sentCount = 0;
+
+	while(sentCount < ioHeaders.size())
+	{
+		const int result = sendmmsg(
+			this->m_UDPsocket.native_handle(),
+			&ioHeaders[sentCount],
+			ioHeaders.size() - sentCount,
+			0);
+
+		sentCount += (result > 0) ? result : 1;
+	}
+};
+#endif
+
+//----------------------------------------------------------------- sendDatagram
+// Implementation notes:
+//  Sends from the state stage are batched for the egress stage, with the
+//  dispatch they answer, sends from any other thread go straight out
+//------------------------------------------------------------------------------
+void server::sendDatagram(
+	const std::vector<char>& inDatagram,
+	const boost::asio::ip::udp::endpoint& inDestination)
+{
+	if(boost::this_thread::get_id() != this->m_stateThreadId)
+	{
+		boost::system::error_code ignoredError;
+
+		this->m_UDPsocket.send_to(
+			boost::asio::buffer(inDatagram),
+			inDestination, 0, ignoredError);
+
+		this->m_flightRecorder.record(
+			flightRecorder::ek_PACKET_OUT,
+			constants::MessageType::mt_UNDEFINED,
+			static_cast<uint32_t>(inDatagram.size()),
+			flightRecorder::endpointDetail(inDestination),
+			server::realtimeNanoseconds());
+		return;
+	}
+
+	if(this->m_pendingEgress == nullptr)
+	{
+		this->m_pendingEgress = new pipelineBatch();
+	}
+
+	this->m_pendingEgress->push_back(pipelineDatagram());
+	this->m_pendingEgress->back().payload = inDatagram;
+	this->m_pendingEgress->back().endpoint = inDestination;
+	this->m_pendingEgress->back().dispatchedNanoseconds = this->m_dispatchedNanoseconds;
+	this->m_pendingEgress->back().dispatchedType = this->m_dispatchedType;
+};
+
+//------------------------------------------------------------------- pushToRing
+// Implementation notes:
+//  A full ring means the next stage is behind, so the producer waits for it
+//  rather than dropping work that was already received. Only the producer
+//  may ask how much room is left, which is the depth seen from the other
+//  side.
+//------------------------------------------------------------------------------
+size_t server::pushToRing(
+	pipelineRing& inRing,
+	pipelineBatch* inBatch,
+	stageWakeup& ioWakeup)
+{
+	while(!inRing.push(inBatch))
+	{
+		boost::this_thread::yield();
+	}
+
+	server::wakeStage(
+		ioWakeup);
+
+	return constants::pipelineRingCapacity - inRing.write_available();
+};
+
+//-------------------------------------------------------------------- wakeStage
+// Implementation notes:
+//  The fence pairs with the one in waitForInput: either the stage sees what
+//  was just added when it looks a last time, or this sees it marked
+//  sleeping. The lock keeps the notification from landing between its
+//  last look and its wait. A busy stage costs a fence and a load.
+//------------------------------------------------------------------------------
+void server::wakeStage(
+	stageWakeup& ioWakeup)
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if(ioWakeup.sleeping.load(std::memory_order_relaxed))
+	{
+		boost::mutex::scoped_lock lock(ioWakeup.mutex);
+
+		ioWakeup.condition.notify_one();
+	}
+};
+
+//----------------------------------------------------------------- waitForInput
+// Implementation notes:
+//  Input usually follows closely under load, so the stage yields for the
+//  spin window before it pays for sleeping and being woken. The wait is an
+//  interruption point, so stop wakes it like it did the old sleep.
+//------------------------------------------------------------------------------
+void server::waitForInput(
+	stageWakeup& ioWakeup,
+	const std::vector<pipelineRing*>& inRings,
+	const bool& inWithCompletions)
+{
+	const boost::chrono::steady_clock::time_point spinDeadline =
+		boost::chrono::steady_clock::now()
+		+ boost::chrono::microseconds(constants::pipelineIdleSpinMicroseconds);
+
+	while(boost::chrono::steady_clock::now() < spinDeadline)
+	{
+		if(this->m_terminate || this->hasInput(inRings, inWithCompletions))
+		{
+			return;
+		}
+
+		boost::this_thread::yield();
+	}
+
+	boost::mutex::scoped_lock lock(ioWakeup.mutex);
+
+	ioWakeup.sleeping.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	while(!this->m_terminate && !this->hasInput(inRings, inWithCompletions))
+	{
+		ioWakeup.condition.wait(lock);
+	}
+
+	ioWakeup.sleeping.store(false, std::memory_order_relaxed);
+};
+
+//--------------------------------------------------------------------- hasInput
+// Implementation notes:
+//  Only the consumer of the rings calls this
+//------------------------------------------------------------------------------
+bool server::hasInput(
+	const std::vector<pipelineRing*>& inRings,
+	const bool& inWithCompletions)
+{
+	for(pipelineRing* currentRing : inRings)
+	{
+		if(currentRing->read_available() > 0)
+		{
+			return true;
+		}
+	}
+
+	if(inWithCompletions)
+	{
+		boost::mutex::scoped_lock lock(this->m_completionMutex);
+
+		return !this->m_completions.empty();
+	}
+
+	return false;
+};
+
+//------------------------------------------------------------------- deleteRing
+// Implementation notes:
+//  Deletes the ring along with any batches still in it
+//------------------------------------------------------------------------------
+void server::deleteRing(
+	pipelineRing* inRing)
+{
+	pipelineBatch* batch = nullptr;
+
+	while(inRing->pop(batch))
+	{
+		delete batch;
+	}
+
+	delete inRing;
+};
+
+//------------------------------------------------------ decodeWorkerForEndpoint
+// Implementation notes:
+//  Address and port mixed with the MurmurHash3 finalizer, so the
+//  neighbouring ports of one host spread evenly over the workers
+//------------------------------------------------------------------------------
+uint16_t server::decodeWorkerForEndpoint(
+	const boost::asio::ip::udp::endpoint& inEndpoint,
+	const uint16_t& inDecodeWorkers)
+{
+	uint64_t key = inEndpoint.port();
+
+	if(inEndpoint.address().is_v4())
+	{
+		key |= static_cast<uint64_t>(inEndpoint.address().to_v4().to_ulong()) << 16;
+	}
+
+	key ^= key >> 33;
+	key *= 0xFF51AFD7ED558CCDULL;
+	key ^= key >> 33;
+	key *= 0xC4CEB9FE1A85EC53ULL;
+	key ^= key >> 33;
+
+	return static_cast<uint16_t>(key % inDecodeWorkers);
+};
+
+//--------------------------------------------------------------- isAdminMessage
+// Implementation notes:
+//  Lets the decode stage filter admin commands out with std::remove_if
+//------------------------------------------------------------------------------
+bool server::isAdminMessage(
+	const dataMessage& inMessage)
+{
+	return inMessage.viewMessageType() == constants::MessageType::mt_ADMIN;
+};
+
+//------------------------------------------------------------------ offloadTask
+// Implementation notes:
+//  The work and completion are copied into the pool task
+//------------------------------------------------------------------------------
+void server::offloadTask(
+	const boost::function<void()>& inWork,
+	const boost::function<void()>& inCompletion)
+{
+	this->m_taskPool.submit(
+		boost::bind(&server::runOffloadedTask, this, inWork, inCompletion));
+};
+
+//------------------------------------------------------------- runOffloadedTask
+// Implementation notes:
+//  The completion is queued even if the work threw, so the state stage
+//  never waits on a task that failed
+//------------------------------------------------------------------------------
+void server::runOffloadedTask(
+	const boost::function<void()>& inWork,
+	const boost::function<void()>& inCompletion)
+{
+	try
+	{
+		inWork();
+	}
+	catch(...)
+	{
+
+	}
+
+	this->postToStateStage(
+		inCompletion);
+};
+
+//------------------------------------------------------------- postToStateStage
+// Implementation notes:
+//  Shares the completion queue of offloaded tasks, and wakes the state
+//  stage if it sleeps with nothing in its rings
+//------------------------------------------------------------------------------
+void server::postToStateStage(
+	const boost::function<void()>& inCompletion)
+{
+	{
+		boost::mutex::scoped_lock lock(this->m_completionMutex);
+
+		this->m_completions.push_back(inCompletion);
+	}
+
+	server::wakeStage(
+		this->m_stateWakeup);
+};
+
+//--------------------------------------------------------------- runCompletions
+// Implementation notes:
+//  Takes the whole queue at once so completions run without the lock held
+//------------------------------------------------------------------------------
+size_t server::runCompletions()
+{
+	std::deque<boost::function<void()>> completions;
+
+	{
+		boost::mutex::scoped_lock lock(this->m_completionMutex);
+
+		if(this->m_completions.empty())
+		{
+			return 0;
+		}
+
+		completions.swap(this->m_completions);
+	}
+
+	for(const boost::function<void()>& currentCompletion : completions)
+	{
+		try
+		{
+			currentCompletion();
+		}
+		catch(...)
+		{
+
+		}
+	}
+
+	return completions.size();
+};
+
+//------------------------------------------------------------- dispatchDatagram
+// Implementation notes:
+//  The messages of a datagram are dispatched in order. Sends and scheduled
+//  sends that came straight from a client (origin index -1, forwarded sends
+//  carry the forwarding server's index) are acknowledged with one ACK per
+//  datagram listing every accepted sequence number. Only messages without a
+//  checksum trailer need the sender looked up, and only those of peers that
+//  never announced the capability are let through.
+//------------------------------------------------------------------------------
+void server::dispatchDatagram(
+	const std::vector<dataMessage>& inMessages,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	std::vector<std::string> acceptedSequenceNumbers;
+	std::string senderIdentifier;
+
+	for(const dataMessage& currentMessage : inMessages)
+	{
+		if(!currentMessage.viewHasChecksum()
+			&& this->requiresChecksum(
+				currentMessage,
+				inSenderEndpoint))
+		{
+			// the trailer was lost on the way, treat it like a corrupt message
+			continue;
+		}
+
+		this->dispatchMessage(
+			currentMessage,
+			inSenderEndpoint);
+
+		if(((currentMessage.viewMessageType() == constants::MessageType::mt_CLIENT_SEND)
+			|| (currentMessage.viewMessageType() == constants::MessageType::mt_CLIENT_SCHEDULE))
+			&& (currentMessage.viewServerSyncPayloadOriginIndex() < 0))
+		{
+			acceptedSequenceNumbers.push_back(
+				std::to_string(currentMessage.viewSequenceNumber()));
+
+			senderIdentifier = currentMessage.viewSourceIdentifier();
+		}
+	}
+
+	if(!acceptedSequenceNumbers.empty())
+	{
+		const dataMessage ackMessage(
+			this->sequenceNumber(),
+			constants::MessageType::mt_SERVER_ACK,
+			constants::serverIndexToServerName(this->m_index),
+			senderIdentifier,
+			dataMessage::createServerSyncPayload(acceptedSequenceNumbers));
+
+		this->sendDatagram(
+			ackMessage.asCharVector(),
+			inSenderEndpoint);
+	}
+};
+
+//------------------------------------------------------------- isAdjacentServer
+// Implementation notes:
+//  Servers send from their listening port, so their datagrams come from the
+//  endpoint they are reached at
+//------------------------------------------------------------------------------
+bool server::isAdjacentServer(
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint) const
+{
+	for(const remoteConnection* adjacentServer :
+		{this->m_leftAdjacentServerConnection, this->m_rightAdjacentServerConnection})
+	{
+		if((adjacentServer != nullptr)
+			&& (adjacentServer->viewEndpoint() == inSenderEndpoint))
+		{
+			return true;
+		}
+	}
+
+	return false;
+};
+
+//------------------------------------------------------------- requiresChecksum
+// Implementation notes:
+//  Servers other than the adjacent ones and unknown endpoints have announced
+//  nothing here, so their messages are taken as they come
+//------------------------------------------------------------------------------
+bool server::requiresChecksum(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint) const
+{
+	for(const remoteConnection* adjacentServer :
+		{this->m_leftAdjacentServerConnection, this->m_rightAdjacentServerConnection})
+	{
+		if((adjacentServer != nullptr)
+			&& (adjacentServer->viewEndpoint() == inSenderEndpoint))
+		{
+			return (adjacentServer->viewCapabilities() & constants::cap_CHECKSUM) != 0;
+		}
+	}
+
+	const std::map<std::string, std::vector<remoteConnection>>::const_iterator sessions =
+		this->m_connectedClients.find(inMessage.viewSourceIdentifier());
+
+	if(sessions == this->m_connectedClients.end())
+	{
+		return false;
+	}
+
+	for(const remoteConnection& currentSession : sessions->second)
+	{
+		if(currentSession.viewEndpoint() == inSenderEndpoint)
+		{
+			return (currentSession.viewCapabilities() & constants::cap_CHECKSUM) != 0;
+		}
+	}
+
+	return false;
+};
+
+//----------------------------------------------------------------- markDispatch
+// Implementation notes:
+//  Only dispatches on the state stage are timed, and only those of received
+//  datagrams, completions such as multicast frames carry no receive
+//  timestamps. The flight recorder judges its latency windows on this
+//  thread alone.
+//------------------------------------------------------------------------------
+void server::markDispatch(
+	const constants::MessageType& inMessageType)
+{
+	if(boost::this_thread::get_id() != this->m_stateThreadId)
+	{
+		return;
+	}
+
+	this->m_dispatchedNanoseconds = server::realtimeNanoseconds();
+	this->m_dispatchedType = inMessageType;
+
+	if(this->m_receivedNanoseconds != 0)
+	{
+		this->m_arrivalToDispatch[inMessageType]->record(
+			this->m_dispatchedNanoseconds - this->m_receivedNanoseconds);
+
+		this->m_flightRecorder.recordLatency(
+			this->m_dispatchedNanoseconds - this->m_receivedNanoseconds,
+			this->m_dispatchedNanoseconds);
+	}
+};
+
+//-------------------------------------------------------------- dispatchMessage
+// Implementation notes:
+//  Acts on a single received message. Receive backends only decode the
+//  datagram and hand it here, so every backend shares the same handling.
+//------------------------------------------------------------------------------
+void server::dispatchMessage(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	this->markDispatch(
+		inMessage.viewMessageType());
+
+	std::cout << "Received " << inMessage.viewMessageTypeAsString();
+	std::cout << " message from " << inMessage.viewSourceIdentifier();
+
+	switch(inMessage.viewMessageType())
+	{
+		case constants::MessageType::mt_CLIENT_CONNECT:
+		{
+			this->processClientConnectMessage(
+				inMessage,
+				inSenderEndpoint);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_DISCONNECT:
+		{
+			this->removeClientConnection(
+				inMessage.viewSourceIdentifier(),
+				inSenderEndpoint);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_SEND:
+		{
+			this->processClientSendMessage(
+				inMessage);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_SCHEDULE:
+		{
+			this->processClientScheduleMessage(
+				inMessage);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_GET:
+		{
+			this->processClientGetMessage(
+				inMessage,
+				inSenderEndpoint);
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_ACK:
+		{
+			this->removeReceivedMessageFromList(
+				inMessage,
+				inSenderEndpoint);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_SEND:
+		{
+			this->processServerRelayMessage(
+				inMessage);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_ACK:
+		{
+			// #TODO necessary?
+			break;
+		}
+		case constants::MessageType::mt_SERVER_SYNC:
+		{
+			this->receiveClientsFromAdjacentServers(
+				inMessage);
+
+			std::cout << " (Origin: " << constants::serverIndexToServerName(
+				inMessage.viewServerSyncPayloadOriginIndex()) << ")" << std::endl;
+			return;
+		}
+		case constants::MessageType::mt_PING:
+		{
+			this->replyToPing(
+				inMessage,
+				inSenderEndpoint);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_NACK:
+		{
+			this->resendMulticastFrames(
+				inMessage);
+			break;
+		}
+		case constants::MessageType::mt_SERVER_LOAD:
+		{
+			this->receiveServerLoad(
+				inMessage);
+
+			std::cout << " (Origin: " << constants::serverIndexToServerName(
+				inMessage.viewServerSyncPayloadOriginIndex()) << ", "
+				<< inMessage.viewPayload() << ")" << std::endl;
+			return;
+		}
+		case constants::MessageType::mt_SERVER_HELLO:
+		{
+			this->processServerHelloMessage(
+				inMessage);
+			break;
+		}
+		case constants::MessageType::mt_ADMIN:
+		{
+			this->processAdminMessage(
+				inMessage,
+				inSenderEndpoint);
+			break;
+		}
+		case constants::MessageType::mt_UNDEFINED:
+		{
+			// Do nothing, a message type only newer peers know
+			break;
+		}
+		default:
+		{
+			assert(false);
+		}
+	}
+
+	std::cout << std::endl;
+};
+
+//---------------------------------------------------------- sendMessageToClient
+// Implementation notes:
+//  Sends the messages in the client's mailbox that the requesting session
+//  has not acknowledged yet, packed into one batch datagram. Each message was
+//  encoded once when it was added to the mailbox, so the batch is built from
+//  the stored encodings. Messages that do not fit the batch are announced
+//  with a pending hint at its end and sent on the next get. A session that
+//  accepts compressed batches gets a long batch compressed on the task pool,
+//  one that accepts no batches gets a single message and the hint after it.
+//  Every datagram carries the entries right after the session's cursor with
+//  no gaps, so acknowledging one entry also covers those before it.
+//------------------------------------------------------------------------------
+void server::sendMessagesToClient(
+	const std::string& inClientIdentifier,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint)
+{
+	std::map<std::string, std::vector<remoteConnection>>::iterator sessions =
+		this->m_connectedClients.find(inClientIdentifier);
+
+	std::map<std::string, std::list<std::shared_ptr<const encodedMessage>>>::iterator mailbox =
+		this->m_mailboxes.find(inClientIdentifier);
+
+	if((sessions == this->m_connectedClients.end())
+		|| (mailbox == this->m_mailboxes.end()))
+	{
+		// Do nothing, client is not connected here or has no messages
+		return;
+	}
+
+	for(remoteConnection& targetSession : sessions->second)
+	{
+		if(targetSession.viewEndpoint() == inClientEndpoint)
+		{
+			const bool acceptsBatch =
+				(targetSession.viewCapabilities() & constants::cap_BATCH) != 0;
+
+			const bool acceptsCompressedBatch = acceptsBatch
+				&& ((targetSession.viewCapabilities() & constants::cap_COMPRESSED_BATCH) != 0);
+
+			std::vector<char> response;
+			int64_t messagesLeftOver = 0;
+
+			for(const std::shared_ptr<const encodedMessage>& currentMessage : mailbox->second)
+			{
+				if(targetSession.hasAcknowledged(
+					currentMessage->viewMessage().viewSequenceNumber()))
+				{
+					// Do nothing, this session already has it
+					continue;
+				}
+
+				// a smaller message after one that did not fit waits too
+				const bool fitsResponse = response.empty()
+					|| (acceptsBatch
+						&& (messagesLeftOver == 0)
+						&& (response.size() + currentMessage->viewEncoded().size()
+							< constants::getResponseMaximumBatchLength));
+
+				if(fitsResponse && !acceptsBatch)
+				{
+					response = currentMessage->viewEncoded();
+				}
+				else if(fitsResponse)
+				{
+					dataMessage::appendToBatch(
+						response,
+						currentMessage->viewEncoded());
+				}
+				else
+				{
+					messagesLeftOver++;
+				}
+			}
+
+			if(response.empty())
+			{
+				// Do nothing, nothing waiting for this session
+				break;
+			}
+
+			std::vector<char> pendingHint;
+
+			if(messagesLeftOver > 0)
+			{
+				// tells the client to get again straight away
+				const std::vector<std::string> pendingFields({
+					"pending=" + std::to_string(messagesLeftOver)});
+
+				const dataMessage pendingMessage(
+					this->sequenceNumber(),
+					constants::MessageType::mt_SERVER_PENDING,
+					constants::serverIndexToServerName(this->m_index),
+					inClientIdentifier,
+					dataMessage::createServerSyncPayload(pendingFields));
+
+				pendingHint = pendingMessage.asCharVector();
+			}
+
+			if(acceptsBatch && !pendingHint.empty())
+			{
+				dataMessage::appendToBatch(
+					response,
+					pendingHint);
+
+				pendingHint.clear();
+			}
+
+			if(acceptsCompressedBatch
+				&& (response.size() >= constants::compressedResponseMinimumLength))
+			{
+				const std::shared_ptr<std::vector<char>> batch(
+					std::make_shared<std::vector<char>>(response));
+
+				this->offloadTask(
+					boost::bind(&server::compressHandoff, batch),
+					boost::bind(&server::sendHandoff, this, batch, targetSession.viewEndpoint()));
+
+				break;
+			}
+
+			try
+			{
+				this->sendDatagram(
+					response,
+					targetSession.viewEndpoint());
+
+				if(!pendingHint.empty())
+				{
+					this->sendDatagram(
+						pendingHint,
+						targetSession.viewEndpoint());
+				}
+			}
+			catch(std::exception& exception)
+			{
+				// std::cout << exception.what() << std::endl;
+			}
+
+			break;
+		}
+		else
+		{
+			// Do nothing, another session of the same user
+		}
+	}
+};
+
+//------------------------------------------------ removeReceivedMessageFromList
+// Implementation notes:
+//  Moves the cursor of the session that sent the acknowledgement, then drops
+//  the entries every session of the user is now past. An id that is not in
+//  the mailbox was either dropped already or never handed out, and moving
+//  the cursor on it could skip entries the session never received.
+//------------------------------------------------------------------------------
+void server::removeReceivedMessageFromList(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint)
+{
+	std::map<std::string, std::vector<remoteConnection>>::iterator sessions =
+		this->m_connectedClients.find(inMessage.viewSourceIdentifier());
+
+	std::map<std::string, std::list<std::shared_ptr<const encodedMessage>>>::iterator mailbox =
+		this->m_mailboxes.find(inMessage.viewSourceIdentifier());
+
+	if((sessions == this->m_connectedClients.end())
+		|| (mailbox == this->m_mailboxes.end()))
+	{
+		return;
+	}
+
+	bool isInMailbox = false;
+
+	for(const std::shared_ptr<const encodedMessage>& currentMessage : mailbox->second)
+	{
+		if(currentMessage->viewMessage().viewSequenceNumber()
+			== inMessage.viewSequenceNumber())
+		{
+			isInMailbox = true;
+			break;
+		}
+	}
+
+	if(!isInMailbox)
+	{
+		// Do nothing, a stale or made up acknowledgement
+		return;
+	}
+
+	for(remoteConnection& currentSession : sessions->second)
+	{
+		if(currentSession.viewEndpoint() == inClientEndpoint)
+		{
+			currentSession.acknowledge(
+				inMessage.viewSequenceNumber());
+			break;
+		}
+	}
+
+	this->removeFullyAcknowledgedMessages(
+		inMessage.viewSourceIdentifier());
+};
+
+//---------------------------------------------- removeFullyAcknowledgedMessages
+// Implementation notes:
+//  A user without any session keeps their mailbox, it is delivered when
+//  they connect again. Entries are in the order of their ids, so those
+//  every session is past are at the front.
+//------------------------------------------------------------------------------
+void server::removeFullyAcknowledgedMessages(
+	const std::string& inClientIdentifier)
+{
+	std::map<std::string, std::vector<remoteConnection>>::iterator sessions =
+		this->m_connectedClients.find(inClientIdentifier);
+
+	std::map<std::string, std::list<std::shared_ptr<const encodedMessage>>>::iterator mailbox =
+		this->m_mailboxes.find(inClientIdentifier);
+
+	if((sessions == this->m_connectedClients.end())
+		|| (mailbox == this->m_mailboxes.end()))
+	{
+		return;
+	}
+
+	int64_t acknowledgedByAllSessions = std::numeric_limits<int64_t>::max();
+
+	for(const remoteConnection& currentSession : sessions->second)
+	{
+		acknowledgedByAllSessions = std::min(
+			acknowledgedByAllSessions,
+			currentSession.viewAcknowledgedMailboxEntry());
+	}
+
+	while(!mailbox->second.empty()
+		&& (mailbox->second.front()->viewMessage().viewSequenceNumber()
+			<= acknowledgedByAllSessions))
+	{
+		mailbox->second.pop_front();
+	}
+
+	if(mailbox->second.empty())
+	{
+		this->m_mailboxes.erase(mailbox);
+	}
+};
+
+//-------------------------------------------------- processClientConnectMessage
+// Implementation notes:
+//  Nothing is stored for a connect without a valid cookie, so spoofed
+//  connects cost one datagram of the same size in reply. Connects that
+//  continue an existing session are never redirected, a client that already
+//  holds a session here stays here.
+//------------------------------------------------------------------------------
+void server::processClientConnectMessage(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	if(!this->hasValidCookie(
+		inMessage,
+		inSenderEndpoint))
+	{
+		this->sendCookie(
+			inMessage,
+			inSenderEndpoint);
+		return;
+	}
+
+	const std::string resumeToken(
+		inMessage.viewPayloadField("token"));
+
+	const bool continuesSession = (this->findClientSession(
+		inMessage.viewSourceIdentifier(),
+		inSenderEndpoint,
+		resumeToken) != nullptr);
+
+	const int8_t redirectIndex = continuesSession
+		? -1
+		: this->findRedirectTarget();
+
+	if(redirectIndex < 0)
+	{
+		this->addClientConnection(
+			inMessage.viewSourceIdentifier(),
+			inSenderEndpoint,
+			resumeToken,
+			inMessage.viewPayloadCapabilities());
+		return;
+	}
+
+	std::cout << " (redirected to "
+		<< constants::serverIndexToServerName(redirectIndex) << ")";
+
+	const std::vector<std::string> redirectFields({
+		"server=" + std::to_string(redirectIndex)});
+
+	const dataMessage redirectMessage(
+		inMessage.viewSequenceNumber(),
+		constants::MessageType::mt_SERVER_REDIRECT,
+		constants::serverIndexToServerName(this->m_index),
+		inMessage.viewSourceIdentifier(),
+		dataMessage::createServerSyncPayload(redirectFields));
+
+	this->sendDatagram(
+		redirectMessage.asCharVector(),
+		inSenderEndpoint);
+};
+
+//------------------------------------------------------ processClientGetMessage
+// Implementation notes:
+//  A get is answered with at most one datagram either way, but only a
+//  verified one can be answered with a full batch
+//------------------------------------------------------------------------------
+void server::processClientGetMessage(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	if(!this->hasValidCookie(
+		inMessage,
+		inSenderEndpoint))
+	{
+		this->sendCookie(
+			inMessage,
+			inSenderEndpoint);
+		return;
+	}
+
+	remoteConnection* session = this->findClientSession(
+		inMessage.viewSourceIdentifier(),
+		inSenderEndpoint,
+		"");
+
+	if(session != nullptr)
+	{
+		// an empty mailbox still keeps the session alive
+		session->refreshTimeOfLastActivity();
+	}
+
+	this->sendMessagesToClient(
+		inMessage.viewSourceIdentifier(),
+		inSenderEndpoint);
+};
+
+//--------------------------------------------------------------- hasValidCookie
+// Implementation notes:
+//  Legacy clients never see a cookie reply during the grace, they would not
+//  know what to do with one
+//------------------------------------------------------------------------------
+bool server::hasValidCookie(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	if(constants::cookieGraceForLegacyClients
+		&& ((inMessage.viewPayloadCapabilities() & constants::cap_COOKIE) == 0))
+	{
+		return true;
+	}
+
+	return this->m_cookies.verifyCookie(
+		inSenderEndpoint,
+		inMessage.viewPayloadField("cookie"));
+};
+
+//------------------------------------------------------------------- sendCookie
+// Implementation notes:
+//  Echoes the sequence number like a ping reply. The cookie is derived from
+//  the endpoint and the time alone, so nothing is stored until the client
+//  returns it.
+//------------------------------------------------------------------------------
+void server::sendCookie(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	std::cout << " (cookie sent)";
+
+	const std::vector<std::string> cookieFields({
+		"cookie=" + this->m_cookies.createCookie(inSenderEndpoint),
+		dataMessage::capabilitiesField(constants::localCapabilities)});
+
+	const dataMessage cookieMessage(
+		inMessage.viewSequenceNumber(),
+		constants::MessageType::mt_SERVER_COOKIE,
+		constants::serverIndexToServerName(this->m_index),
+		inMessage.viewSourceIdentifier(),
+		dataMessage::createServerSyncPayload(cookieFields));
+
+	this->sendDatagram(
+		cookieMessage.asCharVector(),
+		inSenderEndpoint);
+};
+
+//----------------------------------------------------- processClientSendMessage
+// Implementation notes:
+//  Delivers the message to every server that has a session for the
+//  destination user, along the route resolveRoute picks. A message nobody
+//  serves yet is parked. A broadcast travels the whole chain, and keeps
+//  travelling away from the server that forwarded it like any other message.
+//  With the multicast group enabled it is published to the group once
+//  instead, and every server delivers it locally.
+//------------------------------------------------------------------------------
+void server::processClientSendMessage(
+	const dataMessage& inMessage)
+{
+	const std::string destinationID(
+		inMessage.viewDestinationIdentifier());
+
+	const int8_t forwardedFromIndex =
+		inMessage.viewServerSyncPayloadOriginIndex();
+
+	const bool mayForwardLeft =
+		(forwardedFromIndex < 0) || (forwardedFromIndex > this->m_index);
+
+	const bool mayForwardRight =
+		(forwardedFromIndex < 0) || (forwardedFromIndex < this->m_index);
+
+	dataMessage forwardedMessage(inMessage);
+	forwardedMessage.setServerSyncPayloadOriginIndex(this->m_index);
+
+	if(destinationID == constants::broadcastDestination)
+	{
+		this->deliverBroadcast(
+			inMessage);
+
+		if(constants::multicastSyncEnabled)
+		{
+			// the load report gives the frame its multicast sequence number
+			dataMessage publishedMessage(inMessage);
+			publishedMessage.setServerSyncPayloadOriginIndex(this->m_index);
+
+			this->publishMulticastFrame({
+				this->createLoadReport(
+					0,
+					this->m_index,
+					constants::multicastGroupAddress),
+				publishedMessage});
+
+			return;
+		}
+
+		if(mayForwardLeft && (this->m_leftAdjacentServerConnection != nullptr))
+		{
+			this->sendDatagram(
+				forwardedMessage.asCharVector(),
+				this->m_leftAdjacentServerConnection->viewEndpoint());
+		}
+
+		if(mayForwardRight && (this->m_rightAdjacentServerConnection != nullptr))
+		{
+			this->sendDatagram(
+				forwardedMessage.asCharVector(),
+				this->m_rightAdjacentServerConnection->viewEndpoint());
+		}
+
+		return;
+	}
+
+	const messageRoute route =
+		this->resolveRoute(inMessage);
+
+	this->recordRoute(
+		inMessage,
+		route);
+
+	if(route.local)
+	{
+		this->addToMessageList(
+			inMessage);
+	}
+
+	if(route.left)
+	{
+		try
+		{
+			this->sendDatagram(
+				forwardedMessage.asCharVector(),
+				this->m_leftAdjacentServerConnection->viewEndpoint());
+
+		}
+		catch(std::exception& exception)
+		{
+			// std::cout << exception.what() << std::endl;
+		}
+	}
+
+	if(route.right)
+	{
+		try
+		{
+			this->sendDatagram(
+				forwardedMessage.asCharVector(),
+				this->m_rightAdjacentServerConnection->viewEndpoint());
+
+		}
+		catch(std::exception& exception)
+		{
+			// std::cout << exception.what() << std::endl;
+		}
+	}
+
+	if(!route.local && !route.left && !route.right)
+	{
+		// if we make it here, as per the requirements, we hold on to the message
+		this->addToMessageListOfUnassociatedClients(
+			inMessage);
+	}
+};
+
+//----------------------------------------------------------------- resolveRoute
+// Implementation notes:
+//  The local mailbox, and at most one copy in each direction along the
+//  chain. A message forwarded by another server keeps travelling away from
+//  it, so users with sessions on both sides of a server don't make copies
+//  bounce back and forth.
+//------------------------------------------------------------------------------
+server::messageRoute server::resolveRoute(
+	const dataMessage& inMessage)
+{
+	const std::string& destinationID(
+		inMessage.viewDestinationIdentifier());
+
+	const int8_t forwardedFromIndex =
+		inMessage.viewServerSyncPayloadOriginIndex();
+
+	const bool mayForwardLeft =
+		(forwardedFromIndex < 0) || (forwardedFromIndex > this->m_index);
+
+	const bool mayForwardRight =
+		(forwardedFromIndex < 0) || (forwardedFromIndex < this->m_index);
+
+	messageRoute outRoute = {false, false, false};
+
+	// check this server's client list first
+	outRoute.local = (this->m_connectedClients.count(destinationID) > 0);
+
+	// check clients on servers to the left
+	for(int8_t serverIndex = 0;
+		mayForwardLeft && !outRoute.left && (serverIndex < this->m_index);
+		serverIndex++)
+	{
+		outRoute.left =
+			this->serverIndexServesClient(serverIndex, destinationID);
+	}
+
+	// check clients on servers to the right
+	for(int8_t serverIndex = constants::highestServerIndex;
+		mayForwardRight && !outRoute.right && (serverIndex > this->m_index);
+		serverIndex--)
+	{
+		outRoute.right =
+			this->serverIndexServesClient(serverIndex, destinationID);
+	}
+
+	// programming error if a server serving the client has no connection
+	assert(!outRoute.left || (this->m_leftAdjacentServerConnection != nullptr));
+	assert(!outRoute.right || (this->m_rightAdjacentServerConnection != nullptr));
+
+	return outRoute;
+};
+
+//------------------------------------------------------------------ recordRoute
+// Implementation notes:
+//  Routes are recorded where a message is acted on, not in resolveRoute,
+//  which the parked message retries call for every message on every scan
+//------------------------------------------------------------------------------
+void server::recordRoute(
+	const dataMessage& inMessage,
+	const messageRoute& inRoute)
+{
+	this->m_flightRecorder.record(
+		flightRecorder::ek_ROUTE,
+		inMessage.viewMessageType(),
+		0,
+		(inRoute.local ? flightRecorder::rb_LOCAL : 0)
+			| (inRoute.left ? flightRecorder::rb_LEFT : 0)
+			| (inRoute.right ? flightRecorder::rb_RIGHT : 0),
+		server::realtimeNanoseconds());
+};
+
+//------------------------------------------------------------------ routeInBulk
+// Implementation notes:
+//  Routes like processClientSendMessage, but collects the messages for each
+//  mailbox and each direction first. Every mailbox then takes its messages
+//  in one insert, and each direction gets them as a handoff.
+//------------------------------------------------------------------------------
+void server::routeInBulk(
+	const std::vector<dataMessage>& inMessages)
+{
+	std::map<std::string, std::vector<std::shared_ptr<const encodedMessage>>> localMessages;
+	std::vector<dataMessage> leftMessages;
+	std::vector<dataMessage> rightMessages;
+
+	for(const dataMessage& currentMessage : inMessages)
+	{
+		if(currentMessage.viewDestinationIdentifier() == constants::broadcastDestination)
+		{
+			this->processClientSendMessage(
+				currentMessage);
+			continue;
+		}
+
+		const messageRoute route =
+			this->resolveRoute(currentMessage);
+
+		this->recordRoute(
+			currentMessage,
+			route);
+
+		if(route.local)
+		{
+			dataMessage storedMessage(currentMessage);
+			storedMessage.setMessageType(
+				constants::MessageType::mt_SERVER_SEND);
+
+			this->m_history.append(
+				currentMessage.viewDestinationIdentifier(),
+				storedMessage);
+
+			localMessages[currentMessage.viewDestinationIdentifier()].push_back(
+				this->createMailboxEntry(storedMessage));
+		}
+
+		if(route.left || route.right)
+		{
+			dataMessage forwardedMessage(currentMessage);
+			forwardedMessage.setServerSyncPayloadOriginIndex(this->m_index);
+
+			if(route.left)
+			{
+				leftMessages.push_back(forwardedMessage);
+			}
+
+			if(route.right)
+			{
+				rightMessages.push_back(forwardedMessage);
+			}
+		}
+
+		if(!route.local && !route.left && !route.right)
+		{
+			this->addToMessageListOfUnassociatedClients(
+				currentMessage);
+		}
+	}
+
+	for(const std::pair<const std::string, std::vector<std::shared_ptr<const encodedMessage>>>& currentMailbox :
+		localMessages)
+	{
+		std::list<std::shared_ptr<const encodedMessage>>& mailbox =
+			this->m_mailboxes[currentMailbox.first];
+
+		mailbox.insert(
+			mailbox.end(),
+			currentMailbox.second.begin(),
+			currentMailbox.second.end());
+	}
+
+	if(!leftMessages.empty())
+	{
+		this->handOffMessages(
+			leftMessages,
+			*this->m_leftAdjacentServerConnection);
+	}
+
+	if(!rightMessages.empty())
+	{
+		this->handOffMessages(
+			rightMessages,
+			*this->m_rightAdjacentServerConnection);
+	}
+};
+
+//-------------------------------------------------------------- handOffMessages
+// Implementation notes:
+//  Messages are packed into batches from their encodings, and each batch is
+//  compressed on the task pool, whose completion sends it. A few messages
+//  aren't worth compressing and are forwarded one by one, as is any message
+//  too long to share a batch. A neighbour that has not announced compressed
+//  batches gets the batches as they are, one that has not announced batches
+//  gets every message on its own.
+//------------------------------------------------------------------------------
+void server::handOffMessages(
+	const std::vector<dataMessage>& inMessages,
+	const remoteConnection& inAdjacentServer)
+{
+	const boost::asio::ip::udp::endpoint& destination =
+		inAdjacentServer.viewEndpoint();
+
+	const bool batched = (inMessages.size() >= constants::handoffMinimumMessages)
+		&& ((inAdjacentServer.viewCapabilities() & constants::cap_BATCH) != 0);
+
+	const bool compressed = batched
+		&& ((inAdjacentServer.viewCapabilities() & constants::cap_COMPRESSED_BATCH) != 0);
+
+	std::shared_ptr<std::vector<char>> batch;
+
+	for(const dataMessage& currentMessage : inMessages)
+	{
+		const std::vector<char> encodedMessage(
+			currentMessage.asCharVector());
+
+		// the message with its length prefix, as appendToBatch adds it
+		const size_t framedLength = encodedMessage.size()
+			+ std::to_string(encodedMessage.size()).size() + 1;
+
+		if(!batched
+			|| (constants::batchPrefix().size() + framedLength
+				> constants::handoffMaximumBatchLength))
+		{
+			this->sendDatagram(
+				encodedMessage,
+				destination);
+			continue;
+		}
+
+		if((batch != nullptr)
+			&& (batch->size() + framedLength > constants::handoffMaximumBatchLength))
+		{
+			this->sendHandoffBatch(
+				batch,
+				destination,
+				compressed);
+
+			batch.reset();
+		}
+
+		if(batch == nullptr)
+		{
+			batch = std::make_shared<std::vector<char>>();
+		}
+
+		dataMessage::appendToBatch(
+			*batch,
+			encodedMessage);
+	}
+
+	if(batch != nullptr)
+	{
+		this->sendHandoffBatch(
+			batch,
+			destination,
+			compressed);
+	}
+};
+
+//------------------------------------------------------------- sendHandoffBatch
+// Implementation notes:
+//  Only a compressed batch needs the task pool
+//------------------------------------------------------------------------------
+void server::sendHandoffBatch(
+	const std::shared_ptr<std::vector<char>>& inBatch,
+	const boost::asio::ip::udp::endpoint& inDestination,
+	const bool& inCompressed)
+{
+	if(!inCompressed)
+	{
+		this->sendDatagram(
+			*inBatch,
+			inDestination);
+		return;
+	}
+
+	this->offloadTask(
+		boost::bind(&server::compressHandoff, inBatch),
+		boost::bind(&server::sendHandoff, this, inBatch, inDestination));
+};
+
+//-------------------------------------------------------------- compressHandoff
+// Implementation notes:
+//  Replaces the batch with its compressed datagram
+//------------------------------------------------------------------------------
+void server::compressHandoff(
+	const std::shared_ptr<std::vector<char>>& ioBatch)
+{
+	*ioBatch = dataMessage::createCompressedBatch(
+		*ioBatch);
+};
+
+//------------------------------------------------------------------ sendHandoff
+// Implementation notes:
+//  A batch whose compression failed is still uncompressed, and is sent as
+//  a plain batch instead
+//------------------------------------------------------------------------------
+void server::sendHandoff(
+	const std::shared_ptr<std::vector<char>>& inDatagram,
+	const boost::asio::ip::udp::endpoint& inDestination)
+{
+	this->sendDatagram(
+		*inDatagram,
+		inDestination);
+};
+
+//--------------------------------------------------------------- receiveHandoff
+// Implementation notes:
+//  Messages of a handoff are routed onwards the same way, so a handoff
+//  crossing several servers stays in bulk. Its latency counts as one
+//  server send. A handoff skips the cookie and session checks, so one from
+//  any other endpoint is dropped.
+//------------------------------------------------------------------------------
+void server::receiveHandoff(
+	const std::vector<dataMessage>& inMessages,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	if(!this->isAdjacentServer(
+		inSenderEndpoint))
+	{
+		std::cout << "Dropped handoff from " << inSenderEndpoint
+			<< ", not an adjacent server" << std::endl;
+		return;
+	}
+
+	this->markDispatch(
+		constants::MessageType::mt_SERVER_SEND);
+
+	std::cout << "Received handoff of " << inMessages.size()
+		<< " messages from " << inSenderEndpoint << std::endl;
+
+	this->routeInBulk(
+		inMessages);
+};
+
+//-------------------------------------------------------- forwardParkedMessages
+// Implementation notes:
+//  Only the messages that now have a route leave the list and the offline
+//  store, the rest stay where they are without being written again
+//------------------------------------------------------------------------------
+void server::forwardParkedMessages()
+{
+	std::vector<dataMessage> routableMessages;
+
+	std::map<std::string, dataMessage>::iterator it =
+		this->m_messageListOfUnassociatedClients.begin();
+
+	while(it != this->m_messageListOfUnassociatedClients.end())
+	{
+		const messageRoute route =
+			this->resolveRoute(it->second);
+
+		if(!route.local && !route.left && !route.right)
+		{
+			it++;
+			continue;
+		}
+
+		routableMessages.push_back(
+			it->second);
+
+		this->m_offlineMailboxes.erase(
+			it->first);
+
+		it = this->m_messageListOfUnassociatedClients.erase(it);
+	}
+
+	if(routableMessages.empty())
+	{
+		return;
+	}
+
+	// one event per scan that moved something, the routes follow
+	this->m_flightRecorder.record(
+		flightRecorder::ek_PARKED_SCAN,
+		constants::MessageType::mt_UNDEFINED,
+		static_cast<uint32_t>(routableMessages.size()),
+		this->m_messageListOfUnassociatedClients.size(),
+		server::realtimeNanoseconds());
+
+	this->routeInBulk(
+		routableMessages);
+};
+
+//--------------------------------------------------------------- flushStoreLogs
+// Implementation notes:
+//  The stores buffer their logs, this bounds how much a crash can lose
+//------------------------------------------------------------------------------
+void server::flushStoreLogs()
+{
+	this->m_history.flushLog();
+	this->m_offlineMailboxes.flushLog();
+};
+
+//------------------------------------------------- processClientScheduleMessage
+// Implementation notes:
+//  The delivery time is the run of digits the payload starts with. The
+//  message stored is the send the client would have made at that time, so
+//  delivery needs no special handling. Times too far ahead are refused
+//  rather than kept in the schedule file indefinitely.
+//------------------------------------------------------------------------------
+void server::processClientScheduleMessage(
+	const dataMessage& inMessage)
+{
+	const std::string& payload(
+		inMessage.viewPayload());
+
+	const size_t textBegin = std::min(
+		payload.find_first_not_of("0123456789"),
+		payload.size());
+
+	const int64_t now = messageScheduler::currentTimeMilliseconds();
+	const int64_t latestDelivery = now
+		+ int64_t(constants::scheduleMaximumDelayDays) * 24 * 60 * 60 * 1000;
+
+	int64_t dueMilliseconds = -1;
+
+	try
+	{
+		dueMilliseconds = std::stoll(payload.substr(0, textBegin));
+	}
+	catch(std::exception& exception)
+	{
+		// no delivery time, or one out of range
+	}
+
+	if((dueMilliseconds < 0) || (dueMilliseconds > latestDelivery))
+	{
+		std::cout << " (invalid delivery time, dropped)";
+		return;
+	}
+
+	this->m_scheduler.schedule(
+		dueMilliseconds,
+		dataMessage(
+			inMessage.viewSequenceNumber(),
+			constants::MessageType::mt_CLIENT_SEND,
+			inMessage.viewSourceIdentifier(),
+			inMessage.viewDestinationIdentifier(),
+			payload.substr(textBegin)));
+
+	std::cout << " (due in "
+		<< std::max<int64_t>(dueMilliseconds - now, 0) / 1000 << "s)";
+};
+
+//----------------------------------------------------------------- scheduleLoop
+// Implementation notes:
+//  Blocks in the scheduler between deliveries, so an idle server never
+//  wakes for its schedule
+//------------------------------------------------------------------------------
+void server::scheduleLoop()
+{
+	while(!this->m_terminate)
+	{
+		const std::vector<dataMessage> dueMessages =
+			this->m_scheduler.waitForDueMessages();
+
+		for(const dataMessage& currentMessage : dueMessages)
+		{
+			this->postToStateStage(
+				boost::bind(&server::deliverScheduledMessage, this, currentMessage));
+		}
+	}
+};
+
+//------------------------------------------------------ deliverScheduledMessage
+// Implementation notes:
+//  Handled exactly like a send arriving from the client now
+//------------------------------------------------------------------------------
+void server::deliverScheduledMessage(
+	const dataMessage& inMessage)
+{
+	std::cout << "Delivering scheduled message from "
+		<< inMessage.viewSourceIdentifier() << " to "
+		<< inMessage.viewDestinationIdentifier() << std::endl;
+
+	this->processClientSendMessage(
+		inMessage);
+};
+
+//------------------------------------------------------------- deliverBroadcast
+// Implementation notes:
+//  The message is encoded once and shared by every mailbox. The state stage
+//  fills the first shard itself and waits for the shard workers to fill the
+//  rest, so the next message it handles sees the broadcast in every mailbox.
+//  The shard workers are not the task pool, whose niced workers may be busy
+//  flushing or compacting while the state stage waits.
+//------------------------------------------------------------------------------
+void server::deliverBroadcast(
+	const dataMessage& inMessage)
+{
+	dataMessage message(inMessage);
+
+	message.setMessageType(
+		constants::MessageType::mt_SERVER_SEND);
+
+	const std::shared_ptr<const encodedMessage> sharedMessage =
+		this->createMailboxEntry(message);
+
+	// archived once, under the broadcast destination
+	this->m_history.append(
+		constants::broadcastDestination,
+		message);
+
+	std::vector<broadcastRecipient> recipients;
+	recipients.reserve(this->m_connectedClients.size());
+
+	for(std::pair<const std::string, std::vector<remoteConnection>>& currentClient
+		: this->m_connectedClients)
+	{
+		if(currentClient.first == inMessage.viewSourceIdentifier())
+		{
+			// Do nothing, the sender already has its own message
+			continue;
+		}
+
+		broadcastRecipient recipient;
+		recipient.mailbox = &this->m_mailboxes[currentClient.first];
+		recipient.sessions = &currentClient.second;
+
+		recipients.push_back(recipient);
+	}
+
+	std::cout << " (broadcast to " << recipients.size() << " users)";
+
+	// one notice serves every session, clients do not check its destination
+	const std::vector<std::string> pendingFields({
+		"pending=1"});
+
+	const std::vector<char> pendingNotice = dataMessage(
+		message.viewSequenceNumber(),
+		constants::MessageType::mt_SERVER_PENDING,
+		constants::serverIndexToServerName(this->m_index),
+		constants::broadcastDestination,
+		dataMessage::createServerSyncPayload(pendingFields)).asCharVector();
+
+	const size_t shardCount = std::max<size_t>(1, std::min<size_t>(
+		constants::broadcastShardWorkers + 1,
+		recipients.size() / constants::broadcastShardMinimumRecipients));
+
+	const size_t shardLength = (recipients.size() + shardCount - 1) / shardCount;
+
+	boost::latch shardsDone(shardCount - 1);
+
+	for(size_t shard = 1; shard < shardCount; shard++)
+	{
+		this->m_shardPool.submit(boost::bind(
+			&server::fanOutShard,
+			this,
+			boost::cref(recipients),
+			shard * shardLength,
+			std::min(recipients.size(), (shard + 1) * shardLength),
+			boost::cref(sharedMessage),
+			boost::cref(pendingNotice),
+			&shardsDone));
+	}
+
+	this->fanOutShard(
+		recipients,
+		0,
+		std::min(recipients.size(), shardLength),
+		sharedMessage,
+		pendingNotice,
+		nullptr);
+
+	shardsDone.wait();
+};
+
+//------------------------------------------------------------------ fanOutShard
+// Implementation notes:
+//  Shards only touch their own mailboxes. The notices bypass the egress
+//  stage so each shard's batch goes out from the thread that built it. The
+//  latch is counted down however the shard ends, a shard that throws must
+//  not leave the state stage waiting forever.
+//------------------------------------------------------------------------------
+void server::fanOutShard(
+	const std::vector<broadcastRecipient>& inRecipients,
+	const size_t& inBegin,
+	const size_t& inEnd,
+	const std::shared_ptr<const encodedMessage>& inMessage,
+	const std::vector<char>& inPendingNotice,
+	boost::latch* inShardsDone)
+{
+	const shardCompletion completion(
+		inShardsDone);
+
+	std::vector<boost::asio::ip::udp::endpoint> sessionEndpoints;
+	sessionEndpoints.reserve(inEnd - inBegin);
+
+	for(size_t i = inBegin; i < inEnd; i++)
+	{
+		inRecipients[i].mailbox->push_back(
+			inMessage);
+
+		for(const remoteConnection& currentSession : *inRecipients[i].sessions)
+		{
+			sessionEndpoints.push_back(
+				currentSession.viewEndpoint());
+		}
+	}
+
+	this->sendToEndpoints(
+		inPendingNotice,
+		sessionEndpoints);
+};
+
+//---------------------------------------------------- processServerRelayMessage
+// Implementation notes:
+//  Determines if a message relayed from another server has reached
+//  the destination or if it must be relayed further
+//------------------------------------------------------------------------------
+void server::processServerRelayMessage(
+	const dataMessage& inMessage)
+{
+	if(inMessage.viewDestinationIdentifier()
+		== constants::serverIndexToServerName(this->m_index))
+	{
+		this->addToMessageList(
+			inMessage);
+	}
+	else
+	{
+		if(inMessage.viewServerSyncPayloadOriginIndex() < this->m_index)
+		{
+			// forward right
+			if(this->m_rightAdjacentServerConnection != nullptr)
+			{
+				try
+				{
+					this->sendDatagram(
+						inMessage.asCharVector(),
+						this->m_rightAdjacentServerConnection->viewEndpoint());
+				}
+				catch(std::exception& exception)
+				{
+					// std::cout << exception.what() << std::endl;
+				}
+			}
+			else
+			{
+				// programming error, should never make it here
+				assert(false);
+			}
+		}
+		else
+		{
+			// forward left
+			if(this->m_leftAdjacentServerConnection != nullptr)
+			{
+				try
+				{
+					this->sendDatagram(
+						inMessage.asCharVector(),
+						this->m_leftAdjacentServerConnection->viewEndpoint());
+
+				}
+				catch(std::exception& exception)
+				{
+					// std::cout << exception.what() << std::endl;
+				}
+			}
+			else
+			{
+				// programming error, should never make it here
+				assert(false);
+			}
+		}
+	}
+};
+
+//---------------------------------------------------------- listenLoopBluetooth
+// Implementation notes:
+//  Listens and acts via Bluetooth
+//------------------------------------------------------------------------------
+void server::listenLoopBluetooth()
+{
+	while(!this->m_terminate)
+	{
+		// #TODO_MT implement
+	}
+};
+
+//---------------------------------------------------------- listenLoopMulticast
+// Implementation notes:
+//  Only decodes and screens the frames, sequencing and repair happen on the
+//  state stage with everything else it owns. A frame is a sync or load
+//  message of another server, or a batch of a load report followed by the
+//  broadcasts it carries.
+//------------------------------------------------------------------------------
+void server::listenLoopMulticast()
+{
+	std::vector<char> receivedPayload;
+	receivedPayload.reserve(constants::maximumDatagramLength);
+
+	this->m_flightRecorder.nameThread("multicast");
+
+	while(!this->m_terminate)
+	{
+		try
+		{
+			receivedPayload.resize(constants::maximumDatagramLength);
+
+			boost::asio::ip::udp::endpoint senderEndpoint;
+
+			const size_t receivedLength = this->m_multicastSocket.receive_from(
+				boost::asio::buffer(receivedPayload),
+				senderEndpoint);
+
+			receivedPayload.resize(receivedLength);
+
+			const std::vector<dataMessage> frame = dataMessage::isBatch(receivedPayload)
+				? dataMessage::parseBatch(receivedPayload)
+				: std::vector<dataMessage>(1, dataMessage(receivedPayload));
+
+			if(frame.empty())
+			{
+				continue;
+			}
+
+			const int8_t originIndex =
+				frame.front().viewServerSyncPayloadOriginIndex();
+
+			const bool isSyncFrame =
+				(frame.front().viewMessageType() == constants::MessageType::mt_SERVER_SYNC)
+				|| (frame.front().viewMessageType() == constants::MessageType::mt_SERVER_LOAD);
+
+			bool carriesOnlyBroadcasts = true;
+
+			for(size_t i = 1; i < frame.size(); i++)
+			{
+				carriesOnlyBroadcasts = carriesOnlyBroadcasts
+					&& (frame[i].viewMessageType() == constants::MessageType::mt_CLIENT_SEND)
+					&& (frame[i].viewDestinationIdentifier() == constants::broadcastDestination);
+			}
+
+			if(!isSyncFrame
+				|| !carriesOnlyBroadcasts
+				|| (originIndex == this->m_index)
+				|| (originIndex < 0)
+				|| (originIndex > constants::highestServerIndex))
+			{
+				// our own frame looped back, or not a frame of the group
+				continue;
+			}
+
+			this->postToStateStage(boost::bind(
+				&server::receiveMulticastFrame,
+				this,
+				frame,
+				senderEndpoint));
+		}
+		catch(...)
+		{
+
+		}
+	}
+};
+
+//--------------------------------------------------------------- attemptForward
+// Implementation notes:
+//  Asks the state stage to retry the parked messages at the forward interval
+//------------------------------------------------------------------------------
+void server::attemptForward()
+{
+	while(!this->m_terminate)
+	{
+		// the parked messages and the stores belong to the state stage
+		this->postToStateStage(
+			boost::bind(&server::forwardParkedMessages, this));
+
+		this->postToStateStage(
+			boost::bind(&server::flushStoreLogs, this));
+
+		// sleep
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			constants::forwardIntervalMilliseconds));
+	}
+};
+
+//------------------------------------------------------------- sendSyncPayloads
+// Implementation notes:
+//  Sends the sync payloads for this server and all known servers to adjacent
+//  servers if they exists. This is done as one UDP message per server. The
+//  lists are copied on the state stage, this thread only sends the copy.
+//------------------------------------------------------------------------------
+void server::sendSyncPayloads()
+{
+	while(!this->m_terminate)
+	{
+		const std::shared_ptr<syncSnapshot> snapshot(new syncSnapshot());
+		const std::shared_ptr<boost::latch> snapshotTaken(new boost::latch(1));
+
+		// the client lists belong to the state stage, which hands back a copy
+		this->postToStateStage(
+			boost::bind(&server::takeSyncSnapshot, this, snapshot, snapshotTaken));
+
+		// a round the state stage is too busy to copy for is skipped
+		if(snapshotTaken->wait_for(
+			boost::chrono::milliseconds(constants::syncIntervalMilliseconds))
+			== boost::cv_status::no_timeout)
+		{
+			if(this->m_sharedDirectory != nullptr)
+			{
+				this->m_sharedDirectory->writeServerClients(
+					this->m_index,
+					snapshot->clientsByServerIndex[this->m_index]);
+			}
+
+			if(constants::multicastSyncEnabled)
+			{
+				this->sendSyncPayloadMulticast(
+					*snapshot);
+			}
+			else
+			{
+				this->sendSyncPayloadsLeft(
+					*snapshot);
+				this->sendSyncPayloadsRight(
+					*snapshot);
+				this->sendLoadReports();
+			}
+		}
+
+		// sleep
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			constants::syncIntervalMilliseconds));
+	}
+};
+
+//------------------------------------------------------------- takeSyncSnapshot
+// Implementation notes:
+//  The greeting of adjacent servers rides along, the links belong to the
+//  state stage too. The latch is counted down last, once the copy is whole.
+//------------------------------------------------------------------------------
+void server::takeSyncSnapshot(
+	const std::shared_ptr<syncSnapshot>& outSnapshot,
+	const std::shared_ptr<boost::latch>& inTaken)
+{
+	std::vector<std::string> thisServersClients;
+
+	// users whose last session expired are no longer announced
+	this->expireIdleSessions();
+
+	for(const std::pair<const std::string, std::vector<remoteConnection>>& currentClient :
+		this->m_connectedClients)
+	{
+		thisServersClients.push_back(currentClient.first);
+	}
+
+	this->m_clientsServedByServerIndex[this->m_index] =
+		thisServersClients;
+
+	for(int8_t i = 0; i <= constants::highestServerIndex; i++)
+	{
+		outSnapshot->clientsByServerIndex[i] = (i == this->m_index)
+			? thisServersClients
+			: this->clientsServedByServerIndex(i);
+	}
+
+	// the sessions and mailboxes it counts belong here as well
+	this->measureLoad();
+
+	this->greetAdjacentServers();
+
+	inTaken->count_down();
+};
+
+//----------------------------------------------------------- flightRecorderLoop
+// Implementation notes:
+//  Triggers copy the rings themselves, this only moves the copy to disk,
+//  which is too slow for the threads that trigger
+//------------------------------------------------------------------------------
+void server::flightRecorderLoop()
+{
+	while(!this->m_terminate)
+	{
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			constants::flightRecorderCheckMilliseconds));
+
+		const std::string summary =
+			this->m_flightRecorder.writePendingDump();
+
+		if(!summary.empty())
+		{
+			std::cout << summary << std::endl;
+		}
+	}
+};
+
+//--------------------------------------------------------- greetAdjacentServers
+// Implementation notes:
+//  Called every sync round, a lost hello or reply is simply sent again. A
+//  neighbour that shares no capabilities at all keeps being greeted, which
+//  costs one datagram a round.
+//------------------------------------------------------------------------------
+void server::greetAdjacentServers()
+{
+	remoteConnection* adjacentServers[2] = {
+		this->m_leftAdjacentServerConnection,
+		this->m_rightAdjacentServerConnection};
+
+	for(remoteConnection* currentServer : adjacentServers)
+	{
+		if((currentServer != nullptr)
+			&& (currentServer->viewCapabilities() == 0))
+		{
+			this->sendServerHello(
+				*currentServer,
+				false);
+		}
+	}
+};
+
+//-------------------------------------------------------------- sendServerHello
+// Implementation notes:
+//  A reply is marked as one so it is not answered in turn
+//------------------------------------------------------------------------------
+void server::sendServerHello(
+	const remoteConnection& inAdjacentServer,
+	const bool& inIsReply)
+{
+	std::vector<std::string> helloFields({
+		dataMessage::capabilitiesField(constants::localCapabilities)});
+
+	if(inIsReply)
+	{
+		helloFields.push_back("reply=1");
+	}
+
+	const dataMessage helloMessage(
+		this->sequenceNumber(),
+		constants::MessageType::mt_SERVER_HELLO,
+		constants::serverIndexToServerName(this->m_index),
+		inAdjacentServer.viewIdentifier(),
+		dataMessage::createServerSyncPayload(helloFields));
+
+	this->sendDatagram(
+		helloMessage.asCharVector(),
+		inAdjacentServer.viewEndpoint());
+};
+
+//---------------------------------------------------- processServerHelloMessage
+// Implementation notes:
+//  The neighbour is known by name rather than endpoint, since it may send
+//  from another address than the one it was resolved to. A neighbour that
+//  restarted greets again, so a downgrade is noticed as well.
+//------------------------------------------------------------------------------
+void server::processServerHelloMessage(
+	const dataMessage& inMessage)
+{
+	remoteConnection* adjacentServers[2] = {
+		this->m_leftAdjacentServerConnection,
+		this->m_rightAdjacentServerConnection};
+
+	for(remoteConnection* currentServer : adjacentServers)
+	{
+		if((currentServer == nullptr)
+			|| (currentServer->viewIdentifier() != inMessage.viewSourceIdentifier()))
+		{
+			continue;
+		}
+
+		currentServer->setCapabilities(
+			inMessage.viewPayloadCapabilities());
+
+		std::cout << " (capabilities " << currentServer->viewCapabilities() << ")";
+
+		if(inMessage.viewPayloadField("reply").empty())
+		{
+			this->sendServerHello(
+				*currentServer,
+				true);
+		}
+
+		break;
+	}
+};
+
+//---------------------------------------------------------- processAdminMessage
+// Implementation notes:
+//  Admin commands need no session, only a sender on this host, so they
+//  cannot be sent from elsewhere however the port is exposed. The decode
+//  stage drops those received through AF_XDP, whose source address the
+//  kernel never checked. Writing the profile resolves every frame's name,
+//  so it runs on the task pool and the reply goes out once it is done.
+//------------------------------------------------------------------------------
+void server::processAdminMessage(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	if(!inSenderEndpoint.address().is_loopback())
+	{
+		std::cout << " (refused, not sent from this host)";
+		return;
+	}
 
-//---------------------------------------------------- processServerRelayMessage
+	const std::string& command = inMessage.viewPayload();
+
+	std::shared_ptr<std::string> outcome(
+		new std::string());
+
+	if(command == "profile start")
+	{
+		*outcome = this->m_profiler.start(constants::profilerSamplingHertz)
+			? "profiling at " + std::to_string(constants::profilerSamplingHertz) + " Hz"
+			: "the profiler is already running, still writing, or not supported here";
+	}
+	else if(command == "profile stop")
+	{
+		if(this->m_profiler.stop())
+		{
+			std::cout << " (" << command << ")";
+
+			this->offloadTask(
+				boost::bind(&server::writeProfile, this, outcome),
+				boost::bind(&server::sendAdminReply, this, inMessage, inSenderEndpoint, outcome));
+			return;
+		}
+
+		*outcome = "the profiler is not running";
+	}
+	else if(command == "stats")
+	{
+		*outcome = this->viewLatencyStatistics();
+	}
+	else
+	{
+		*outcome = "unknown admin command, use 'stats', 'profile start' or 'profile stop'";
+	}
+
+	std::cout << " (" << command << ")";
+
+	this->sendAdminReply(
+		inMessage,
+		inSenderEndpoint,
+		outcome);
+};
+
+//----------------------------------------------------------------- writeProfile
 // Implementation notes:
-//  Determines if a message relayed from another server has reached
-//  the destination or if it must be relayed further
+//  The file is named after the server, and replaced by every profile
 //------------------------------------------------------------------------------
-void server::processServerRelayMessage(
-	const dataMessage& inMessage)
+void server::writeProfile(
+	const std::shared_ptr<std::string>& outSummary)
 {
-	if(inMessage.viewDestinationIdentifier()
-		== constants::serverIndexToServerName(this->m_index))
+	*outSummary = this->m_profiler.writeFoldedStacks(
+		constants::serverIndexToServerName(this->m_index) + constants::profileFileExtension);
+};
+
+//--------------------------------------------------------------- sendAdminReply
+// Implementation notes:
+//  Echoes the command's sequence number. A profile whose writing threw
+//  leaves its outcome empty.
+//------------------------------------------------------------------------------
+void server::sendAdminReply(
+	const dataMessage& inCommand,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint,
+	const std::shared_ptr<std::string>& inOutcome)
+{
+	const std::string outcome(
+		inOutcome->empty() ? "writing the profile failed" : *inOutcome);
+
+	const dataMessage reply(
+		inCommand.viewSequenceNumber(),
+		constants::MessageType::mt_ADMIN,
+		constants::serverIndexToServerName(this->m_index),
+		inCommand.viewSourceIdentifier(),
+		outcome);
+
+	this->sendDatagram(
+		reply.asCharVector(),
+		inSenderEndpoint);
+};
+
+//--------------------------------------------------------- sendSyncPayloadsLeft
+// Implementation notes:
+//  Sends all known sync payloads to the left adjacent server
+//------------------------------------------------------------------------------
+void server::sendSyncPayloadsLeft(
+	const syncSnapshot& inSnapshot)
+{
+	if((this->m_sharedDirectory != nullptr)
+		&& (this->m_leftAdjacentServerConnection != nullptr)
+		&& this->m_sharedDirectory->serverIsAttached(this->m_leftAdjacentServerIndex))
 	{
-		this->addToMessageList(
-			inMessage);
+		// the adjacent server reads the shared directory directly
+		return;
 	}
-	else
+
+	if(this->m_leftAdjacentServerConnection != nullptr)
 	{
-		if(inMessage.viewServerSyncPayloadOriginIndex() < this->m_index)
+		for(int8_t i = this->m_index; i <= constants::highestServerIndex; i++)
 		{
-			// forward right
-			if(this->m_rightAdjacentServerConnection != nullptr)
+			const std::vector<std::string>& clientList =
+				inSnapshot.clientsByServerIndex[i];
+
+			const size_t clientListSize =
+				clientList.size();
+
+			if(clientListSize == 0)
+			{
+				continue;
+			}
+			else
 			{
 				try
 				{
 					boost::system::error_code ignoredError;
 
+					const dataMessage syncMessageToSend(
+						this->sequenceNumber(),
+						constants::MessageType::mt_SERVER_SYNC,
+						constants::serverIndexToServerName(this->m_index),
+						constants::serverIndexToServerName(this->m_leftAdjacentServerIndex),
+						clientList,
+						i);
+
 					this->m_UDPsocket.send_to(
-						boost::asio::buffer(inMessage.asCharVector()),
-						this->m_rightAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
+						boost::asio::buffer(syncMessageToSend.asCharVector()),
+						this->m_leftAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
 				}
 				catch(std::exception& exception)
 				{
 					// std::cout << exception.what() << std::endl;
 				}
 			}
-			else
-			{
-				// programming error, should never make it here
-				assert(false);
-			}
 		}
-		else
+	}
+	else
+	{
+		// Do nothing
+	}
+};
+
+//--------------------------------------------------------- sendSyncPaylodsRight
+// Implementation notes:
+//  Sends all known sync payloads to the right adjacent server
+//------------------------------------------------------------------------------
+void server::sendSyncPayloadsRight(
+	const syncSnapshot& inSnapshot)
+{
+	if((this->m_sharedDirectory != nullptr)
+		&& (this->m_rightAdjacentServerConnection != nullptr)
+		&& this->m_sharedDirectory->serverIsAttached(this->m_rightAdjacentServerIndex))
+	{
+		// the adjacent server reads the shared directory directly
+		return;
+	}
+
+	if(this->m_rightAdjacentServerConnection != nullptr)
+	{
+		for(int8_t i = this->m_index; i >= 0; i--)
 		{
-			// forward left
-			if(this->m_leftAdjacentServerConnection != nullptr)
+			const std::vector<std::string>& clientList =
+				inSnapshot.clientsByServerIndex[i];
+
+			const size_t clientListSize =
+				clientList.size();
+
+			if(clientListSize == 0)
+			{
+				continue;
+			}
+			else
 			{
 				try
 				{
 					boost::system::error_code ignoredError;
 
+					const dataMessage syncMessageToSend(
+						this->sequenceNumber(),
+						constants::MessageType::mt_SERVER_SYNC,
+						constants::serverIndexToServerName(this->m_index),
+						constants::serverIndexToServerName(this->m_rightAdjacentServerIndex),
+						clientList,
+						i);
+
 					this->m_UDPsocket.send_to(
-						boost::asio::buffer(inMessage.asCharVector()),
-						this->m_leftAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
+						boost::asio::buffer(syncMessageToSend.asCharVector()),
+						this->m_rightAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
+				}
+				catch(std::exception& exception)
+				{
+					// std::cout << exception.what() << std::endl;
+				}
+			}
+		}
+	}
+	else
+	{
+		// Do nothing
+	}
+
+};
+
+//----------------------------------------------------- sendSyncPayloadMulticast
+// Implementation notes:
+//  Publishes this server's own client list and load to the multicast group.
+//  Unlike the chain syncs an empty list is still sent, so other servers
+//  notice when the last client leaves.
+//------------------------------------------------------------------------------
+void server::sendSyncPayloadMulticast(
+	const syncSnapshot& inSnapshot)
+{
+	try
+	{
+		this->publishMulticastFrame({
+			dataMessage(
+				0,
+				constants::MessageType::mt_SERVER_SYNC,
+				constants::serverIndexToServerName(this->m_index),
+				constants::multicastGroupAddress,
+				inSnapshot.clientsByServerIndex[this->m_index],
+				this->m_index)});
+
+		this->publishMulticastFrame({
+			this->createLoadReport(
+				0,
+				this->m_index,
+				constants::multicastGroupAddress)});
+	}
+	catch(std::exception& exception)
+	{
+		// std::cout << exception.what() << std::endl;
+	}
+};
+
+//-------------------------------------------------------- publishMulticastFrame
+// Implementation notes:
+//  The number is taken and the frame sent under the history lock, so the
+//  sync thread and the state stage cannot put frames on the wire out of
+//  sequence order.
+//------------------------------------------------------------------------------
+void server::publishMulticastFrame(
+	const std::vector<dataMessage>& inFrame)
+{
+	std::vector<dataMessage> frame(inFrame);
+
+	boost::lock_guard<boost::mutex> lock(
+		this->m_multicastHistoryMutex);
+
+	frame.front().setSequenceNumber(
+		++this->m_multicastSequenceNumber);
+
+	const std::vector<char> encodedFrame = (frame.size() == 1)
+		? frame.front().asCharVector()
+		: dataMessage::createBatch(frame);
+
+	this->m_multicastHistory.push_back(std::make_pair(
+		this->m_multicastSequenceNumber,
+		encodedFrame));
+
+	if(this->m_multicastHistory.size() > constants::multicastRepairHistoryLength)
+	{
+		this->m_multicastHistory.pop_front();
+	}
+
+	boost::system::error_code ignoredError;
+
+	this->m_multicastSocket.send_to(
+		boost::asio::buffer(encodedFrame),
+		this->m_multicastGroupEndpoint, 0, ignoredError);
+};
+
+//-------------------------------------------------------- resendMulticastFrames
+// Implementation notes:
+//  The NACK payload lists the missing sequence numbers. Frames that already
+//  fell out of the history are skipped, receivers give up on them once
+//  their repair wait is over and the next periodic sync covers them.
+//------------------------------------------------------------------------------
+void server::resendMulticastFrames(
+	const dataMessage& inNackMessage)
+{
+	if(!constants::multicastSyncEnabled)
+	{
+		return;
+	}
+
+	const std::vector<std::string> requestedSequenceNumbers =
+		inNackMessage.viewServerSyncPayload();
+
+	boost::lock_guard<boost::mutex> lock(
+		this->m_multicastHistoryMutex);
+
+	for(const std::string& requested : requestedSequenceNumbers)
+	{
+		const int64_t requestedSequenceNumber = std::stoll(requested);
+
+		for(const std::pair<int64_t, std::vector<char>>& sentFrame : this->m_multicastHistory)
+		{
+			if(sentFrame.first == requestedSequenceNumber)
+			{
+				boost::system::error_code ignoredError;
+
+				this->m_multicastSocket.send_to(
+					boost::asio::buffer(sentFrame.second),
+					this->m_multicastGroupEndpoint, 0, ignoredError);
+				break;
+			}
+		}
+	}
+};
+
+//-------------------------------------------------------- receiveMulticastFrame
+// Implementation notes:
+//  Only the numbers not already asked for are put in a NACK, those between
+//  the newest frame known and this one. A frame far behind anything that
+//  could still be repaired means the origin restarted and numbers its
+//  frames from the start again.
+//------------------------------------------------------------------------------
+void server::receiveMulticastFrame(
+	const std::vector<dataMessage>& inFrame,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	const int8_t originIndex =
+		inFrame.front().viewServerSyncPayloadOriginIndex();
+
+	const int64_t receivedSequenceNumber =
+		inFrame.front().viewSequenceNumber();
+
+	int64_t& highestSequenceNumber =
+		this->m_highestMulticastSequenceNumberByServerIndex[originIndex];
+
+	std::map<int64_t, heldMulticastFrame>& heldFrames =
+		this->m_heldMulticastFramesByServerIndex[originIndex];
+
+	if((highestSequenceNumber == 0)
+		|| (receivedSequenceNumber + constants::multicastRepairHistoryLength
+			< highestSequenceNumber))
+	{
+		// the first frame of the origin, or the origin restarted
+		heldFrames.clear();
+		highestSequenceNumber = receivedSequenceNumber - 1;
+	}
+
+	if((receivedSequenceNumber <= highestSequenceNumber)
+		|| (heldFrames.count(receivedSequenceNumber) != 0))
+	{
+		// a repair another server asked for, which we already have
+		return;
+	}
+
+	const int64_t newestKnownSequenceNumber = heldFrames.empty()
+		? highestSequenceNumber
+		: heldFrames.rbegin()->first;
+
+	if(receivedSequenceNumber > newestKnownSequenceNumber + 1)
+	{
+		std::vector<std::string> missingSequenceNumbers;
+
+		for(int64_t missing = std::max<int64_t>(
+				newestKnownSequenceNumber + 1,
+				receivedSequenceNumber - constants::multicastRepairHistoryLength);
+			missing < receivedSequenceNumber;
+			missing++)
+		{
+			missingSequenceNumbers.push_back(std::to_string(missing));
+		}
+
+		const dataMessage nackMessage(
+			this->sequenceNumber(),
+			constants::MessageType::mt_SERVER_NACK,
+			constants::serverIndexToServerName(this->m_index),
+			constants::serverIndexToServerName(originIndex),
+			missingSequenceNumbers,
+			originIndex);
+
+		this->sendDatagram(
+			nackMessage.asCharVector(),
+			boost::asio::ip::udp::endpoint(
+				inSenderEndpoint.address(),
+				constants::serverListeningPorts[originIndex]));
+	}
+
+	heldMulticastFrame& heldFrame = heldFrames[receivedSequenceNumber];
+	heldFrame.messages = inFrame;
+	heldFrame.arrivedNanoseconds = server::realtimeNanoseconds();
+
+	this->releaseMulticastFrames(
+		originIndex,
+		inSenderEndpoint);
+};
+
+//------------------------------------------------------- releaseMulticastFrames
+// Implementation notes:
+//  The first held frame arrived right after the gap in front of it opened,
+//  so its age is how long the gap has waited. Broadcasts carried by a frame
+//  are delivered here only, the group already reached every other server.
+//------------------------------------------------------------------------------
+void server::releaseMulticastFrames(
+	const int8_t& inOriginIndex,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	int64_t& highestSequenceNumber =
+		this->m_highestMulticastSequenceNumberByServerIndex[inOriginIndex];
+
+	std::map<int64_t, heldMulticastFrame>& heldFrames =
+		this->m_heldMulticastFramesByServerIndex[inOriginIndex];
+
+	const int64_t nowNanoseconds = server::realtimeNanoseconds();
+
+	while(!heldFrames.empty())
+	{
+		const std::map<int64_t, heldMulticastFrame>::iterator nextFrame =
+			heldFrames.begin();
+
+		if((nextFrame->first != highestSequenceNumber + 1)
+			&& (heldFrames.size() < constants::multicastRepairHistoryLength)
+			&& (nowNanoseconds - nextFrame->second.arrivedNanoseconds
+				< int64_t(constants::multicastRepairWaitMilliseconds) * 1000000))
+		{
+			// still waiting on the repair of the gap
+			break;
+		}
+
+		highestSequenceNumber = nextFrame->first;
+
+		for(const dataMessage& currentMessage : nextFrame->second.messages)
+		{
+			if(currentMessage.viewMessageType() == constants::MessageType::mt_CLIENT_SEND)
+			{
+				std::cout << "Received broadcast from " << currentMessage.viewSourceIdentifier()
+					<< " over the multicast group";
+
+				this->deliverBroadcast(
+					currentMessage);
+
+				std::cout << std::endl;
+			}
+			else
+			{
+				this->dispatchMessage(
+					currentMessage,
+					inSenderEndpoint);
+			}
+		}
+
+		heldFrames.erase(nextFrame);
+	}
+};
+
+//--------------------------------------------------------------- sequenceNumber
+// Implementation notes:
+//  Increments the sequence number every time it is used. The state stage
+//  and the sync thread both take numbers, so the increment is atomic and
+//  the number is returned by value.
+//------------------------------------------------------------------------------
+int64_t server::sequenceNumber()
+{
+	return this->m_sequenceNumber.fetch_add(1) + 1;
+};
+
+//------------------------------------------------------------------ measureLoad
+// Implementation notes:
+//  Runs once per sync round on the state stage, which walks the sessions
+//  and mailboxes while nothing changes them. The ingress rate covers the
+//  time since the previous round.
+//------------------------------------------------------------------------------
+void server::measureLoad()
+{
+	const boost::chrono::steady_clock::time_point now =
+		boost::chrono::steady_clock::now();
+
+	int64_t connectedSessions = 0;
+	int64_t queueDepth = this->m_messageListOfUnassociatedClients.size();
+
+	for(const std::pair<const std::string, std::vector<remoteConnection>>& currentClient :
+		this->m_connectedClients)
+	{
+		connectedSessions += currentClient.second.size();
+	}
+
+	for(const std::pair<const std::string, std::list<std::shared_ptr<const encodedMessage>>>& currentMailbox :
+		this->m_mailboxes)
+	{
+		queueDepth += currentMailbox.second.size();
+	}
+
+	const int64_t ingressPacketCount =
+		this->m_ingressPacketCount.load();
+
+	const int64_t elapsedMilliseconds =
+		boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			now - this->m_timeOfLastLoadMeasurement).count();
+
+	boost::lock_guard<boost::mutex> lock(
+		this->m_loadMutex);
+
+	int64_t ingressPacketsPerSecond =
+		this->m_loadByServerIndex[this->m_index].viewIngressPacketsPerSecond();
+
+	// a few packets over a very short window, as on the first round right
+	// after startup, would read as a huge rate
+	if(elapsedMilliseconds >= constants::syncIntervalMilliseconds / 2)
+	{
+		ingressPacketsPerSecond =
+			(ingressPacketCount - this->m_ingressPacketCountAtLastMeasurement) * 1000
+			/ elapsedMilliseconds;
+
+		this->m_ingressPacketCountAtLastMeasurement = ingressPacketCount;
+		this->m_timeOfLastLoadMeasurement = now;
+	}
+
+	this->m_loadByServerIndex[this->m_index] = serverLoad(
+		connectedSessions,
+		ingressPacketsPerSecond,
+		queueDepth);
+
+	this->m_timeOfLoadReportByServerIndex[this->m_index] = now;
+};
+
+//-------------------------------------------------------------- sendLoadReports
+// Implementation notes:
+//  Unlike the client lists these are sent even when the adjacent server
+//  shares the client directory, since the directory holds no load. Stale
+//  reports are not relayed, so a dead server drops out of every table.
+//------------------------------------------------------------------------------
+void server::sendLoadReports()
+{
+	const boost::chrono::steady_clock::time_point now =
+		boost::chrono::steady_clock::now();
+
+	const boost::chrono::milliseconds maximumAge(
+		constants::loadReportMaximumAgeMilliseconds);
+
+	for(int8_t i = 0; i <= constants::highestServerIndex; i++)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(
+				this->m_loadMutex);
 
-				}
-				catch(std::exception& exception)
-				{
-					// std::cout << exception.what() << std::endl;
-				}
+			if(now - this->m_timeOfLoadReportByServerIndex[i] > maximumAge)
+			{
+				continue;
 			}
-			else
+		}
+
+		// reports from the right travel left and vice versa, ours goes both ways
+		const std::vector<remoteConnection*> adjacentServerConnections({
+			(i >= this->m_index) ? this->m_leftAdjacentServerConnection : nullptr,
+			(i <= this->m_index) ? this->m_rightAdjacentServerConnection : nullptr});
+
+		for(remoteConnection* adjacentServerConnection : adjacentServerConnections)
+		{
+			if(adjacentServerConnection == nullptr)
 			{
-				// programming error, should never make it here
-				assert(false);
+				continue;
 			}
+
+			const dataMessage loadMessageToSend(
+				this->createLoadReport(
+					this->sequenceNumber(),
+					i,
+					adjacentServerConnection->viewIdentifier()));
+
+			boost::system::error_code ignoredError;
+
+			this->m_UDPsocket.send_to(
+				boost::asio::buffer(loadMessageToSend.asCharVector()),
+				adjacentServerConnection->viewEndpoint(), 0, ignoredError);
 		}
 	}
 };
 
-//---------------------------------------------------------- listenLoopBluetooth
+//------------------------------------------------------------- createLoadReport
 // Implementation notes:
-//  Listens and acts via Bluetooth
+//  The origin index names the server the report describes, as for syncs
 //------------------------------------------------------------------------------
-void server::listenLoopBluetooth()
+dataMessage server::createLoadReport(
+	const int64_t& inSequenceNumber,
+	const int8_t& inServerIndex,
+	const std::string& inDestination)
 {
-	while(!this->m_terminate)
-	{
-		// #TODO_MT implement
-	}
+	boost::lock_guard<boost::mutex> lock(
+		this->m_loadMutex);
+
+	return dataMessage(
+		inSequenceNumber,
+		constants::MessageType::mt_SERVER_LOAD,
+		constants::serverIndexToServerName(this->m_index),
+		inDestination,
+		this->m_loadByServerIndex[inServerIndex].asPayloadFields(),
+		inServerIndex);
 };
 
-//--------------------------------------------------------------- attemptForward
+//------------------------------------------------------------ receiveServerLoad
 // Implementation notes:
-//  Listens and acts via Bluetooth
+//  A report about this server, relayed back by a neighbour, is ignored
 //------------------------------------------------------------------------------
-void server::attemptForward()
+void server::receiveServerLoad(
+	const dataMessage& inLoadMessage)
 {
-	while(!this->m_terminate)
-	{
-		// handle potential weird behavior with deletions
-		const size_t currentMessageListSize =
-			this->m_messageListOfUnassociatedClients.size();
-
-		for(size_t i = 0; i < currentMessageListSize; i++)
-		{
+	const int8_t originIndex =
+		inLoadMessage.viewServerSyncPayloadOriginIndex();
 
-			const dataMessage messageToCheck =
-				this->m_messageListOfUnassociatedClients.front();
+	if((originIndex < 0)
+		|| (originIndex > constants::highestServerIndex)
+		|| (originIndex == this->m_index))
+	{
+		return;
+	}
 
-			this->m_messageListOfUnassociatedClients.pop_front();
+	boost::lock_guard<boost::mutex> lock(
+		this->m_loadMutex);
 
-			this->processClientSendMessage(
-				messageToCheck);
-		}
+	this->m_loadByServerIndex[originIndex] = serverLoad(
+		inLoadMessage);
 
-		// sleep
-		boost::this_thread::sleep(
-			boost::posix_time::millisec(
-			constants::forwardIntervalMilliseconds));
-	}
+	this->m_timeOfLoadReportByServerIndex[originIndex] =
+		boost::chrono::steady_clock::now();
 };
 
-//------------------------------------------------------------- sendSyncPayloads
+//----------------------------------------------------------- findRedirectTarget
 // Implementation notes:
-//  Sends the sync payloads for this server and all known servers to adjacent
-//  servers if they exists. This is done as one UDP message per server.
+//  This server's own load counts the clients as of the last sync round, so
+//  a burst of connects is spread out one sync interval late at worst
 //------------------------------------------------------------------------------
-void server::sendSyncPayloads()
+int8_t server::findRedirectTarget()
 {
-	while(!this->m_terminate)
-	{
-		std::vector<std::string> thisServersClients;
+	const boost::chrono::steady_clock::time_point now =
+		boost::chrono::steady_clock::now();
+
+	const boost::chrono::milliseconds maximumAge(
+		constants::loadReportMaximumAgeMilliseconds);
+
+	boost::lock_guard<boost::mutex> lock(
+		this->m_loadMutex);
+
+	int8_t lightestIndex = -1;
+	int64_t lightestScore = 0;
 
-		for(const remoteConnection& currentClient : this->m_connectedClients)
+	for(int8_t i = 0; i <= constants::highestServerIndex; i++)
+	{
+		if((i == this->m_index)
+			|| (now - this->m_timeOfLoadReportByServerIndex[i] > maximumAge))
 		{
-			thisServersClients.push_back(currentClient.viewIdentifier());
+			continue;
 		}
 
-		this->m_clientsServedByServerIndex[this->m_index] =
-			thisServersClients;
+		const int64_t score =
+			this->m_loadByServerIndex[i].score();
 
-		this->sendSyncPayloadsLeft();
-		this->sendSyncPayloadsRight();
+		if((lightestIndex < 0) || (score < lightestScore))
+		{
+			lightestIndex = i;
+			lightestScore = score;
+		}
+	}
 
-		// sleep
-		boost::this_thread::sleep(
-			boost::posix_time::millisec(
-			constants::syncIntervalMilliseconds));
+	if((lightestIndex >= 0)
+		&& (this->m_loadByServerIndex[this->m_index].score()
+			> lightestScore + constants::redirectLoadMargin))
+	{
+		return lightestIndex;
 	}
+
+	return -1;
 };
 
-//--------------------------------------------------------- sendSyncPayloadsLeft
+//------------------------------------------------- sendClientsToAdjacentServers
 // Implementation notes:
-//  Sends all known sync payloads to the left adjacent server
+//  Receives the list of clients from an adjacent server and stores them.
 //------------------------------------------------------------------------------
-void server::sendSyncPayloadsLeft()
+void server::receiveClientsFromAdjacentServers(
+	const dataMessage& inSyncMessage)
 {
-	if(this->m_leftAdjacentServerConnection != nullptr)
-	{
-		for(int8_t i = this->m_index; i <= constants::highestServerIndex; i++)
-		{
-			const size_t clientListSize =
-				this->m_clientsServedByServerIndex[i].size();
-
-			if(clientListSize == 0)
-			{
-				continue;
-			}
-			else
-			{
-				try
-				{
-					boost::system::error_code ignoredError;
+	const int8_t originIndex =
+		inSyncMessage.viewServerSyncPayloadOriginIndex();
 
-					const dataMessage syncMessageToSend(
-						this->sequenceNumber(),
-						constants::MessageType::mt_SERVER_SYNC,
-						constants::serverIndexToServerName(this->m_index),
-						constants::serverIndexToServerName(this->m_leftAdjacentServerIndex),
-						this->m_clientsServedByServerIndex[i],
-						i);
+	this->m_flightRecorder.record(
+		flightRecorder::ek_SYNC,
+		inSyncMessage.viewMessageType(),
+		static_cast<uint32_t>(inSyncMessage.viewServerSyncPayload().size()),
+		static_cast<uint64_t>(originIndex),
+		server::realtimeNanoseconds());
 
-					this->m_UDPsocket.send_to(
-						boost::asio::buffer(syncMessageToSend.asCharVector()),
-						this->m_leftAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
-				}
-				catch(std::exception& exception)
-				{
-					// std::cout << exception.what() << std::endl;
-				}
-			}
+	if(this->m_sharedDirectory != nullptr)
+	{
+		if(!this->m_sharedDirectory->serverIsAttached(originIndex))
+		{
+			// servers on this host keep their own slot current
+			this->m_sharedDirectory->writeServerClients(
+				originIndex,
+				inSyncMessage.viewServerSyncPayload());
 		}
 	}
 	else
 	{
-		// Do nothing
+		this->m_clientsServedByServerIndex[originIndex] =
+			inSyncMessage.viewServerSyncPayload();
 	}
 };
 
-//--------------------------------------------------------- sendSyncPaylodsRight
+//------------------------------------------------------ serverIndexServesClient
 // Implementation notes:
-//  Sends all known sync payloads to the right adjacent server
+//  The shared directory is searched in place, so routing a message does not
+//  copy any client list.
 //------------------------------------------------------------------------------
-void server::sendSyncPayloadsRight()
+bool server::serverIndexServesClient(
+	const int8_t& inServerIndex,
+	const std::string& inClientIdentifier) const
 {
-	if(this->m_rightAdjacentServerConnection != nullptr)
+	if(this->m_sharedDirectory != nullptr)
 	{
-		for(int8_t i = this->m_index; i >= 0; i--)
-		{
-			const size_t clientListSize =
-				this->m_clientsServedByServerIndex[i].size();
-
-			if(clientListSize == 0)
-			{
-				continue;
-			}
-			else
-			{
-				try
-				{
-					boost::system::error_code ignoredError;
-
-					const dataMessage syncMessageToSend(
-						this->sequenceNumber(),
-						constants::MessageType::mt_SERVER_SYNC,
-						constants::serverIndexToServerName(this->m_index),
-						constants::serverIndexToServerName(this->m_rightAdjacentServerIndex),
-						this->m_clientsServedByServerIndex[i],
-						i);
-
-					this->m_UDPsocket.send_to(
-						boost::asio::buffer(syncMessageToSend.asCharVector()),
-						this->m_rightAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
-				}
-				catch(std::exception& exception)
-				{
-					// std::cout << exception.what() << std::endl;
-				}
-			}
-		}
+		return this->m_sharedDirectory->servesClient(
+			inServerIndex,
+			inClientIdentifier);
 	}
-	else
+
+	for(const std::string& currentClient : this->m_clientsServedByServerIndex[inServerIndex])
 	{
-		// Do nothing
+		if(currentClient == inClientIdentifier)
+		{
+			return true;
+		}
 	}
 
+	return false;
 };
 
-//--------------------------------------------------------------- sequenceNumber
+//--------------------------------------------------- clientsServedByServerIndex
 // Implementation notes:
-//  Increments the sequence number every time it is used, self explanatory.
+//  Returns a copy so callers never hold on to a shared slot
 //------------------------------------------------------------------------------
-const int64_t& server::sequenceNumber()
+std::vector<std::string> server::clientsServedByServerIndex(
+	const int8_t& inServerIndex) const
 {
-	return ++this->m_sequenceNumber;
+	if(this->m_sharedDirectory != nullptr)
+	{
+		return this->m_sharedDirectory->readServerClients(
+			inServerIndex);
+	}
+
+	return this->m_clientsServedByServerIndex[inServerIndex];
 };
 
-//------------------------------------------------- sendClientsToAdjacentServers
+//------------------------------------------------------------ findClientSession
 // Implementation notes:
-//  Receives the list of clients from an adjacent server and stores them.
+//  A connect carrying the resume token of an existing session (a client
+//  failing back over, or whose address changed) continues that session, as
+//  does a connect from an endpoint that already has one
 //------------------------------------------------------------------------------
-void server::receiveClientsFromAdjacentServers(
-	const dataMessage& inSyncMessage)
+remoteConnection* server::findClientSession(
+	const std::string& inClientUsername,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint,
+	const std::string& inResumeToken)
 {
-	this->m_clientsServedByServerIndex[inSyncMessage.viewServerSyncPayloadOriginIndex()] =
-		inSyncMessage.viewServerSyncPayload();
+	std::map<std::string, std::vector<remoteConnection>>::iterator sessions =
+		this->m_connectedClients.find(inClientUsername);
+
+	if(sessions == this->m_connectedClients.end())
+	{
+		return nullptr;
+	}
+
+	for(remoteConnection& currentSession : sessions->second)
+	{
+		const bool resumesSession = !inResumeToken.empty()
+			&& (currentSession.viewResumeToken() == inResumeToken);
+
+		if(resumesSession || (currentSession.viewEndpoint() == inClientEndpoint))
+		{
+			return &currentSession;
+		}
+	}
+
+	return nullptr;
 };
 
 //---------------------------------------------------------- addClientConnection
 // Implementation notes:
-//  Adds a new client connection to the connections list
+//  Adds a new session for the client. A user may hold several sessions, one
+//  per device. A continued session is moved to the new endpoint and keeps
+//  its acknowledgements, but takes the capabilities of the connect, since
+//  the client may have been upgraded in between.
 //------------------------------------------------------------------------------
 void server::addClientConnection(
 	const std::string& inClientUsername,
-	const boost::asio::ip::udp::endpoint& inClientEndpoint)
+	const boost::asio::ip::udp::endpoint& inClientEndpoint,
+	const std::string& inResumeToken,
+	const uint32_t& inCapabilities)
 {
-	this->m_connectedClients.push_back(
-		remoteConnection(inClientUsername, inClientEndpoint));
+	remoteConnection* existingSession = this->findClientSession(
+		inClientUsername,
+		inClientEndpoint,
+		inResumeToken);
+
+	if(existingSession != nullptr)
+	{
+		existingSession->setEndpoint(inClientEndpoint);
+		existingSession->setResumeToken(inResumeToken);
+		existingSession->setCapabilities(inCapabilities);
+		existingSession->refreshTimeOfLastActivity();
+		return;
+	}
+
+	remoteConnection newSession(
+		inClientUsername,
+		inClientEndpoint);
+
+	newSession.setResumeToken(inResumeToken);
+	newSession.setCapabilities(inCapabilities);
+
+	this->m_connectedClients[inClientUsername].push_back(newSession);
 };
 
 //------------------------------------------------------- removeClientConnection
 // Implementation notes:
-//  Remove the matching client connection from the connections list
+//  Removes only the session that disconnected. Messages the remaining
+//  sessions have all acknowledged can then be dropped.
 //------------------------------------------------------------------------------
 void server::removeClientConnection(
-	const std::string& inClientUsername)
+	const std::string& inClientUsername,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint)
 {
-	for(std::vector<remoteConnection>::iterator it = this->m_connectedClients.begin();
-		it != this->m_connectedClients.end();
+	std::map<std::string, std::vector<remoteConnection>>::iterator sessions =
+		this->m_connectedClients.find(inClientUsername);
+
+	if(sessions == this->m_connectedClients.end())
+	{
+		return;
+	}
+
+	for(std::vector<remoteConnection>::iterator it = sessions->second.begin();
+		it != sessions->second.end();
 		it++)
 	{
-		if(it->viewIdentifier() == inClientUsername)
+		if(it->viewEndpoint() == inClientEndpoint)
 		{
-			this->m_connectedClients.erase(it);
+			sessions->second.erase(it);
+			break;
 		}
-		break;
 	}
+
+	if(sessions->second.empty())
+	{
+		this->m_connectedClients.erase(sessions);
+	}
+	else
+	{
+		this->removeFullyAcknowledgedMessages(
+			inClientUsername);
+	}
+};
+
+//----------------------------------------------------------- expireIdleSessions
+// Implementation notes:
+//  Unlike a user who disconnected, a user whose last session expired loses
+//  their mailbox, which that session is taken to have acknowledged
+//------------------------------------------------------------------------------
+void server::expireIdleSessions()
+{
+	const boost::chrono::system_clock::time_point expiredBefore =
+		boost::chrono::system_clock::now()
+		- boost::chrono::milliseconds(constants::sessionExpiryMilliseconds);
+
+	std::map<std::string, std::vector<remoteConnection>>::iterator sessions =
+		this->m_connectedClients.begin();
+
+	while(sessions != this->m_connectedClients.end())
+	{
+		const size_t sessionCount = sessions->second.size();
+
+		std::vector<remoteConnection>::iterator it = sessions->second.begin();
+
+		while(it != sessions->second.end())
+		{
+			if(it->viewTimeOfLastActivity() < expiredBefore)
+			{
+				std::cout << "Expired a session of " << sessions->first << std::endl;
+				it = sessions->second.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+
+		if(sessions->second.empty())
+		{
+			this->m_mailboxes.erase(sessions->first);
+			sessions = this->m_connectedClients.erase(sessions);
+		}
+		else
+		{
+			if(sessions->second.size() < sessionCount)
+			{
+				this->removeFullyAcknowledgedMessages(
+					sessions->first);
+			}
+
+			sessions++;
+		}
+	}
+};
+
+//--------------------------------------------------------- countPendingMessages
+// Implementation notes:
+//  Counts the mailbox entries the session has not acknowledged, zero for an
+//  unknown session
+//------------------------------------------------------------------------------
+int64_t server::countPendingMessages(
+	const std::string& inClientIdentifier,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint)
+{
+	std::map<std::string, std::list<std::shared_ptr<const encodedMessage>>>::iterator mailbox =
+		this->m_mailboxes.find(inClientIdentifier);
+
+	remoteConnection* session = this->findClientSession(
+		inClientIdentifier,
+		inClientEndpoint,
+		"");
+
+	if((session == nullptr) || (mailbox == this->m_mailboxes.end()))
+	{
+		return 0;
+	}
+
+	int64_t pendingMessages = 0;
+
+	for(const std::shared_ptr<const encodedMessage>& currentMessage : mailbox->second)
+	{
+		if(!session->hasAcknowledged(
+			currentMessage->viewMessage().viewSequenceNumber()))
+		{
+			pendingMessages++;
+		}
+	}
+
+	return pendingMessages;
+};
+
+//------------------------------------------------------------------ replyToPing
+// Implementation notes:
+//  Echoes the sequence number so the client can match the reply to its ping
+//  and measure the round trip time. The load is the one last measured. The
+//  pending count lets an idle client poll only when there is something to
+//  get. The cookie keeps the client's cookie for every server current, and
+//  the capabilities let a client find out this server was upgraded. A ping
+//  keeps the session of its sender alive.
+//------------------------------------------------------------------------------
+void server::replyToPing(
+	const dataMessage& inPingMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	std::vector<std::string> loadFields;
+
+	{
+		boost::lock_guard<boost::mutex> lock(
+			this->m_loadMutex);
+
+		loadFields = this->m_loadByServerIndex[this->m_index].asPayloadFields();
+	}
+
+	remoteConnection* session = this->findClientSession(
+		inPingMessage.viewSourceIdentifier(),
+		inSenderEndpoint,
+		"");
+
+	if(session != nullptr)
+	{
+		session->refreshTimeOfLastActivity();
+	}
+
+	loadFields.push_back("pending=" + std::to_string(
+		this->countPendingMessages(
+			inPingMessage.viewSourceIdentifier(),
+			inSenderEndpoint)));
+
+	loadFields.push_back("cookie=" +
+		this->m_cookies.createCookie(inSenderEndpoint));
+
+	loadFields.push_back(
+		dataMessage::capabilitiesField(constants::localCapabilities));
+
+	const dataMessage pingReply(
+		inPingMessage.viewSequenceNumber(),
+		constants::MessageType::mt_PING,
+		constants::serverIndexToServerName(this->m_index),
+		inPingMessage.viewSourceIdentifier(),
+		dataMessage::createServerSyncPayload(loadFields));
+
+	this->sendDatagram(
+		pingReply.asCharVector(),
+		inSenderEndpoint);
 };
 
 //------------------------------------------------------------- addToMessageList
 // Implementation notes:
-//  Add a new message to the message list
+//  Encodes the message once and adds it to the destination's mailbox
 //------------------------------------------------------------------------------
 void server::addToMessageList(
 	dataMessage message)
@@ -723,13 +4225,33 @@ void server::addToMessageList(
 	message.setMessageType(
 		constants::MessageType::mt_SERVER_SEND);
 
-	this->m_messageList.push_back(
+	this->m_history.append(
+		message.viewDestinationIdentifier(),
 		message);
+
+	this->m_mailboxes[message.viewDestinationIdentifier()].push_back(
+		this->createMailboxEntry(message));
+};
+
+//----------------------------------------------------------- createMailboxEntry
+// Implementation notes:
+//  A broadcast shares one entry, and so one id, across every mailbox. Ids
+//  still rise along each mailbox, since an entry is added to every mailbox
+//  it goes to before the next is created.
+//------------------------------------------------------------------------------
+std::shared_ptr<const encodedMessage> server::createMailboxEntry(
+	dataMessage message)
+{
+	message.setSequenceNumber(
+		++this->m_lastMailboxEntry);
+
+	return std::make_shared<const encodedMessage>(message);
 };
 
 //---------------------------------------- addToMessageListOfUnassociatedClients
 // Implementation notes:
-//  Add a new message to the message list of unassociated clients
+//  The list is keyed like the offline store, by destination and time, so
+//  messages for one client are retried in the order they were parked
 //------------------------------------------------------------------------------
 void server::addToMessageListOfUnassociatedClients(
 	dataMessage message)
@@ -737,6 +4259,19 @@ void server::addToMessageListOfUnassociatedClients(
 	message.setMessageType(
 		constants::MessageType::mt_CLIENT_SEND);
 
-	this->m_messageListOfUnassociatedClients.push_back(
-		message);
+	const std::string key(lsmStore::timeOrderedKey(
+		message.viewDestinationIdentifier(),
+		messageScheduler::currentTimeMilliseconds(),
+		this->m_parkedSequenceNumber++));
+
+	const std::vector<char> encodedMessage(
+		message.asCharVector());
+
+	this->m_offlineMailboxes.put(
+		key,
+		std::string(encodedMessage.begin(), encodedMessage.end()));
+
+	this->m_messageListOfUnassociatedClients.insert(std::make_pair(
+		key,
+		message));
 };
\ No newline at end of file
@@ -3,17 +3,42 @@
 // Boost
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/latch.hpp>
 
 // STL
 #include <vector>
 #include <list>
+#include <map>
+#include <memory>
+#include <deque>
 #include <string>
 #include <utility>
 #include <cstdint>
+#include <atomic>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
 
 // Project
 #include "../Common/remoteConnection.h"
 #include "../Common/dataMessage.h"
+#include "../Common/encodedMessage.h"
+#include "../Common/serverLoad.h"
+#include "sharedClientDirectory.h"
+#include "endpointCookie.h"
+#include "pipelineStage.h"
+#include "taskPool.h"
+#include "messageScheduler.h"
+#include "messageHistory.h"
+#include "lsmStore.h"
+#include "sampleProfiler.h"
+#include "latencyHistogram.h"
+#include "flightRecorder.h"
+#include "xdpSocket.h"
 
 class server
 {
@@ -30,11 +55,13 @@ public:
 	// Parameter: const uint16_t& inListeningPort
 	// Parameter: const int8_t& inServerIndex
 	// Parameter: boost::asio::io_service& ioService
+	// Parameter: const uint16_t& inDecodeWorkers
 	//--------------------------------------------------------------------------
 	server(
 		const uint16_t& inListeningPort,
 		const int8_t& inServerIndex,
-		boost::asio::io_service& ioService);
+		boost::asio::io_service& ioService,
+		const uint16_t& inDecodeWorkers);
 
 	//--------------------------------------------------------------- destructor
 	// Brief Description
@@ -59,12 +86,145 @@ public:
 	//--------------------------------------------------------------------------
 	void run();
 
+	//------------------------------------------------------- viewPipelineStages
+	// Brief Description
+	//  Returns the statistics of every stage of the UDP pipeline, in the
+	//  order datagrams pass through them.
+	//
+	// Method:    viewPipelineStages
+	// FullName:  server::viewPipelineStages
+	// Access:    public 
+	// Returns:   std::vector<const pipelineStage*>
+	//--------------------------------------------------------------------------
+	std::vector<const pipelineStage*> viewPipelineStages() const;
+
+	//---------------------------------------------------- viewLatencyStatistics
+	// Brief Description
+	//  Returns, for every message type received so far, how long its
+	//  datagrams waited from the kernel receiving them until they were
+	//  dispatched, and how long the replies to it took from the dispatch
+	//  until they were sent, one line per type.
+	//
+	// Method:    viewLatencyStatistics
+	// FullName:  server::viewLatencyStatistics
+	// Access:    public 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string viewLatencyStatistics() const;
+
+	//--------------------------------------------------------------------- stop
+	// Brief Description
+	//  Makes every loop of the server finish, after which run returns and the
+	//  server can be destroyed. Lets a benchmark run several servers one
+	//  after another in the same process.
+	//
+	// Method:    stop
+	// FullName:  server::stop
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void stop();
+
 private:
 
+	// A datagram on its way through the UDP pipeline. The receive stage
+	// fills in the payload, which the decode stage replaces with the
+	// messages, noting if they came as a compressed handoff from another
+	// server. On the way out only the payload is used.
+	struct pipelineDatagram
+	{
+		std::vector<char> payload;
+		std::vector<dataMessage> messages;
+		boost::asio::ip::udp::endpoint endpoint;
+		bool handoff;
+
+		// received through AF_XDP, where the kernel never checked the
+		// source address
+		bool bypassedKernel;
+
+		// when the kernel received a datagram, or when the state stage
+		// dispatched the message a reply answers and its type, on the
+		// realtime clock in nanoseconds, zero if unknown
+		int64_t receivedNanoseconds;
+		int64_t dispatchedNanoseconds;
+		constants::MessageType dispatchedType;
+	};
+
+	typedef std::vector<pipelineDatagram> pipelineBatch;
+	typedef boost::lockfree::spsc_queue<pipelineBatch*> pipelineRing;
+
+	// Lets a stage sleep while its input is empty. The stage marks itself
+	// sleeping before its last look at the input, and whoever adds to the
+	// input wakes it only if it is marked.
+	struct stageWakeup
+	{
+		stageWakeup() :
+			sleeping(false)
+		{
+
+		};
+
+		boost::mutex mutex;
+		boost::condition_variable condition;
+		std::atomic<bool> sleeping;
+	};
+
+	// Where a message goes: the local mailbox, and the servers to either side.
+	struct messageRoute
+	{
+		bool local;
+		bool left;
+		bool right;
+	};
+
+	// The client lists of every server, copied on the state stage for the
+	// sync thread to send
+	struct syncSnapshot
+	{
+		std::vector<std::string> clientsByServerIndex[constants::numberOfServers];
+	};
+
+	// A multicast frame held back until the frames before it arrive. The
+	// first message carries the frame's sequence number.
+	struct heldMulticastFrame
+	{
+		std::vector<dataMessage> messages;
+		int64_t arrivedNanoseconds;
+	};
+
+	// Counts the latch of a broadcast's shards down when a shard ends, by
+	// returning or by throwing
+	struct shardCompletion
+	{
+		explicit shardCompletion(
+			boost::latch* inShardsDone) :
+			shardsDone(inShardsDone)
+		{
+		}
+
+		~shardCompletion()
+		{
+			if(this->shardsDone != nullptr)
+			{
+				this->shardsDone->count_down();
+			}
+		}
+
+		boost::latch* shardsDone;
+	};
+
+	// A user a broadcast is delivered to. The mailbox is created before the
+	// fan-out starts, so shards never change the mailbox map itself.
+	struct broadcastRecipient
+	{
+		std::list<std::shared_ptr<const encodedMessage>>* mailbox;
+		const std::vector<remoteConnection>* sessions;
+	};
+
 	//------------------------------------------------------------ listenLoopUDP
 	// Brief Description
-	//  The server's listening loop for UDP. It receives messages from clients
-	//  over UDP and acts accordingly.
+	//  The server's listening loop for UDP. It receives datagrams from
+	//  clients and servers in batches and hands them to the decode workers.
 	//
 	// Method:    listenLoopUDP
 	// FullName:  server::listenLoopUDP
@@ -73,36 +233,569 @@ private:
 	//--------------------------------------------------------------------------
 	void listenLoopUDP();
 
+#ifdef __linux__
+	//------------------------------------------------------------ listenLoopXDP
+	// Brief Description
+	//  The server's listening loop while an AF_XDP socket is open. It waits
+	//  on that socket and on the UDP socket, which still gets whatever the
+	//  XDP program passes to the kernel, and hands what arrives on either
+	//  to the decode workers in batches, as listenLoopUDP does.
+	//
+	// Method:    listenLoopXDP
+	// FullName:  server::listenLoopXDP
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void listenLoopXDP();
+#endif
+
+	//------------------------------------------------------------ batchDatagram
+	// Brief Description
+	//  Adds a received datagram to the batch for the decode worker of its
+	//  sender, starting the batch if there is none yet. Datagrams from the
+	//  AF_XDP socket are marked as having bypassed the kernel.
+	//
+	// Method:    batchDatagram
+	// FullName:  server::batchDatagram
+	// Access:    private 
+	// Returns:   void
+	// Parameter: std::vector<pipelineBatch*>& ioBatchByWorker
+	// Parameter: const std::vector<char>& inBuffer
+	// Parameter: const size_t& inLength
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	// Parameter: const int64_t& inReceivedNanoseconds
+	// Parameter: const bool& inBypassedKernel
+	//--------------------------------------------------------------------------
+	void batchDatagram(
+		std::vector<pipelineBatch*>& ioBatchByWorker,
+		const std::vector<char>& inBuffer,
+		const size_t& inLength,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint,
+		const int64_t& inReceivedNanoseconds,
+		const bool& inBypassedKernel);
+
+	//-------------------------------------------------------------- pushBatches
+	// Brief Description
+	//  Hands every started batch to the ring of its decode worker.
+	//
+	// Method:    pushBatches
+	// FullName:  server::pushBatches
+	// Access:    private 
+	// Returns:   void
+	// Parameter: std::vector<pipelineBatch*>& ioBatchByWorker
+	//--------------------------------------------------------------------------
+	void pushBatches(
+		std::vector<pipelineBatch*>& ioBatchByWorker);
+
+	//---------------------------------------------------------- receiveDatagram
+	// Brief Description
+	//  Blocks until a datagram arrives on the UDP socket and returns its
+	//  length, with the sender and the time the kernel received it.
+	//
+	// Method:    receiveDatagram
+	// FullName:  server::receiveDatagram
+	// Access:    private 
+	// Returns:   size_t
+	// Parameter: std::vector<char>& outBuffer
+	// Parameter: boost::asio::ip::udp::endpoint& outSenderEndpoint
+	// Parameter: int64_t& outReceivedNanoseconds
+	// Parameter: boost::system::error_code& outError
+	//--------------------------------------------------------------------------
+	size_t receiveDatagram(
+		std::vector<char>& outBuffer,
+		boost::asio::ip::udp::endpoint& outSenderEndpoint,
+		int64_t& outReceivedNanoseconds,
+		boost::system::error_code& outError);
+
+	//------------------------------------------------------ realtimeNanoseconds
+	// Brief Description
+	//  Returns the time on the clock the kernel stamps datagrams with.
+	//
+	// Method:    realtimeNanoseconds
+	// FullName:  server::realtimeNanoseconds
+	// Access:    private static
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	static int64_t realtimeNanoseconds();
+
+	//--------------------------------------------------------------- decodeLoop
+	// Brief Description
+	//  Loop of one decode worker. It decodes the datagrams of each batch it
+	//  is handed, which hold either a single message or a batch of them, and
+	//  passes the batch on to the state stage.
+	//
+	// Method:    decodeLoop
+	// FullName:  server::decodeLoop
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const uint16_t& inWorkerIndex
+	//--------------------------------------------------------------------------
+	void decodeLoop(
+		const uint16_t& inWorkerIndex);
+
+	//---------------------------------------------------------------- stateLoop
+	// Brief Description
+	//  Loop of the state stage. It acts on the decoded datagrams of every
+	//  decode worker, and queues the replies for the egress stage.
+	//
+	// Method:    stateLoop
+	// FullName:  server::stateLoop
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void stateLoop();
+
+	//--------------------------------------------------------------- egressLoop
+	// Brief Description
+	//  Loop of the egress stage. It sends the batches of replies queued by
+	//  the state stage.
+	//
+	// Method:    egressLoop
+	// FullName:  server::egressLoop
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void egressLoop();
+
+	//---------------------------------------------------------------- sendBatch
+	// Brief Description
+	//  Sends every datagram of the batch from the UDP socket, or through the
+	//  AF_XDP socket to senders it received from.
+	//
+	// Method:    sendBatch
+	// FullName:  server::sendBatch
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const pipelineBatch& inBatch
+	//--------------------------------------------------------------------------
+	void sendBatch(
+		const pipelineBatch& inBatch);
+
+	//---------------------------------------------------------- sendToEndpoints
+	// Brief Description
+	//  Sends the same datagram to every destination from the UDP socket.
+	//
+	// Method:    sendToEndpoints
+	// FullName:  server::sendToEndpoints
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<char>& inDatagram
+	// Parameter: const std::vector<boost::asio::ip::udp::endpoint>& inDestinations
+	//--------------------------------------------------------------------------
+	void sendToEndpoints(
+		const std::vector<char>& inDatagram,
+		const std::vector<boost::asio::ip::udp::endpoint>& inDestinations);
+
+#ifdef __linux__
+	//-------------------------------------------------------------- sendHeaders
+	// Brief Description
+	//  Sends the prepared datagrams from the UDP socket with sendmmsg.
+	//
+	// Method:    sendHeaders
+	// FullName:  server::sendHeaders
+	// Access:    private 
+	// Returns:   void
+	// Parameter: std::vector<mmsghdr>& ioHeaders
+	//--------------------------------------------------------------------------
+	void sendHeaders(
+		std::vector<mmsghdr>& ioHeaders);
+#endif
+
+	//------------------------------------------------------------- sendDatagram
+	// Brief Description
+	//  Sends a datagram from the UDP socket. Called from the state stage, the
+	//  datagram is queued and sent by the egress stage with the rest of the
+	//  replies to the same batch.
+	//
+	// Method:    sendDatagram
+	// FullName:  server::sendDatagram
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<char>& inDatagram
+	// Parameter: const boost::asio::ip::udp::endpoint& inDestination
+	//--------------------------------------------------------------------------
+	void sendDatagram(
+		const std::vector<char>& inDatagram,
+		const boost::asio::ip::udp::endpoint& inDestination);
+
+	//--------------------------------------------------------------- pushToRing
+	// Brief Description
+	//  Hands a batch to the next stage, waiting while its ring is full, and
+	//  wakes the stage if it sleeps. Returns the number of batches on the
+	//  ring once it is pushed.
+	//
+	// Method:    pushToRing
+	// FullName:  server::pushToRing
+	// Access:    private static 
+	// Returns:   size_t
+	// Parameter: pipelineRing& inRing
+	// Parameter: pipelineBatch* inBatch
+	// Parameter: stageWakeup& ioWakeup
+	//--------------------------------------------------------------------------
+	static size_t pushToRing(
+		pipelineRing& inRing,
+		pipelineBatch* inBatch,
+		stageWakeup& ioWakeup);
+
+	//---------------------------------------------------------------- wakeStage
+	// Brief Description
+	//  Wakes the stage if it sleeps. Called after adding to its input.
+	//
+	// Method:    wakeStage
+	// FullName:  server::wakeStage
+	// Access:    private static 
+	// Returns:   void
+	// Parameter: stageWakeup& ioWakeup
+	//--------------------------------------------------------------------------
+	static void wakeStage(
+		stageWakeup& ioWakeup);
+
+	//------------------------------------------------------------- waitForInput
+	// Brief Description
+	//  Returns once one of the rings or, for the state stage, the queue of
+	//  completions has something, or the server stops. Spins for a short
+	//  while first, then sleeps until a producer wakes the stage.
+	//
+	// Method:    waitForInput
+	// FullName:  server::waitForInput
+	// Access:    private 
+	// Returns:   void
+	// Parameter: stageWakeup& ioWakeup
+	// Parameter: const std::vector<pipelineRing*>& inRings
+	// Parameter: const bool& inWithCompletions
+	//--------------------------------------------------------------------------
+	void waitForInput(
+		stageWakeup& ioWakeup,
+		const std::vector<pipelineRing*>& inRings,
+		const bool& inWithCompletions);
+
+	//----------------------------------------------------------------- hasInput
+	// Brief Description
+	//  Determines if one of the rings or, if asked, the queue of
+	//  completions has something.
+	//
+	// Method:    hasInput
+	// FullName:  server::hasInput
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const std::vector<pipelineRing*>& inRings
+	// Parameter: const bool& inWithCompletions
+	//--------------------------------------------------------------------------
+	bool hasInput(
+		const std::vector<pipelineRing*>& inRings,
+		const bool& inWithCompletions);
+
+	//--------------------------------------------------------------- deleteRing
+	// Brief Description
+	//  Deletes a ring and the batches left in it.
+	//
+	// Method:    deleteRing
+	// FullName:  server::deleteRing
+	// Access:    private static 
+	// Returns:   void
+	// Parameter: pipelineRing* inRing
+	//--------------------------------------------------------------------------
+	static void deleteRing(
+		pipelineRing* inRing);
+
+	//-------------------------------------------------- decodeWorkerForEndpoint
+	// Brief Description
+	//  Returns the decode worker that handles datagrams from the endpoint.
+	//  Every datagram of one sender goes to the same worker.
+	//
+	// Method:    decodeWorkerForEndpoint
+	// FullName:  server::decodeWorkerForEndpoint
+	// Access:    private static 
+	// Returns:   uint16_t
+	// Parameter: const boost::asio::ip::udp::endpoint& inEndpoint
+	// Parameter: const uint16_t& inDecodeWorkers
+	//--------------------------------------------------------------------------
+	static uint16_t decodeWorkerForEndpoint(
+		const boost::asio::ip::udp::endpoint& inEndpoint,
+		const uint16_t& inDecodeWorkers);
+
+	//----------------------------------------------------------- isAdminMessage
+	// Brief Description
+	//  Determines if a message is an admin command.
+	//
+	// Method:    isAdminMessage
+	// FullName:  server::isAdminMessage
+	// Access:    private static 
+	// Returns:   bool
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	static bool isAdminMessage(
+		const dataMessage& inMessage);
+
+	//-------------------------------------------------------------- offloadTask
+	// Brief Description
+	//  Runs CPU heavy work on the task pool instead of the calling thread.
+	//  The completion then runs on the state stage, where it can safely act
+	//  on the result. Only the state stage calls this.
+	//
+	// Method:    offloadTask
+	// FullName:  server::offloadTask
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const boost::function<void()>& inWork
+	// Parameter: const boost::function<void()>& inCompletion
+	//--------------------------------------------------------------------------
+	void offloadTask(
+		const boost::function<void()>& inWork,
+		const boost::function<void()>& inCompletion);
+
+	//--------------------------------------------------------- runOffloadedTask
+	// Brief Description
+	//  Runs offloaded work on a pool worker and queues its completion for the
+	//  state stage.
+	//
+	// Method:    runOffloadedTask
+	// FullName:  server::runOffloadedTask
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const boost::function<void()>& inWork
+	// Parameter: const boost::function<void()>& inCompletion
+	//--------------------------------------------------------------------------
+	void runOffloadedTask(
+		const boost::function<void()>& inWork,
+		const boost::function<void()>& inCompletion);
+
+	//--------------------------------------------------------- postToStateStage
+	// Brief Description
+	//  Queues work to run on the state stage between batches. Used by threads
+	//  outside the pipeline to act on the server's state safely.
+	//
+	// Method:    postToStateStage
+	// FullName:  server::postToStateStage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const boost::function<void()>& inCompletion
+	//--------------------------------------------------------------------------
+	void postToStateStage(
+		const boost::function<void()>& inCompletion);
+
+	//----------------------------------------------------------- runCompletions
+	// Brief Description
+	//  Runs the completions of every offloaded task that has finished. Called
+	//  by the state stage between batches. Returns the number run.
+	//
+	// Method:    runCompletions
+	// FullName:  server::runCompletions
+	// Access:    private 
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t runCompletions();
+
+	//--------------------------------------------------------- dispatchDatagram
+	// Brief Description
+	//  Dispatches every message a received datagram carried and acknowledges
+	//  the client sends among them.
+	//
+	// Method:    dispatchDatagram
+	// FullName:  server::dispatchDatagram
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<dataMessage>& inMessages
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void dispatchDatagram(
+		const std::vector<dataMessage>& inMessages,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//--------------------------------------------------------- isAdjacentServer
+	// Brief Description
+	//  Determines if a datagram came from the left or right adjacent server.
+	//
+	// Method:    isAdjacentServer
+	// FullName:  server::isAdjacentServer
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	bool isAdjacentServer(
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint) const;
+
+	//--------------------------------------------------------- requiresChecksum
+	// Brief Description
+	//  Returns whether the sender of a message announced the checksum
+	//  capability, as a session of the message's source or as an adjacent
+	//  server. Its messages must then carry a checksum trailer.
+	//
+	// Method:    requiresChecksum
+	// FullName:  server::requiresChecksum
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	bool requiresChecksum(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint) const;
+
+	//------------------------------------------------------------- markDispatch
+	// Brief Description
+	//  Records how long the datagram being dispatched waited since the
+	//  kernel received it, under the given message type, and attributes
+	//  the replies sent from now on to that type.
+	//
+	// Method:    markDispatch
+	// FullName:  server::markDispatch
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const constants::MessageType& inMessageType
+	//--------------------------------------------------------------------------
+	void markDispatch(
+		const constants::MessageType& inMessageType);
+
+	//---------------------------------------------------------- dispatchMessage
+	// Brief Description
+	//  Acts on a single message received by the server. This is the common
+	//  entry point for every receive path, so a new transport only has to
+	//  produce a dataMessage and the endpoint it came from.
+	//
+	// Method:    dispatchMessage
+	// FullName:  server::dispatchMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void dispatchMessage(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
 	//----------------------------------------------------- sendMessagesToClient
 	// Brief Description
 	//  Called when a client sends a get to the server. It makes the server send
-	//  that client all messages that are destined for it.
+	//  the session that issued the get all messages that are destined for its
+	//  user and that this session has not acknowledged yet.
 	//
 	// Method:    sendMessagesToClient
 	// FullName:  server::sendMessagesToClient
 	// Access:    private 
 	// Returns:   void
+	// Parameter: const std::string& inClientIdentifier
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
 	//--------------------------------------------------------------------------
 	void sendMessagesToClient(
-		const std::string& inClientIdentifier);
+		const std::string& inClientIdentifier,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint);
 
 	//-------------------------------------------- removeReceivedMessageFromList
 	// Brief Description
 	//  Removes the corresponding message specified via the input parameter
 	//  from the message list. This is usually done in response to getting
 	//  an ACK from the client. Once a message has been confirmed received
-	//  by the intended client, it is no longer necessary to store it on the
-	//  server.
+	//  by every session of the intended client, it is no longer necessary to
+	//  store it on the server.
 	//
 	// Method:    removeReceivedMessageFromList
 	// FullName:  server::removeReceivedMessageFromList
 	// Access:    private 
 	// Returns:   void
 	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
 	//--------------------------------------------------------------------------
 	void removeReceivedMessageFromList(
-		const dataMessage& inMessage);
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint);
+
+	//------------------------------------------ removeFullyAcknowledgedMessages
+	// Brief Description
+	//  Removes the messages in the client's mailbox that every session of that
+	//  client has acknowledged.
+	//
+	// Method:    removeFullyAcknowledgedMessages
+	// FullName:  server::removeFullyAcknowledgedMessages
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::string& inClientIdentifier
+	//--------------------------------------------------------------------------
+	void removeFullyAcknowledgedMessages(
+		const std::string& inClientIdentifier);
+
+	//------------------------------------------------------- expireIdleSessions
+	// Brief Description
+	//  Drops the sessions that have sent neither a get nor a ping for the
+	//  session expiry time, as if they had acknowledged everything in their
+	//  mailbox. A client that vanished without disconnecting would otherwise
+	//  hold its mailbox forever.
+	//
+	// Method:    expireIdleSessions
+	// FullName:  server::expireIdleSessions
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void expireIdleSessions();
+
+
+	//---------------------------------------------- processClientConnectMessage
+	// Brief Description
+	//  Handles a connect from a client. A connect without a valid cookie is
+	//  answered with one and otherwise ignored. A new client connecting to a
+	//  server that is much busier than another one is redirected there
+	//  instead of being given a session.
+	//
+	// Method:    processClientConnectMessage
+	// FullName:  server::processClientConnectMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void processClientConnectMessage(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
 
+	//-------------------------------------------------- processClientGetMessage
+	// Brief Description
+	//  Handles a get from a client. Only a get carrying a valid cookie, which
+	//  proves the client receives datagrams at its source address, is
+	//  answered with the client's messages.
+	//
+	// Method:    processClientGetMessage
+	// FullName:  server::processClientGetMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void processClientGetMessage(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//----------------------------------------------------------- hasValidCookie
+	// Brief Description
+	//  Returns whether a connect or get may be served. It must carry a valid
+	//  cookie for the sender's endpoint, unless it announces no cookie
+	//  capability while the grace for legacy clients is on.
+	//
+	// Method:    hasValidCookie
+	// FullName:  server::hasValidCookie
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	bool hasValidCookie(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//--------------------------------------------------------------- sendCookie
+	// Brief Description
+	//  Answers a connect or get that carried no valid cookie with a fresh
+	//  cookie for the sender's endpoint.
+	//
+	// Method:    sendCookie
+	// FullName:  server::sendCookie
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void sendCookie(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
 
 	//------------------------------------------------- processClientSendMessage
 	// Brief Description
@@ -123,6 +816,237 @@ private:
 		const dataMessage& inMessage);
 
 	
+	//------------------------------------------------------------- resolveRoute
+	// Brief Description
+	//  Determines where a client's message must go: the local mailbox if the
+	//  destination user is connected here, and the adjacent server on each
+	//  side that has a server serving the user further along.
+	//
+	// Method:    resolveRoute
+	// FullName:  server::resolveRoute
+	// Access:    private 
+	// Returns:   messageRoute
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	messageRoute resolveRoute(
+		const dataMessage& inMessage);
+
+	//-------------------------------------------------------------- recordRoute
+	// Brief Description
+	//  Records the route a message is about to take with the flight
+	//  recorder.
+	//
+	// Method:    recordRoute
+	// FullName:  server::recordRoute
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const messageRoute& inRoute
+	//--------------------------------------------------------------------------
+	void recordRoute(
+		const dataMessage& inMessage,
+		const messageRoute& inRoute);
+
+	//-------------------------------------------------------------- routeInBulk
+	// Brief Description
+	//  Routes many client messages at once. Messages for the same mailbox are
+	//  added together, and messages for the same direction are handed to the
+	//  adjacent server in compressed batches. Messages without a route are
+	//  parked.
+	//
+	// Method:    routeInBulk
+	// FullName:  server::routeInBulk
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<dataMessage>& inMessages
+	//--------------------------------------------------------------------------
+	void routeInBulk(
+		const std::vector<dataMessage>& inMessages);
+
+	//---------------------------------------------------------- handOffMessages
+	// Brief Description
+	//  Sends messages to an adjacent server in the fastest form it announced
+	//  it accepts, compressed batches where possible.
+	//
+	// Method:    handOffMessages
+	// FullName:  server::handOffMessages
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<dataMessage>& inMessages
+	// Parameter: const remoteConnection& inAdjacentServer
+	//--------------------------------------------------------------------------
+	void handOffMessages(
+		const std::vector<dataMessage>& inMessages,
+		const remoteConnection& inAdjacentServer);
+
+	//--------------------------------------------------------- sendHandoffBatch
+	// Brief Description
+	//  Sends one batch of a handoff, first compressing it on the task pool
+	//  if asked to.
+	//
+	// Method:    sendHandoffBatch
+	// FullName:  server::sendHandoffBatch
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::shared_ptr<std::vector<char>>& inBatch
+	// Parameter: const boost::asio::ip::udp::endpoint& inDestination
+	// Parameter: const bool& inCompressed
+	//--------------------------------------------------------------------------
+	void sendHandoffBatch(
+		const std::shared_ptr<std::vector<char>>& inBatch,
+		const boost::asio::ip::udp::endpoint& inDestination,
+		const bool& inCompressed);
+
+	//---------------------------------------------------------- compressHandoff
+	// Brief Description
+	//  Compresses a batch of a handoff or get response in place. Runs on the
+	//  task pool.
+	//
+	// Method:    compressHandoff
+	// FullName:  server::compressHandoff
+	// Access:    private static 
+	// Returns:   void
+	// Parameter: const std::shared_ptr<std::vector<char>>& ioBatch
+	//--------------------------------------------------------------------------
+	static void compressHandoff(
+		const std::shared_ptr<std::vector<char>>& ioBatch);
+
+	//-------------------------------------------------------------- sendHandoff
+	// Brief Description
+	//  Sends a compressed batch of a handoff or get response once the task
+	//  pool is done with it.
+	//
+	// Method:    sendHandoff
+	// FullName:  server::sendHandoff
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::shared_ptr<std::vector<char>>& inDatagram
+	// Parameter: const boost::asio::ip::udp::endpoint& inDestination
+	//--------------------------------------------------------------------------
+	void sendHandoff(
+		const std::shared_ptr<std::vector<char>>& inDatagram,
+		const boost::asio::ip::udp::endpoint& inDestination);
+
+	//----------------------------------------------------------- receiveHandoff
+	// Brief Description
+	//  Acts on a compressed batch of messages handed off by an adjacent
+	//  server. Drops it if it came from anywhere else.
+	//
+	// Method:    receiveHandoff
+	// FullName:  server::receiveHandoff
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<dataMessage>& inMessages
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void receiveHandoff(
+		const std::vector<dataMessage>& inMessages,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//---------------------------------------------------- forwardParkedMessages
+	// Brief Description
+	//  Retries every parked message in bulk. Runs on the state stage.
+	//
+	// Method:    forwardParkedMessages
+	// FullName:  server::forwardParkedMessages
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void forwardParkedMessages();
+
+	//----------------------------------------------------------- flushStoreLogs
+	// Brief Description
+	//  Writes the buffered log records of the history and offline stores.
+	//  Runs on the state stage.
+	//
+	// Method:    flushStoreLogs
+	// FullName:  server::flushStoreLogs
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushStoreLogs();
+
+	//--------------------------------------------- processClientScheduleMessage
+	// Brief Description
+	//  Stores a message a client wants delivered at a later time. The payload
+	//  starts with the delivery time in milliseconds since the epoch, followed
+	//  by the text. Once due, it is handled as if the client had sent it then.
+	//
+	// Method:    processClientScheduleMessage
+	// FullName:  server::processClientScheduleMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void processClientScheduleMessage(
+		const dataMessage& inMessage);
+
+	//------------------------------------------------------------- scheduleLoop
+	// Brief Description
+	//  Waits for scheduled messages to become due and passes them to the
+	//  state stage for delivery. Sleeps until the next one is due.
+	//
+	// Method:    scheduleLoop
+	// FullName:  server::scheduleLoop
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void scheduleLoop();
+
+	//-------------------------------------------------- deliverScheduledMessage
+	// Brief Description
+	//  Delivers a scheduled message that has become due. Runs on the state
+	//  stage.
+	//
+	// Method:    deliverScheduledMessage
+	// FullName:  server::deliverScheduledMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void deliverScheduledMessage(
+		const dataMessage& inMessage);
+
+	//--------------------------------------------------------- deliverBroadcast
+	// Brief Description
+	//  Adds a broadcast to the mailbox of every user connected to this server
+	//  other than its sender, and tells each of their sessions a message is
+	//  waiting. Large fan-outs are split into shards that run in parallel.
+	//
+	// Method:    deliverBroadcast
+	// FullName:  server::deliverBroadcast
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void deliverBroadcast(
+		const dataMessage& inMessage);
+
+	//-------------------------------------------------------------- fanOutShard
+	// Brief Description
+	//  Delivers a broadcast to one shard of its recipients and sends their
+	//  sessions the pending notice as one batch. Counts down the latch, if
+	//  given, when done, even if the shard throws.
+	//
+	// Method:    fanOutShard
+	// FullName:  server::fanOutShard
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<broadcastRecipient>& inRecipients
+	// Parameter: const size_t& inBegin
+	// Parameter: const size_t& inEnd
+	// Parameter: const std::shared_ptr<const encodedMessage>& inMessage
+	// Parameter: const std::vector<char>& inPendingNotice
+	// Parameter: boost::latch* inShardsDone
+	//--------------------------------------------------------------------------
+	void fanOutShard(
+		const std::vector<broadcastRecipient>& inRecipients,
+		const size_t& inBegin,
+		const size_t& inEnd,
+		const std::shared_ptr<const encodedMessage>& inMessage,
+		const std::vector<char>& inPendingNotice,
+		boost::latch* inShardsDone);
+
 	//------------------------------------------------ processServerRelayMessage
 	// Brief Description
 	//  Determines if a message that was forwarded from another server has
@@ -151,11 +1075,24 @@ private:
 	//--------------------------------------------------------------------------
 	void listenLoopBluetooth();
 
+	//------------------------------------------------------ listenLoopMulticast
+	// Brief Description
+	//  The server's listening loop for the cluster multicast group. It
+	//  receives the frames every other server publishes to the group and
+	//  hands them to the state stage.
+	//
+	// Method:    listenLoopMulticast
+	// FullName:  server::listenLoopMulticast
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void listenLoopMulticast();
+
 	//----------------------------------------------------------- attemptForward
 	// Brief Description
-	//  Periodically cycles through all the messages on this server and
-	//  determines if they should be forwarded to another server, or kept
-	//  on this server instead.
+	//  Periodically has the state stage cycle through the parked messages
+	//  and forward the ones whose destination has become reachable, and
+	//  flush the logs of the message stores.
 	//
 	// Method:    attemptForward
 	// FullName:  server::attemptForward
@@ -176,6 +1113,35 @@ private:
 	//--------------------------------------------------------------------------
 	void sendSyncPayloads();
 
+	//--------------------------------------------------------- takeSyncSnapshot
+	// Brief Description
+	//  Records this server's own client list and load, and copies the
+	//  client list of every server for the sync thread, then counts the
+	//  latch down. Runs on the state stage, which owns the lists.
+	//
+	// Method:    takeSyncSnapshot
+	// FullName:  server::takeSyncSnapshot
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::shared_ptr<syncSnapshot>& outSnapshot
+	// Parameter: const std::shared_ptr<boost::latch>& inTaken
+	//--------------------------------------------------------------------------
+	void takeSyncSnapshot(
+		const std::shared_ptr<syncSnapshot>& outSnapshot,
+		const std::shared_ptr<boost::latch>& inTaken);
+
+	//------------------------------------------------------- flightRecorderLoop
+	// Brief Description
+	//  Writes the flight recorder's dump to disk whenever an anomaly has
+	//  triggered one.
+	//
+	// Method:    flightRecorderLoop
+	// FullName:  server::flightRecorderLoop
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flightRecorderLoop();
+
 	//----------------------------------------------------- sendSyncPayloadsLeft
 	// Brief Description
 	//  Helper function that forwards the client lists to the left adjacent
@@ -185,8 +1151,10 @@ private:
 	// FullName:  server::sendSyncPayloadsLeft
 	// Access:    private 
 	// Returns:   void
+	// Parameter: const syncSnapshot& inSnapshot
 	//--------------------------------------------------------------------------
-	void sendSyncPayloadsLeft();
+	void sendSyncPayloadsLeft(
+		const syncSnapshot& inSnapshot);
 
 	//---------------------------------------------------- sendSyncPayloadsRight
 	// Brief Description
@@ -197,10 +1165,161 @@ private:
 	// FullName:  server::sendSyncPayloadsRight
 	// Access:    private 
 	// Returns:   void
+	// Parameter: const syncSnapshot& inSnapshot
+	//--------------------------------------------------------------------------
+	void sendSyncPayloadsRight(
+		const syncSnapshot& inSnapshot);
+
+	//------------------------------------------------- sendSyncPayloadMulticast
+	// Brief Description
+	//  Helper function that publishes this server's client list to the
+	//  multicast group. A single send reaches every server in the cluster,
+	//  so nothing has to be relayed along the chain.
+	//
+	// Method:    sendSyncPayloadMulticast
+	// FullName:  server::sendSyncPayloadMulticast
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const syncSnapshot& inSnapshot
+	//--------------------------------------------------------------------------
+	void sendSyncPayloadMulticast(
+		const syncSnapshot& inSnapshot);
+
+	//---------------------------------------------------- resendMulticastFrames
+	// Brief Description
+	//  Answers a NACK from another server by publishing the requested frames
+	//  to the multicast group again, if they are still in the repair history.
+	//  Resending to the group repairs every server that missed them at once.
+	//
+	// Method:    resendMulticastFrames
+	// FullName:  server::resendMulticastFrames
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inNackMessage
+	//--------------------------------------------------------------------------
+	void resendMulticastFrames(
+		const dataMessage& inNackMessage);
+
+	//---------------------------------------------------- publishMulticastFrame
+	// Brief Description
+	//  Publishes a frame to the multicast group and keeps it for NACK repair.
+	//  The first message of the frame is given the next multicast sequence
+	//  number, the rest ride along in the same datagram. Any thread may call
+	//  this.
+	//
+	// Method:    publishMulticastFrame
+	// FullName:  server::publishMulticastFrame
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<dataMessage>& inFrame
+	//--------------------------------------------------------------------------
+	void publishMulticastFrame(
+		const std::vector<dataMessage>& inFrame);
+
+	//---------------------------------------------------- receiveMulticastFrame
+	// Brief Description
+	//  Accepts a frame from the multicast group on the state stage. Frames
+	//  of each origin are applied in sequence order, frames behind a gap are
+	//  held back while the missing ones are requested with a NACK.
+	//
+	// Method:    receiveMulticastFrame
+	// FullName:  server::receiveMulticastFrame
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<dataMessage>& inFrame
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void receiveMulticastFrame(
+		const std::vector<dataMessage>& inFrame,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//--------------------------------------------------- releaseMulticastFrames
+	// Brief Description
+	//  Applies the held frames of an origin that are next in sequence. A gap
+	//  that was not repaired within the repair wait, or that has more frames
+	//  held behind it than the origin keeps, is skipped.
+	//
+	// Method:    releaseMulticastFrames
+	// FullName:  server::releaseMulticastFrames
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const int8_t& inOriginIndex
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void releaseMulticastFrames(
+		const int8_t& inOriginIndex,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	int64_t sequenceNumber();
+
+	//-------------------------------------------------------------- measureLoad
+	// Brief Description
+	//  Records this server's current load: sessions, datagrams received per
+	//  second since the last measurement, and messages waiting for delivery.
+	//  Runs on the state stage, which owns the sessions and mailboxes.
+	//
+	// Method:    measureLoad
+	// FullName:  server::measureLoad
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void measureLoad();
+
+	//---------------------------------------------------------- sendLoadReports
+	// Brief Description
+	//  Sends every fresh load report this server knows to the adjacent
+	//  servers, in the same direction the client lists travel, so each
+	//  server ends up with the load of every other.
+	//
+	// Method:    sendLoadReports
+	// FullName:  server::sendLoadReports
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void sendLoadReports();
+
+	//--------------------------------------------------------- createLoadReport
+	// Brief Description
+	//  Returns the load frame for the given server index.
+	//
+	// Method:    createLoadReport
+	// FullName:  server::createLoadReport
+	// Access:    private 
+	// Returns:   dataMessage
+	// Parameter: const int64_t& inSequenceNumber
+	// Parameter: const int8_t& inServerIndex
+	// Parameter: const std::string& inDestination
+	//--------------------------------------------------------------------------
+	dataMessage createLoadReport(
+		const int64_t& inSequenceNumber,
+		const int8_t& inServerIndex,
+		const std::string& inDestination);
+
+	//-------------------------------------------------------- receiveServerLoad
+	// Brief Description
+	//  Stores the load report of another server.
+	//
+	// Method:    receiveServerLoad
+	// FullName:  server::receiveServerLoad
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inLoadMessage
 	//--------------------------------------------------------------------------
-	void sendSyncPayloadsRight();
+	void receiveServerLoad(
+		const dataMessage& inLoadMessage);
 
-	const int64_t& sequenceNumber();
+	//------------------------------------------------------- findRedirectTarget
+	// Brief Description
+	//  Returns the index of the lightest server with a fresh load report if
+	//  this server is busier than it by more than the redirect margin, or -1
+	//  if new clients should stay here.
+	//
+	// Method:    findRedirectTarget
+	// FullName:  server::findRedirectTarget
+	// Access:    private 
+	// Returns:   int8_t
+	//--------------------------------------------------------------------------
+	int8_t findRedirectTarget();
 
 	//---------------------------------------- receiveClientsFromAdjacentServers
 	// Brief Description
@@ -216,12 +1335,63 @@ private:
 	void receiveClientsFromAdjacentServers(
 		const dataMessage& inSyncMessage);
 
+	//-------------------------------------------------- serverIndexServesClient
+	// Brief Description
+	//  Determines if the server with the given index serves the client, using
+	//  the shared directory when enabled and the synced lists otherwise.
+	//
+	// Method:    serverIndexServesClient
+	// FullName:  server::serverIndexServesClient
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const int8_t& inServerIndex
+	// Parameter: const std::string& inClientIdentifier
+	//--------------------------------------------------------------------------
+	bool serverIndexServesClient(
+		const int8_t& inServerIndex,
+		const std::string& inClientIdentifier) const;
+
+	//----------------------------------------------- clientsServedByServerIndex
+	// Brief Description
+	//  Returns the known client list for the given server index, read from
+	//  the shared directory when enabled and the synced lists otherwise.
+	//
+	// Method:    clientsServedByServerIndex
+	// FullName:  server::clientsServedByServerIndex
+	// Access:    private 
+	// Returns:   std::vector<std::string>
+	// Parameter: const int8_t& inServerIndex
+	//--------------------------------------------------------------------------
+	std::vector<std::string> clientsServedByServerIndex(
+		const int8_t& inServerIndex) const;
+
+	//-------------------------------------------------------- findClientSession
+	// Brief Description
+	//  Returns the session of the client that is continued by a connect from
+	//  the given endpoint with the given resume token, or nullptr if the
+	//  connect starts a new session.
+	//
+	// Method:    findClientSession
+	// FullName:  server::findClientSession
+	// Access:    private 
+	// Returns:   remoteConnection*
+	// Parameter: const std::string& inClientUsername
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
+	// Parameter: const std::string& inResumeToken
+	//--------------------------------------------------------------------------
+	remoteConnection* findClientSession(
+		const std::string& inClientUsername,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint,
+		const std::string& inResumeToken);
+
 	//------------------------------------------------------ addClientConnection
 	// Brief Description
 	//  Used by the server to add a new client connection when it receives a
 	//  connection message from a client. All broadcast messages received 
 	//  afterwards will be relayed to this client. This client will also be a 
-	//  valid target for private messages.
+	//  valid target for private messages. A user connecting from several
+	//  devices holds one session per device. A client presenting the resume
+	//  token of an existing session continues that session.
 	//
 	// Method:    addClientConnection
 	// FullName:  server::addClientConnection
@@ -229,29 +1399,162 @@ private:
 	// Returns:   void
 	// Parameter: const std::string& inClientUsername
 	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
+	// Parameter: const std::string& inResumeToken
+	// Parameter: const uint32_t& inCapabilities
 	//--------------------------------------------------------------------------
 	void addClientConnection(
 		const std::string& inClientUsername,
-		const boost::asio::ip::udp::endpoint& inClientEndpoint);
+		const boost::asio::ip::udp::endpoint& inClientEndpoint,
+		const std::string& inResumeToken,
+		const uint32_t& inCapabilities);
 
 	//--------------------------------------------------- removeClientConnection
 	// Brief Description
-	//  Removes the client connection. The client will no longer be associated
-	//  with this server.
+	//  Removes the client session connected from the given endpoint. Once the
+	//  last session is gone, the client will no longer be associated with
+	//  this server.
 	//
 	// Method:    removeClientConnection
 	// FullName:  server::removeClientConnection
 	// Access:    private 
 	// Returns:   void
 	// Parameter: const std::string& inClientUsername
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
 	//--------------------------------------------------------------------------
 	void removeClientConnection(
-		const std::string& inClientUsername);
+		const std::string& inClientUsername,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint);
+
+	//----------------------------------------------------- countPendingMessages
+	// Brief Description
+	//  Returns the number of messages waiting for the given session of a
+	//  client.
+	//
+	// Method:    countPendingMessages
+	// FullName:  server::countPendingMessages
+	// Access:    private 
+	// Returns:   int64_t
+	// Parameter: const std::string& inClientIdentifier
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
+	//--------------------------------------------------------------------------
+	int64_t countPendingMessages(
+		const std::string& inClientIdentifier,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint);
+
+	//-------------------------------------------------------------- replyToPing
+	// Brief Description
+	//  Answers a ping from a client with this server's current load, which
+	//  the client uses to rank the servers it could fail over to, and the
+	//  number of messages waiting for the client.
+	//
+	// Method:    replyToPing
+	// FullName:  server::replyToPing
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inPingMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void replyToPing(
+		const dataMessage& inPingMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//----------------------------------------------------- greetAdjacentServers
+	// Brief Description
+	//  Sends a hello announcing this server's capabilities to every adjacent
+	//  server whose capabilities are not known yet.
+	//
+	// Method:    greetAdjacentServers
+	// FullName:  server::greetAdjacentServers
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void greetAdjacentServers();
+
+	//---------------------------------------------------------- sendServerHello
+	// Brief Description
+	//  Sends a hello announcing this server's capabilities to an adjacent
+	//  server, either unprompted or in reply to its own.
+	//
+	// Method:    sendServerHello
+	// FullName:  server::sendServerHello
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const remoteConnection& inAdjacentServer
+	// Parameter: const bool& inIsReply
+	//--------------------------------------------------------------------------
+	void sendServerHello(
+		const remoteConnection& inAdjacentServer,
+		const bool& inIsReply);
+
+	//------------------------------------------------ processServerHelloMessage
+	// Brief Description
+	//  Records the capabilities an adjacent server announced in its hello,
+	//  and answers a hello that is not itself a reply.
+	//
+	// Method:    processServerHelloMessage
+	// FullName:  server::processServerHelloMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void processServerHelloMessage(
+		const dataMessage& inMessage);
+
+	//------------------------------------------------------ processAdminMessage
+	// Brief Description
+	//  Carries out an admin command sent from this host and replies with the
+	//  outcome: "stats" returns the latency statistics, "profile start"
+	//  starts the sampling profiler, "profile stop" stops it and writes the
+	//  folded stacks on the task pool. Commands from other hosts are
+	//  ignored.
+	//
+	// Method:    processAdminMessage
+	// FullName:  server::processAdminMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void processAdminMessage(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//------------------------------------------------------------- writeProfile
+	// Brief Description
+	//  Writes the samples of the profiler to this server's profile file and
+	//  stores the summary. Runs on the task pool.
+	//
+	// Method:    writeProfile
+	// FullName:  server::writeProfile
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::shared_ptr<std::string>& outSummary
+	//--------------------------------------------------------------------------
+	void writeProfile(
+		const std::shared_ptr<std::string>& outSummary);
+
+	//----------------------------------------------------------- sendAdminReply
+	// Brief Description
+	//  Replies to an admin command with its outcome.
+	//
+	// Method:    sendAdminReply
+	// FullName:  server::sendAdminReply
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inCommand
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	// Parameter: const std::shared_ptr<std::string>& inOutcome
+	//--------------------------------------------------------------------------
+	void sendAdminReply(
+		const dataMessage& inCommand,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint,
+		const std::shared_ptr<std::string>& inOutcome);
 
 	//--------------------------------------------------------- addToMessageList
 	// Brief Description
-	//  Helper function. Adds a data message to the list of messages that
-	//  haven't been delivered to a client.
+	//  Helper function. Adds a data message to the mailbox of the client it is
+	//  destined for, where it waits until every session of that client has
+	//  acknowledged it.
 	//
 	// Method:    addToMessageList
 	// FullName:  server::addToMessageList
@@ -262,12 +1565,28 @@ private:
 	void addToMessageList(
 		dataMessage message);
 
+	//------------------------------------------------------- createMailboxEntry
+	// Brief Description
+	//  Encodes a message for the mailboxes under the next mailbox entry id,
+	//  which replaces its sequence number. Sessions echo the id when they
+	//  acknowledge the entry.
+	//
+	// Method:    createMailboxEntry
+	// FullName:  server::createMailboxEntry
+	// Access:    private 
+	// Returns:   std::shared_ptr<const encodedMessage>
+	// Parameter: dataMessage message
+	//--------------------------------------------------------------------------
+	std::shared_ptr<const encodedMessage> createMailboxEntry(
+		dataMessage message);
+
 	//------------------------------------ addToMessageListOfUnassociatedClients
 	// Brief Description
 	//  Adds a message to the list that contains all messages for which the
 	//  server was unable to determine what server serves that client. This
 	//  list is periodically checked and the server will attempt to
-	//  find the server associated with a particular client.
+	//  find the server associated with a particular client. The list is
+	//  kept in the offline store too, so it survives a restart.
 	//
 	// Method:    addToMessageListOfUnassociatedClients
 	// FullName:  server::addToMessageListOfUnassociatedClients
@@ -285,13 +1604,17 @@ private:
 	int8_t m_index;
 	boost::thread_group m_threads;
 
-	bool m_terminate;
-	int64_t m_sequenceNumber;
+	std::atomic<bool> m_terminate;
+	std::atomic<int64_t> m_sequenceNumber;
 
-	std::list<dataMessage> m_messageList;
-	std::list<dataMessage> m_messageListOfUnassociatedClients;
+	// mailbox entries are in the order of their ids, which only the state
+	// stage hands out
+	std::map<std::string, std::list<std::shared_ptr<const encodedMessage>>> m_mailboxes;
+	int64_t m_lastMailboxEntry;
+	std::map<std::string, dataMessage> m_messageListOfUnassociatedClients;
+	uint64_t m_parkedSequenceNumber;
 
-	std::vector<remoteConnection> m_connectedClients;
+	std::map<std::string, std::vector<remoteConnection>> m_connectedClients;
 
 	int8_t m_leftAdjacentServerIndex;
 	remoteConnection* m_leftAdjacentServerConnection;
@@ -300,4 +1623,67 @@ private:
 	remoteConnection* m_rightAdjacentServerConnection;
 
 	std::vector<std::string> m_clientsServedByServerIndex[constants::numberOfServers];
+
+	boost::asio::ip::udp::socket m_multicastSocket;
+	boost::asio::ip::udp::endpoint m_multicastGroupEndpoint;
+	// the sequence number and the history are guarded by the mutex, so
+	// frames go out in sequence order whichever thread publishes them
+	int64_t m_multicastSequenceNumber;
+	std::deque<std::pair<int64_t, std::vector<char>>> m_multicastHistory;
+	boost::mutex m_multicastHistoryMutex;
+
+	// the state stage's view of every origin's frames
+	int64_t m_highestMulticastSequenceNumberByServerIndex[constants::numberOfServers];
+	std::map<int64_t, heldMulticastFrame> m_heldMulticastFramesByServerIndex[constants::numberOfServers];
+
+	sharedClientDirectory* m_sharedDirectory;
+
+#ifdef __linux__
+	// open when an interface is configured and the kernel allows it, only
+	// the receive stage receives and only the egress stage sends with it
+	xdpSocket* m_xdpSocket;
+#endif
+
+	std::atomic<int64_t> m_ingressPacketCount;
+	int64_t m_ingressPacketCountAtLastMeasurement;
+	boost::chrono::steady_clock::time_point m_timeOfLastLoadMeasurement;
+	serverLoad m_loadByServerIndex[constants::numberOfServers];
+	boost::chrono::steady_clock::time_point m_timeOfLoadReportByServerIndex[constants::numberOfServers];
+	boost::mutex m_loadMutex;
+
+	endpointCookie m_cookies;
+
+	uint16_t m_decodeWorkers;
+	std::vector<pipelineRing*> m_decodeRings;
+	std::vector<pipelineRing*> m_stateRings;
+	pipelineRing* m_egressRing;
+	std::vector<stageWakeup*> m_decodeWakeups;
+	stageWakeup m_stateWakeup;
+	stageWakeup m_egressWakeup;
+	pipelineBatch* m_pendingEgress;
+	boost::thread::id m_stateThreadId;
+	pipelineStage* m_receiveStage;
+	std::vector<pipelineStage*> m_decodeStages;
+	pipelineStage* m_stateStage;
+	pipelineStage* m_egressStage;
+
+	// per message type, only the state stage sets the dispatch being handled
+	std::vector<latencyHistogram*> m_arrivalToDispatch;
+	std::vector<latencyHistogram*> m_dispatchToSend;
+	int64_t m_receivedNanoseconds;
+	int64_t m_dispatchedNanoseconds;
+	constants::MessageType m_dispatchedType;
+
+	std::deque<boost::function<void()>> m_completions;
+	boost::mutex m_completionMutex;
+
+	messageScheduler m_scheduler;
+	messageHistory m_history;
+	lsmStore m_offlineMailboxes;
+	sampleProfiler m_profiler;
+	flightRecorder m_flightRecorder;
+
+	// declared last so their workers stop before anything they use is gone
+	taskPool m_taskPool;
+	taskPool m_shardPool;
 };
\ No newline at end of file
@@ -40,7 +40,8 @@ int main()
 		server serverInstance(
 			listeningPort,
 			serverIndex,
-			ioService);
+			ioService,
+			constants::pipelineDecodeWorkers);
 
 		serverInstance.run();
 	}
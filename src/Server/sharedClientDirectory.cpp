@@ -0,0 +1,340 @@
+// STL
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#endif
+
+// Boost
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+// Project
+#include "sharedClientDirectory.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  find_or_construct is atomic across processes, so exactly one server
+//  creates the table and the rest attach to it.
+//------------------------------------------------------------------------------
+sharedClientDirectory::sharedClientDirectory(
+	const int8_t& inOwnerServerIndex) :
+	m_segment(
+		boost::interprocess::open_or_create,
+		constants::sharedDirectoryName.c_str(),
+		sizeof(directoryTable) + constants::sharedDirectorySegmentOverhead),
+	m_table(nullptr),
+	m_ownerServerIndex(inOwnerServerIndex)
+{
+	this->m_table =
+		this->m_segment.find_or_construct<directoryTable>("directoryTable")();
+
+	this->m_table->slots[this->m_ownerServerIndex].ownerHeartbeatMilliseconds.store(
+		sharedClientDirectory::currentTimeMilliseconds());
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  Clearing the heartbeat makes the other servers resume syncing to us
+//  straight away instead of waiting for it to go stale. The last server to
+//  detach removes the segment, servers that crashed count as detached once
+//  their heartbeat is stale. Processes still mapping it keep their mapping.
+//------------------------------------------------------------------------------
+sharedClientDirectory::~sharedClientDirectory()
+{
+	this->m_table->slots[this->m_ownerServerIndex].ownerHeartbeatMilliseconds.store(0);
+
+	for(int8_t i = 0; i < constants::numberOfServers; i++)
+	{
+		if(this->serverIsAttached(i))
+		{
+			return;
+		}
+	}
+
+	boost::interprocess::shared_memory_object::remove(
+		constants::sharedDirectoryName.c_str());
+};
+
+//----------------------------------------------------------- writeServerClients
+// Implementation notes:
+//  Seqlock write side. Usernames that do not fit a slot entry are skipped,
+//  as are clients past the slot capacity. An odd sequence under the lock
+//  means the last writer died mid write, the sequence stays odd and this
+//  write replaces whatever it left.
+//------------------------------------------------------------------------------
+void sharedClientDirectory::writeServerClients(
+	const int8_t& inServerIndex,
+	const std::vector<std::string>& inClients)
+{
+	directorySlot& slot = this->m_table->slots[inServerIndex];
+
+	if(!sharedClientDirectory::lockSlot(slot))
+	{
+		return;
+	}
+
+	if((slot.sequence.load(std::memory_order_relaxed) & 1) == 0)
+	{
+		slot.sequence.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	std::atomic_thread_fence(std::memory_order_release);
+
+	uint32_t clientCount = 0;
+
+	for(const std::string& currentClient : inClients)
+	{
+		if(clientCount == constants::sharedDirectoryMaximumClientsPerServer)
+		{
+			break;
+		}
+
+		if(currentClient.size() >= constants::sharedDirectoryMaximumUsernameLength)
+		{
+			continue;
+		}
+
+		std::memcpy(
+			slot.clients[clientCount],
+			currentClient.c_str(),
+			currentClient.size() + 1);
+
+		clientCount++;
+	}
+
+	slot.clientCount = clientCount;
+
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.sequence.fetch_add(1, std::memory_order_relaxed);
+
+	slot.writerProcessId.store(0, std::memory_order_release);
+
+	if(inServerIndex == this->m_ownerServerIndex)
+	{
+		slot.ownerHeartbeatMilliseconds.store(
+			sharedClientDirectory::currentTimeMilliseconds());
+	}
+};
+
+//------------------------------------------------------------ readServerClients
+// Implementation notes:
+//  Seqlock read side, retries while a writer is active or finished a write
+//  during the copy. A writer that died mid write leaves the sequence odd
+//  until the slot is written again, so the retries are bounded.
+//------------------------------------------------------------------------------
+std::vector<std::string> sharedClientDirectory::readServerClients(
+	const int8_t& inServerIndex) const
+{
+	const directorySlot& slot = this->m_table->slots[inServerIndex];
+
+	std::vector<std::string> outClients;
+
+	for(uint16_t attempt = 0; attempt < constants::sharedDirectoryReadAttempts; attempt++)
+	{
+		const uint32_t sequenceBefore =
+			slot.sequence.load(std::memory_order_acquire);
+
+		if((sequenceBefore & 1) != 0)
+		{
+			boost::this_thread::yield();
+			continue;
+		}
+
+		outClients.clear();
+
+		const uint32_t clientCount = std::min<uint32_t>(
+			slot.clientCount,
+			constants::sharedDirectoryMaximumClientsPerServer);
+
+		for(uint32_t i = 0; i < clientCount; i++)
+		{
+			outClients.push_back(std::string(
+				slot.clients[i],
+				strnlen(slot.clients[i], constants::sharedDirectoryMaximumUsernameLength)));
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if(slot.sequence.load(std::memory_order_relaxed) == sequenceBefore)
+		{
+			return outClients;
+		}
+	}
+
+	return std::vector<std::string>();
+};
+
+//----------------------------------------------------------------- servesClient
+// Implementation notes:
+//  Same bounded retry loop as readServerClients, but compares in place so a
+//  lookup does not allocate.
+//------------------------------------------------------------------------------
+bool sharedClientDirectory::servesClient(
+	const int8_t& inServerIndex,
+	const std::string& inClientIdentifier) const
+{
+	if(inClientIdentifier.size() >= constants::sharedDirectoryMaximumUsernameLength)
+	{
+		return false;
+	}
+
+	const directorySlot& slot = this->m_table->slots[inServerIndex];
+
+	for(uint16_t attempt = 0; attempt < constants::sharedDirectoryReadAttempts; attempt++)
+	{
+		const uint32_t sequenceBefore =
+			slot.sequence.load(std::memory_order_acquire);
+
+		if((sequenceBefore & 1) != 0)
+		{
+			boost::this_thread::yield();
+			continue;
+		}
+
+		bool found = false;
+
+		const uint32_t clientCount = std::min<uint32_t>(
+			slot.clientCount,
+			constants::sharedDirectoryMaximumClientsPerServer);
+
+		for(uint32_t i = 0; (i < clientCount) && !found; i++)
+		{
+			found = (strncmp(
+				slot.clients[i],
+				inClientIdentifier.c_str(),
+				constants::sharedDirectoryMaximumUsernameLength) == 0);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if(slot.sequence.load(std::memory_order_relaxed) == sequenceBefore)
+		{
+			return found;
+		}
+	}
+
+	return false;
+};
+
+//------------------------------------------------------------- serverIsAttached
+// Implementation notes:
+//  A server counts as attached while its heartbeat is fresher than a few
+//  sync intervals, which also covers owners that crashed without detaching.
+//------------------------------------------------------------------------------
+bool sharedClientDirectory::serverIsAttached(
+	const int8_t& inServerIndex) const
+{
+	const int64_t heartbeat =
+		this->m_table->slots[inServerIndex].ownerHeartbeatMilliseconds.load();
+
+	return (heartbeat != 0)
+		&& (sharedClientDirectory::currentTimeMilliseconds() - heartbeat
+			< 3 * constants::syncIntervalMilliseconds);
+};
+
+//------------------------------------------------------ currentTimeMilliseconds
+// Implementation notes:
+//  system_clock rather than steady_clock, since the value is compared
+//  between processes.
+//------------------------------------------------------------------------------
+int64_t sharedClientDirectory::currentTimeMilliseconds()
+{
+	return boost::chrono::duration_cast<boost::chrono::milliseconds>(
+		boost::chrono::system_clock::now().time_since_epoch()).count();
+};
+
+//--------------------------------------------------------------------- lockSlot
+// Implementation notes:
+//  A compare and swap from the id seen, so of several writers finding the
+//  same dead holder only one takes the lock over. Threads of one process
+//  share its id, they wait for each other like any live holder.
+//------------------------------------------------------------------------------
+bool sharedClientDirectory::lockSlot(
+	directorySlot& ioSlot)
+{
+	const int32_t processId =
+		sharedClientDirectory::currentProcessId();
+
+	const int64_t giveUpMilliseconds = sharedClientDirectory::currentTimeMilliseconds()
+		+ constants::sharedDirectoryLockTimeoutMilliseconds;
+
+	while(true)
+	{
+		int32_t holderProcessId = 0;
+
+		if(ioSlot.writerProcessId.compare_exchange_strong(
+			holderProcessId,
+			processId,
+			std::memory_order_acquire))
+		{
+			return true;
+		}
+
+		if(!sharedClientDirectory::processIsAlive(holderProcessId)
+			&& ioSlot.writerProcessId.compare_exchange_strong(
+				holderProcessId,
+				processId,
+				std::memory_order_acquire))
+		{
+			return true;
+		}
+
+		if(sharedClientDirectory::currentTimeMilliseconds() >= giveUpMilliseconds)
+		{
+			return false;
+		}
+
+		boost::this_thread::yield();
+	}
+};
+
+//------------------------------------------------------------- currentProcessId
+// Implementation notes:
+//  Process ids fit 32 bits on every supported platform
+//------------------------------------------------------------------------------
+int32_t sharedClientDirectory::currentProcessId()
+{
+#ifdef _WIN32
+	return static_cast<int32_t>(GetCurrentProcessId());
+#else
+	return static_cast<int32_t>(getpid());
+#endif
+};
+
+//--------------------------------------------------------------- processIsAlive
+// Implementation notes:
+//  A process we may not signal or open still exists. A lock held by a
+//  reused id is only waited on until the lock timeout, like a live holder.
+//------------------------------------------------------------------------------
+bool sharedClientDirectory::processIsAlive(
+	const int32_t& inProcessId)
+{
+#ifdef _WIN32
+	HANDLE processHandle = OpenProcess(
+		SYNCHRONIZE,
+		FALSE,
+		static_cast<DWORD>(inProcessId));
+
+	if(processHandle == NULL)
+	{
+		return (GetLastError() == ERROR_ACCESS_DENIED);
+	}
+
+	const bool isAlive =
+		(WaitForSingleObject(processHandle, 0) == WAIT_TIMEOUT);
+
+	CloseHandle(processHandle);
+
+	return isAlive;
+#else
+	return (kill(static_cast<pid_t>(inProcessId), 0) == 0)
+		|| (errno == EPERM);
+#endif
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <atomic>
+
+// Boost
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+// Project
+#include "../Common/constants.h"
+
+class sharedClientDirectory
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Opens the host wide client directory in shared memory, creating it if
+	//  this is the first server process on the host, and attaches this server
+	//  as the owner of its own slot.
+	//
+	// Method:    sharedClientDirectory
+	// FullName:  sharedClientDirectory::sharedClientDirectory
+	// Access:    public
+	// Returns:
+	// Parameter: const int8_t& inOwnerServerIndex
+	//--------------------------------------------------------------------------
+	sharedClientDirectory(
+		const int8_t& inOwnerServerIndex);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Detaches this server from its slot. The shared memory itself is left in
+	//  place for the other server processes on the host, unless none of them
+	//  is attached any more.
+	//
+	// Method:    ~sharedClientDirectory
+	// FullName:  sharedClientDirectory::~sharedClientDirectory
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~sharedClientDirectory();
+
+	//------------------------------------------------------- writeServerClients
+	// Brief Description
+	//  Replaces the client list stored for the given server index. Writers
+	//  are serialized per slot, readers are never blocked. The write is
+	//  skipped if another live writer holds the slot past the lock timeout,
+	//  the next sync round writes the list again.
+	//
+	// Method:    writeServerClients
+	// FullName:  sharedClientDirectory::writeServerClients
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int8_t& inServerIndex
+	// Parameter: const std::vector<std::string>& inClients
+	//--------------------------------------------------------------------------
+	void writeServerClients(
+		const int8_t& inServerIndex,
+		const std::vector<std::string>& inClients);
+
+	//-------------------------------------------------------- readServerClients
+	// Brief Description
+	//  Returns a consistent copy of the client list stored for the given
+	//  server index, or an empty list if no consistent copy could be taken
+	//  within the read attempts.
+	//
+	// Method:    readServerClients
+	// FullName:  sharedClientDirectory::readServerClients
+	// Access:    public
+	// Returns:   std::vector<std::string>
+	// Parameter: const int8_t& inServerIndex
+	//--------------------------------------------------------------------------
+	std::vector<std::string> readServerClients(
+		const int8_t& inServerIndex) const;
+
+	//------------------------------------------------------------- servesClient
+	// Brief Description
+	//  Determines if the given server index serves the client, reading the
+	//  shared slot in place rather than copying it. A slot that cannot be
+	//  read consistently serves nobody.
+	//
+	// Method:    servesClient
+	// FullName:  sharedClientDirectory::servesClient
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const int8_t& inServerIndex
+	// Parameter: const std::string& inClientIdentifier
+	//--------------------------------------------------------------------------
+	bool servesClient(
+		const int8_t& inServerIndex,
+		const std::string& inClientIdentifier) const;
+
+	//--------------------------------------------------------- serverIsAttached
+	// Brief Description
+	//  Determines if the server with the given index runs on this host and
+	//  is currently maintaining its own slot. Such a server reads the
+	//  directory directly, so it does not need to be sent syncs.
+	//
+	// Method:    serverIsAttached
+	// FullName:  sharedClientDirectory::serverIsAttached
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const int8_t& inServerIndex
+	//--------------------------------------------------------------------------
+	bool serverIsAttached(
+		const int8_t& inServerIndex) const;
+
+private:
+
+	// One slot per server. The sequence is odd while a write is in progress,
+	// readers retry until they see the same even sequence before and after
+	// copying. The writer lock holds the process id of the writer, 0 while
+	// the slot is free, so a writer that died holding it can be told apart.
+	struct directorySlot
+	{
+		std::atomic<uint32_t> sequence;
+		std::atomic<int64_t> ownerHeartbeatMilliseconds;
+		std::atomic<int32_t> writerProcessId;
+		uint32_t clientCount;
+		char clients[constants::sharedDirectoryMaximumClientsPerServer]
+			[constants::sharedDirectoryMaximumUsernameLength];
+	};
+
+	struct directoryTable
+	{
+		directorySlot slots[constants::numberOfServers];
+	};
+
+	//-------------------------------------------------------------- currentTime
+	// Brief Description
+	//  Milliseconds since the epoch, used for the owner heartbeat.
+	//
+	// Method:    currentTimeMilliseconds
+	// FullName:  sharedClientDirectory::currentTimeMilliseconds
+	// Access:    private static
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	static int64_t currentTimeMilliseconds();
+
+	//----------------------------------------------------------------- lockSlot
+	// Brief Description
+	//  Takes the writer lock of a slot. Waits for a live holder at most the
+	//  lock timeout, and takes the lock over from a holder whose process is
+	//  gone. Returns false if the lock could not be taken.
+	//
+	// Method:    lockSlot
+	// FullName:  sharedClientDirectory::lockSlot
+	// Access:    private static
+	// Returns:   bool
+	// Parameter: directorySlot& ioSlot
+	//--------------------------------------------------------------------------
+	static bool lockSlot(
+		directorySlot& ioSlot);
+
+	//--------------------------------------------------------- currentProcessId
+	// Brief Description
+	//  Returns the id of this process, as stored in a held writer lock.
+	//
+	// Method:    currentProcessId
+	// FullName:  sharedClientDirectory::currentProcessId
+	// Access:    private static
+	// Returns:   int32_t
+	//--------------------------------------------------------------------------
+	static int32_t currentProcessId();
+
+	//----------------------------------------------------------- processIsAlive
+	// Brief Description
+	//  Determines if the process with the given id is still running.
+	//
+	// Method:    processIsAlive
+	// FullName:  sharedClientDirectory::processIsAlive
+	// Access:    private static
+	// Returns:   bool
+	// Parameter: const int32_t& inProcessId
+	//--------------------------------------------------------------------------
+	static bool processIsAlive(
+		const int32_t& inProcessId);
+
+	// Member Variables
+	boost::interprocess::managed_shared_memory m_segment;
+	directoryTable* m_table;
+	int8_t m_ownerServerIndex;
+};
@@ -0,0 +1,223 @@
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Boost
+#include <boost/bind.hpp>
+
+// Project
+#include "taskPool.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Every deque exists before the first worker starts stealing, and every
+//  worker id is recorded before a task can be submitted
+//------------------------------------------------------------------------------
+taskPool::taskPool(
+	const uint16_t& inWorkers,
+	const int& inNiceness) :
+	m_announcedTasks(0),
+	m_niceness(inNiceness),
+	m_terminate(false)
+{
+	const uint16_t workers = std::max<uint16_t>(inWorkers, 1);
+
+	for(uint16_t i = 0; i < workers; i++)
+	{
+		this->m_deques.push_back(
+			new workStealingDeque(constants::taskPoolDequeCapacity));
+	}
+
+	boost::mutex::scoped_lock lock(this->m_submissionMutex);
+
+	for(uint16_t i = 0; i < workers; i++)
+	{
+		this->m_workerIds.push_back(this->m_threads.create_thread(
+			boost::bind(&taskPool::workerLoop, this, i))->get_id());
+	}
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  Joins the workers before deleting what they share
+//------------------------------------------------------------------------------
+taskPool::~taskPool()
+{
+	{
+		boost::mutex::scoped_lock lock(this->m_submissionMutex);
+
+		this->m_terminate = true;
+	}
+
+	this->m_submissionCondition.notify_all();
+	this->m_threads.join_all();
+
+	for(workStealingDeque* currentDeque : this->m_deques)
+	{
+		delete currentDeque;
+	}
+
+	for(workStealingDeque::task* currentTask : this->m_submissions)
+	{
+		delete currentTask;
+	}
+};
+
+//----------------------------------------------------------------------- submit
+// Implementation notes:
+//  A worker whose deque is full queues the task like an outside thread would.
+//  Every task is counted under the mutex once it can be found, so a worker
+//  that looked before the count changed does not go to sleep on it.
+//------------------------------------------------------------------------------
+void taskPool::submit(
+	const boost::function<void()>& inTask)
+{
+	workStealingDeque::task* newTask = new workStealingDeque::task(inTask);
+
+	const int32_t workerIndex = this->findWorkerIndex();
+
+	const bool pushedToDeque = (workerIndex >= 0)
+		&& this->m_deques[workerIndex]->push(newTask);
+
+	{
+		boost::mutex::scoped_lock lock(this->m_submissionMutex);
+
+		if(!pushedToDeque)
+		{
+			this->m_submissions.push_back(newTask);
+		}
+
+		this->m_announcedTasks++;
+	}
+
+	this->m_submissionCondition.notify_one();
+};
+
+//------------------------------------------------------------------- workerLoop
+// Implementation notes:
+//  Tasks on the deques and the submission queue are both announced through
+//  the count, which the worker reads before it looks for a task. It only
+//  sleeps while the count is unchanged, so a task submitted while it was
+//  looking is never missed. The workers run below the priority of the
+//  network threads where the platform allows it, unless the pool was asked
+//  not to.
+//------------------------------------------------------------------------------
+void taskPool::workerLoop(
+	const uint16_t& inWorkerIndex)
+{
+	{
+		// waits for the constructor to finish recording the worker ids
+		boost::mutex::scoped_lock lock(this->m_submissionMutex);
+	}
+
+#ifdef __linux__
+	// niceness is per thread on Linux
+	if(this->m_niceness != 0)
+	{
+		setpriority(
+			PRIO_PROCESS,
+			static_cast<id_t>(syscall(SYS_gettid)),
+			this->m_niceness);
+	}
+#endif
+
+	while(true)
+	{
+		uint64_t seenAnnouncements = 0;
+
+		{
+			boost::mutex::scoped_lock lock(this->m_submissionMutex);
+
+			seenAnnouncements = this->m_announcedTasks;
+		}
+
+		workStealingDeque::task* currentTask = this->findTask(inWorkerIndex);
+
+		if(currentTask != nullptr)
+		{
+			try
+			{
+				(*currentTask)();
+			}
+			catch(...)
+			{
+
+			}
+
+			delete currentTask;
+			continue;
+		}
+
+		boost::mutex::scoped_lock lock(this->m_submissionMutex);
+
+		while(!this->m_terminate
+			&& (this->m_announcedTasks == seenAnnouncements))
+		{
+			this->m_submissionCondition.wait(lock);
+		}
+
+		if(this->m_terminate)
+		{
+			return;
+		}
+	}
+};
+
+//--------------------------------------------------------------------- findTask
+// Implementation notes:
+//  Own deque newest first, which keeps a task's subtasks on a warm cache,
+//  then outside submissions in order, then the oldest task of another
+//  worker, starting with the next one along so thieves spread out
+//------------------------------------------------------------------------------
+workStealingDeque::task* taskPool::findTask(
+	const uint16_t& inWorkerIndex)
+{
+	workStealingDeque::task* outTask = this->m_deques[inWorkerIndex]->pop();
+
+	if(outTask != nullptr)
+	{
+		return outTask;
+	}
+
+	{
+		boost::mutex::scoped_lock lock(this->m_submissionMutex);
+
+		if(!this->m_submissions.empty())
+		{
+			outTask = this->m_submissions.front();
+			this->m_submissions.pop_front();
+			return outTask;
+		}
+	}
+
+	const size_t workers = this->m_deques.size();
+
+	for(size_t i = 1; (i < workers) && (outTask == nullptr); i++)
+	{
+		outTask = this->m_deques[(inWorkerIndex + i) % workers]->steal();
+	}
+
+	return outTask;
+};
+
+//-------------------------------------------------------------- findWorkerIndex
+// Implementation notes:
+//  A linear search, the pool only has a handful of workers
+//------------------------------------------------------------------------------
+int32_t taskPool::findWorkerIndex() const
+{
+	const boost::thread::id callerId = boost::this_thread::get_id();
+
+	for(size_t i = 0; i < this->m_workerIds.size(); i++)
+	{
+		if(this->m_workerIds[i] == callerId)
+		{
+			return static_cast<int32_t>(i);
+		}
+	}
+
+	return -1;
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Boost
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+
+// Project
+#include "workStealingDeque.h"
+
+class taskPool
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Starts a pool of worker threads for CPU heavy work that should not run
+	//  on the threads handling network traffic. On Linux the workers run at
+	//  the given niceness, 0 leaves them at the priority of the process.
+	//
+	// Method:    taskPool
+	// FullName:  taskPool::taskPool
+	// Access:    public
+	// Returns:
+	// Parameter: const uint16_t& inWorkers
+	// Parameter: const int& inNiceness
+	//--------------------------------------------------------------------------
+	taskPool(
+		const uint16_t& inWorkers,
+		const int& inNiceness);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Stops the workers once they finish the task at hand. Tasks that have
+	//  not started are dropped.
+	//
+	// Method:    ~taskPool
+	// FullName:  taskPool::~taskPool
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~taskPool();
+
+	//------------------------------------------------------------------- submit
+	// Brief Description
+	//  Queues a task to run on one of the workers. A task submitted from a
+	//  worker goes to that worker's own deque, where idle workers can steal
+	//  it, so work split into subtasks spreads over the pool.
+	//
+	// Method:    submit
+	// FullName:  taskPool::submit
+	// Access:    public
+	// Returns:   void
+	// Parameter: const boost::function<void()>& inTask
+	//--------------------------------------------------------------------------
+	void submit(
+		const boost::function<void()>& inTask);
+
+private:
+
+	//--------------------------------------------------------------- workerLoop
+	// Brief Description
+	//  Loop of one worker. Runs tasks from its own deque first, then from the
+	//  queue of submissions from outside the pool, then steals from the
+	//  other workers, and sleeps until the next submission when all of them
+	//  are empty.
+	//
+	// Method:    workerLoop
+	// FullName:  taskPool::workerLoop
+	// Access:    private
+	// Returns:   void
+	// Parameter: const uint16_t& inWorkerIndex
+	//--------------------------------------------------------------------------
+	void workerLoop(
+		const uint16_t& inWorkerIndex);
+
+	//----------------------------------------------------------------- findTask
+	// Brief Description
+	//  Returns the next task for the worker, or nullptr if there is none.
+	//
+	// Method:    findTask
+	// FullName:  taskPool::findTask
+	// Access:    private
+	// Returns:   workStealingDeque::task*
+	// Parameter: const uint16_t& inWorkerIndex
+	//--------------------------------------------------------------------------
+	workStealingDeque::task* findTask(
+		const uint16_t& inWorkerIndex);
+
+	//---------------------------------------------------------- findWorkerIndex
+	// Brief Description
+	//  Returns the index of the worker running on the calling thread, or -1
+	//  if the caller is not one of the workers.
+	//
+	// Method:    findWorkerIndex
+	// FullName:  taskPool::findWorkerIndex
+	// Access:    private
+	// Returns:   int32_t
+	//--------------------------------------------------------------------------
+	int32_t findWorkerIndex() const;
+
+	// Member Variables
+	std::vector<workStealingDeque*> m_deques;
+	std::vector<boost::thread::id> m_workerIds;
+	boost::thread_group m_threads;
+
+	std::deque<workStealingDeque::task*> m_submissions;
+	boost::mutex m_submissionMutex;
+	boost::condition_variable m_submissionCondition;
+
+	// tasks submitted so far, guarded by the submission mutex
+	uint64_t m_announcedTasks;
+
+	int m_niceness;
+	bool m_terminate;
+};
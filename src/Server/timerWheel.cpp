@@ -0,0 +1,287 @@
+// STL
+#include <algorithm>
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Project
+#include "timerWheel.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Slots are allocated up front, 64 per level
+//------------------------------------------------------------------------------
+timerWheel::timerWheel(
+	const int64_t& inCurrentTick,
+	const uint16_t& inLevels) :
+	m_currentTick(inCurrentTick),
+	m_levels(inLevels),
+	m_slots(inLevels, std::vector<std::vector<entry>>(64)),
+	m_occupied(inLevels, 0),
+	m_size(0)
+{
+};
+
+//----------------------------------------------------------------------- insert
+// Implementation notes:
+//  Counts the entry, placing it is shared with cascading
+//------------------------------------------------------------------------------
+void timerWheel::insert(
+	const entry& inEntry)
+{
+	this->place(inEntry);
+
+	this->m_size++;
+};
+
+//---------------------------------------------------------------------- advance
+// Implementation notes:
+//  Jumps from event to event. At each one, overflow entries now within
+//  reach enter the wheel, slots of higher levels that start at this tick
+//  move down, highest level first, and the level 0 slot fires. Every
+//  entry moves down at most once per level, so advancing is O(1) amortized
+//  per entry. The current tick is never processed twice, so it ends one
+//  past the given tick.
+//------------------------------------------------------------------------------
+std::vector<timerWheel::entry> timerWheel::advance(
+	const int64_t& inTick)
+{
+	std::vector<entry> outEntries;
+
+	const uint16_t topShift = 6 * this->m_levels;
+
+	while(true)
+	{
+		const int64_t eventTick = this->nextEventTick();
+
+		if(eventTick > inTick)
+		{
+			break;
+		}
+
+		this->m_currentTick = eventTick;
+
+		while(!this->m_overflow.empty()
+			&& ((this->m_overflow.front().dueTick >> topShift)
+				<= (this->m_currentTick >> topShift)))
+		{
+			std::pop_heap(
+				this->m_overflow.begin(),
+				this->m_overflow.end(),
+				timerWheel::laterEntry);
+
+			this->place(this->m_overflow.back());
+			this->m_overflow.pop_back();
+		}
+
+		for(uint16_t level = this->m_levels - 1; level > 0; level--)
+		{
+			const uint16_t slot = timerWheel::slotOfTick(this->m_currentTick, level);
+
+			if((this->m_occupied[level] & (1ULL << slot)) == 0)
+			{
+				continue;
+			}
+
+			std::vector<entry> cascadingEntries;
+			cascadingEntries.swap(this->m_slots[level][slot]);
+			this->m_occupied[level] &= ~(1ULL << slot);
+
+			for(const entry& currentEntry : cascadingEntries)
+			{
+				this->place(currentEntry);
+			}
+		}
+
+		const uint16_t firingSlot = timerWheel::slotOfTick(this->m_currentTick, 0);
+
+		if((this->m_occupied[0] & (1ULL << firingSlot)) != 0)
+		{
+			std::vector<entry>& firingEntries = this->m_slots[0][firingSlot];
+
+			this->m_size -= firingEntries.size();
+
+			outEntries.insert(
+				outEntries.end(),
+				firingEntries.begin(),
+				firingEntries.end());
+
+			firingEntries.clear();
+			this->m_occupied[0] &= ~(1ULL << firingSlot);
+		}
+
+		this->m_currentTick++;
+	}
+
+	// nothing is due in between, so the ticks up to the given one can be
+	// skipped without moving any entry
+	this->m_currentTick = std::max(this->m_currentTick, inTick + 1);
+
+	return outEntries;
+};
+
+//---------------------------------------------------------------- nextEventTick
+// Implementation notes:
+//  Entries of a level sit in slots at or after its current slot, so the
+//  earliest event of each level is found from the occupancy mask alone
+//------------------------------------------------------------------------------
+int64_t timerWheel::nextEventTick() const
+{
+	int64_t outTick = std::numeric_limits<int64_t>::max();
+
+	for(uint16_t level = 0; level < this->m_levels; level++)
+	{
+		const uint16_t slot = timerWheel::lowestSlot(
+			this->m_occupied[level],
+			timerWheel::slotOfTick(this->m_currentTick, level));
+
+		if(slot == 64)
+		{
+			continue;
+		}
+
+		const int64_t rotationStart =
+			(this->m_currentTick >> (6 * (level + 1))) << (6 * (level + 1));
+
+		outTick = std::min(outTick, std::max(
+			this->m_currentTick,
+			rotationStart + (static_cast<int64_t>(slot) << (6 * level))));
+	}
+
+	if(!this->m_overflow.empty())
+	{
+		const uint16_t topShift = 6 * this->m_levels;
+
+		outTick = std::min(outTick, std::max(
+			this->m_currentTick,
+			(this->m_overflow.front().dueTick >> topShift) << topShift));
+	}
+
+	return outTick;
+};
+
+//------------------------------------------------------------------------- size
+// Implementation notes:
+//  Returns the entry count
+//------------------------------------------------------------------------------
+size_t timerWheel::size() const
+{
+	return this->m_size;
+};
+
+//--------------------------------------------------------------- viewAllEntries
+// Implementation notes:
+//  Walks the occupied slots of every level, then the overflow
+//------------------------------------------------------------------------------
+std::vector<timerWheel::entry> timerWheel::viewAllEntries() const
+{
+	std::vector<entry> outEntries;
+	outEntries.reserve(this->m_size);
+
+	for(uint16_t level = 0; level < this->m_levels; level++)
+	{
+		for(uint16_t slot = timerWheel::lowestSlot(this->m_occupied[level], 0);
+			slot < 64;
+			slot = timerWheel::lowestSlot(this->m_occupied[level], slot + 1))
+		{
+			outEntries.insert(
+				outEntries.end(),
+				this->m_slots[level][slot].begin(),
+				this->m_slots[level][slot].end());
+		}
+	}
+
+	outEntries.insert(
+		outEntries.end(),
+		this->m_overflow.begin(),
+		this->m_overflow.end());
+
+	return outEntries;
+};
+
+//------------------------------------------------------------------------ place
+// Implementation notes:
+//  A level's current rotation is the span of its 64 slots that contains the
+//  current tick. Placing each entry in the lowest level whose rotation holds
+//  it keeps every entry at or after the current slot of its level. Entries
+//  already due go in the current level 0 slot.
+//------------------------------------------------------------------------------
+void timerWheel::place(
+	const entry& inEntry)
+{
+	const int64_t dueTick = std::max(inEntry.dueTick, this->m_currentTick);
+
+	for(uint16_t level = 0; level < this->m_levels; level++)
+	{
+		const uint16_t rotationShift = 6 * (level + 1);
+
+		if((dueTick >> rotationShift) == (this->m_currentTick >> rotationShift))
+		{
+			const uint16_t slot = timerWheel::slotOfTick(dueTick, level);
+
+			this->m_slots[level][slot].push_back(inEntry);
+			this->m_occupied[level] |= (1ULL << slot);
+			return;
+		}
+	}
+
+	this->m_overflow.push_back(inEntry);
+
+	std::push_heap(
+		this->m_overflow.begin(),
+		this->m_overflow.end(),
+		timerWheel::laterEntry);
+};
+
+//------------------------------------------------------------------- laterEntry
+// Implementation notes:
+//  std heaps keep the greatest element on top, so later compares as less
+//------------------------------------------------------------------------------
+bool timerWheel::laterEntry(
+	const entry& inLeft,
+	const entry& inRight)
+{
+	return inLeft.dueTick > inRight.dueTick;
+};
+
+//------------------------------------------------------------------- slotOfTick
+// Implementation notes:
+//  Six bits of the tick per level
+//------------------------------------------------------------------------------
+uint16_t timerWheel::slotOfTick(
+	const int64_t& inTick,
+	const uint16_t& inLevel)
+{
+	return static_cast<uint16_t>((inTick >> (6 * inLevel)) & 63);
+};
+
+//------------------------------------------------------------------- lowestSlot
+// Implementation notes:
+//  Count trailing zeros of the mask with the slots below cleared
+//------------------------------------------------------------------------------
+uint16_t timerWheel::lowestSlot(
+	const uint64_t& inOccupied,
+	const uint16_t& inFromSlot)
+{
+	if(inFromSlot >= 64)
+	{
+		return 64;
+	}
+
+	const uint64_t candidates = inOccupied & (~0ULL << inFromSlot);
+
+	if(candidates == 0)
+	{
+		return 64;
+	}
+
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, candidates);
+	return static_cast<uint16_t>(index);
+#else
+	return static_cast<uint16_t>(__builtin_ctzll(candidates));
+#endif
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// Project
+#include "../Common/dataMessage.h"
+
+class timerWheel
+{
+public:
+
+	// A message waiting in the wheel, due once the wheel reaches its tick
+	struct entry
+	{
+		int64_t identifier;
+		int64_t dueTick;
+		dataMessage message;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a hierarchical timer wheel starting at the given tick.
+	//  Each level has 64 slots, each slot of a level spanning all 64 slots of
+	//  the level below. Entries due beyond the top level wait in an overflow
+	//  min-heap until the wheel comes within reach of them.
+	//
+	// Method:    timerWheel
+	// FullName:  timerWheel::timerWheel
+	// Access:    public
+	// Returns:
+	// Parameter: const int64_t& inCurrentTick
+	// Parameter: const uint16_t& inLevels
+	//--------------------------------------------------------------------------
+	timerWheel(
+		const int64_t& inCurrentTick,
+		const uint16_t& inLevels);
+
+	//------------------------------------------------------------------- insert
+	// Brief Description
+	//  Adds an entry. An entry that is already due fires on the next advance.
+	//
+	// Method:    insert
+	// FullName:  timerWheel::insert
+	// Access:    public
+	// Returns:   void
+	// Parameter: const entry& inEntry
+	//--------------------------------------------------------------------------
+	void insert(
+		const entry& inEntry);
+
+	//------------------------------------------------------------------ advance
+	// Brief Description
+	//  Moves the wheel up to and including the given tick and returns every
+	//  entry that became due, in tick order. Stretches without entries are
+	//  skipped rather than stepped through.
+	//
+	// Method:    advance
+	// FullName:  timerWheel::advance
+	// Access:    public
+	// Returns:   std::vector<timerWheel::entry>
+	// Parameter: const int64_t& inTick
+	//--------------------------------------------------------------------------
+	std::vector<entry> advance(
+		const int64_t& inTick);
+
+	//------------------------------------------------------------ nextEventTick
+	// Brief Description
+	//  Returns the tick at which the wheel next has work to do, firing or
+	//  moving entries down a level, or INT64_MAX if it holds no entries.
+	//
+	// Method:    nextEventTick
+	// FullName:  timerWheel::nextEventTick
+	// Access:    public
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	int64_t nextEventTick() const;
+
+	//--------------------------------------------------------------------- size
+	// Brief Description
+	//  Returns the number of entries waiting, including overflow.
+	//
+	// Method:    size
+	// FullName:  timerWheel::size
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t size() const;
+
+	//----------------------------------------------------------- viewAllEntries
+	// Brief Description
+	//  Returns a copy of every waiting entry, in no particular order.
+	//
+	// Method:    viewAllEntries
+	// FullName:  timerWheel::viewAllEntries
+	// Access:    public
+	// Returns:   std::vector<timerWheel::entry>
+	//--------------------------------------------------------------------------
+	std::vector<entry> viewAllEntries() const;
+
+private:
+
+	//-------------------------------------------------------------------- place
+	// Brief Description
+	//  Puts an entry in the lowest level whose current rotation contains its
+	//  tick, or in the overflow heap if no level does.
+	//
+	// Method:    place
+	// FullName:  timerWheel::place
+	// Access:    private
+	// Returns:   void
+	// Parameter: const entry& inEntry
+	//--------------------------------------------------------------------------
+	void place(
+		const entry& inEntry);
+
+	//--------------------------------------------------------------- laterEntry
+	// Brief Description
+	//  Orders the overflow heap so the earliest entry is on top.
+	//
+	// Method:    laterEntry
+	// FullName:  timerWheel::laterEntry
+	// Access:    private static
+	// Returns:   bool
+	// Parameter: const entry& inLeft
+	// Parameter: const entry& inRight
+	//--------------------------------------------------------------------------
+	static bool laterEntry(
+		const entry& inLeft,
+		const entry& inRight);
+
+	//--------------------------------------------------------------- slotOfTick
+	// Brief Description
+	//  Returns the slot a tick falls in at the given level.
+	//
+	// Method:    slotOfTick
+	// FullName:  timerWheel::slotOfTick
+	// Access:    private static
+	// Returns:   uint16_t
+	// Parameter: const int64_t& inTick
+	// Parameter: const uint16_t& inLevel
+	//--------------------------------------------------------------------------
+	static uint16_t slotOfTick(
+		const int64_t& inTick,
+		const uint16_t& inLevel);
+
+	//--------------------------------------------------------------- lowestSlot
+	// Brief Description
+	//  Returns the lowest occupied slot at or above the given slot in an
+	//  occupancy mask, or 64 if there is none.
+	//
+	// Method:    lowestSlot
+	// FullName:  timerWheel::lowestSlot
+	// Access:    private static
+	// Returns:   uint16_t
+	// Parameter: const uint64_t& inOccupied
+	// Parameter: const uint16_t& inFromSlot
+	//--------------------------------------------------------------------------
+	static uint16_t lowestSlot(
+		const uint64_t& inOccupied,
+		const uint16_t& inFromSlot);
+
+	// Member Variables
+	int64_t m_currentTick;
+	uint16_t m_levels;
+	std::vector<std::vector<std::vector<entry>>> m_slots;
+	std::vector<uint64_t> m_occupied;
+	std::vector<entry> m_overflow;
+	size_t m_size;
+};
@@ -0,0 +1,135 @@
+// Project
+#include "workStealingDeque.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The capacity is rounded up to a power of two so indices wrap with a mask
+//------------------------------------------------------------------------------
+workStealingDeque::workStealingDeque(
+	const uint32_t& inCapacity) :
+	m_top(0),
+	m_bottom(0),
+	m_mask(1)
+{
+	while(this->m_mask < inCapacity)
+	{
+		this->m_mask <<= 1;
+	}
+
+	this->m_tasks = std::vector<std::atomic<task*>>(this->m_mask);
+	this->m_mask--;
+
+	for(std::atomic<task*>& currentSlot : this->m_tasks)
+	{
+		currentSlot.store(nullptr, std::memory_order_relaxed);
+	}
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  Only called once every worker has stopped
+//------------------------------------------------------------------------------
+workStealingDeque::~workStealingDeque()
+{
+	for(int64_t i = this->m_top.load(); i < this->m_bottom.load(); i++)
+	{
+		delete this->m_tasks[i & this->m_mask].load();
+	}
+};
+
+//------------------------------------------------------------------------- push
+// Implementation notes:
+//  The release store of the bottom publishes the task to thieves
+//------------------------------------------------------------------------------
+bool workStealingDeque::push(
+	task* inTask)
+{
+	const int64_t bottom = this->m_bottom.load(std::memory_order_relaxed);
+	const int64_t top = this->m_top.load(std::memory_order_acquire);
+
+	if(bottom - top > this->m_mask)
+	{
+		return false;
+	}
+
+	this->m_tasks[bottom & this->m_mask].store(inTask, std::memory_order_relaxed);
+
+	this->m_bottom.store(bottom + 1, std::memory_order_release);
+
+	return true;
+};
+
+//-------------------------------------------------------------------------- pop
+// Implementation notes:
+//  Claims the bottom slot before looking at the top. Only when a single task
+//  is left can a thief take it at the same time, so the owner then races
+//  for it on the top like a thief would.
+//------------------------------------------------------------------------------
+workStealingDeque::task* workStealingDeque::pop()
+{
+	const int64_t bottom = this->m_bottom.load(std::memory_order_relaxed) - 1;
+
+	this->m_bottom.store(bottom, std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	int64_t top = this->m_top.load(std::memory_order_relaxed);
+
+	if(top > bottom)
+	{
+		// empty, undo the claim
+		this->m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	task* outTask = this->m_tasks[bottom & this->m_mask].load(std::memory_order_relaxed);
+
+	if(top == bottom)
+	{
+		if(!this->m_top.compare_exchange_strong(
+			top,
+			top + 1,
+			std::memory_order_seq_cst,
+			std::memory_order_relaxed))
+		{
+			// a thief took the last task
+			outTask = nullptr;
+		}
+
+		this->m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	return outTask;
+};
+
+//------------------------------------------------------------------------ steal
+// Implementation notes:
+//  The task is read before the top is advanced, a thief that loses the race
+//  returns nullptr and tries elsewhere
+//------------------------------------------------------------------------------
+workStealingDeque::task* workStealingDeque::steal()
+{
+	int64_t top = this->m_top.load(std::memory_order_acquire);
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	const int64_t bottom = this->m_bottom.load(std::memory_order_acquire);
+
+	if(top >= bottom)
+	{
+		return nullptr;
+	}
+
+	task* outTask = this->m_tasks[top & this->m_mask].load(std::memory_order_relaxed);
+
+	if(!this->m_top.compare_exchange_strong(
+		top,
+		top + 1,
+		std::memory_order_seq_cst,
+		std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+
+	return outTask;
+};
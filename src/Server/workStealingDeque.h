@@ -0,0 +1,87 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+// Boost
+#include <boost/function.hpp>
+
+class workStealingDeque
+{
+public:
+
+	typedef boost::function<void()> task;
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a Chase-Lev work stealing deque of fixed capacity. The
+	//  owning worker pushes and pops tasks at the bottom, any other worker
+	//  may steal them from the top.
+	//
+	// Method:    workStealingDeque
+	// FullName:  workStealingDeque::workStealingDeque
+	// Access:    public
+	// Returns:
+	// Parameter: const uint32_t& inCapacity
+	//--------------------------------------------------------------------------
+	workStealingDeque(
+		const uint32_t& inCapacity);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Deletes any tasks still in the deque without running them.
+	//
+	// Method:    ~workStealingDeque
+	// FullName:  workStealingDeque::~workStealingDeque
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~workStealingDeque();
+
+	//--------------------------------------------------------------------- push
+	// Brief Description
+	//  Adds a task at the bottom. Only the owning worker calls this. Returns
+	//  false, leaving the task with the caller, if the deque is full.
+	//
+	// Method:    push
+	// FullName:  workStealingDeque::push
+	// Access:    public
+	// Returns:   bool
+	// Parameter: task* inTask
+	//--------------------------------------------------------------------------
+	bool push(
+		task* inTask);
+
+	//---------------------------------------------------------------------- pop
+	// Brief Description
+	//  Takes the newest task from the bottom, or returns nullptr if the deque
+	//  is empty. Only the owning worker calls this.
+	//
+	// Method:    pop
+	// FullName:  workStealingDeque::pop
+	// Access:    public
+	// Returns:   task*
+	//--------------------------------------------------------------------------
+	task* pop();
+
+	//-------------------------------------------------------------------- steal
+	// Brief Description
+	//  Takes the oldest task from the top, or returns nullptr if the deque is
+	//  empty or another thief won the race for it.
+	//
+	// Method:    steal
+	// FullName:  workStealingDeque::steal
+	// Access:    public
+	// Returns:   task*
+	//--------------------------------------------------------------------------
+	task* steal();
+
+private:
+	// Member Variables
+	std::atomic<int64_t> m_top;
+	std::atomic<int64_t> m_bottom;
+	std::vector<std::atomic<task*>> m_tasks;
+	int64_t m_mask;
+};
@@ -0,0 +1,704 @@
+#ifdef __linux__
+
+// STL
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+// Linux
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+
+// Project
+#include "xdpSocket.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The program is attached last, once the socket is in the map, so no
+//  datagram is redirected before something reads them. Until then, and
+//  for any queue without a socket, the program lets them pass to the
+//  kernel. The link holding the program detaches it when closed, also if
+//  the process dies.
+//------------------------------------------------------------------------------
+xdpSocket::xdpSocket(
+	const std::string& inInterfaceName,
+	const uint32_t& inQueueIndex,
+	const uint16_t& inPort) :
+	m_interfaceName(inInterfaceName),
+	m_interfaceIndex(if_nametoindex(inInterfaceName.c_str())),
+	m_queueIndex(inQueueIndex),
+	m_port(inPort),
+	m_mapDescriptor(-1),
+	m_programDescriptor(-1),
+	m_linkDescriptor(-1),
+	m_socketDescriptor(-1),
+	m_umem(nullptr),
+	m_umemLength(0),
+	m_fillRing(),
+	m_completionRing(),
+	m_receiveRing(),
+	m_transmitRing(),
+	m_identification(0)
+{
+	if(this->m_interfaceIndex == 0)
+	{
+		throw std::runtime_error("no network interface named " + inInterfaceName);
+	}
+
+	try
+	{
+		this->loadFilter();
+
+		this->m_socketDescriptor = socket(AF_XDP, SOCK_RAW, 0);
+		xdpSocket::throwIfFailed(this->m_socketDescriptor, "unable to open an AF_XDP socket");
+
+		this->createUmem();
+		this->mapRings();
+
+		const uint32_t frameCount = std::min(
+			constants::xdpFrameCount / 2,
+			constants::xdpRingEntries);
+
+		for(uint32_t i = 0; i < frameCount; i++)
+		{
+			static_cast<uint64_t*>(this->m_fillRing.descriptors)[i] =
+				uint64_t(i) * constants::xdpFrameLength;
+
+			this->m_freeTransmitFrames.push_back(
+				uint64_t(frameCount + i) * constants::xdpFrameLength);
+		}
+
+		this->m_fillRing.localIndex = frameCount;
+		__atomic_store_n(this->m_fillRing.producer, frameCount, __ATOMIC_RELEASE);
+
+		sockaddr_xdp address;
+		std::memset(&address, 0, sizeof(address));
+		address.sxdp_family = AF_XDP;
+		address.sxdp_flags = XDP_COPY;
+		address.sxdp_ifindex = this->m_interfaceIndex;
+		address.sxdp_queue_id = this->m_queueIndex;
+
+		xdpSocket::throwIfFailed(
+			bind(this->m_socketDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)),
+			"unable to bind the AF_XDP socket to " + inInterfaceName);
+
+		union bpf_attr attributes;
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.map_fd = this->m_mapDescriptor;
+		attributes.key = reinterpret_cast<uint64_t>(&this->m_queueIndex);
+		attributes.value = reinterpret_cast<uint64_t>(&this->m_socketDescriptor);
+
+		xdpSocket::bpfCommand(
+			BPF_MAP_UPDATE_ELEM,
+			&attributes,
+			sizeof(attributes),
+			"unable to add the socket to the map");
+
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.link_create.prog_fd = this->m_programDescriptor;
+		attributes.link_create.target_ifindex = this->m_interfaceIndex;
+		attributes.link_create.attach_type = BPF_XDP;
+		attributes.link_create.flags = XDP_FLAGS_SKB_MODE;
+
+		this->m_linkDescriptor = xdpSocket::bpfCommand(
+			BPF_LINK_CREATE,
+			&attributes,
+			sizeof(attributes),
+			"unable to attach the XDP program to " + inInterfaceName);
+	}
+	catch(...)
+	{
+		this->release();
+		throw;
+	}
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  See release
+//------------------------------------------------------------------------------
+xdpSocket::~xdpSocket()
+{
+	this->release();
+};
+
+//--------------------------------------------------------------- viewDescriptor
+// Implementation notes:
+//  Only valid while the socket is open
+//------------------------------------------------------------------------------
+int xdpSocket::viewDescriptor() const
+{
+	return this->m_socketDescriptor;
+};
+
+//---------------------------------------------------------------------- receive
+// Implementation notes:
+//  The payload is copied out so the frame can go straight back on the fill
+//  ring. The program only redirects unfragmented IPv4 UDP without options,
+//  so a frame that is not one, or whose lengths do not add up, is dropped.
+//  Frames skip the kernel's check of their source address, so one claiming
+//  to come from this host's loopback network is dropped the way the kernel
+//  would drop it.
+//------------------------------------------------------------------------------
+bool xdpSocket::receive(
+	std::vector<char>& outBuffer,
+	size_t& outLength,
+	boost::asio::ip::udp::endpoint& outSenderEndpoint)
+{
+	ring& receiveRing = this->m_receiveRing;
+	ring& fillRing = this->m_fillRing;
+
+	while(__atomic_load_n(receiveRing.producer, __ATOMIC_ACQUIRE) != receiveRing.localIndex)
+	{
+		const xdp_desc descriptor =
+			static_cast<const xdp_desc*>(receiveRing.descriptors)[receiveRing.localIndex & receiveRing.mask];
+
+		receiveRing.localIndex++;
+		__atomic_store_n(receiveRing.consumer, receiveRing.localIndex, __ATOMIC_RELEASE);
+
+		const uint8_t* frame = this->m_umem + descriptor.addr;
+
+		const size_t datagramLength = (descriptor.len >= 42)
+			? ((size_t(frame[38]) << 8) | frame[39])
+			: 0;
+
+		const bool isValid = (datagramLength >= 8)
+			&& (42 + datagramLength - 8 <= descriptor.len)
+			&& (frame[26] != 127)
+			&& (datagramLength - 8 <= outBuffer.size());
+
+		if(isValid)
+		{
+			outLength = datagramLength - 8;
+			std::memcpy(outBuffer.data(), frame + 42, outLength);
+
+			outSenderEndpoint = boost::asio::ip::udp::endpoint(
+				boost::asio::ip::address_v4(
+					(uint32_t(frame[26]) << 24) | (uint32_t(frame[27]) << 16)
+					| (uint32_t(frame[28]) << 8) | uint32_t(frame[29])),
+				static_cast<uint16_t>((frame[34] << 8) | frame[35]));
+
+			this->learnRoute(
+				frame,
+				outSenderEndpoint);
+		}
+
+		static_cast<uint64_t*>(fillRing.descriptors)[fillRing.localIndex & fillRing.mask] =
+			descriptor.addr & ~uint64_t(constants::xdpFrameLength - 1);
+
+		fillRing.localIndex++;
+		__atomic_store_n(fillRing.producer, fillRing.localIndex, __ATOMIC_RELEASE);
+
+		if(isValid)
+		{
+			return true;
+		}
+	}
+
+	return false;
+};
+
+//------------------------------------------------------------------------- send
+// Implementation notes:
+//  The reply swaps the link and network addresses of the last datagram
+//  received from the destination. The UDP checksum is left out, which IPv4
+//  allows. Running out of frames first hands the queued datagrams to the
+//  kernel to free some.
+//------------------------------------------------------------------------------
+bool xdpSocket::send(
+	const std::vector<char>& inPayload,
+	const boost::asio::ip::udp::endpoint& inDestination)
+{
+	if((inPayload.size() > constants::xdpFrameLength - 42)
+		|| !inDestination.address().is_v4())
+	{
+		return false;
+	}
+
+	route destinationRoute;
+
+	{
+		boost::lock_guard<boost::mutex> lock(this->m_routesMutex);
+
+		std::map<boost::asio::ip::udp::endpoint, route>::const_iterator found =
+			this->m_routes.find(inDestination);
+
+		if(found == this->m_routes.end())
+		{
+			return false;
+		}
+
+		destinationRoute = found->second;
+	}
+
+	if(this->m_freeTransmitFrames.empty())
+	{
+		this->flush();
+	}
+
+	if(this->m_freeTransmitFrames.empty())
+	{
+		return false;
+	}
+
+	const uint64_t frameAddress = this->m_freeTransmitFrames.back();
+	this->m_freeTransmitFrames.pop_back();
+
+	uint8_t* frame = this->m_umem + frameAddress;
+
+	const uint16_t datagramLength = static_cast<uint16_t>(inPayload.size() + 8);
+	const uint16_t packetLength = datagramLength + 20;
+	const uint32_t destinationAddress = inDestination.address().to_v4().to_ulong();
+
+	// Ethernet
+	std::memcpy(frame, destinationRoute.peerMac, 6);
+	std::memcpy(frame + 6, destinationRoute.localMac, 6);
+	frame[12] = 0x08;
+	frame[13] = 0x00;
+
+	// IPv4, don't fragment
+	frame[14] = 0x45;
+	frame[15] = 0;
+	frame[16] = static_cast<uint8_t>(packetLength >> 8);
+	frame[17] = static_cast<uint8_t>(packetLength);
+	frame[18] = static_cast<uint8_t>(this->m_identification >> 8);
+	frame[19] = static_cast<uint8_t>(this->m_identification);
+	frame[20] = 0x40;
+	frame[21] = 0;
+	frame[22] = 64;
+	frame[23] = 17;
+	frame[24] = 0;
+	frame[25] = 0;
+	std::memcpy(frame + 26, &destinationRoute.localAddress, 4);
+	frame[30] = static_cast<uint8_t>(destinationAddress >> 24);
+	frame[31] = static_cast<uint8_t>(destinationAddress >> 16);
+	frame[32] = static_cast<uint8_t>(destinationAddress >> 8);
+	frame[33] = static_cast<uint8_t>(destinationAddress);
+
+	const uint16_t checksum = xdpSocket::headerChecksum(frame + 14);
+	frame[24] = static_cast<uint8_t>(checksum >> 8);
+	frame[25] = static_cast<uint8_t>(checksum);
+
+	// UDP
+	frame[34] = static_cast<uint8_t>(this->m_port >> 8);
+	frame[35] = static_cast<uint8_t>(this->m_port);
+	frame[36] = static_cast<uint8_t>(inDestination.port() >> 8);
+	frame[37] = static_cast<uint8_t>(inDestination.port());
+	frame[38] = static_cast<uint8_t>(datagramLength >> 8);
+	frame[39] = static_cast<uint8_t>(datagramLength);
+	frame[40] = 0;
+	frame[41] = 0;
+
+	std::memcpy(frame + 42, inPayload.data(), inPayload.size());
+
+	this->m_identification++;
+
+	xdp_desc& descriptor = static_cast<xdp_desc*>(this->m_transmitRing.descriptors)[
+		this->m_transmitRing.localIndex & this->m_transmitRing.mask];
+
+	descriptor.addr = frameAddress;
+	descriptor.len = 42 + static_cast<uint32_t>(inPayload.size());
+	descriptor.options = 0;
+
+	this->m_transmitRing.localIndex++;
+
+	return true;
+};
+
+//------------------------------------------------------------------------ flush
+// Implementation notes:
+//  In copy mode the kernel sends the ring's datagrams during the sendto.
+//  One it could not take yet, with EAGAIN or EBUSY, stays on the ring and
+//  goes out on the next flush.
+//------------------------------------------------------------------------------
+void xdpSocket::flush()
+{
+	__atomic_store_n(this->m_transmitRing.producer, this->m_transmitRing.localIndex, __ATOMIC_RELEASE);
+
+	if(__atomic_load_n(this->m_transmitRing.consumer, __ATOMIC_ACQUIRE) != this->m_transmitRing.localIndex)
+	{
+		sendto(this->m_socketDescriptor, nullptr, 0, MSG_DONTWAIT, nullptr, 0);
+	}
+
+	this->reapCompleted();
+};
+
+//---------------------------------------------------------------------- release
+// Implementation notes:
+//  Closing the link detaches the program before the socket it feeds goes
+//------------------------------------------------------------------------------
+void xdpSocket::release()
+{
+	if(this->m_linkDescriptor >= 0)
+	{
+		close(this->m_linkDescriptor);
+		this->m_linkDescriptor = -1;
+	}
+
+	ring* rings[] = {
+		&this->m_fillRing,
+		&this->m_completionRing,
+		&this->m_receiveRing,
+		&this->m_transmitRing};
+
+	for(ring* currentRing : rings)
+	{
+		if(currentRing->area != nullptr)
+		{
+			munmap(currentRing->area, currentRing->areaLength);
+			currentRing->area = nullptr;
+		}
+	}
+
+	int* descriptors[] = {
+		&this->m_socketDescriptor,
+		&this->m_programDescriptor,
+		&this->m_mapDescriptor};
+
+	for(int* currentDescriptor : descriptors)
+	{
+		if(*currentDescriptor >= 0)
+		{
+			close(*currentDescriptor);
+			*currentDescriptor = -1;
+		}
+	}
+
+	if(this->m_umem != nullptr)
+	{
+		munmap(this->m_umem, this->m_umemLength);
+		this->m_umem = nullptr;
+	}
+};
+
+//------------------------------------------------------------------- loadFilter
+// Implementation notes:
+//  The program is assembled here rather than compiled, so the build needs
+//  neither clang nor libbpf. In the terms of the C it stands for:
+//
+//   if(data + 42 > data_end || ethertype != IPv4 || version_ihl != 0x45
+//      || fragment bits or offset set || protocol != UDP
+//      || destination port != port)
+//       return XDP_PASS;
+//   return bpf_redirect_map(&sockets, rx_queue_index, XDP_PASS);
+//
+//  Fields are read a byte at a time so the comparisons do not depend on the
+//  host's byte order. Every failed check jumps to the final return.
+//------------------------------------------------------------------------------
+void xdpSocket::loadFilter()
+{
+	union bpf_attr attributes;
+	std::memset(&attributes, 0, sizeof(attributes));
+	attributes.map_type = BPF_MAP_TYPE_XSKMAP;
+	attributes.key_size = sizeof(uint32_t);
+	attributes.value_size = sizeof(int);
+	attributes.max_entries = this->m_queueIndex + 1;
+
+	this->m_mapDescriptor = xdpSocket::bpfCommand(
+		BPF_MAP_CREATE,
+		&attributes,
+		sizeof(attributes),
+		"unable to create the AF_XDP socket map");
+
+	const int32_t portHigh = this->m_port >> 8;
+	const int32_t portLow = this->m_port & 0xFF;
+
+	// code, destination register, source register, offset, immediate
+	bpf_insn program[] = {
+		{BPF_ALU64 | BPF_MOV | BPF_X, 6, 1, 0, 0},             // r6 = context
+		{BPF_LDX | BPF_MEM | BPF_W, 2, 1, 0, 0},               // r2 = data
+		{BPF_LDX | BPF_MEM | BPF_W, 3, 1, 4, 0},               // r3 = data_end
+		{BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0},
+		{BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, 42},
+		{BPF_JMP | BPF_JGT | BPF_X, 4, 3, 0, 0},               // headers fit
+		{BPF_LDX | BPF_MEM | BPF_B, 5, 2, 12, 0},
+		{BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, 0x08},            // IPv4
+		{BPF_LDX | BPF_MEM | BPF_B, 5, 2, 13, 0},
+		{BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, 0x00},
+		{BPF_LDX | BPF_MEM | BPF_B, 5, 2, 14, 0},
+		{BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, 0x45},            // no options
+		{BPF_LDX | BPF_MEM | BPF_B, 5, 2, 20, 0},
+		{BPF_ALU64 | BPF_AND | BPF_K, 5, 0, 0, 0x3F},
+		{BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, 0},               // not a fragment
+		{BPF_LDX | BPF_MEM | BPF_B, 5, 2, 21, 0},
+		{BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, 0},
+		{BPF_LDX | BPF_MEM | BPF_B, 5, 2, 23, 0},
+		{BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, 17},              // UDP
+		{BPF_LDX | BPF_MEM | BPF_B, 5, 2, 36, 0},
+		{BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, portHigh},        // to the port
+		{BPF_LDX | BPF_MEM | BPF_B, 5, 2, 37, 0},
+		{BPF_JMP | BPF_JNE | BPF_K, 5, 0, 0, portLow},
+		{BPF_LDX | BPF_MEM | BPF_W, 2, 6, 16, 0},              // r2 = rx_queue_index
+		{BPF_LD | BPF_DW | BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0, this->m_mapDescriptor},
+		{0, 0, 0, 0, 0},
+		{BPF_ALU64 | BPF_MOV | BPF_K, 3, 0, 0, XDP_PASS},
+		{BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map},
+		{BPF_JMP | BPF_EXIT, 0, 0, 0, 0},
+		{BPF_ALU64 | BPF_MOV | BPF_K, 0, 0, 0, XDP_PASS},      // pass
+		{BPF_JMP | BPF_EXIT, 0, 0, 0, 0}};
+
+	const int16_t instructionCount = sizeof(program) / sizeof(program[0]);
+
+	for(int16_t i = 0; i < instructionCount; i++)
+	{
+		if((program[i].code == (BPF_JMP | BPF_JGT | BPF_X))
+			|| (program[i].code == (BPF_JMP | BPF_JNE | BPF_K)))
+		{
+			program[i].off = (instructionCount - 2) - (i + 1);
+		}
+	}
+
+	const char license[] = "Dual BSD/GPL";
+
+	std::memset(&attributes, 0, sizeof(attributes));
+	attributes.prog_type = BPF_PROG_TYPE_XDP;
+	attributes.insns = reinterpret_cast<uint64_t>(program);
+	attributes.insn_cnt = instructionCount;
+	attributes.license = reinterpret_cast<uint64_t>(license);
+
+	this->m_programDescriptor = xdpSocket::bpfCommand(
+		BPF_PROG_LOAD,
+		&attributes,
+		sizeof(attributes),
+		"unable to load the XDP program");
+};
+
+//------------------------------------------------------------------- createUmem
+// Implementation notes:
+//  The frame memory is mapped rather than allocated so it is page aligned
+//------------------------------------------------------------------------------
+void xdpSocket::createUmem()
+{
+	this->m_umemLength = size_t(constants::xdpFrameCount) * constants::xdpFrameLength;
+
+	void* umem = mmap(
+		nullptr,
+		this->m_umemLength,
+		PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS,
+		-1,
+		0);
+
+	if(umem == MAP_FAILED)
+	{
+		throw std::runtime_error("unable to map the AF_XDP frame memory");
+	}
+
+	this->m_umem = static_cast<uint8_t*>(umem);
+
+	xdp_umem_reg registration;
+	std::memset(&registration, 0, sizeof(registration));
+	registration.addr = reinterpret_cast<uint64_t>(this->m_umem);
+	registration.len = this->m_umemLength;
+	registration.chunk_size = constants::xdpFrameLength;
+	registration.headroom = 0;
+
+	xdpSocket::throwIfFailed(
+		setsockopt(this->m_socketDescriptor, SOL_XDP, XDP_UMEM_REG, &registration, sizeof(registration)),
+		"unable to register the AF_XDP frame memory");
+
+	const int ringOptions[] = {
+		XDP_UMEM_FILL_RING,
+		XDP_UMEM_COMPLETION_RING,
+		XDP_RX_RING,
+		XDP_TX_RING};
+
+	for(const int& currentOption : ringOptions)
+	{
+		const uint32_t entries = constants::xdpRingEntries;
+
+		xdpSocket::throwIfFailed(
+			setsockopt(this->m_socketDescriptor, SOL_XDP, currentOption, &entries, sizeof(entries)),
+			"unable to size the AF_XDP rings");
+	}
+};
+
+//--------------------------------------------------------------------- mapRings
+// Implementation notes:
+//  The kernel reports where in each mapping its indexes and descriptors are
+//------------------------------------------------------------------------------
+void xdpSocket::mapRings()
+{
+	xdp_mmap_offsets offsets;
+	socklen_t offsetsLength = sizeof(offsets);
+
+	xdpSocket::throwIfFailed(
+		getsockopt(this->m_socketDescriptor, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &offsetsLength),
+		"unable to read the AF_XDP ring offsets");
+
+	this->m_receiveRing = this->mapRing(
+		offsets.rx,
+		sizeof(xdp_desc),
+		XDP_PGOFF_RX_RING);
+
+	this->m_transmitRing = this->mapRing(
+		offsets.tx,
+		sizeof(xdp_desc),
+		XDP_PGOFF_TX_RING);
+
+	this->m_fillRing = this->mapRing(
+		offsets.fr,
+		sizeof(uint64_t),
+		XDP_UMEM_PGOFF_FILL_RING);
+
+	this->m_completionRing = this->mapRing(
+		offsets.cr,
+		sizeof(uint64_t),
+		XDP_UMEM_PGOFF_COMPLETION_RING);
+};
+
+//---------------------------------------------------------------------- mapRing
+// Implementation notes:
+//  Every ring has the same number of entries, a power of two, so an index
+//  is turned into a slot with the mask
+//------------------------------------------------------------------------------
+xdpSocket::ring xdpSocket::mapRing(
+	const xdp_ring_offset& inOffsets,
+	const size_t& inDescriptorLength,
+	const uint64_t& inPageOffset)
+{
+	ring outRing;
+	outRing.areaLength = inOffsets.desc + constants::xdpRingEntries * inDescriptorLength;
+
+	outRing.area = mmap(
+		nullptr,
+		outRing.areaLength,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		this->m_socketDescriptor,
+		inPageOffset);
+
+	if(outRing.area == MAP_FAILED)
+	{
+		throw std::runtime_error("unable to map an AF_XDP ring");
+	}
+
+	uint8_t* area = static_cast<uint8_t*>(outRing.area);
+
+	outRing.producer = reinterpret_cast<uint32_t*>(area + inOffsets.producer);
+	outRing.consumer = reinterpret_cast<uint32_t*>(area + inOffsets.consumer);
+	outRing.descriptors = area + inOffsets.desc;
+	outRing.mask = constants::xdpRingEntries - 1;
+	outRing.localIndex = 0;
+
+	return outRing;
+};
+
+//---------------------------------------------------------------- reapCompleted
+// Implementation notes:
+//  The kernel returns each frame it sent once, at the address it was sent from
+//------------------------------------------------------------------------------
+void xdpSocket::reapCompleted()
+{
+	ring& completionRing = this->m_completionRing;
+
+	const uint32_t produced = __atomic_load_n(completionRing.producer, __ATOMIC_ACQUIRE);
+
+	while(completionRing.localIndex != produced)
+	{
+		this->m_freeTransmitFrames.push_back(
+			static_cast<const uint64_t*>(completionRing.descriptors)[completionRing.localIndex & completionRing.mask]);
+
+		completionRing.localIndex++;
+	}
+
+	__atomic_store_n(completionRing.consumer, completionRing.localIndex, __ATOMIC_RELEASE);
+};
+
+//------------------------------------------------------------------- learnRoute
+// Implementation notes:
+//  Consecutive datagrams from one sender skip the lock. The routes are
+//  forgotten all at once when full, and learned again as datagrams arrive.
+//------------------------------------------------------------------------------
+void xdpSocket::learnRoute(
+	const uint8_t* inFrame,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	if(inSenderEndpoint == this->m_lastSenderEndpoint)
+	{
+		return;
+	}
+
+	route senderRoute;
+	std::memcpy(senderRoute.localMac, inFrame, 6);
+	std::memcpy(senderRoute.peerMac, inFrame + 6, 6);
+	std::memcpy(&senderRoute.localAddress, inFrame + 30, 4);
+
+	boost::lock_guard<boost::mutex> lock(this->m_routesMutex);
+
+	if(this->m_routes.size() >= constants::xdpRouteCapacity)
+	{
+		this->m_routes.clear();
+	}
+
+	this->m_routes[inSenderEndpoint] = senderRoute;
+	this->m_lastSenderEndpoint = inSenderEndpoint;
+};
+
+//--------------------------------------------------------------- headerChecksum
+// Implementation notes:
+//  One's complement sum of the header's ten words, its checksum zeroed
+//------------------------------------------------------------------------------
+uint16_t xdpSocket::headerChecksum(
+	const uint8_t* inHeader)
+{
+	uint32_t sum = 0;
+
+	for(int i = 0; i < 20; i += 2)
+	{
+		sum += (uint32_t(inHeader[i]) << 8) | inHeader[i + 1];
+	}
+
+	while((sum >> 16) != 0)
+	{
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+
+	return static_cast<uint16_t>(~sum);
+};
+
+//------------------------------------------------------------------- bpfCommand
+// Implementation notes:
+//  glibc has no wrapper for bpf
+//------------------------------------------------------------------------------
+int xdpSocket::bpfCommand(
+	const int& inCommand,
+	void* inAttributes,
+	const size_t& inLength,
+	const std::string& inDescription)
+{
+	const int result = static_cast<int>(syscall(
+		__NR_bpf,
+		inCommand,
+		inAttributes,
+		inLength));
+
+	xdpSocket::throwIfFailed(
+		result,
+		inDescription);
+
+	return result;
+};
+
+//---------------------------------------------------------------- throwIfFailed
+// Implementation notes:
+//  errno is read before anything else can change it
+//------------------------------------------------------------------------------
+void xdpSocket::throwIfFailed(
+	const int& inResult,
+	const std::string& inDescription)
+{
+	if(inResult < 0)
+	{
+		throw std::runtime_error(inDescription + ": " + std::strerror(errno));
+	}
+};
+
+#endif
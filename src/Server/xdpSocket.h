@@ -0,0 +1,310 @@
+#pragma once
+
+#ifdef __linux__
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+// Linux
+#include <linux/if_xdp.h>
+
+class xdpSocket
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Opens an AF_XDP socket in copy mode on one queue of a network
+	//  interface, and attaches an XDP program to the interface that hands
+	//  the socket the unfragmented IPv4 UDP datagrams for the port. Other
+	//  traffic takes the kernel's path as before. Throws if the kernel
+	//  refuses any of it, which needs Linux 5.9 and CAP_NET_ADMIN.
+	//
+	// Method:    xdpSocket
+	// FullName:  xdpSocket::xdpSocket
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inInterfaceName
+	// Parameter: const uint32_t& inQueueIndex
+	// Parameter: const uint16_t& inPort
+	//--------------------------------------------------------------------------
+	xdpSocket(
+		const std::string& inInterfaceName,
+		const uint32_t& inQueueIndex,
+		const uint16_t& inPort);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Detaches the XDP program and closes the socket.
+	//
+	// Method:    ~xdpSocket
+	// FullName:  xdpSocket::~xdpSocket
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~xdpSocket();
+
+	//----------------------------------------------------------- viewDescriptor
+	// Brief Description
+	//  Returns the descriptor of the socket, which polls readable while
+	//  received datagrams wait.
+	//
+	// Method:    viewDescriptor
+	// FullName:  xdpSocket::viewDescriptor
+	// Access:    public
+	// Returns:   int
+	//--------------------------------------------------------------------------
+	int viewDescriptor() const;
+
+	//------------------------------------------------------------------ receive
+	// Brief Description
+	//  Copies the payload of the next received datagram into the buffer,
+	//  which must hold the largest UDP payload, and returns true. Returns
+	//  false without blocking if none is waiting. Datagrams from a loopback
+	//  address are dropped. Only one thread may call this.
+	//
+	// Method:    receive
+	// FullName:  xdpSocket::receive
+	// Access:    public
+	// Returns:   bool
+	// Parameter: std::vector<char>& outBuffer
+	// Parameter: size_t& outLength
+	// Parameter: boost::asio::ip::udp::endpoint& outSenderEndpoint
+	//--------------------------------------------------------------------------
+	bool receive(
+		std::vector<char>& outBuffer,
+		size_t& outLength,
+		boost::asio::ip::udp::endpoint& outSenderEndpoint);
+
+	//--------------------------------------------------------------------- send
+	// Brief Description
+	//  Queues a datagram from the port to an endpoint a datagram was
+	//  received from, and returns true. Returns false if the endpoint was
+	//  never seen, the payload does not fit a frame or no frame frees up,
+	//  and the caller should send it through the kernel. Queued datagrams
+	//  go out on flush. Only one thread may call this and flush.
+	//
+	// Method:    send
+	// FullName:  xdpSocket::send
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const std::vector<char>& inPayload
+	// Parameter: const boost::asio::ip::udp::endpoint& inDestination
+	//--------------------------------------------------------------------------
+	bool send(
+		const std::vector<char>& inPayload,
+		const boost::asio::ip::udp::endpoint& inDestination);
+
+	//-------------------------------------------------------------------- flush
+	// Brief Description
+	//  Hands the datagrams queued by send to the kernel.
+	//
+	// Method:    flush
+	// FullName:  xdpSocket::flush
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flush();
+
+	//----------------------------------------------------------- headerChecksum
+	// Brief Description
+	//  Returns the checksum of an IPv4 header without options, its own
+	//  checksum field zeroed.
+	//
+	// Method:    headerChecksum
+	// FullName:  xdpSocket::headerChecksum
+	// Access:    public static
+	// Returns:   uint16_t
+	// Parameter: const uint8_t* inHeader
+	//--------------------------------------------------------------------------
+	static uint16_t headerChecksum(
+		const uint8_t* inHeader);
+
+private:
+
+	// The link and network addresses a reply to an endpoint is sent with,
+	// swapped from the last datagram received from it
+	struct route
+	{
+		uint8_t localMac[6];
+		uint8_t peerMac[6];
+		uint32_t localAddress;
+	};
+
+	// One of the four rings shared with the kernel. This side takes or adds
+	// descriptors at the local index, and publishes it to the kernel.
+	struct ring
+	{
+		void* area;
+		size_t areaLength;
+		uint32_t* producer;
+		uint32_t* consumer;
+		void* descriptors;
+		uint32_t mask;
+		uint32_t localIndex;
+	};
+
+	//------------------------------------------------------------------ release
+	// Brief Description
+	//  Detaches the program and frees whatever was set up, also when the
+	//  constructor gave up part way.
+	//
+	// Method:    release
+	// FullName:  xdpSocket::release
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void release();
+
+	//--------------------------------------------------------------- loadFilter
+	// Brief Description
+	//  Creates the map of sockets by queue and loads the program that
+	//  redirects datagrams for the port to the socket of their queue.
+	//
+	// Method:    loadFilter
+	// FullName:  xdpSocket::loadFilter
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void loadFilter();
+
+	//--------------------------------------------------------------- createUmem
+	// Brief Description
+	//  Registers the frame memory with the socket and sizes its rings.
+	//
+	// Method:    createUmem
+	// FullName:  xdpSocket::createUmem
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void createUmem();
+
+	//----------------------------------------------------------------- mapRings
+	// Brief Description
+	//  Maps the four rings of the socket into the process.
+	//
+	// Method:    mapRings
+	// FullName:  xdpSocket::mapRings
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void mapRings();
+
+	//------------------------------------------------------------------ mapRing
+	// Brief Description
+	//  Maps one ring of the given number of descriptors of the given length
+	//  at the page offset, with the offsets the kernel reported for it.
+	//
+	// Method:    mapRing
+	// FullName:  xdpSocket::mapRing
+	// Access:    private
+	// Returns:   xdpSocket::ring
+	// Parameter: const xdp_ring_offset& inOffsets
+	// Parameter: const size_t& inDescriptorLength
+	// Parameter: const uint64_t& inPageOffset
+	//--------------------------------------------------------------------------
+	ring mapRing(
+		const xdp_ring_offset& inOffsets,
+		const size_t& inDescriptorLength,
+		const uint64_t& inPageOffset);
+
+	//------------------------------------------------------------ reapCompleted
+	// Brief Description
+	//  Returns the frames of sent datagrams to the free send frames.
+	//
+	// Method:    reapCompleted
+	// FullName:  xdpSocket::reapCompleted
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void reapCompleted();
+
+	//--------------------------------------------------------------- learnRoute
+	// Brief Description
+	//  Records how to reach the sender of a received frame.
+	//
+	// Method:    learnRoute
+	// FullName:  xdpSocket::learnRoute
+	// Access:    private
+	// Returns:   void
+	// Parameter: const uint8_t* inFrame
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void learnRoute(
+		const uint8_t* inFrame,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//--------------------------------------------------------------- bpfCommand
+	// Brief Description
+	//  Issues a bpf command and returns its result, throwing with the
+	//  description if it fails.
+	//
+	// Method:    bpfCommand
+	// FullName:  xdpSocket::bpfCommand
+	// Access:    private static
+	// Returns:   int
+	// Parameter: const int& inCommand
+	// Parameter: void* inAttributes
+	// Parameter: const size_t& inLength
+	// Parameter: const std::string& inDescription
+	//--------------------------------------------------------------------------
+	static int bpfCommand(
+		const int& inCommand,
+		void* inAttributes,
+		const size_t& inLength,
+		const std::string& inDescription);
+
+	//------------------------------------------------------------ throwIfFailed
+	// Brief Description
+	//  Throws with the description and the system's error if a system call
+	//  returned a negative result.
+	//
+	// Method:    throwIfFailed
+	// FullName:  xdpSocket::throwIfFailed
+	// Access:    private static
+	// Returns:   void
+	// Parameter: const int& inResult
+	// Parameter: const std::string& inDescription
+	//--------------------------------------------------------------------------
+	static void throwIfFailed(
+		const int& inResult,
+		const std::string& inDescription);
+
+	// Member Variables
+	std::string m_interfaceName;
+	uint32_t m_interfaceIndex;
+	uint32_t m_queueIndex;
+	uint16_t m_port;
+
+	int m_mapDescriptor;
+	int m_programDescriptor;
+	int m_linkDescriptor;
+	int m_socketDescriptor;
+
+	// the frames, the first half for receiving and the rest for sending
+	uint8_t* m_umem;
+	size_t m_umemLength;
+
+	ring m_fillRing;
+	ring m_completionRing;
+	ring m_receiveRing;
+	ring m_transmitRing;
+
+	// only the sending thread touches these
+	std::vector<uint64_t> m_freeTransmitFrames;
+	uint16_t m_identification;
+
+	// the receiving thread adds routes, the sending thread reads them
+	std::map<boost::asio::ip::udp::endpoint, route> m_routes;
+	boost::asio::ip::udp::endpoint m_lastSenderEndpoint;
+	boost::mutex m_routesMutex;
+};
+
+#endif
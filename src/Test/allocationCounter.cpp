@@ -0,0 +1,198 @@
+// STL
+#include <new>
+#include <cstdlib>
+#include <fstream>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// Project
+#include "allocationCounter.h"
+
+//------------------------------------------------------------------ operator new
+// Implementation notes:
+//  Only the counter is added to what the default allocation does
+//------------------------------------------------------------------------------
+void* operator new(
+	size_t inLength)
+{
+	char* block = static_cast<char*>(
+		std::malloc(inLength + allocationCounter::headerLength));
+
+	if(block == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	*reinterpret_cast<size_t*>(block) = inLength;
+	allocationCounter::recordAllocation(inLength);
+
+	return block + allocationCounter::headerLength;
+};
+
+//--------------------------------------------------------------- operator delete
+// Implementation notes:
+//  The length comes from the header operator new wrote
+//------------------------------------------------------------------------------
+void operator delete(
+	void* inBlock) noexcept
+{
+	if(inBlock == nullptr)
+	{
+		return;
+	}
+
+	char* block = static_cast<char*>(inBlock) - allocationCounter::headerLength;
+
+	allocationCounter::recordRelease(
+		*reinterpret_cast<size_t*>(block));
+
+	std::free(block);
+};
+
+//-------------------------------------------------------------- operator new[]
+// Implementation notes:
+//  Arrays are counted like single objects
+//------------------------------------------------------------------------------
+void* operator new[](
+	size_t inLength)
+{
+	return operator new(inLength);
+};
+
+//----------------------------------------------------------- operator delete[]
+// Implementation notes:
+//  Arrays are counted like single objects
+//------------------------------------------------------------------------------
+void operator delete[](
+	void* inBlock) noexcept
+{
+	operator delete(inBlock);
+};
+
+//------------------------------------------------------------------ operator new
+// Implementation notes:
+//  The nothrow forms must be replaced too, the library's own would not write
+//  the header the replaced delete reads
+//------------------------------------------------------------------------------
+void* operator new(
+	size_t inLength,
+	const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return operator new(inLength);
+	}
+	catch(...)
+	{
+		return nullptr;
+	}
+};
+
+//-------------------------------------------------------------- operator new[]
+// Implementation notes:
+//  As the nothrow operator new
+//------------------------------------------------------------------------------
+void* operator new[](
+	size_t inLength,
+	const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return operator new(inLength);
+	}
+	catch(...)
+	{
+		return nullptr;
+	}
+};
+
+//--------------------------------------------------------------- operator delete
+// Implementation notes:
+//  The header holds the length already, the one passed in is not needed
+//------------------------------------------------------------------------------
+void operator delete(
+	void* inBlock,
+	size_t) noexcept
+{
+	operator delete(inBlock);
+};
+
+//----------------------------------------------------------- operator delete[]
+// Implementation notes:
+//  As the sized operator delete
+//------------------------------------------------------------------------------
+void operator delete[](
+	void* inBlock,
+	size_t) noexcept
+{
+	operator delete(inBlock);
+};
+
+//------------------------------------------------------------- recordAllocation
+// Implementation notes:
+//  Relaxed, the benchmark reads the counter only once the server has gone
+//  quiet
+//------------------------------------------------------------------------------
+void allocationCounter::recordAllocation(
+	const size_t& inLength)
+{
+	allocationCounter::liveBytes().fetch_add(
+		inLength,
+		std::memory_order_relaxed);
+};
+
+//---------------------------------------------------------------- recordRelease
+// Implementation notes:
+//  Relaxed, as recordAllocation
+//------------------------------------------------------------------------------
+void allocationCounter::recordRelease(
+	const size_t& inLength)
+{
+	allocationCounter::liveBytes().fetch_sub(
+		inLength,
+		std::memory_order_relaxed);
+};
+
+//---------------------------------------------------------------- viewLiveBytes
+// Implementation notes:
+//  Reads the counter
+//------------------------------------------------------------------------------
+int64_t allocationCounter::viewLiveBytes()
+{
+	return allocationCounter::liveBytes().load(
+		std::memory_order_relaxed);
+};
+
+//--------------------------------------------------------- viewResidentSetBytes
+// Implementation notes:
+//  The second field of statm is the resident set in pages
+//------------------------------------------------------------------------------
+int64_t allocationCounter::viewResidentSetBytes()
+{
+#ifdef __linux__
+	std::ifstream statm("/proc/self/statm");
+
+	int64_t totalPages = 0;
+	int64_t residentPages = 0;
+
+	if(statm >> totalPages >> residentPages)
+	{
+		return residentPages * sysconf(_SC_PAGESIZE);
+	}
+#endif
+
+	return 0;
+};
+
+//-------------------------------------------------------------------- liveBytes
+// Implementation notes:
+//  A local static is initialized on first use, whenever that is
+//------------------------------------------------------------------------------
+std::atomic<int64_t>& allocationCounter::liveBytes()
+{
+	static std::atomic<int64_t> liveBytes(0);
+
+	return liveBytes;
+};
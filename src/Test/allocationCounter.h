@@ -0,0 +1,80 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+class allocationCounter
+{
+public:
+
+	// Every block is preceded by its length, in a header as large as the
+	// strictest fundamental alignment so the block keeps that alignment
+	static const size_t headerLength = 16;
+
+	//--------------------------------------------------------- recordAllocation
+	// Brief Description
+	//  Adds a block of the given length to the live bytes.
+	//
+	// Method:    recordAllocation
+	// FullName:  allocationCounter::recordAllocation
+	// Access:    public static
+	// Returns:   void
+	// Parameter: const size_t& inLength
+	//--------------------------------------------------------------------------
+	static void recordAllocation(
+		const size_t& inLength);
+
+	//------------------------------------------------------------ recordRelease
+	// Brief Description
+	//  Takes a block of the given length off the live bytes.
+	//
+	// Method:    recordRelease
+	// FullName:  allocationCounter::recordRelease
+	// Access:    public static
+	// Returns:   void
+	// Parameter: const size_t& inLength
+	//--------------------------------------------------------------------------
+	static void recordRelease(
+		const size_t& inLength);
+
+	//------------------------------------------------------------ viewLiveBytes
+	// Brief Description
+	//  Returns the number of bytes currently allocated with new and not yet
+	//  deleted, counted by the replacement of the global allocation functions
+	//  in the test configuration.
+	//
+	// Method:    viewLiveBytes
+	// FullName:  allocationCounter::viewLiveBytes
+	// Access:    public static
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	static int64_t viewLiveBytes();
+
+	//----------------------------------------------------- viewResidentSetBytes
+	// Brief Description
+	//  Returns the resident set size of this process, or 0 where it cannot be
+	//  read.
+	//
+	// Method:    viewResidentSetBytes
+	// FullName:  allocationCounter::viewResidentSetBytes
+	// Access:    public static
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	static int64_t viewResidentSetBytes();
+
+private:
+
+	//---------------------------------------------------------------- liveBytes
+	// Brief Description
+	//  The counter, created on first use since allocations happen before
+	//  any other static is initialized.
+	//
+	// Method:    liveBytes
+	// FullName:  allocationCounter::liveBytes
+	// Access:    private static
+	// Returns:   std::atomic<int64_t>&
+	//--------------------------------------------------------------------------
+	static std::atomic<int64_t>& liveBytes();
+};
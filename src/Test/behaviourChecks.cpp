@@ -0,0 +1,1063 @@
+// STL
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+
+// Project
+#include "behaviourChecks.h"
+#include "../Server/server.h"
+#include "../Common/crc32c.h"
+#include "../Common/dataMessage.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The deque check sizes the run counts when it starts
+//------------------------------------------------------------------------------
+behaviourChecks::behaviourChecks() :
+	m_sequenceNumber(0),
+	m_finishedTasks(0),
+	m_stopStealing(false)
+{
+
+};
+
+//-------------------------------------------------------------------------- run
+// Implementation notes:
+//  Every check runs even after one fails, so a run shows all that broke
+//------------------------------------------------------------------------------
+bool behaviourChecks::run()
+{
+	bool allPassed = true;
+
+	const bool crcPassed = this->checkCrc32c();
+	std::cout << (crcPassed ? "PASS" : "FAIL") << "  crc32c" << std::endl;
+	allPassed = allPassed && crcPassed;
+
+	const bool batchesPassed = this->checkBatches();
+	std::cout << (batchesPassed ? "PASS" : "FAIL") << "  batches" << std::endl;
+	allPassed = allPassed && batchesPassed;
+
+	const bool dequePassed = this->checkDeque();
+	std::cout << (dequePassed ? "PASS" : "FAIL") << "  deque" << std::endl;
+	allPassed = allPassed && dequePassed;
+
+	const bool poolPassed = this->checkTaskPool();
+	std::cout << (poolPassed ? "PASS" : "FAIL") << "  task pool" << std::endl;
+	allPassed = allPassed && poolPassed;
+
+	const bool handoffsPassed = this->checkHandoffs();
+	std::cout << (handoffsPassed ? "PASS" : "FAIL") << "  handoffs" << std::endl;
+	allPassed = allPassed && handoffsPassed;
+
+	const bool mailboxPassed = this->checkMailbox();
+	std::cout << (mailboxPassed ? "PASS" : "FAIL") << "  mailbox" << std::endl;
+	allPassed = allPassed && mailboxPassed;
+
+	const bool storePassed = this->checkStore();
+	std::cout << (storePassed ? "PASS" : "FAIL") << "  lsm store" << std::endl;
+	allPassed = allPassed && storePassed;
+
+	return allPassed;
+};
+
+//------------------------------------------------------------------- checkStore
+// Implementation notes:
+//  About seven memory tables of values are written, so at least four level
+//  0 segments exist at once and are merged into level 1. The store is
+//  scanned while that merge may still run, and again once the manifest
+//  lists level 1. The pool is deleted before the store, as its owner must.
+//------------------------------------------------------------------------------
+bool behaviourChecks::checkStore()
+{
+	const std::string name("checksStore");
+	const uint32_t keyCount = 12000;
+
+	behaviourChecks::removeStoreFiles(name, 1000);
+
+	std::map<std::string, std::string> model;
+
+	taskPool* pool = new taskPool(1, 0);
+	lsmStore* store = new lsmStore(name, *pool);
+
+	bool passed = true;
+
+	char key[16];
+
+	for(uint32_t round = 0; round < 2; round++)
+	{
+		for(uint32_t i = 0; i < keyCount; i++)
+		{
+			std::snprintf(key, sizeof(key), "key%06u", (round * keyCount) + i);
+
+			const std::string value(
+				std::string(1000, char('a' + (i % 26))) + std::to_string(i));
+
+			store->put(key, value);
+			model[key] = value;
+		}
+
+		// overwrite and erase some of what was just written
+		for(uint32_t i = 0; i < keyCount; i += 5)
+		{
+			std::snprintf(key, sizeof(key), "key%06u", (round * keyCount) + i);
+
+			store->put(key, "overwritten" + std::to_string(i));
+			model[key] = "overwritten" + std::to_string(i);
+		}
+
+		for(uint32_t i = 0; i < keyCount; i += 7)
+		{
+			std::snprintf(key, sizeof(key), "key%06u", (round * keyCount) + i);
+
+			store->erase(key);
+			model.erase(key);
+		}
+	}
+
+	passed = passed && behaviourChecks::compareToModel(*store, model, "", "~");
+
+	const boost::chrono::steady_clock::time_point deadline =
+		boost::chrono::steady_clock::now() + boost::chrono::seconds(60);
+
+	while((behaviourChecks::highestListedLevel(name) < 1)
+		&& (boost::chrono::steady_clock::now() < deadline))
+	{
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+	}
+
+	if(behaviourChecks::highestListedLevel(name) < 1)
+	{
+		std::cout << "  no segment was compacted into level 1" << std::endl;
+		passed = false;
+	}
+
+	passed = passed && behaviourChecks::compareToModel(*store, model, "", "~");
+	passed = passed && behaviourChecks::compareToModel(*store, model, "key005000", "key017500");
+
+	// the last of these is torn off the log below
+	for(uint32_t i = 0; i < 10; i++)
+	{
+		store->put("tail" + std::to_string(i), "value" + std::to_string(i));
+		model["tail" + std::to_string(i)] = "value" + std::to_string(i);
+	}
+
+	store->flushLog();
+
+	delete pool;
+	delete store;
+
+	model.erase("tail9");
+
+	// the log being written is the highest numbered one that exists
+	uint64_t lastLog = 0;
+
+	for(uint64_t i = 0; i < 1000; i++)
+	{
+		if(std::ifstream((name + ".log." + std::to_string(i)).c_str()).good())
+		{
+			lastLog = i;
+		}
+	}
+
+	const std::string lastLogPath(
+		name + ".log." + std::to_string(lastLog));
+
+	std::vector<char> contents;
+
+	{
+		std::ifstream logFile(
+			lastLogPath.c_str(),
+			std::ios::binary);
+
+		contents.assign(
+			(std::istreambuf_iterator<char>(logFile)),
+			std::istreambuf_iterator<char>());
+	}
+
+	if(contents.size() < 3)
+	{
+		std::cout << "  the log holds no records to tear" << std::endl;
+		behaviourChecks::removeStoreFiles(name, 1000);
+		return false;
+	}
+
+	{
+		std::ofstream logFile(
+			lastLogPath.c_str(),
+			std::ios::binary | std::ios::trunc);
+
+		logFile.write(contents.data(), contents.size() - 3);
+	}
+
+	pool = new taskPool(1, 0);
+	store = new lsmStore(name, *pool);
+
+	if(!behaviourChecks::compareToModel(*store, model, "", "~"))
+	{
+		std::cout << "  replay after a torn log record differs" << std::endl;
+		passed = false;
+	}
+
+	// the reopened store takes writes again
+	store->put("tail9", "rewritten");
+	model["tail9"] = "rewritten";
+
+	passed = passed && behaviourChecks::compareToModel(*store, model, "tail", "tailz");
+
+	delete pool;
+	delete store;
+
+	behaviourChecks::removeStoreFiles(name, 1000);
+
+	return passed;
+};
+
+//------------------------------------------------------------------- checkDeque
+// Implementation notes:
+//  The deque is small next to the number of tasks, so the owner runs into
+//  a full deque and into thieves emptying it. The owner pops a task every
+//  few pushes, so pops and steals race for the last tasks.
+//------------------------------------------------------------------------------
+bool behaviourChecks::checkDeque()
+{
+	const uint32_t taskCount = 500000;
+	const uint16_t thieves = 3;
+
+	this->m_taskRuns = std::vector<std::atomic<uint32_t>>(taskCount);
+	this->m_stopStealing.store(false);
+
+	workStealingDeque* deque = new workStealingDeque(256);
+
+	boost::thread_group thiefThreads;
+
+	for(uint16_t i = 0; i < thieves; i++)
+	{
+		thiefThreads.create_thread(
+			boost::bind(&behaviourChecks::stealLoop, this, deque));
+	}
+
+	workStealingDeque::task* currentTask = nullptr;
+
+	for(uint32_t i = 0; i < taskCount; i++)
+	{
+		workStealingDeque::task* newTask = new workStealingDeque::task(
+			boost::bind(&behaviourChecks::markRun, this, i));
+
+		while(!deque->push(newTask))
+		{
+			if((currentTask = deque->pop()) != nullptr)
+			{
+				(*currentTask)();
+				delete currentTask;
+			}
+		}
+
+		if(((i % 3) == 0) && ((currentTask = deque->pop()) != nullptr))
+		{
+			(*currentTask)();
+			delete currentTask;
+		}
+	}
+
+	while((currentTask = deque->pop()) != nullptr)
+	{
+		(*currentTask)();
+		delete currentTask;
+	}
+
+	this->m_stopStealing.store(true);
+	thiefThreads.join_all();
+
+	delete deque;
+
+	uint32_t lost = 0;
+	uint32_t repeated = 0;
+
+	for(uint32_t i = 0; i < taskCount; i++)
+	{
+		const uint32_t runs = this->m_taskRuns[i].load();
+
+		lost += (runs == 0) ? 1 : 0;
+		repeated += (runs > 1) ? 1 : 0;
+	}
+
+	if((lost != 0) || (repeated != 0))
+	{
+		std::cout << "  " << lost << " tasks never ran, "
+			<< repeated << " ran more than once" << std::endl;
+	}
+
+	return (lost == 0) && (repeated == 0);
+};
+
+//---------------------------------------------------------------- checkTaskPool
+// Implementation notes:
+//  The pauses between bursts are long enough for the workers to run out of
+//  work and sleep, so every burst has to wake them
+//------------------------------------------------------------------------------
+bool behaviourChecks::checkTaskPool()
+{
+	const uint32_t halfCount = 50000;
+	const uint32_t burstLength = 500;
+
+	this->m_taskRuns = std::vector<std::atomic<uint32_t>>(2 * halfCount);
+	this->m_finishedTasks.store(0);
+
+	taskPool* pool = new taskPool(4, 0);
+
+	for(uint32_t i = 0; i < halfCount; i++)
+	{
+		pool->submit(
+			boost::bind(&behaviourChecks::markRunAndSplit, this, pool, i, halfCount));
+
+		if((i % burstLength) == (burstLength - 1))
+		{
+			boost::this_thread::sleep_for(
+				boost::chrono::microseconds(200));
+		}
+	}
+
+	const boost::chrono::steady_clock::time_point deadline =
+		boost::chrono::steady_clock::now() + boost::chrono::seconds(10);
+
+	while((this->m_finishedTasks.load() < 2 * halfCount)
+		&& (boost::chrono::steady_clock::now() < deadline))
+	{
+		boost::this_thread::sleep_for(
+			boost::chrono::milliseconds(1));
+	}
+
+	delete pool;
+
+	uint32_t lost = 0;
+	uint32_t repeated = 0;
+
+	for(uint32_t i = 0; i < 2 * halfCount; i++)
+	{
+		const uint32_t runs = this->m_taskRuns[i].load();
+
+		lost += (runs == 0) ? 1 : 0;
+		repeated += (runs > 1) ? 1 : 0;
+	}
+
+	if((lost != 0) || (repeated != 0))
+	{
+		std::cout << "  " << lost << " tasks never ran, "
+			<< repeated << " ran more than once" << std::endl;
+	}
+
+	return (lost == 0) && (repeated == 0);
+};
+
+//------------------------------------------------------------------ checkCrc32c
+// Implementation notes:
+//  0xe3069283 is the CRC32C of "123456789" given with the polynomial. The
+//  longer buffer takes the eight byte loops and the unaligned tails.
+//------------------------------------------------------------------------------
+bool behaviourChecks::checkCrc32c()
+{
+	const std::string checkInput("123456789");
+	const uint32_t checkValue = 0xe3069283;
+
+	bool passed = true;
+
+	if((crc32c::checksum(checkInput.data(), checkInput.size()) != checkValue)
+		|| (crc32c::checksumSlicingBy8(checkInput.data(), checkInput.size()) != checkValue))
+	{
+		std::cout << "  wrong checksum of the check input" << std::endl;
+		passed = false;
+	}
+
+	const uint32_t firstPart = crc32c::checksum(checkInput.data(), 4);
+
+	if(crc32c::checksum(checkInput.data() + 4, 5, firstPart) != checkValue)
+	{
+		std::cout << "  continued checksum differs" << std::endl;
+		passed = false;
+	}
+
+	if(crc32c::asHex(checkValue) != "e3069283")
+	{
+		std::cout << "  wrong hex form of a checksum" << std::endl;
+		passed = false;
+	}
+
+	std::string longInput;
+
+	for(uint32_t i = 0; i < 1000; i++)
+	{
+		longInput.push_back(char((i * 31) + 7));
+	}
+
+	for(size_t offset = 0; offset < 8; offset++)
+	{
+		if(crc32c::checksum(longInput.data() + offset, longInput.size() - offset)
+			!= crc32c::checksumSlicingBy8(longInput.data() + offset, longInput.size() - offset))
+		{
+			std::cout << "  hardware and table checksums differ at offset "
+				<< offset << std::endl;
+			passed = false;
+		}
+	}
+
+	return passed;
+};
+
+//----------------------------------------------------------------- checkBatches
+// Implementation notes:
+//  A corrupt byte must make parsing throw, never return other messages.
+//  Every message carries its checksum trailer, so a flip that lands in a
+//  message and one that breaks the framing are both caught.
+//------------------------------------------------------------------------------
+bool behaviourChecks::checkBatches()
+{
+	std::vector<dataMessage> messages;
+
+	for(int64_t i = 0; i < 8; i++)
+	{
+		messages.push_back(dataMessage(
+			i + 1,
+			constants::mt_CLIENT_SEND,
+			"alice",
+			"bob",
+			"message " + std::to_string(i) + " of the batch"));
+	}
+
+	const std::vector<char> batch(
+		dataMessage::createBatch(messages));
+	const std::vector<char> compressedBatch(
+		dataMessage::createCompressedBatch(batch));
+
+	bool passed = true;
+
+	if(!dataMessage::isBatch(batch) || dataMessage::isCompressedBatch(batch)
+		|| !dataMessage::isCompressedBatch(compressedBatch) || dataMessage::isBatch(compressedBatch))
+	{
+		std::cout << "  batch kinds are not told apart" << std::endl;
+		passed = false;
+	}
+
+	try
+	{
+		const std::vector<dataMessage> fromBatch(
+			dataMessage::parseBatch(batch));
+		const std::vector<dataMessage> fromCompressedBatch(
+			dataMessage::parseCompressedBatch(compressedBatch));
+
+		if((fromBatch.size() != messages.size())
+			|| (fromCompressedBatch.size() != messages.size()))
+		{
+			std::cout << "  round trip changed the number of messages" << std::endl;
+			passed = false;
+		}
+
+		for(size_t i = 0; passed && (i < messages.size()); i++)
+		{
+			if((fromBatch[i].asCharVector() != messages[i].asCharVector())
+				|| (fromCompressedBatch[i].asCharVector() != messages[i].asCharVector()))
+			{
+				std::cout << "  round trip changed message " << i << std::endl;
+				passed = false;
+			}
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		std::cout << "  round trip threw: " << exception.what() << std::endl;
+		passed = false;
+	}
+
+	// each datagram with every byte past its prefix flipped in turn, then cut
+	// short by one byte
+	const std::vector<std::vector<char>> datagrams({batch, compressedBatch});
+	const size_t prefixLengths[] = {
+		constants::batchPrefix().size(),
+		constants::compressedBatchPrefix().size()};
+
+	for(size_t d = 0; d < datagrams.size(); d++)
+	{
+		uint32_t accepted = 0;
+
+		for(size_t position = prefixLengths[d]; position <= datagrams[d].size(); position++)
+		{
+			std::vector<char> corrupt(datagrams[d]);
+
+			if(position < corrupt.size())
+			{
+				corrupt[position] ^= 0x20;
+			}
+			else
+			{
+				corrupt.pop_back();
+			}
+
+			try
+			{
+				if(d == 0)
+				{
+					dataMessage::parseBatch(corrupt);
+				}
+				else
+				{
+					dataMessage::parseCompressedBatch(corrupt);
+				}
+
+				accepted++;
+			}
+			catch(const std::exception&)
+			{
+
+			}
+		}
+
+		if(accepted != 0)
+		{
+			std::cout << "  " << accepted << " corrupt "
+				<< ((d == 0) ? "batches" : "compressed batches")
+				<< " were parsed" << std::endl;
+			passed = false;
+		}
+	}
+
+	return passed;
+};
+
+//---------------------------------------------------------------- checkHandoffs
+// Implementation notes:
+//  Bravo is not started, the check sends from its listening port in its
+//  place. The server's console output is discarded while it runs, the
+//  reason for a failure is printed once it is back.
+//------------------------------------------------------------------------------
+bool behaviourChecks::checkHandoffs()
+{
+	boost::asio::io_service ioService;
+
+	std::streambuf* consoleBuffer = std::cout.rdbuf(nullptr);
+
+	server* checkedServer = new server(
+		constants::serverListeningPorts[0],
+		0,
+		ioService,
+		constants::pipelineDecodeWorkers);
+
+	boost::thread serverThread(
+		boost::bind(&server::run, checkedServer));
+
+	boost::asio::ip::udp::socket clientSocket(
+		ioService,
+		boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+	boost::asio::ip::udp::socket bravoSocket(
+		ioService);
+
+	std::string failure;
+	bool fromClientDelivered = false;
+	bool fromBravoDelivered = false;
+
+	try
+	{
+		bravoSocket.open(boost::asio::ip::udp::v4());
+		bravoSocket.bind(boost::asio::ip::udp::endpoint(
+			boost::asio::ip::address_v4::loopback(),
+			constants::serverListeningPorts[1]));
+
+		const std::string cookie = this->connectSession(
+			clientSocket,
+			"victim");
+
+		// a handoff as Bravo would forward it, one per sender
+		std::vector<std::vector<char>> handoffs;
+
+		for(const char* payload : {"handoff from a client", "handoff from Bravo"})
+		{
+			dataMessage forwardedMessage(
+				this->m_sequenceNumber++,
+				constants::MessageType::mt_CLIENT_SEND,
+				"mallory",
+				"victim",
+				payload);
+
+			forwardedMessage.setServerSyncPayloadOriginIndex(1);
+
+			handoffs.push_back(dataMessage::createCompressedBatch(
+				dataMessage::createBatch({forwardedMessage})));
+		}
+
+		behaviourChecks::exchange(clientSocket, handoffs[0], 200);
+		behaviourChecks::exchange(bravoSocket, handoffs[1], 200);
+
+		for(const dataMessage& reply : this->getFromMailbox(clientSocket, "victim", cookie))
+		{
+			fromClientDelivered = fromClientDelivered
+				|| (reply.viewPayload() == "handoff from a client");
+			fromBravoDelivered = fromBravoDelivered
+				|| (reply.viewPayload() == "handoff from Bravo");
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		failure = exception.what();
+	}
+
+	checkedServer->stop();
+	serverThread.join();
+	delete checkedServer;
+
+	std::cout.rdbuf(consoleBuffer);
+
+	if(!failure.empty())
+	{
+		std::cout << "  " << failure << std::endl;
+		return false;
+	}
+
+	if(fromClientDelivered)
+	{
+		std::cout << "  a handoff from a client was delivered" << std::endl;
+	}
+
+	if(!fromBravoDelivered)
+	{
+		std::cout << "  the handoff from the adjacent server was not delivered" << std::endl;
+	}
+
+	return !fromClientDelivered && fromBravoDelivered;
+};
+
+//----------------------------------------------------------------- checkMailbox
+// Implementation notes:
+//  The messages arrive as a handoff from Bravo, which skips the sender's
+//  session, so both can carry the same sequence number. The server stamps
+//  its own ids over them, and those are what the acknowledgements echo.
+//------------------------------------------------------------------------------
+bool behaviourChecks::checkMailbox()
+{
+	boost::asio::io_service ioService;
+
+	std::streambuf* consoleBuffer = std::cout.rdbuf(nullptr);
+
+	server* checkedServer = new server(
+		constants::serverListeningPorts[0],
+		0,
+		ioService,
+		constants::pipelineDecodeWorkers);
+
+	boost::thread serverThread(
+		boost::bind(&server::run, checkedServer));
+
+	boost::asio::ip::udp::socket clientSocket(
+		ioService,
+		boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+	boost::asio::ip::udp::socket bravoSocket(
+		ioService);
+
+	std::string failure;
+
+	try
+	{
+		bravoSocket.open(boost::asio::ip::udp::v4());
+		bravoSocket.bind(boost::asio::ip::udp::endpoint(
+			boost::asio::ip::address_v4::loopback(),
+			constants::serverListeningPorts[1]));
+
+		const std::string cookie = this->connectSession(
+			clientSocket,
+			"victim");
+
+		std::vector<dataMessage> forwardedMessages;
+
+		for(const char* sender : {"mallory", "trent"})
+		{
+			dataMessage forwardedMessage(
+				7,
+				constants::MessageType::mt_CLIENT_SEND,
+				sender,
+				"victim",
+				std::string("hello from ") + sender);
+
+			forwardedMessage.setServerSyncPayloadOriginIndex(1);
+			forwardedMessages.push_back(forwardedMessage);
+		}
+
+		behaviourChecks::exchange(
+			bravoSocket,
+			dataMessage::createCompressedBatch(dataMessage::createBatch(forwardedMessages)),
+			200);
+
+		const std::vector<dataMessage> delivered(
+			this->getFromMailbox(clientSocket, "victim", cookie));
+
+		if((delivered.size() != 2)
+			|| (delivered[0].viewSequenceNumber() == delivered[1].viewSequenceNumber()))
+		{
+			throw std::runtime_error("the first get did not deliver both messages under their own ids");
+		}
+
+		for(const int64_t acknowledged : {
+			delivered[0].viewSequenceNumber(),
+			delivered[0].viewSequenceNumber(),
+			delivered[1].viewSequenceNumber() + 1000})
+		{
+			const dataMessage ackMessage(
+				acknowledged,
+				constants::MessageType::mt_CLIENT_ACK,
+				"victim",
+				constants::serverIndexToServerName(0),
+				"blank");
+
+			behaviourChecks::exchange(clientSocket, ackMessage.asCharVector(), 50);
+		}
+
+		const std::vector<dataMessage> redelivered(
+			this->getFromMailbox(clientSocket, "victim", cookie));
+
+		if((redelivered.size() != 1)
+			|| (redelivered[0].viewPayload() != delivered[1].viewPayload()))
+		{
+			throw std::runtime_error("the second get did not deliver just the unacknowledged message");
+		}
+
+		const dataMessage ackMessage(
+			redelivered[0].viewSequenceNumber(),
+			constants::MessageType::mt_CLIENT_ACK,
+			"victim",
+			constants::serverIndexToServerName(0),
+			"blank");
+
+		behaviourChecks::exchange(clientSocket, ackMessage.asCharVector(), 50);
+
+		if(!this->getFromMailbox(clientSocket, "victim", cookie).empty())
+		{
+			throw std::runtime_error("the mailbox was not empty once everything was acknowledged");
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		failure = exception.what();
+	}
+
+	checkedServer->stop();
+	serverThread.join();
+	delete checkedServer;
+
+	std::cout.rdbuf(consoleBuffer);
+
+	if(!failure.empty())
+	{
+		std::cout << "  " << failure << std::endl;
+		return false;
+	}
+
+	return true;
+};
+
+//--------------------------------------------------------------- connectSession
+// Implementation notes:
+//  The first pings may reach the server before its threads run
+//------------------------------------------------------------------------------
+std::string behaviourChecks::connectSession(
+	boost::asio::ip::udp::socket& inSocket,
+	const std::string& inUsername)
+{
+	std::string cookie;
+
+	for(int attempt = 0; (attempt < 50) && cookie.empty(); attempt++)
+	{
+		const dataMessage pingMessage(
+			this->m_sequenceNumber++,
+			constants::MessageType::mt_PING,
+			inUsername,
+			constants::serverIndexToServerName(0),
+			"blank");
+
+		for(const dataMessage& reply : behaviourChecks::exchange(inSocket, pingMessage.asCharVector(), 100))
+		{
+			if(reply.viewMessageType() == constants::MessageType::mt_PING)
+			{
+				cookie = reply.viewPayloadField("cookie");
+			}
+		}
+	}
+
+	if(cookie.empty())
+	{
+		throw std::runtime_error("server did not answer the pings");
+	}
+
+	const std::vector<std::string> connectFields({
+		"token=checks",
+		"cookie=" + cookie,
+		dataMessage::capabilitiesField(constants::cap_BATCH)});
+
+	const dataMessage connectMessage(
+		this->m_sequenceNumber++,
+		constants::MessageType::mt_CLIENT_CONNECT,
+		inUsername,
+		constants::serverIndexToServerName(0),
+		dataMessage::createServerSyncPayload(connectFields));
+
+	behaviourChecks::exchange(inSocket, connectMessage.asCharVector(), 200);
+
+	return cookie;
+};
+
+//--------------------------------------------------------------- getFromMailbox
+// Implementation notes:
+//  Pending hints and other replies are left out
+//------------------------------------------------------------------------------
+std::vector<dataMessage> behaviourChecks::getFromMailbox(
+	boost::asio::ip::udp::socket& inSocket,
+	const std::string& inUsername,
+	const std::string& inCookie)
+{
+	const std::vector<std::string> getFields({
+		"cookie=" + inCookie,
+		dataMessage::capabilitiesField(constants::cap_BATCH)});
+
+	const dataMessage getMessage(
+		this->m_sequenceNumber++,
+		constants::MessageType::mt_CLIENT_GET,
+		inUsername,
+		constants::serverIndexToServerName(0),
+		dataMessage::createServerSyncPayload(getFields));
+
+	std::vector<dataMessage> outMessages;
+
+	for(const dataMessage& reply : behaviourChecks::exchange(inSocket, getMessage.asCharVector(), 300))
+	{
+		if(reply.viewMessageType() == constants::MessageType::mt_SERVER_SEND)
+		{
+			outMessages.push_back(reply);
+		}
+	}
+
+	return outMessages;
+};
+
+//--------------------------------------------------------------------- exchange
+// Implementation notes:
+//  Datagrams that do not parse are skipped, the checks look for what they
+//  expect among the rest
+//------------------------------------------------------------------------------
+std::vector<dataMessage> behaviourChecks::exchange(
+	boost::asio::ip::udp::socket& inSocket,
+	const std::vector<char>& inDatagram,
+	const int64_t& inWaitMilliseconds)
+{
+	boost::system::error_code error;
+
+	inSocket.send_to(
+		boost::asio::buffer(inDatagram),
+		boost::asio::ip::udp::endpoint(
+			boost::asio::ip::address_v4::loopback(),
+			constants::serverListeningPorts[0]),
+		0, error);
+
+	std::vector<dataMessage> outMessages;
+	std::vector<char> reply(constants::maximumDatagramLength);
+
+	const boost::chrono::steady_clock::time_point deadline =
+		boost::chrono::steady_clock::now() + boost::chrono::milliseconds(inWaitMilliseconds);
+
+	while(boost::chrono::steady_clock::now() < deadline)
+	{
+		if(inSocket.available(error) == 0)
+		{
+			boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(1));
+			continue;
+		}
+
+		boost::asio::ip::udp::endpoint senderEndpoint;
+
+		const size_t replyLength = inSocket.receive_from(
+			boost::asio::buffer(reply),
+			senderEndpoint, 0, error);
+
+		const std::vector<char> datagram(
+			reply.begin(),
+			reply.begin() + replyLength);
+
+		try
+		{
+			std::vector<dataMessage> messages;
+
+			if(dataMessage::isCompressedBatch(datagram))
+			{
+				messages = dataMessage::parseCompressedBatch(datagram);
+			}
+			else if(dataMessage::isBatch(datagram))
+			{
+				messages = dataMessage::parseBatch(datagram);
+			}
+			else
+			{
+				messages.push_back(dataMessage(datagram));
+			}
+
+			outMessages.insert(outMessages.end(), messages.begin(), messages.end());
+		}
+		catch(...)
+		{
+			// Do nothing, not a message
+		}
+	}
+
+	return outMessages;
+};
+
+//--------------------------------------------------------------- compareToModel
+// Implementation notes:
+//  Walks the scan and the model's range side by side
+//------------------------------------------------------------------------------
+bool behaviourChecks::compareToModel(
+	lsmStore& inStore,
+	const std::map<std::string, std::string>& inModel,
+	const std::string& inFromKey,
+	const std::string& inToKey)
+{
+	const std::vector<lsmStore::record> records(
+		inStore.scan(inFromKey, inToKey));
+
+	std::map<std::string, std::string>::const_iterator expected =
+		inModel.lower_bound(inFromKey);
+	const std::map<std::string, std::string>::const_iterator expectedEnd =
+		inModel.lower_bound(inToKey);
+
+	for(size_t i = 0; i < records.size(); i++, expected++)
+	{
+		if(expected == expectedEnd)
+		{
+			std::cout << "  scan returned the extra key "
+				<< records[i].key << std::endl;
+			return false;
+		}
+
+		if((records[i].key != expected->first) || (records[i].value != expected->second))
+		{
+			std::cout << "  scan returned " << records[i].key << " where "
+				<< expected->first << " was expected, or its value differs" << std::endl;
+			return false;
+		}
+	}
+
+	if(expected != expectedEnd)
+	{
+		std::cout << "  scan is missing the key " << expected->first << std::endl;
+		return false;
+	}
+
+	return true;
+};
+
+//----------------------------------------------------------- highestListedLevel
+// Implementation notes:
+//  Reads the manifest the way the store does
+//------------------------------------------------------------------------------
+int behaviourChecks::highestListedLevel(
+	const std::string& inName)
+{
+	std::ifstream manifest(
+		(inName + ".manifest").c_str());
+
+	int outLevel = -1;
+	std::string field;
+
+	while(manifest >> field)
+	{
+		uint64_t number = 0;
+
+		if(field == "file")
+		{
+			int level = 0;
+
+			manifest >> level >> number;
+			outLevel = std::max(outLevel, level);
+		}
+		else
+		{
+			manifest >> number;
+		}
+	}
+
+	return outLevel;
+};
+
+//------------------------------------------------------------- removeStoreFiles
+// Implementation notes:
+//  Also removes a temporary manifest a crash may have left
+//------------------------------------------------------------------------------
+void behaviourChecks::removeStoreFiles(
+	const std::string& inName,
+	const uint64_t& inHighestNumber)
+{
+	std::remove((inName + ".manifest").c_str());
+	std::remove((inName + ".manifest.tmp").c_str());
+
+	for(uint64_t i = 0; i <= inHighestNumber; i++)
+	{
+		std::remove((inName + "." + std::to_string(i)).c_str());
+		std::remove((inName + ".log." + std::to_string(i)).c_str());
+	}
+};
+
+//-------------------------------------------------------------------- stealLoop
+// Implementation notes:
+//  Keeps stealing until told to stop, which the owner only does once the
+//  deque is empty
+//------------------------------------------------------------------------------
+void behaviourChecks::stealLoop(
+	workStealingDeque* inDeque)
+{
+	while(!this->m_stopStealing.load())
+	{
+		workStealingDeque::task* stolenTask = inDeque->steal();
+
+		if(stolenTask == nullptr)
+		{
+			boost::this_thread::yield();
+			continue;
+		}
+
+		(*stolenTask)();
+		delete stolenTask;
+	}
+};
+
+//-------------------------------------------------------------- markRunAndSplit
+// Implementation notes:
+//  The second half is submitted from a worker, so it goes to its deque
+//------------------------------------------------------------------------------
+void behaviourChecks::markRunAndSplit(
+	taskPool* inPool,
+	const uint32_t& inTaskIndex,
+	const uint32_t& inHalfCount)
+{
+	if(inTaskIndex < inHalfCount)
+	{
+		inPool->submit(boost::bind(
+			&behaviourChecks::markRunAndSplit, this, inPool, inTaskIndex + inHalfCount, inHalfCount));
+	}
+
+	this->markRun(inTaskIndex);
+};
+
+//---------------------------------------------------------------------- markRun
+// Implementation notes:
+//  Counts rather than sets a flag, so a task run twice shows up
+//------------------------------------------------------------------------------
+void behaviourChecks::markRun(
+	const uint32_t& inTaskIndex)
+{
+	this->m_taskRuns[inTaskIndex].fetch_add(1);
+	this->m_finishedTasks.fetch_add(1);
+};
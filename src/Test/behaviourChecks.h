@@ -0,0 +1,294 @@
+#pragma once
+
+// STL
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/asio.hpp>
+
+// Project
+#include "../Common/dataMessage.h"
+#include "../Server/lsmStore.h"
+#include "../Server/taskPool.h"
+#include "../Server/workStealingDeque.h"
+
+class behaviourChecks
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the checks of the behaviour of the storage, scheduling
+	//  and wire encoding code the benchmarks only time.
+	//
+	// Method:    behaviourChecks
+	// FullName:  behaviourChecks::behaviourChecks
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	behaviourChecks();
+
+	//---------------------------------------------------------------------- run
+	// Brief Description
+	//  Runs every check, printing whether each passed and why not, and
+	//  returns false if any failed.
+	//
+	// Method:    run
+	// FullName:  behaviourChecks::run
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool run();
+
+private:
+
+	//--------------------------------------------------------------- checkStore
+	// Brief Description
+	//  Writes, overwrites and erases enough records in an LSM store for its
+	//  memory tables to be sealed, written out and compacted, compares its
+	//  scans with the same writes kept in a map, then tears the last record
+	//  of its log and checks that reopening it replays everything before.
+	//
+	// Method:    checkStore
+	// FullName:  behaviourChecks::checkStore
+	// Access:    private
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool checkStore();
+
+	//--------------------------------------------------------------- checkDeque
+	// Brief Description
+	//  Pushes and pops tasks on a work stealing deque while other threads
+	//  steal from it, and checks that every task ran exactly once.
+	//
+	// Method:    checkDeque
+	// FullName:  behaviourChecks::checkDeque
+	// Access:    private
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool checkDeque();
+
+	//------------------------------------------------------------ checkTaskPool
+	// Brief Description
+	//  Submits tasks to a task pool in bursts from outside, each of which
+	//  submits another from inside, and checks that every task runs exactly
+	//  once before the deadline. Idle workers sleep in between, so a missed
+	//  wakeup shows as tasks left over.
+	//
+	// Method:    checkTaskPool
+	// FullName:  behaviourChecks::checkTaskPool
+	// Access:    private
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool checkTaskPool();
+
+	//-------------------------------------------------------------- checkCrc32c
+	// Brief Description
+	//  Checks both ways of computing CRC32C against the published check
+	//  value, whole and continued over two buffers.
+	//
+	// Method:    checkCrc32c
+	// FullName:  behaviourChecks::checkCrc32c
+	// Access:    private
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool checkCrc32c();
+
+	//------------------------------------------------------------- checkBatches
+	// Brief Description
+	//  Round trips messages through a batch and a compressed batch, and
+	//  checks that every single corrupt byte and a truncation are refused.
+	//
+	// Method:    checkBatches
+	// FullName:  behaviourChecks::checkBatches
+	// Access:    private
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool checkBatches();
+
+	//------------------------------------------------------------ checkHandoffs
+	// Brief Description
+	//  Starts an Alpha server on this host and hands it a compressed batch
+	//  from a client socket and the same batch from the endpoint of Bravo,
+	//  its right adjacent server. Checks that only the one from Bravo
+	//  reaches the mailbox of the connected recipient.
+	//
+	// Method:    checkHandoffs
+	// FullName:  behaviourChecks::checkHandoffs
+	// Access:    private
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool checkHandoffs();
+
+	//------------------------------------------------------------- checkMailbox
+	// Brief Description
+	//  Starts an Alpha server on this host, hands it two messages for a
+	//  connected recipient that carry the same sequence number, and
+	//  acknowledges the first twice along with an id the server never handed
+	//  out. Checks that the second is still delivered, and that nothing is
+	//  left once it is acknowledged too.
+	//
+	// Method:    checkMailbox
+	// FullName:  behaviourChecks::checkMailbox
+	// Access:    private
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool checkMailbox();
+
+	//----------------------------------------------------------- connectSession
+	// Brief Description
+	//  Pings the server until it hands out a cookie, then connects a session
+	//  of the given user that accepts batches, and returns the cookie.
+	//
+	// Method:    connectSession
+	// FullName:  behaviourChecks::connectSession
+	// Access:    private
+	// Returns:   std::string
+	// Parameter: boost::asio::ip::udp::socket& inSocket
+	// Parameter: const std::string& inUsername
+	//--------------------------------------------------------------------------
+	std::string connectSession(
+		boost::asio::ip::udp::socket& inSocket,
+		const std::string& inUsername);
+
+	//----------------------------------------------------------- getFromMailbox
+	// Brief Description
+	//  Sends a get for the session of the given user and returns the
+	//  messages the server delivers in reply.
+	//
+	// Method:    getFromMailbox
+	// FullName:  behaviourChecks::getFromMailbox
+	// Access:    private
+	// Returns:   std::vector<dataMessage>
+	// Parameter: boost::asio::ip::udp::socket& inSocket
+	// Parameter: const std::string& inUsername
+	// Parameter: const std::string& inCookie
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> getFromMailbox(
+		boost::asio::ip::udp::socket& inSocket,
+		const std::string& inUsername,
+		const std::string& inCookie);
+
+	//----------------------------------------------------------------- exchange
+	// Brief Description
+	//  Sends a datagram to the server and returns the messages of every
+	//  datagram received in reply within the given time.
+	//
+	// Method:    exchange
+	// FullName:  behaviourChecks::exchange
+	// Access:    private static
+	// Returns:   std::vector<dataMessage>
+	// Parameter: boost::asio::ip::udp::socket& inSocket
+	// Parameter: const std::vector<char>& inDatagram
+	// Parameter: const int64_t& inWaitMilliseconds
+	//--------------------------------------------------------------------------
+	static std::vector<dataMessage> exchange(
+		boost::asio::ip::udp::socket& inSocket,
+		const std::vector<char>& inDatagram,
+		const int64_t& inWaitMilliseconds);
+
+	//----------------------------------------------------------- compareToModel
+	// Brief Description
+	//  Returns true if a scan of the store from the first key up to but
+	//  excluding the last key returns exactly the records of the model in
+	//  that range, and prints the first difference if not.
+	//
+	// Method:    compareToModel
+	// FullName:  behaviourChecks::compareToModel
+	// Access:    private static
+	// Returns:   bool
+	// Parameter: lsmStore& inStore
+	// Parameter: const std::map<std::string, std::string>& inModel
+	// Parameter: const std::string& inFromKey
+	// Parameter: const std::string& inToKey
+	//--------------------------------------------------------------------------
+	static bool compareToModel(
+		lsmStore& inStore,
+		const std::map<std::string, std::string>& inModel,
+		const std::string& inFromKey,
+		const std::string& inToKey);
+
+	//------------------------------------------------------- highestListedLevel
+	// Brief Description
+	//  Returns the highest level the manifest of the store lists a segment
+	//  in, or -1 if it lists none.
+	//
+	// Method:    highestListedLevel
+	// FullName:  behaviourChecks::highestListedLevel
+	// Access:    private static
+	// Returns:   int
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	static int highestListedLevel(
+		const std::string& inName);
+
+	//--------------------------------------------------------- removeStoreFiles
+	// Brief Description
+	//  Deletes the manifest, logs and segments of the store, numbered up to
+	//  the given number.
+	//
+	// Method:    removeStoreFiles
+	// FullName:  behaviourChecks::removeStoreFiles
+	// Access:    private static
+	// Returns:   void
+	// Parameter: const std::string& inName
+	// Parameter: const uint64_t& inHighestNumber
+	//--------------------------------------------------------------------------
+	static void removeStoreFiles(
+		const std::string& inName,
+		const uint64_t& inHighestNumber);
+
+	//---------------------------------------------------------------- stealLoop
+	// Brief Description
+	//  Steals tasks from the deque and runs them until told to stop.
+	//
+	// Method:    stealLoop
+	// FullName:  behaviourChecks::stealLoop
+	// Access:    private
+	// Returns:   void
+	// Parameter: workStealingDeque* inDeque
+	//--------------------------------------------------------------------------
+	void stealLoop(
+		workStealingDeque* inDeque);
+
+	//------------------------------------------------------------------ markRun
+	// Brief Description
+	//  The task the deque check pushes, counts that it ran.
+	//
+	// Method:    markRun
+	// FullName:  behaviourChecks::markRun
+	// Access:    private
+	// Returns:   void
+	// Parameter: const uint32_t& inTaskIndex
+	//--------------------------------------------------------------------------
+	void markRun(
+		const uint32_t& inTaskIndex);
+
+	//---------------------------------------------------------- markRunAndSplit
+	// Brief Description
+	//  The task the task pool check submits, counts that it ran and submits
+	//  its second half to the pool if it is a first half.
+	//
+	// Method:    markRunAndSplit
+	// FullName:  behaviourChecks::markRunAndSplit
+	// Access:    private
+	// Returns:   void
+	// Parameter: taskPool* inPool
+	// Parameter: const uint32_t& inTaskIndex
+	// Parameter: const uint32_t& inHalfCount
+	//--------------------------------------------------------------------------
+	void markRunAndSplit(
+		taskPool* inPool,
+		const uint32_t& inTaskIndex,
+		const uint32_t& inHalfCount);
+
+	// Member Variables
+	int64_t m_sequenceNumber;
+	std::vector<std::atomic<uint32_t>> m_taskRuns;
+	std::atomic<uint32_t> m_finishedTasks;
+	std::atomic<bool> m_stopStealing;
+};
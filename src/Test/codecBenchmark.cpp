@@ -0,0 +1,217 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Project
+#include "codecBenchmark.h"
+#include "../Common/constants.h"
+#include "../Common/dataMessage.h"
+#include "../Common/crc32c.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Stores the parameters
+//------------------------------------------------------------------------------
+codecBenchmark::codecBenchmark(
+	const int64_t& inIterations) :
+	m_iterations(inIterations),
+	m_sink(0)
+{
+};
+
+//-------------------------------------------------------------------------- run
+// Implementation notes:
+//  Every result feeds the sink, so the compiler cannot drop the work being
+//  timed. The counters are stopped before anything is printed, so they only
+//  see the work of a phase.
+//------------------------------------------------------------------------------
+void codecBenchmark::run()
+{
+	const dataMessage message(
+		42,
+		constants::MessageType::mt_CLIENT_SEND,
+		"alice",
+		"bob",
+		"The quick brown fox jumps over the lazy dog, then asks how the weekend was.");
+
+	const std::vector<char> encodedMessage(
+		message.asCharVector());
+
+	std::vector<dataMessage> batchMessages;
+
+	for(int64_t i = 0; i < 32; i++)
+	{
+		batchMessages.push_back(dataMessage(
+			i,
+			constants::MessageType::mt_CLIENT_SEND,
+			"user" + std::to_string(i % 4),
+			"user" + std::to_string((i + 1) % 4),
+			"message number " + std::to_string(i) + " of the batch"));
+	}
+
+	const std::vector<char> batch(
+		dataMessage::createBatch(batchMessages));
+
+	const std::vector<char> compressedBatch(
+		dataMessage::createCompressedBatch(batch));
+
+	std::cout << "Checksum: " << (crc32c::hardwareAccelerated()
+		? "hardware CRC instructions"
+		: "slicing by 8 tables") << std::endl;
+
+	std::cout << std::fixed << std::setprecision(1);
+
+	this->m_counters.start();
+
+	boost::chrono::steady_clock::time_point timeStarted =
+		boost::chrono::steady_clock::now();
+
+	for(int64_t i = 0; i < this->m_iterations; i++)
+	{
+		this->m_sink += message.asCharVector().size();
+	}
+
+	this->m_counters.stop();
+
+	std::cout << "Encode message (" << encodedMessage.size() << " bytes): "
+		<< (boost::chrono::duration<double, boost::nano>(
+			boost::chrono::steady_clock::now() - timeStarted).count() / this->m_iterations)
+		<< " ns" << std::endl;
+
+	this->m_counters.printPerItem(
+		"message",
+		this->m_iterations);
+
+	this->m_counters.start();
+
+	timeStarted = boost::chrono::steady_clock::now();
+
+	for(int64_t i = 0; i < this->m_iterations; i++)
+	{
+		this->m_sink += dataMessage(encodedMessage).viewPayload().size();
+	}
+
+	this->m_counters.stop();
+
+	std::cout << "Decode message (" << encodedMessage.size() << " bytes): "
+		<< (boost::chrono::duration<double, boost::nano>(
+			boost::chrono::steady_clock::now() - timeStarted).count() / this->m_iterations)
+		<< " ns" << std::endl;
+
+	this->m_counters.printPerItem(
+		"message",
+		this->m_iterations);
+
+	const int64_t batchIterations =
+		std::max<int64_t>(this->m_iterations / batchMessages.size(), 1);
+
+	this->m_counters.start();
+
+	timeStarted = boost::chrono::steady_clock::now();
+
+	for(int64_t i = 0; i < batchIterations; i++)
+	{
+		this->m_sink += dataMessage::parseBatch(batch).size();
+	}
+
+	this->m_counters.stop();
+
+	std::cout << "Decode batch of " << batchMessages.size() << " (" << batch.size() << " bytes): "
+		<< (boost::chrono::duration<double, boost::nano>(
+			boost::chrono::steady_clock::now() - timeStarted).count() / batchIterations)
+		<< " ns" << std::endl;
+
+	this->m_counters.printPerItem(
+		"message",
+		double(batchIterations) * batchMessages.size());
+
+	this->m_counters.start();
+
+	timeStarted = boost::chrono::steady_clock::now();
+
+	for(int64_t i = 0; i < batchIterations; i++)
+	{
+		this->m_sink += dataMessage::parseCompressedBatch(compressedBatch).size();
+	}
+
+	this->m_counters.stop();
+
+	std::cout << "Decode compressed batch of " << batchMessages.size() << " (" << compressedBatch.size() << " bytes): "
+		<< (boost::chrono::duration<double, boost::nano>(
+			boost::chrono::steady_clock::now() - timeStarted).count() / batchIterations)
+		<< " ns" << std::endl;
+
+	this->m_counters.printPerItem(
+		"message",
+		double(batchIterations) * batchMessages.size());
+
+	this->timeChecksums(64);
+	this->timeChecksums(1024);
+	this->timeChecksums(constants::storageBlockLength);
+
+	// printed so the sink is used
+	std::cout << "(" << (this->m_sink & 1) << ")" << std::endl;
+};
+
+//---------------------------------------------------------------- timeChecksums
+// Implementation notes:
+//  The iterations are spread so every length checksums about the same number
+//  of bytes. The previous checksum is fed back in so calls cannot overlap.
+//------------------------------------------------------------------------------
+void codecBenchmark::timeChecksums(
+	const size_t& inLength)
+{
+	std::vector<char> buffer(inLength);
+
+	for(size_t i = 0; i < buffer.size(); i++)
+	{
+		buffer[i] = static_cast<char>(i * 131);
+	}
+
+	const int64_t iterations =
+		std::max<int64_t>(this->m_iterations * 64 / static_cast<int64_t>(inLength), 1);
+
+	const double bytes =
+		static_cast<double>(iterations) * inLength;
+
+	uint32_t checksum = 0;
+
+	boost::chrono::steady_clock::time_point timeStarted =
+		boost::chrono::steady_clock::now();
+
+	for(int64_t i = 0; i < iterations; i++)
+	{
+		checksum = crc32c::checksum(buffer.data(), buffer.size(), checksum);
+	}
+
+	const double acceleratedNanoseconds =
+		boost::chrono::duration<double, boost::nano>(
+			boost::chrono::steady_clock::now() - timeStarted).count();
+
+	timeStarted = boost::chrono::steady_clock::now();
+
+	for(int64_t i = 0; i < iterations; i++)
+	{
+		checksum = crc32c::checksumSlicingBy8(buffer.data(), buffer.size(), checksum);
+	}
+
+	const double tableNanoseconds =
+		boost::chrono::duration<double, boost::nano>(
+			boost::chrono::steady_clock::now() - timeStarted).count();
+
+	this->m_sink += checksum;
+
+	std::cout << std::setprecision(3)
+		<< "Checksum " << std::setw(6) << inLength << " bytes: "
+		<< (acceleratedNanoseconds / bytes) << " ns/byte ("
+		<< (bytes / acceleratedNanoseconds) << " GB/s), slicing by 8 "
+		<< (tableNanoseconds / bytes) << " ns/byte ("
+		<< (bytes / tableNanoseconds) << " GB/s)" << std::endl
+		<< std::setprecision(1);
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <cstddef>
+
+// Project
+#include "perfCounters.h"
+
+class codecBenchmark
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the benchmark of the message codec and checksums.
+	//
+	// Method:    codecBenchmark
+	// FullName:  codecBenchmark::codecBenchmark
+	// Access:    public
+	// Returns:
+	// Parameter: const int64_t& inIterations
+	//--------------------------------------------------------------------------
+	codecBenchmark(
+		const int64_t& inIterations);
+
+	//---------------------------------------------------------------------- run
+	// Brief Description
+	//  Times encoding and decoding of single messages, batches and compressed
+	//  batches, then the checksum over buffers of several lengths with both
+	//  the hardware and the table implementation, and prints the results.
+	//  The codec results come with the hardware counters per message.
+	//
+	// Method:    run
+	// FullName:  codecBenchmark::run
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void run();
+
+private:
+
+	//------------------------------------------------------------ timeChecksums
+	// Brief Description
+	//  Prints the cost per byte of checksumming buffers of the given length.
+	//
+	// Method:    timeChecksums
+	// FullName:  codecBenchmark::timeChecksums
+	// Access:    private
+	// Returns:   void
+	// Parameter: const size_t& inLength
+	//--------------------------------------------------------------------------
+	void timeChecksums(
+		const size_t& inLength);
+
+	// Member Variables
+	int64_t m_iterations;
+	uint64_t m_sink;
+	perfCounters m_counters;
+};
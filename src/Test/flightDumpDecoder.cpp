@@ -0,0 +1,224 @@
+// STL
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <ctime>
+
+// Project
+#include "flightDumpDecoder.h"
+#include "../Common/dataMessage.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The dump is read by run
+//------------------------------------------------------------------------------
+flightDumpDecoder::flightDumpDecoder(
+	const std::string& inPath) :
+	m_path(inPath)
+{
+};
+
+//-------------------------------------------------------------------------- run
+// Implementation notes:
+//  Events are sorted by time, and by thread for equal times since each
+//  thread's events are already in order
+//------------------------------------------------------------------------------
+bool flightDumpDecoder::run()
+{
+	flightRecorder::dump contents;
+
+	try
+	{
+		contents = flightRecorder::readDump(this->m_path);
+	}
+	catch(std::exception& exception)
+	{
+		std::cout << "Cannot decode " << this->m_path << ": " << exception.what() << std::endl;
+		return false;
+	}
+
+	std::vector<std::pair<int64_t, std::pair<size_t, size_t>>> timeline;
+	size_t nameWidth = 0;
+
+	for(size_t i = 0; i < contents.threads.size(); i++)
+	{
+		nameWidth = std::max(nameWidth, contents.threads[i].name.size());
+
+		for(size_t j = 0; j < contents.threads[i].events.size(); j++)
+		{
+			timeline.push_back(std::make_pair(
+				contents.threads[i].events[j].nanoseconds,
+				std::make_pair(i, j)));
+		}
+	}
+
+	std::sort(timeline.begin(), timeline.end());
+
+	const std::time_t triggerSeconds =
+		static_cast<std::time_t>(contents.triggerNanoseconds / 1000000000);
+
+	char triggerTime[32];
+	std::strftime(triggerTime, sizeof(triggerTime), "%Y-%m-%d %H:%M:%S", std::gmtime(&triggerSeconds));
+
+	std::cout << "Flight recorder dump " << this->m_path << std::endl;
+	std::cout << "Triggered at " << triggerTime << "."
+		<< std::setfill('0') << std::setw(6) << (contents.triggerNanoseconds % 1000000000) / 1000
+		<< std::setfill(' ') << " UTC: " << contents.reason << std::endl;
+	std::cout << timeline.size() << " events of " << contents.threads.size()
+		<< " threads, in milliseconds from the trigger" << std::endl;
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	for(const std::pair<int64_t, std::pair<size_t, size_t>>& currentEntry : timeline)
+	{
+		const flightRecorder::threadEvents& currentThread =
+			contents.threads[currentEntry.second.first];
+
+		std::cout << std::setw(12)
+			<< (currentEntry.first - contents.triggerNanoseconds) / 1e6
+			<< "  " << std::left << std::setw(nameWidth) << currentThread.name << std::right
+			<< "  " << flightDumpDecoder::describeEvent(currentThread.events[currentEntry.second.second])
+			<< std::endl;
+	}
+
+	return true;
+};
+
+//---------------------------------------------------------------- describeEvent
+// Implementation notes:
+//  The fields mean what flightRecorder::EventKind says for each kind
+//------------------------------------------------------------------------------
+std::string flightDumpDecoder::describeEvent(
+	const flightRecorder::event& inEvent)
+{
+	std::ostringstream outDescription;
+
+	switch(inEvent.kind)
+	{
+	case flightRecorder::ek_PACKET_IN:
+		outDescription << "packet in, " << inEvent.length << " bytes from "
+			<< flightDumpDecoder::describeEndpoint(inEvent.detail);
+		break;
+
+	case flightRecorder::ek_PACKET_OUT:
+		outDescription << "packet out, " << inEvent.length << " bytes to "
+			<< flightDumpDecoder::describeEndpoint(inEvent.detail);
+
+		if(inEvent.messageType != constants::MessageType::mt_UNDEFINED)
+		{
+			outDescription << ", answering "
+				<< flightDumpDecoder::describeMessageType(inEvent.messageType);
+		}
+		break;
+
+	case flightRecorder::ek_QUEUE_DEPTH:
+	{
+		const char* ringNames[] = {"decode", "state", "egress"};
+		const uint64_t ringKind = inEvent.detail >> 16;
+
+		outDescription << ((ringKind < 3) ? ringNames[ringKind] : "unknown")
+			<< " ring " << (inEvent.detail & 0xFFFF) << " holds "
+			<< inEvent.length << " batches";
+		break;
+	}
+
+	case flightRecorder::ek_ROUTE:
+		outDescription << flightDumpDecoder::describeMessageType(inEvent.messageType)
+			<< " routed";
+
+		if(inEvent.detail == 0)
+		{
+			outDescription << " nowhere";
+		}
+		if(inEvent.detail & flightRecorder::rb_LOCAL)
+		{
+			outDescription << " local";
+		}
+		if(inEvent.detail & flightRecorder::rb_LEFT)
+		{
+			outDescription << " left";
+		}
+		if(inEvent.detail & flightRecorder::rb_RIGHT)
+		{
+			outDescription << " right";
+		}
+		break;
+
+	case flightRecorder::ek_SYNC:
+		outDescription << flightDumpDecoder::describeMessageType(inEvent.messageType)
+			<< " of " << inEvent.length << " clients from "
+			<< ((inEvent.detail < uint64_t(constants::numberOfServers))
+				? constants::serverIndexToServerName(static_cast<uint8_t>(inEvent.detail))
+				: "server " + std::to_string(inEvent.detail));
+		break;
+
+	case flightRecorder::ek_TRIGGER:
+		outDescription << "dump triggered";
+
+		if(inEvent.length == flightRecorder::tr_LATENCY)
+		{
+			outDescription << ", p99 arrival to dispatch " << (inEvent.detail / 1000) << "us";
+		}
+		else if(inEvent.length == flightRecorder::tr_QUEUE_DEPTH)
+		{
+			outDescription << ", " << inEvent.detail << " batches on a ring";
+		}
+		else if(inEvent.length == flightRecorder::tr_EXCEPTION)
+		{
+			outDescription << ", exception swallowed";
+		}
+		break;
+
+	case flightRecorder::ek_PARKED_SCAN:
+		outDescription << "parked scan found " << inEvent.length << " routable, "
+			<< inEvent.detail << " still parked";
+		break;
+
+	default:
+		outDescription << "unknown event kind " << inEvent.kind;
+		break;
+	}
+
+	return outDescription.str();
+};
+
+//------------------------------------------------------------- describeEndpoint
+// Implementation notes:
+//  Inverse of flightRecorder::endpointDetail
+//------------------------------------------------------------------------------
+std::string flightDumpDecoder::describeEndpoint(
+	const uint64_t& inDetail)
+{
+	const uint64_t address = inDetail >> 16;
+
+	std::ostringstream outEndpoint;
+	outEndpoint << ((address >> 24) & 0xFF) << "." << ((address >> 16) & 0xFF) << "."
+		<< ((address >> 8) & 0xFF) << "." << (address & 0xFF) << ":" << (inDetail & 0xFFFF);
+
+	return outEndpoint.str();
+};
+
+//---------------------------------------------------------- describeMessageType
+// Implementation notes:
+//  Named through a message of the type, as the server's statistics are
+//------------------------------------------------------------------------------
+std::string flightDumpDecoder::describeMessageType(
+	const uint16_t& inMessageType)
+{
+	if(inMessageType >= constants::messageTypeCount)
+	{
+		return "message type " + std::to_string(inMessageType);
+	}
+
+	const dataMessage typeName(
+		0,
+		static_cast<constants::MessageType>(inMessageType),
+		"",
+		"",
+		"");
+
+	return typeName.viewMessageTypeAsString();
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+
+// Project
+#include "../Server/flightRecorder.h"
+
+class flightDumpDecoder
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the offline decoder of a flight recorder dump.
+	//
+	// Method:    flightDumpDecoder
+	// FullName:  flightDumpDecoder::flightDumpDecoder
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inPath
+	//--------------------------------------------------------------------------
+	flightDumpDecoder(
+		const std::string& inPath);
+
+	//---------------------------------------------------------------------- run
+	// Brief Description
+	//  Reads the dump and prints why it was triggered, followed by the
+	//  events of every thread merged into one timeline, in milliseconds
+	//  relative to the trigger. Returns false if the file is not a dump.
+	//
+	// Method:    run
+	// FullName:  flightDumpDecoder::run
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool run();
+
+private:
+
+	//------------------------------------------------------------ describeEvent
+	// Brief Description
+	//  Returns an event in words.
+	//
+	// Method:    describeEvent
+	// FullName:  flightDumpDecoder::describeEvent
+	// Access:    private static
+	// Returns:   std::string
+	// Parameter: const flightRecorder::event& inEvent
+	//--------------------------------------------------------------------------
+	static std::string describeEvent(
+		const flightRecorder::event& inEvent);
+
+	//--------------------------------------------------------- describeEndpoint
+	// Brief Description
+	//  Returns the endpoint packed into the detail of a packet event.
+	//
+	// Method:    describeEndpoint
+	// FullName:  flightDumpDecoder::describeEndpoint
+	// Access:    private static
+	// Returns:   std::string
+	// Parameter: const uint64_t& inDetail
+	//--------------------------------------------------------------------------
+	static std::string describeEndpoint(
+		const uint64_t& inDetail);
+
+	//------------------------------------------------------ describeMessageType
+	// Brief Description
+	//  Returns the wire name of a message type, or its number if it is not
+	//  one this build knows.
+	//
+	// Method:    describeMessageType
+	// FullName:  flightDumpDecoder::describeMessageType
+	// Access:    private static
+	// Returns:   std::string
+	// Parameter: const uint16_t& inMessageType
+	//--------------------------------------------------------------------------
+	static std::string describeMessageType(
+		const uint16_t& inMessageType);
+
+	// Member Variables
+	std::string m_path;
+};
@@ -0,0 +1,336 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+
+// Project
+#include "memoryBenchmark.h"
+#include "allocationCounter.h"
+#include "../Server/server.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  A sync carries the users of one server in one datagram, so the remote
+//  users a peer can report are capped at what fits, and there are at most
+//  as many peers as other servers
+//------------------------------------------------------------------------------
+memoryBenchmark::memoryBenchmark(
+	const int64_t& inUsers,
+	const int64_t& inPendingMessagesPerUser,
+	const int64_t& inRemoteUsers,
+	const int8_t& inSyncPeers) :
+	m_users(inUsers),
+	m_pendingMessagesPerUser(inPendingMessagesPerUser),
+	m_syncPeers(std::min<int8_t>(
+		std::max<int8_t>(inSyncPeers, 1),
+		constants::numberOfServers - 1)),
+	m_sequenceNumber(0)
+{
+	this->m_remoteUsers = std::min<int64_t>(
+		inRemoteUsers,
+		int64_t(this->m_syncPeers) * 4000);
+};
+
+//-------------------------------------------------------------------------- run
+// Implementation notes:
+//  The budgets apply to the heap bytes, the resident set grows by whole
+//  pages and keeps memory the allocator has not returned, so it is only
+//  printed. The server's console output is discarded while it runs.
+//------------------------------------------------------------------------------
+bool memoryBenchmark::run()
+{
+	boost::asio::io_service ioService;
+
+	std::streambuf* consoleBuffer = std::cout.rdbuf(nullptr);
+
+	server* benchmarkServer = new server(
+		constants::serverListeningPorts[0],
+		0,
+		ioService,
+		constants::pipelineDecodeWorkers);
+
+	boost::thread serverThread(
+		boost::bind(&server::run, benchmarkServer));
+
+	boost::asio::ip::udp::socket clientSocket(
+		ioService,
+		boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+
+	const std::string cookie(
+		this->waitForServer(clientSocket));
+
+	const memorySample idle = memoryBenchmark::sampleMemory();
+
+	// every user connects from the same socket, one session each
+	std::vector<dataMessage> messages;
+
+	for(int64_t i = 0; i < this->m_users; i++)
+	{
+		const std::vector<std::string> connectFields({
+			"token=bench" + std::to_string(i),
+			"cookie=" + cookie,
+			dataMessage::capabilitiesField(constants::localCapabilities)});
+
+		messages.push_back(dataMessage(
+			this->m_sequenceNumber++,
+			constants::MessageType::mt_CLIENT_CONNECT,
+			"user" + std::to_string(i),
+			constants::serverIndexToServerName(0),
+			dataMessage::createServerSyncPayload(connectFields)));
+	}
+
+	memoryBenchmark::sendInBatches(
+		clientSocket,
+		messages);
+
+	this->waitForServer(clientSocket);
+
+	const memorySample connected = memoryBenchmark::sampleMemory();
+
+	// short text messages, nobody gets them so they all stay in the mailboxes
+	messages.clear();
+
+	for(int64_t i = 0; i < this->m_users * this->m_pendingMessagesPerUser; i++)
+	{
+		messages.push_back(dataMessage(
+			this->m_sequenceNumber++,
+			constants::MessageType::mt_CLIENT_SEND,
+			"sender",
+			"user" + std::to_string(i % std::max<int64_t>(this->m_users, 1)),
+			"pending message number " + std::to_string(i)));
+	}
+
+	memoryBenchmark::sendInBatches(
+		clientSocket,
+		messages);
+
+	this->waitForServer(clientSocket);
+
+	const memorySample filled = memoryBenchmark::sampleMemory();
+
+	for(int8_t peer = 1; peer <= this->m_syncPeers; peer++)
+	{
+		std::vector<std::string> remoteUsers;
+
+		for(int64_t i = peer - 1; i < this->m_remoteUsers; i += this->m_syncPeers)
+		{
+			remoteUsers.push_back("remote" + std::to_string(i));
+		}
+
+		const dataMessage syncMessage(
+			this->m_sequenceNumber++,
+			constants::MessageType::mt_SERVER_SYNC,
+			constants::serverIndexToServerName(peer),
+			constants::serverIndexToServerName(0),
+			remoteUsers,
+			peer);
+
+		boost::system::error_code ignoredError;
+
+		clientSocket.send_to(
+			boost::asio::buffer(syncMessage.asCharVector()),
+			boost::asio::ip::udp::endpoint(
+				boost::asio::ip::address_v4::loopback(),
+				constants::serverListeningPorts[0]),
+			0, ignoredError);
+	}
+
+	this->waitForServer(clientSocket);
+
+	const memorySample synced = memoryBenchmark::sampleMemory();
+
+	benchmarkServer->stop();
+	serverThread.join();
+	delete benchmarkServer;
+
+	std::cout.rdbuf(consoleBuffer);
+
+	std::cout << "Users: " << this->m_users
+		<< ", pending messages: " << this->m_users * this->m_pendingMessagesPerUser
+		<< ", remote users: " << this->m_remoteUsers
+		<< " from " << int(this->m_syncPeers) << " peers" << std::endl;
+
+	std::cout << std::left << std::setw(20) << ""
+		<< std::right << std::setw(12) << "heap bytes"
+		<< std::setw(12) << "rss bytes"
+		<< std::setw(10) << "budget" << std::endl;
+
+	bool withinBudgets = true;
+
+	withinBudgets &= memoryBenchmark::reportCost(
+		"per user",
+		idle,
+		connected,
+		this->m_users,
+		constants::memoryBudgetBytesPerUser);
+
+	withinBudgets &= memoryBenchmark::reportCost(
+		"per pending message",
+		connected,
+		filled,
+		this->m_users * this->m_pendingMessagesPerUser,
+		constants::memoryBudgetBytesPerPendingMessage);
+
+	withinBudgets &= memoryBenchmark::reportCost(
+		"per remote user",
+		filled,
+		synced,
+		this->m_remoteUsers,
+		constants::memoryBudgetBytesPerRemoteUser);
+
+	return withinBudgets;
+};
+
+//---------------------------------------------------------------- waitForServer
+// Implementation notes:
+//  Replies to anything else, the acknowledgements of the sends, are read
+//  and dropped on the way. A lost ping is sent again after 200ms.
+//------------------------------------------------------------------------------
+std::string memoryBenchmark::waitForServer(
+	boost::asio::ip::udp::socket& inSocket)
+{
+	const boost::asio::ip::udp::endpoint serverEndpoint(
+		boost::asio::ip::address_v4::loopback(),
+		constants::serverListeningPorts[0]);
+
+	std::vector<char> reply(constants::maximumDatagramLength);
+
+	for(int attempt = 0; attempt < 100; attempt++)
+	{
+		const int64_t pingSequenceNumber = this->m_sequenceNumber++;
+
+		const dataMessage pingMessage(
+			pingSequenceNumber,
+			constants::MessageType::mt_PING,
+			"sender",
+			constants::serverIndexToServerName(0),
+			"blank");
+
+		boost::system::error_code error;
+
+		inSocket.send_to(
+			boost::asio::buffer(pingMessage.asCharVector()),
+			serverEndpoint, 0, error);
+
+		const boost::chrono::steady_clock::time_point deadline =
+			boost::chrono::steady_clock::now() + boost::chrono::milliseconds(200);
+
+		while(boost::chrono::steady_clock::now() < deadline)
+		{
+			if(inSocket.available(error) == 0)
+			{
+				boost::this_thread::sleep_for(
+					boost::chrono::milliseconds(1));
+				continue;
+			}
+
+			boost::asio::ip::udp::endpoint senderEndpoint;
+
+			const size_t replyLength = inSocket.receive_from(
+				boost::asio::buffer(reply),
+				senderEndpoint, 0, error);
+
+			try
+			{
+				const dataMessage replyMessage(
+					std::vector<char>(reply.begin(), reply.begin() + replyLength));
+
+				if((replyMessage.viewMessageType() == constants::MessageType::mt_PING)
+					&& (replyMessage.viewSequenceNumber() == pingSequenceNumber))
+				{
+					return replyMessage.viewPayloadField("cookie");
+				}
+			}
+			catch(...)
+			{
+				// Do nothing, not the reply being waited for
+			}
+		}
+	}
+
+	throw std::runtime_error("server did not answer the benchmark's pings");
+};
+
+//---------------------------------------------------------------- sendInBatches
+// Implementation notes:
+//  Batches are kept well below the datagram limit, and sending pauses
+//  briefly after each so the server's socket buffer does not overflow
+//------------------------------------------------------------------------------
+void memoryBenchmark::sendInBatches(
+	boost::asio::ip::udp::socket& inSocket,
+	const std::vector<dataMessage>& inMessages)
+{
+	const boost::asio::ip::udp::endpoint serverEndpoint(
+		boost::asio::ip::address_v4::loopback(),
+		constants::serverListeningPorts[0]);
+
+	for(size_t first = 0; first < inMessages.size(); first += 64)
+	{
+		const std::vector<dataMessage> batch(
+			inMessages.begin() + first,
+			inMessages.begin() + std::min<size_t>(first + 64, inMessages.size()));
+
+		boost::system::error_code ignoredError;
+
+		inSocket.send_to(
+			boost::asio::buffer(dataMessage::createBatch(batch)),
+			serverEndpoint, 0, ignoredError);
+
+		boost::this_thread::sleep_for(
+			boost::chrono::microseconds(200));
+	}
+};
+
+//----------------------------------------------------------------- sampleMemory
+// Implementation notes:
+//  Reads both measures at once
+//------------------------------------------------------------------------------
+memoryBenchmark::memorySample memoryBenchmark::sampleMemory()
+{
+	memorySample outSample;
+	outSample.liveBytes = allocationCounter::viewLiveBytes();
+	outSample.residentSetBytes = allocationCounter::viewResidentSetBytes();
+
+	return outSample;
+};
+
+//------------------------------------------------------------------- reportCost
+// Implementation notes:
+//  Nothing added means nothing to measure, which is within budget
+//------------------------------------------------------------------------------
+bool memoryBenchmark::reportCost(
+	const std::string& inItemName,
+	const memorySample& inBefore,
+	const memorySample& inAfter,
+	const int64_t& inItems,
+	const uint32_t& inBudgetBytes)
+{
+	if(inItems <= 0)
+	{
+		return true;
+	}
+
+	const double heapBytes =
+		double(inAfter.liveBytes - inBefore.liveBytes) / inItems;
+
+	const double residentSetBytes =
+		double(inAfter.residentSetBytes - inBefore.residentSetBytes) / inItems;
+
+	const bool withinBudget = (heapBytes <= inBudgetBytes);
+
+	std::cout << std::left << std::setw(20) << inItemName
+		<< std::right << std::fixed << std::setprecision(1)
+		<< std::setw(12) << heapBytes
+		<< std::setw(12) << residentSetBytes
+		<< std::setw(10) << inBudgetBytes
+		<< (withinBudget ? "" : "  over budget") << std::endl;
+
+	return withinBudget;
+};
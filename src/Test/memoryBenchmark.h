@@ -0,0 +1,131 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/asio.hpp>
+
+// Project
+#include "../Common/dataMessage.h"
+
+class memoryBenchmark
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the benchmark of the memory a server needs per user.
+	//
+	// Method:    memoryBenchmark
+	// FullName:  memoryBenchmark::memoryBenchmark
+	// Access:    public
+	// Returns:
+	// Parameter: const int64_t& inUsers
+	// Parameter: const int64_t& inPendingMessagesPerUser
+	// Parameter: const int64_t& inRemoteUsers
+	// Parameter: const int8_t& inSyncPeers
+	//--------------------------------------------------------------------------
+	memoryBenchmark(
+		const int64_t& inUsers,
+		const int64_t& inPendingMessagesPerUser,
+		const int64_t& inRemoteUsers,
+		const int8_t& inSyncPeers);
+
+	//---------------------------------------------------------------------- run
+	// Brief Description
+	//  Starts an Alpha server on this host, connects the synthetic users,
+	//  fills their mailboxes and reports the remote users in syncs from the
+	//  peers, measuring the memory of the process after every step. Prints
+	//  the bytes per user, per pending message and per remote user, and
+	//  returns false if any exceeds its budget.
+	//
+	// Method:    run
+	// FullName:  memoryBenchmark::run
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool run();
+
+private:
+
+	// The memory of the process at one point of the benchmark
+	struct memorySample
+	{
+		int64_t liveBytes;
+		int64_t residentSetBytes;
+	};
+
+	//------------------------------------------------------------ waitForServer
+	// Brief Description
+	//  Pings the server until it answers. The server handles a client's
+	//  datagrams in order, so everything sent before has been acted on once
+	//  the reply is back. Returns the cookie the reply carries.
+	//
+	// Method:    waitForServer
+	// FullName:  memoryBenchmark::waitForServer
+	// Access:    private
+	// Returns:   std::string
+	// Parameter: boost::asio::ip::udp::socket& inSocket
+	//--------------------------------------------------------------------------
+	std::string waitForServer(
+		boost::asio::ip::udp::socket& inSocket);
+
+	//------------------------------------------------------------ sendInBatches
+	// Brief Description
+	//  Sends the messages to the server packed into batches.
+	//
+	// Method:    sendInBatches
+	// FullName:  memoryBenchmark::sendInBatches
+	// Access:    private static
+	// Returns:   void
+	// Parameter: boost::asio::ip::udp::socket& inSocket
+	// Parameter: const std::vector<dataMessage>& inMessages
+	//--------------------------------------------------------------------------
+	static void sendInBatches(
+		boost::asio::ip::udp::socket& inSocket,
+		const std::vector<dataMessage>& inMessages);
+
+	//------------------------------------------------------------- sampleMemory
+	// Brief Description
+	//  Returns the memory of the process right now.
+	//
+	// Method:    sampleMemory
+	// FullName:  memoryBenchmark::sampleMemory
+	// Access:    private static
+	// Returns:   memorySample
+	//--------------------------------------------------------------------------
+	static memorySample sampleMemory();
+
+	//--------------------------------------------------------------- reportCost
+	// Brief Description
+	//  Prints the memory each of the given number of items added between
+	//  the two samples, and returns false if the heap bytes per item exceed
+	//  the budget.
+	//
+	// Method:    reportCost
+	// FullName:  memoryBenchmark::reportCost
+	// Access:    private static
+	// Returns:   bool
+	// Parameter: const std::string& inItemName
+	// Parameter: const memorySample& inBefore
+	// Parameter: const memorySample& inAfter
+	// Parameter: const int64_t& inItems
+	// Parameter: const uint32_t& inBudgetBytes
+	//--------------------------------------------------------------------------
+	static bool reportCost(
+		const std::string& inItemName,
+		const memorySample& inBefore,
+		const memorySample& inAfter,
+		const int64_t& inItems,
+		const uint32_t& inBudgetBytes);
+
+	// Member Variables
+	int64_t m_users;
+	int64_t m_pendingMessagesPerUser;
+	int64_t m_remoteUsers;
+	int8_t m_syncPeers;
+	int64_t m_sequenceNumber;
+};
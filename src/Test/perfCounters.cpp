@@ -0,0 +1,274 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Project
+#include "perfCounters.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Each counter is opened on its own rather than as a group, since counters
+//  inherited by new threads cannot be read as a group on every kernel
+//------------------------------------------------------------------------------
+perfCounters::perfCounters()
+{
+#ifdef __linux__
+	this->openCounter(
+		"cycles",
+		PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_CPU_CYCLES);
+
+	this->openCounter(
+		"instructions",
+		PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_INSTRUCTIONS);
+
+	this->openCounter(
+		"L1D misses",
+		PERF_TYPE_HW_CACHE,
+		PERF_COUNT_HW_CACHE_L1D
+			| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+			| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+	this->openCounter(
+		"LLC misses",
+		PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_CACHE_MISSES);
+
+	this->openCounter(
+		"branch misses",
+		PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_BRANCH_MISSES);
+
+	this->openCounter(
+		"context switches",
+		PERF_TYPE_SOFTWARE,
+		PERF_COUNT_SW_CONTEXT_SWITCHES);
+#else
+	this->m_notes.push_back("perf_event_open is Linux only");
+#endif
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  Closes every descriptor opened
+//------------------------------------------------------------------------------
+perfCounters::~perfCounters()
+{
+#ifdef __linux__
+	for(const int& currentDescriptor : this->m_descriptors)
+	{
+		close(currentDescriptor);
+	}
+#endif
+};
+
+//------------------------------------------------------------------------ start
+// Implementation notes:
+//  Resetting and enabling a counter applies to the copies inherited by
+//  threads as well
+//------------------------------------------------------------------------------
+void perfCounters::start()
+{
+#ifdef __linux__
+	for(const int& currentDescriptor : this->m_descriptors)
+	{
+		ioctl(currentDescriptor, PERF_EVENT_IOC_RESET, 0);
+		ioctl(currentDescriptor, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+};
+
+//------------------------------------------------------------------------- stop
+// Implementation notes:
+//  Disabling a counter applies to the inherited copies as well
+//------------------------------------------------------------------------------
+void perfCounters::stop()
+{
+#ifdef __linux__
+	for(const int& currentDescriptor : this->m_descriptors)
+	{
+		ioctl(currentDescriptor, PERF_EVENT_IOC_DISABLE, 0);
+	}
+#endif
+};
+
+//-------------------------------------------------------------------- viewNames
+// Implementation notes:
+//  Returns a const reference to the names
+//------------------------------------------------------------------------------
+const std::vector<std::string>& perfCounters::viewNames() const
+{
+	return this->m_names;
+};
+
+//------------------------------------------------------------------ viewPerItem
+// Implementation notes:
+//  No items counts as one, so a phase that processed nothing still shows
+//  what it cost
+//------------------------------------------------------------------------------
+std::vector<double> perfCounters::viewPerItem(
+	const double& inItems) const
+{
+	std::vector<double> outCounts;
+
+	for(const int& currentDescriptor : this->m_descriptors)
+	{
+		outCounts.push_back(
+			this->readCounter(currentDescriptor) / std::max(inItems, 1.0));
+	}
+
+	return outCounts;
+};
+
+//----------------------------------------------------------------- printPerItem
+// Implementation notes:
+//  Instructions per cycle follow the instructions when both were counted
+//------------------------------------------------------------------------------
+void perfCounters::printPerItem(
+	const std::string& inItemName,
+	const double& inItems) const
+{
+	if(this->m_descriptors.empty())
+	{
+		std::cout << "  no hardware counters: " << perfCounters::joinNotes(this->m_notes) << std::endl;
+		return;
+	}
+
+	const std::ios_base::fmtflags previousFlags = std::cout.flags();
+	const std::streamsize previousPrecision = std::cout.precision();
+
+	const std::vector<double> counts =
+		this->viewPerItem(inItems);
+
+	std::cout << "  per " << inItemName << ":" << std::fixed;
+
+	for(size_t i = 0; i < counts.size(); i++)
+	{
+		std::cout << ((i == 0) ? " " : ", ")
+			<< std::setprecision((counts[i] < 10) ? 3 : 1)
+			<< counts[i] << " " << this->m_names[i];
+
+		if((this->m_names[i] == "instructions") && (i > 0)
+			&& (this->m_names[i - 1] == "cycles") && (counts[i - 1] > 0))
+		{
+			std::cout << " (" << std::setprecision(2)
+				<< (counts[i] / counts[i - 1]) << " IPC)";
+		}
+	}
+
+	if(!this->m_notes.empty())
+	{
+		std::cout << " (" << perfCounters::joinNotes(this->m_notes) << ")";
+	}
+
+	std::cout.flags(previousFlags);
+	std::cout << std::setprecision(previousPrecision) << std::endl;
+};
+
+//------------------------------------------------------------------ openCounter
+// Implementation notes:
+//  Most systems only let unprivileged users count their own user time, so
+//  a counter refused with kernel time is tried again without it. Virtual
+//  machines often have no hardware counters at all, only software ones.
+//------------------------------------------------------------------------------
+void perfCounters::openCounter(
+	const std::string& inName,
+	const uint32_t& inType,
+	const uint64_t& inConfig)
+{
+#ifdef __linux__
+	perf_event_attr attributes;
+	std::memset(&attributes, 0, sizeof(attributes));
+
+	attributes.size = sizeof(attributes);
+	attributes.type = inType;
+	attributes.config = inConfig;
+	attributes.disabled = 1;
+	attributes.inherit = 1;
+	attributes.exclude_hv = 1;
+	attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+		| PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	int descriptor = static_cast<int>(syscall(
+		__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+
+	if((descriptor < 0) && ((errno == EACCES) || (errno == EPERM)))
+	{
+		attributes.exclude_kernel = 1;
+
+		descriptor = static_cast<int>(syscall(
+			__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+
+		if((descriptor >= 0)
+			&& (std::find(this->m_notes.begin(), this->m_notes.end(), "user time only")
+				== this->m_notes.end()))
+		{
+			this->m_notes.push_back("user time only");
+		}
+	}
+
+	if(descriptor < 0)
+	{
+		this->m_notes.push_back(
+			"no " + inName + ": " + std::strerror(errno));
+		return;
+	}
+
+	this->m_names.push_back(inName);
+	this->m_descriptors.push_back(descriptor);
+#endif
+};
+
+//------------------------------------------------------------------ readCounter
+// Implementation notes:
+//  The read format is the value, the time enabled and the time running
+//------------------------------------------------------------------------------
+double perfCounters::readCounter(
+	const int& inDescriptor) const
+{
+#ifdef __linux__
+	uint64_t values[3] = {0, 0, 0};
+
+	if(read(inDescriptor, values, sizeof(values)) != sizeof(values))
+	{
+		return 0;
+	}
+
+	if((values[2] == 0) || (values[2] >= values[1]))
+	{
+		return static_cast<double>(values[0]);
+	}
+
+	return static_cast<double>(values[0]) * values[1] / values[2];
+#else
+	return 0;
+#endif
+};
+
+//-------------------------------------------------------------------- joinNotes
+// Implementation notes:
+//  Separated by semicolons, the notes contain commas
+//------------------------------------------------------------------------------
+std::string perfCounters::joinNotes(
+	const std::vector<std::string>& inNotes)
+{
+	std::string outJoined;
+
+	for(const std::string& currentNote : inNotes)
+	{
+		outJoined += (outJoined.empty() ? "" : "; ") + currentNote;
+	}
+
+	return outJoined;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class perfCounters
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Opens the hardware and software counters of this process: cycles,
+	//  instructions, L1 data cache misses, last level cache misses, branch
+	//  misses and context switches. They count every thread created after
+	//  this, and stay stopped until started. Counters the system refuses are
+	//  left out, all of them outside Linux.
+	//
+	// Method:    perfCounters
+	// FullName:  perfCounters::perfCounters
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	perfCounters();
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Closes the counters.
+	//
+	// Method:    ~perfCounters
+	// FullName:  perfCounters::~perfCounters
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~perfCounters();
+
+	//-------------------------------------------------------------------- start
+	// Brief Description
+	//  Zeroes the counters and starts them, at the beginning of a phase.
+	//
+	// Method:    start
+	// FullName:  perfCounters::start
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void start();
+
+	//--------------------------------------------------------------------- stop
+	// Brief Description
+	//  Stops the counters at the end of a phase, keeping their counts.
+	//
+	// Method:    stop
+	// FullName:  perfCounters::stop
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void stop();
+
+	//---------------------------------------------------------------- viewNames
+	// Brief Description
+	//  Returns the names of the counters that could be opened.
+	//
+	// Method:    viewNames
+	// FullName:  perfCounters::viewNames
+	// Access:    public
+	// Returns:   const std::vector<std::string>&
+	//--------------------------------------------------------------------------
+	const std::vector<std::string>& viewNames() const;
+
+	//-------------------------------------------------------------- viewPerItem
+	// Brief Description
+	//  Returns the counts of the last phase divided by the number of items
+	//  it processed, in the order of the names.
+	//
+	// Method:    viewPerItem
+	// FullName:  perfCounters::viewPerItem
+	// Access:    public
+	// Returns:   std::vector<double>
+	// Parameter: const double& inItems
+	//--------------------------------------------------------------------------
+	std::vector<double> viewPerItem(
+		const double& inItems) const;
+
+	//------------------------------------------------------------- printPerItem
+	// Brief Description
+	//  Prints the counts of the last phase divided by the number of items it
+	//  processed, on one line, or why there are none.
+	//
+	// Method:    printPerItem
+	// FullName:  perfCounters::printPerItem
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inItemName
+	// Parameter: const double& inItems
+	//--------------------------------------------------------------------------
+	void printPerItem(
+		const std::string& inItemName,
+		const double& inItems) const;
+
+private:
+
+	//-------------------------------------------------------------- openCounter
+	// Brief Description
+	//  Opens one counter and adds it to the list if the system allows it.
+	//  Kernel time is left out if counting it is not permitted.
+	//
+	// Method:    openCounter
+	// FullName:  perfCounters::openCounter
+	// Access:    private
+	// Returns:   void
+	// Parameter: const std::string& inName
+	// Parameter: const uint32_t& inType
+	// Parameter: const uint64_t& inConfig
+	//--------------------------------------------------------------------------
+	void openCounter(
+		const std::string& inName,
+		const uint32_t& inType,
+		const uint64_t& inConfig);
+
+	//-------------------------------------------------------------- readCounter
+	// Brief Description
+	//  Returns the count of a counter, scaled up for the time it was not
+	//  running when more counters were open than the processor has.
+	//
+	// Method:    readCounter
+	// FullName:  perfCounters::readCounter
+	// Access:    private
+	// Returns:   double
+	// Parameter: const int& inDescriptor
+	//--------------------------------------------------------------------------
+	double readCounter(
+		const int& inDescriptor) const;
+
+	//---------------------------------------------------------------- joinNotes
+	// Brief Description
+	//  Returns the notes on the counters as one line.
+	//
+	// Method:    joinNotes
+	// FullName:  perfCounters::joinNotes
+	// Access:    private static
+	// Returns:   std::string
+	// Parameter: const std::vector<std::string>& inNotes
+	//--------------------------------------------------------------------------
+	static std::string joinNotes(
+		const std::vector<std::string>& inNotes);
+
+	// Member Variables
+	std::vector<std::string> m_names;
+	std::vector<int> m_descriptors;
+	std::vector<std::string> m_notes;
+};
@@ -0,0 +1,168 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+
+// Project
+#include "pipelineBenchmark.h"
+#include "perfCounters.h"
+#include "../Server/server.h"
+#include "../Common/constants.h"
+#include "../Common/dataMessage.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Stores the parameters
+//------------------------------------------------------------------------------
+pipelineBenchmark::pipelineBenchmark(
+	const uint16_t& inDecodeWorkers,
+	const int64_t& inDatagrams) :
+	m_decodeWorkers(inDecodeWorkers),
+	m_datagrams(inDatagrams)
+{
+};
+
+//-------------------------------------------------------------------------- run
+// Implementation notes:
+//  The server's console output is discarded while it runs, printing every
+//  message would otherwise be the bottleneck being measured. Its loops never
+//  terminate, so the server is left running until the process exits. The
+//  counters are opened before the server so its threads inherit them, they
+//  count the senders as well. The latencies are the server's since it
+//  started, the wait for it to come up included.
+//------------------------------------------------------------------------------
+void pipelineBenchmark::run()
+{
+	boost::asio::io_service ioService;
+
+	perfCounters counters;
+
+	std::streambuf* consoleBuffer = std::cout.rdbuf(nullptr);
+
+	server* benchmarkServer = new server(
+		constants::serverListeningPorts[0],
+		0,
+		ioService,
+		this->m_decodeWorkers);
+
+	boost::thread serverThread(
+		boost::bind(&server::run, benchmarkServer));
+
+	boost::this_thread::sleep_for(
+		boost::chrono::milliseconds(200));
+
+	// several senders, the datagrams of one sender all go to one decode worker
+	std::vector<boost::asio::ip::udp::socket*> clientSockets;
+
+	for(int i = 0; i < 16; i++)
+	{
+		clientSockets.push_back(new boost::asio::ip::udp::socket(
+			ioService,
+			boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0)));
+	}
+
+	const boost::asio::ip::udp::endpoint serverEndpoint(
+		boost::asio::ip::address_v4::loopback(),
+		constants::serverListeningPorts[0]);
+
+	// alternating pings and cookieless gets, both answered with one datagram
+	std::vector<std::vector<char>> requests;
+
+	for(int64_t i = 0; i < 64; i++)
+	{
+		requests.push_back(dataMessage(
+			i,
+			(i % 2 == 0)
+				? constants::MessageType::mt_PING
+				: constants::MessageType::mt_CLIENT_GET,
+			"bench" + std::to_string(i % 16),
+			constants::serverIndexToServerName(0),
+			"blank").asCharVector());
+	}
+
+	const std::vector<const pipelineStage*> stages =
+		benchmarkServer->viewPipelineStages();
+
+	std::vector<int64_t> busyBefore;
+	std::vector<uint64_t> itemsBefore;
+
+	for(const pipelineStage* currentStage : stages)
+	{
+		busyBefore.push_back(currentStage->viewBusyNanoseconds());
+		itemsBefore.push_back(currentStage->viewItems());
+	}
+
+	counters.start();
+
+	const boost::chrono::steady_clock::time_point timeStarted =
+		boost::chrono::steady_clock::now();
+
+	for(int64_t i = 0; i < this->m_datagrams; i++)
+	{
+		boost::system::error_code ignoredError;
+
+		clientSockets[i % clientSockets.size()]->send_to(
+			boost::asio::buffer(requests[i % requests.size()]),
+			serverEndpoint, 0, ignoredError);
+	}
+
+	// wait for the state stage to catch up with what was received
+	const pipelineStage* receiveStage = stages.front();
+	const pipelineStage* egressStage = stages.back();
+	uint64_t itemsSeen = 0;
+
+	do
+	{
+		itemsSeen = egressStage->viewItems();
+
+		boost::this_thread::sleep_for(
+			boost::chrono::milliseconds(50));
+	} while(egressStage->viewItems() != itemsSeen);
+
+	const double elapsedSeconds =
+		boost::chrono::duration<double>(
+			boost::chrono::steady_clock::now() - timeStarted).count()
+		- 0.05;
+
+	counters.stop();
+
+	std::cout.rdbuf(consoleBuffer);
+
+	for(boost::asio::ip::udp::socket* currentSocket : clientSockets)
+	{
+		delete currentSocket;
+	}
+
+	const uint64_t received = receiveStage->viewItems() - itemsBefore.front();
+
+	std::cout << "Decode workers: " << this->m_decodeWorkers << std::endl;
+	std::cout << "Datagrams sent: " << this->m_datagrams
+		<< ", received: " << received << std::endl;
+	std::cout << "Throughput: " << std::fixed << std::setprecision(0)
+		<< (received / elapsedSeconds) << " datagrams/s" << std::endl;
+
+	counters.printPerItem(
+		"datagram",
+		received);
+
+	for(size_t i = 0; i < stages.size(); i++)
+	{
+		const uint64_t items = stages[i]->viewItems() - itemsBefore[i];
+		const double busySeconds =
+			(stages[i]->viewBusyNanoseconds() - busyBefore[i]) / 1e9;
+
+		std::cout << std::left << std::setw(10) << stages[i]->viewName()
+			<< std::right << std::setw(10) << items << " items"
+			<< std::setw(7) << std::setprecision(1)
+			<< (100.0 * busySeconds / elapsedSeconds) << "% busy" << std::endl;
+	}
+
+	std::cout << benchmarkServer->viewLatencyStatistics() << std::endl;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+// STL
+#include <cstdint>
+
+class pipelineBenchmark
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the benchmark of the server's UDP pipeline.
+	//
+	// Method:    pipelineBenchmark
+	// FullName:  pipelineBenchmark::pipelineBenchmark
+	// Access:    public
+	// Returns:
+	// Parameter: const uint16_t& inDecodeWorkers
+	// Parameter: const int64_t& inDatagrams
+	//--------------------------------------------------------------------------
+	pipelineBenchmark(
+		const uint16_t& inDecodeWorkers,
+		const int64_t& inDatagrams);
+
+	//---------------------------------------------------------------------- run
+	// Brief Description
+	//  Starts an Alpha server on this host, sends it the configured number of
+	//  pings and gets as fast as possible, and prints the throughput and the
+	//  utilization of every pipeline stage while it worked through them,
+	//  with the hardware counters of the process per datagram and the
+	//  latencies per message type.
+	//
+	// Method:    run
+	// FullName:  pipelineBenchmark::run
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void run();
+
+private:
+	// Member Variables
+	uint16_t m_decodeWorkers;
+	int64_t m_datagrams;
+};
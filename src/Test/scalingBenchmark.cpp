@@ -0,0 +1,418 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cctype>
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/chrono/process_cpu_clocks.hpp>
+#include <boost/chrono/thread_clock.hpp>
+
+// Project
+#include "scalingBenchmark.h"
+#include "perfCounters.h"
+#include "../Server/server.h"
+#include "../Common/constants.h"
+#include "../Common/dataMessage.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Stores the parameters
+//------------------------------------------------------------------------------
+scalingBenchmark::scalingBenchmark(
+	const uint16_t& inMaximumDecodeWorkers,
+	const int64_t& inRunMilliseconds,
+	const std::string& inFormat) :
+	m_maximumDecodeWorkers(std::max<uint16_t>(inMaximumDecodeWorkers, 1)),
+	m_runMilliseconds(inRunMilliseconds),
+	m_format(inFormat)
+{
+};
+
+//-------------------------------------------------------------------------- run
+// Implementation notes:
+//  The worker counts double, with the maximum added at the end if it is not
+//  a power of two. UDP is the only receive backend with an implementation,
+//  Bluetooth is still a placeholder, so every point is a UDP one.
+//------------------------------------------------------------------------------
+void scalingBenchmark::run()
+{
+	std::vector<scalingPoint> points;
+
+	uint16_t decodeWorkers = 1;
+
+	while(true)
+	{
+		points.push_back(this->measure(
+			decodeWorkers));
+
+		if(decodeWorkers == this->m_maximumDecodeWorkers)
+		{
+			break;
+		}
+
+		decodeWorkers = std::min<uint16_t>(
+			decodeWorkers * 2,
+			this->m_maximumDecodeWorkers);
+	}
+
+	if(this->m_format == "json")
+	{
+		scalingBenchmark::printJson(points);
+	}
+	else
+	{
+		scalingBenchmark::printCsv(points);
+	}
+};
+
+//---------------------------------------------------------------------- measure
+// Implementation notes:
+//  The load generators run in this process too, so the CPU they used by
+//  their own thread clocks is taken off the process's, leaving what the
+//  server spent. The hardware counters cannot tell the two apart and count
+//  both. The server's console output is discarded while it runs, as in the
+//  pipeline benchmark.
+//------------------------------------------------------------------------------
+scalingBenchmark::scalingPoint scalingBenchmark::measure(
+	const uint16_t& inDecodeWorkers)
+{
+	boost::asio::io_service ioService;
+
+	perfCounters counters;
+
+	std::streambuf* consoleBuffer = std::cout.rdbuf(nullptr);
+
+	server* benchmarkServer = new server(
+		constants::serverListeningPorts[0],
+		0,
+		ioService,
+		inDecodeWorkers);
+
+	boost::thread serverThread(
+		boost::bind(&server::run, benchmarkServer));
+
+	boost::this_thread::sleep_for(
+		boost::chrono::milliseconds(200));
+
+	// several clients, the datagrams of one client all go to one decode worker
+	std::vector<boost::asio::ip::udp::socket*> clientSockets;
+	std::vector<clientResult> results(8);
+
+	for(size_t i = 0; i < results.size(); i++)
+	{
+		clientSockets.push_back(new boost::asio::ip::udp::socket(
+			ioService,
+			boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0)));
+
+		results[i].requests = 0;
+		results[i].cpuNanoseconds = 0;
+	}
+
+	counters.start();
+
+	const boost::chrono::nanoseconds processCpuBefore =
+		boost::chrono::process_user_cpu_clock::now().time_since_epoch()
+		+ boost::chrono::process_system_cpu_clock::now().time_since_epoch();
+
+	const boost::chrono::steady_clock::time_point timeStarted =
+		boost::chrono::steady_clock::now();
+
+	const boost::chrono::steady_clock::time_point deadline =
+		timeStarted + boost::chrono::milliseconds(this->m_runMilliseconds);
+
+	boost::thread_group clients;
+
+	for(size_t i = 0; i < clientSockets.size(); i++)
+	{
+		clients.create_thread(boost::bind(
+			&scalingBenchmark::driveClient,
+			clientSockets[i],
+			"bench" + std::to_string(i),
+			deadline,
+			&results[i]));
+	}
+
+	clients.join_all();
+
+	counters.stop();
+
+	const double elapsedSeconds =
+		boost::chrono::duration<double>(
+			boost::chrono::steady_clock::now() - timeStarted).count();
+
+	const boost::chrono::nanoseconds processCpuAfter =
+		boost::chrono::process_user_cpu_clock::now().time_since_epoch()
+		+ boost::chrono::process_system_cpu_clock::now().time_since_epoch();
+
+	benchmarkServer->stop();
+	serverThread.join();
+	delete benchmarkServer;
+
+	for(boost::asio::ip::udp::socket* currentSocket : clientSockets)
+	{
+		delete currentSocket;
+	}
+
+	std::cout.rdbuf(consoleBuffer);
+
+	std::vector<int64_t> latencies;
+	int64_t clientCpuNanoseconds = 0;
+
+	scalingPoint outPoint;
+	outPoint.backend = "udp";
+	outPoint.decodeWorkers = inDecodeWorkers;
+	outPoint.requests = 0;
+
+	for(const clientResult& currentResult : results)
+	{
+		outPoint.requests += currentResult.requests;
+		clientCpuNanoseconds += currentResult.cpuNanoseconds;
+
+		latencies.insert(
+			latencies.end(),
+			currentResult.latencyNanoseconds.begin(),
+			currentResult.latencyNanoseconds.end());
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	outPoint.replies = latencies.size();
+	outPoint.repliesPerSecond = latencies.size() / elapsedSeconds;
+	outPoint.p50Microseconds = latencies.empty()
+		? 0
+		: latencies[latencies.size() / 2] / 1e3;
+	outPoint.p99Microseconds = latencies.empty()
+		? 0
+		: latencies[latencies.size() * 99 / 100] / 1e3;
+
+	const int64_t serverCpuNanoseconds = std::max<int64_t>(
+		(processCpuAfter - processCpuBefore).count() - clientCpuNanoseconds,
+		0);
+
+	outPoint.cpuMicrosecondsPerReply = latencies.empty()
+		? 0
+		: serverCpuNanoseconds / 1e3 / latencies.size();
+
+	outPoint.counterNames = counters.viewNames();
+	outPoint.countsPerReply = counters.viewPerItem(
+		latencies.size());
+
+	return outPoint;
+};
+
+//------------------------------------------------------------------ driveClient
+// Implementation notes:
+//  Half the requests are pings, a quarter gets and a quarter connects, the
+//  last two without a cookie, so every request is answered with exactly one
+//  datagram echoing its sequence number. A window whose replies are not all
+//  back within 100ms is given up on, so a dropped datagram costs time
+//  rather than stalling the client.
+//------------------------------------------------------------------------------
+void scalingBenchmark::driveClient(
+	boost::asio::ip::udp::socket* inSocket,
+	const std::string& inUsername,
+	const boost::chrono::steady_clock::time_point& inDeadline,
+	clientResult* outResult)
+{
+	const int64_t window = 16;
+
+	const boost::asio::ip::udp::endpoint serverEndpoint(
+		boost::asio::ip::address_v4::loopback(),
+		constants::serverListeningPorts[0]);
+
+	const boost::chrono::thread_clock::time_point cpuStarted =
+		boost::chrono::thread_clock::now();
+
+	std::vector<boost::chrono::steady_clock::time_point> timeSent(window);
+	std::vector<char> reply(constants::maximumDatagramLength);
+	int64_t sequenceNumber = 0;
+
+	while(boost::chrono::steady_clock::now() < inDeadline)
+	{
+		const int64_t windowBegin = sequenceNumber;
+
+		for(int64_t i = 0; i < window; i++, sequenceNumber++)
+		{
+			constants::MessageType messageType = constants::MessageType::mt_PING;
+
+			if(sequenceNumber % 4 == 2)
+			{
+				messageType = constants::MessageType::mt_CLIENT_GET;
+			}
+			else if(sequenceNumber % 4 == 3)
+			{
+				messageType = constants::MessageType::mt_CLIENT_CONNECT;
+			}
+
+			const dataMessage request(
+				sequenceNumber,
+				messageType,
+				inUsername,
+				constants::serverIndexToServerName(0),
+				"blank");
+
+			boost::system::error_code ignoredError;
+
+			timeSent[sequenceNumber % window] = boost::chrono::steady_clock::now();
+
+			inSocket->send_to(
+				boost::asio::buffer(request.asCharVector()),
+				serverEndpoint, 0, ignoredError);
+
+			outResult->requests++;
+		}
+
+		const boost::chrono::steady_clock::time_point windowDeadline =
+			boost::chrono::steady_clock::now() + boost::chrono::milliseconds(100);
+
+		int64_t repliesLeft = window;
+
+		while((repliesLeft > 0)
+			&& (boost::chrono::steady_clock::now() < windowDeadline))
+		{
+			boost::system::error_code error;
+
+			if(inSocket->available(error) == 0)
+			{
+				boost::this_thread::yield();
+				continue;
+			}
+
+			boost::asio::ip::udp::endpoint senderEndpoint;
+
+			const size_t replyLength = inSocket->receive_from(
+				boost::asio::buffer(reply),
+				senderEndpoint, 0, error);
+
+			try
+			{
+				const dataMessage replyMessage(
+					std::vector<char>(reply.begin(), reply.begin() + replyLength));
+
+				const int64_t replySequenceNumber =
+					replyMessage.viewSequenceNumber();
+
+				if((replySequenceNumber >= windowBegin)
+					&& (replySequenceNumber < sequenceNumber))
+				{
+					outResult->latencyNanoseconds.push_back(
+						boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+							boost::chrono::steady_clock::now()
+							- timeSent[replySequenceNumber % window]).count());
+
+					repliesLeft--;
+				}
+			}
+			catch(...)
+			{
+				// a late reply of an abandoned window or garbage, ignored
+			}
+		}
+	}
+
+	outResult->cpuNanoseconds =
+		boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+			boost::chrono::thread_clock::now() - cpuStarted).count();
+};
+
+//--------------------------------------------------------------------- printCsv
+// Implementation notes:
+//  One line per point, in the order the points were measured. Every point
+//  opened the same counters, the first one names their columns.
+//------------------------------------------------------------------------------
+void scalingBenchmark::printCsv(
+	const std::vector<scalingPoint>& inPoints)
+{
+	std::cout << "backend,decode_workers,requests,replies,replies_per_second,"
+		<< "p50_microseconds,p99_microseconds,cpu_microseconds_per_reply";
+
+	if(!inPoints.empty())
+	{
+		for(const std::string& currentName : inPoints.front().counterNames)
+		{
+			std::cout << ',' << scalingBenchmark::counterColumn(currentName);
+		}
+	}
+
+	std::cout << std::endl;
+
+	for(const scalingPoint& currentPoint : inPoints)
+	{
+		std::cout << std::fixed
+			<< currentPoint.backend << ','
+			<< currentPoint.decodeWorkers << ','
+			<< currentPoint.requests << ','
+			<< currentPoint.replies << ','
+			<< std::setprecision(0) << currentPoint.repliesPerSecond << ','
+			<< std::setprecision(1) << currentPoint.p50Microseconds << ','
+			<< currentPoint.p99Microseconds << ','
+			<< std::setprecision(2) << currentPoint.cpuMicrosecondsPerReply;
+
+		for(const double& currentCount : currentPoint.countsPerReply)
+		{
+			std::cout << ',' << currentCount;
+		}
+
+		std::cout << std::endl;
+	}
+};
+
+//-------------------------------------------------------------------- printJson
+// Implementation notes:
+//  Same fields and names as the CSV columns
+//------------------------------------------------------------------------------
+void scalingBenchmark::printJson(
+	const std::vector<scalingPoint>& inPoints)
+{
+	std::cout << "[" << std::endl;
+
+	for(size_t i = 0; i < inPoints.size(); i++)
+	{
+		const scalingPoint& currentPoint = inPoints[i];
+
+		std::cout << std::fixed
+			<< "  {\"backend\": \"" << currentPoint.backend << "\""
+			<< ", \"decode_workers\": " << currentPoint.decodeWorkers
+			<< ", \"requests\": " << currentPoint.requests
+			<< ", \"replies\": " << currentPoint.replies
+			<< ", \"replies_per_second\": " << std::setprecision(0) << currentPoint.repliesPerSecond
+			<< ", \"p50_microseconds\": " << std::setprecision(1) << currentPoint.p50Microseconds
+			<< ", \"p99_microseconds\": " << currentPoint.p99Microseconds
+			<< ", \"cpu_microseconds_per_reply\": " << std::setprecision(2)
+			<< currentPoint.cpuMicrosecondsPerReply;
+
+		for(size_t j = 0; j < currentPoint.countsPerReply.size(); j++)
+		{
+			std::cout << ", \"" << scalingBenchmark::counterColumn(currentPoint.counterNames[j])
+				<< "\": " << currentPoint.countsPerReply[j];
+		}
+
+		std::cout << "}" << ((i + 1 < inPoints.size()) ? "," : "") << std::endl;
+	}
+
+	std::cout << "]" << std::endl;
+};
+
+
+//---------------------------------------------------------------- counterColumn
+// Implementation notes:
+//  Lower case, with underscores for the spaces
+//------------------------------------------------------------------------------
+std::string scalingBenchmark::counterColumn(
+	const std::string& inCounterName)
+{
+	std::string outColumn(inCounterName);
+
+	std::transform(
+		outColumn.begin(),
+		outColumn.end(),
+		outColumn.begin(),
+		::tolower);
+
+	std::replace(outColumn.begin(), outColumn.end(), ' ', '_');
+
+	return outColumn + "_per_reply";
+};
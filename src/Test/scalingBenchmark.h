@@ -0,0 +1,150 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/chrono.hpp>
+
+class scalingBenchmark
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the benchmark of how the server scales with the
+	//  number of decode workers.
+	//
+	// Method:    scalingBenchmark
+	// FullName:  scalingBenchmark::scalingBenchmark
+	// Access:    public
+	// Returns:
+	// Parameter: const uint16_t& inMaximumDecodeWorkers
+	// Parameter: const int64_t& inRunMilliseconds
+	// Parameter: const std::string& inFormat
+	//--------------------------------------------------------------------------
+	scalingBenchmark(
+		const uint16_t& inMaximumDecodeWorkers,
+		const int64_t& inRunMilliseconds,
+		const std::string& inFormat);
+
+	//---------------------------------------------------------------------- run
+	// Brief Description
+	//  Runs an Alpha server with 1, 2, 4, ... up to the maximum number of
+	//  decode workers, each under the same mix of pings, gets and connects
+	//  for the configured time, and prints the scaling curve as CSV or JSON,
+	//  with the hardware counters per reply where the system allows them.
+	//
+	// Method:    run
+	// FullName:  scalingBenchmark::run
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void run();
+
+private:
+
+	// One point of the scaling curve
+	struct scalingPoint
+	{
+		std::string backend;
+		uint16_t decodeWorkers;
+		uint64_t requests;
+		uint64_t replies;
+		double repliesPerSecond;
+		double p50Microseconds;
+		double p99Microseconds;
+		double cpuMicrosecondsPerReply;
+		std::vector<std::string> counterNames;
+		std::vector<double> countsPerReply;
+	};
+
+	// What one load generating client did during a run
+	struct clientResult
+	{
+		uint64_t requests;
+		std::vector<int64_t> latencyNanoseconds;
+		int64_t cpuNanoseconds;
+	};
+
+	//------------------------------------------------------------------ measure
+	// Brief Description
+	//  Starts a server with the given number of decode workers, puts it
+	//  under load for the configured time, stops it and returns the point.
+	//
+	// Method:    measure
+	// FullName:  scalingBenchmark::measure
+	// Access:    private
+	// Returns:   scalingPoint
+	// Parameter: const uint16_t& inDecodeWorkers
+	//--------------------------------------------------------------------------
+	scalingPoint measure(
+		const uint16_t& inDecodeWorkers);
+
+	//-------------------------------------------------------------- driveClient
+	// Brief Description
+	//  Load generating client. Sends a window of requests, waits for their
+	//  replies and times each one, over and over until the deadline.
+	//
+	// Method:    driveClient
+	// FullName:  scalingBenchmark::driveClient
+	// Access:    private static
+	// Returns:   void
+	// Parameter: boost::asio::ip::udp::socket* inSocket
+	// Parameter: const std::string& inUsername
+	// Parameter: const boost::chrono::steady_clock::time_point& inDeadline
+	// Parameter: clientResult* outResult
+	//--------------------------------------------------------------------------
+	static void driveClient(
+		boost::asio::ip::udp::socket* inSocket,
+		const std::string& inUsername,
+		const boost::chrono::steady_clock::time_point& inDeadline,
+		clientResult* outResult);
+
+	//----------------------------------------------------------------- printCsv
+	// Brief Description
+	//  Prints the scaling curve as CSV with a header line.
+	//
+	// Method:    printCsv
+	// FullName:  scalingBenchmark::printCsv
+	// Access:    private static
+	// Returns:   void
+	// Parameter: const std::vector<scalingPoint>& inPoints
+	//--------------------------------------------------------------------------
+	static void printCsv(
+		const std::vector<scalingPoint>& inPoints);
+
+	//---------------------------------------------------------------- printJson
+	// Brief Description
+	//  Prints the scaling curve as a JSON array with one object per point.
+	//
+	// Method:    printJson
+	// FullName:  scalingBenchmark::printJson
+	// Access:    private static
+	// Returns:   void
+	// Parameter: const std::vector<scalingPoint>& inPoints
+	//--------------------------------------------------------------------------
+	static void printJson(
+		const std::vector<scalingPoint>& inPoints);
+
+	//------------------------------------------------------------ counterColumn
+	// Brief Description
+	//  Returns the CSV column and JSON field name of a counter.
+	//
+	// Method:    counterColumn
+	// FullName:  scalingBenchmark::counterColumn
+	// Access:    private static
+	// Returns:   std::string
+	// Parameter: const std::string& inCounterName
+	//--------------------------------------------------------------------------
+	static std::string counterColumn(
+		const std::string& inCounterName);
+
+	// Member Variables
+	uint16_t m_maximumDecodeWorkers;
+	int64_t m_runMilliseconds;
+	std::string m_format;
+};
@@ -1,12 +1,96 @@
 #include <boost/lambda/lambda.hpp>
+#include <boost/thread.hpp>
 #include <iostream>
 #include <iterator>
 #include <algorithm>
 #include <string>
 #include <vector>
 
-int main()
+#include "pipelineBenchmark.h"
+#include "codecBenchmark.h"
+#include "scalingBenchmark.h"
+#include "memoryBenchmark.h"
+#include "flightDumpDecoder.h"
+#include "xdpBenchmark.h"
+#include "behaviourChecks.h"
+#include "../Common/constants.h"
+
+int main(int argc, char* argv[])
 {
+	// test pipeline [decode workers] [datagrams]
+	if((argc > 1) && (std::string(argv[1]) == "pipeline"))
+	{
+		pipelineBenchmark benchmark(
+			(argc > 2) ? std::stoi(argv[2]) : constants::pipelineDecodeWorkers,
+			(argc > 3) ? std::stoll(argv[3]) : 200000);
+
+		benchmark.run();
+		return 0;
+	}
+
+	// test codec [iterations]
+	if((argc > 1) && (std::string(argv[1]) == "codec"))
+	{
+		codecBenchmark benchmark(
+			(argc > 2) ? std::stoll(argv[2]) : 1000000);
+
+		benchmark.run();
+		return 0;
+	}
+
+	// test scaling [maximum decode workers] [milliseconds per run] [csv|json]
+	if((argc > 1) && (std::string(argv[1]) == "scaling"))
+	{
+		scalingBenchmark benchmark(
+			(argc > 2) ? std::stoi(argv[2]) : boost::thread::hardware_concurrency(),
+			(argc > 3) ? std::stoll(argv[3]) : 2000,
+			(argc > 4) ? argv[4] : "csv");
+
+		benchmark.run();
+		return 0;
+	}
+
+	// test memory [users] [pending messages per user] [remote users] [sync peers]
+	if((argc > 1) && (std::string(argv[1]) == "memory"))
+	{
+		memoryBenchmark benchmark(
+			(argc > 2) ? std::stoll(argv[2]) : 10000,
+			(argc > 3) ? std::stoll(argv[3]) : 4,
+			(argc > 4) ? std::stoll(argv[4]) : 10000,
+			(argc > 5) ? std::stoi(argv[5]) : 4);
+
+		// fails the run when a budget is exceeded
+		return benchmark.run() ? 0 : 1;
+	}
+
+	// test flight <dump file>
+	if((argc > 2) && (std::string(argv[1]) == "flight"))
+	{
+		flightDumpDecoder decoder(
+			argv[2]);
+
+		return decoder.run() ? 0 : 1;
+	}
+
+	// test xdp <receive interface> <send interface> [milliseconds per backend]
+	if((argc > 3) && (std::string(argv[1]) == "xdp"))
+	{
+		xdpBenchmark benchmark(
+			argv[2],
+			argv[3],
+			(argc > 4) ? std::stoll(argv[4]) : 2000);
+
+		return benchmark.run() ? 0 : 1;
+	}
+
+	// test checks
+	if((argc > 1) && (std::string(argv[1]) == "checks"))
+	{
+		behaviourChecks checks;
+
+		return checks.run() ? 0 : 1;
+	}
+
 	std::string a = "a";
 	std::string b = "b";
 	std::string c = "c";
@@ -0,0 +1,499 @@
+// STL
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#endif
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+// Project
+#include "xdpBenchmark.h"
+#include "../Server/xdpSocket.h"
+#include "../Common/constants.h"
+#include "../Common/dataMessage.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Alpha's port is the one flooded
+//------------------------------------------------------------------------------
+xdpBenchmark::xdpBenchmark(
+	const std::string& inReceiveInterface,
+	const std::string& inSendInterface,
+	const int64_t& inRunMilliseconds) :
+	m_receiveInterface(inReceiveInterface),
+	m_sendInterface(inSendInterface),
+	m_runMilliseconds(inRunMilliseconds),
+	m_port(constants::serverListeningPorts[0]),
+	m_receiveAddress(0)
+{
+};
+
+//-------------------------------------------------------------------------- run
+// Implementation notes:
+//  On veth the kernel handles a frame, the XDP program and the UDP stack
+//  included, on the core that sent it. The CPU time of the receiving
+//  thread alone leaves that out for every backend, so the time of the
+//  whole process, generator included, is shown as well. The generator's
+//  own share is the same for every backend.
+//------------------------------------------------------------------------------
+bool xdpBenchmark::run()
+{
+#ifdef __linux__
+	if(!this->readInterfaces())
+	{
+		return false;
+	}
+
+	this->buildFrames();
+
+	std::vector<backendResult> results;
+	results.push_back(this->measure("recvmsg"));
+	results.push_back(this->measure("recvmmsg"));
+	results.push_back(this->measure("af_xdp"));
+
+	std::cout << "Receiving on " << this->m_receiveInterface << ", sending on "
+		<< this->m_sendInterface << ", " << this->m_runMilliseconds
+		<< " ms per backend" << std::endl;
+
+	std::cout << std::left << std::setw(10) << "backend" << std::right
+		<< std::setw(12) << "sent"
+		<< std::setw(12) << "received"
+		<< std::setw(12) << "received/s"
+		<< std::setw(18) << "/s receiver core"
+		<< std::setw(18) << "/s process core" << std::endl;
+
+	std::cout << std::fixed << std::setprecision(0);
+
+	for(const backendResult& currentResult : results)
+	{
+		std::cout << std::left << std::setw(10) << currentResult.backend << std::right
+			<< std::setw(12) << currentResult.sent
+			<< std::setw(12) << currentResult.received
+			<< std::setw(12) << (currentResult.received / currentResult.seconds)
+			<< std::setw(18) << ((currentResult.receiverCpuNanoseconds > 0)
+				? currentResult.received * 1e9 / currentResult.receiverCpuNanoseconds
+				: 0.0)
+			<< std::setw(18) << ((currentResult.processCpuNanoseconds > 0)
+				? currentResult.received * 1e9 / currentResult.processCpuNanoseconds
+				: 0.0)
+			<< std::endl;
+	}
+
+	return true;
+#else
+	std::cout << "AF_XDP is Linux only" << std::endl;
+	return false;
+#endif
+};
+
+#ifdef __linux__
+//--------------------------------------------------------------- readInterfaces
+// Implementation notes:
+//  Read through the ioctls of an ordinary socket
+//------------------------------------------------------------------------------
+bool xdpBenchmark::readInterfaces()
+{
+	const int descriptor = socket(AF_INET, SOCK_DGRAM, 0);
+
+	ifreq request;
+	bool isUsable = (descriptor >= 0);
+
+	std::memset(&request, 0, sizeof(request));
+	std::strncpy(request.ifr_name, this->m_receiveInterface.c_str(), IFNAMSIZ - 1);
+	isUsable = isUsable && (ioctl(descriptor, SIOCGIFHWADDR, &request) == 0);
+	std::memcpy(this->m_receiveMac, request.ifr_hwaddr.sa_data, 6);
+
+	std::memset(&request, 0, sizeof(request));
+	std::strncpy(request.ifr_name, this->m_receiveInterface.c_str(), IFNAMSIZ - 1);
+	request.ifr_addr.sa_family = AF_INET;
+	isUsable = isUsable && (ioctl(descriptor, SIOCGIFADDR, &request) == 0);
+	this->m_receiveAddress = ntohl(
+		reinterpret_cast<sockaddr_in*>(&request.ifr_addr)->sin_addr.s_addr);
+
+	std::memset(&request, 0, sizeof(request));
+	std::strncpy(request.ifr_name, this->m_sendInterface.c_str(), IFNAMSIZ - 1);
+	isUsable = isUsable && (ioctl(descriptor, SIOCGIFHWADDR, &request) == 0);
+	std::memcpy(this->m_sendMac, request.ifr_hwaddr.sa_data, 6);
+
+	if(descriptor >= 0)
+	{
+		close(descriptor);
+	}
+
+	if(!isUsable)
+	{
+		std::cout << "Cannot use " << this->m_receiveInterface << " and "
+			<< this->m_sendInterface << ": " << std::strerror(errno) << std::endl;
+		std::cout << "Both must exist, the receiving end with an IPv4 address, "
+			<< "for example:" << std::endl;
+		std::cout << "  ip link add xdp0 type veth peer name xdp1" << std::endl;
+		std::cout << "  ip addr add 10.11.0.1/24 dev xdp0" << std::endl;
+		std::cout << "  ip link set xdp0 up && ip link set xdp1 up" << std::endl;
+		std::cout << "  test xdp xdp0 xdp1" << std::endl;
+	}
+
+	return isUsable;
+};
+
+//------------------------------------------------------------------ buildFrames
+// Implementation notes:
+//  The source address is on the receiving end's subnet, so the socket
+//  backends pass reverse path filtering. The UDP checksum is left out.
+//------------------------------------------------------------------------------
+void xdpBenchmark::buildFrames()
+{
+	const uint32_t sourceAddress = this->m_receiveAddress + 1;
+
+	for(uint16_t i = 0; i < 64; i++)
+	{
+		const std::vector<char> payload = dataMessage(
+			i,
+			constants::MessageType::mt_PING,
+			"bench" + std::to_string(i),
+			constants::serverIndexToServerName(0),
+			"blank").asCharVector();
+
+		const uint16_t sourcePort = 40000 + i;
+		const uint16_t datagramLength = static_cast<uint16_t>(payload.size() + 8);
+		const uint16_t packetLength = datagramLength + 20;
+
+		std::vector<uint8_t> frame(14 + packetLength, 0);
+
+		std::memcpy(&frame[0], this->m_receiveMac, 6);
+		std::memcpy(&frame[6], this->m_sendMac, 6);
+		frame[12] = 0x08;
+
+		frame[14] = 0x45;
+		frame[16] = static_cast<uint8_t>(packetLength >> 8);
+		frame[17] = static_cast<uint8_t>(packetLength);
+		frame[20] = 0x40;
+		frame[22] = 64;
+		frame[23] = 17;
+
+		for(int j = 0; j < 4; j++)
+		{
+			frame[26 + j] = static_cast<uint8_t>(sourceAddress >> (24 - 8 * j));
+			frame[30 + j] = static_cast<uint8_t>(this->m_receiveAddress >> (24 - 8 * j));
+		}
+
+		const uint16_t checksum = xdpSocket::headerChecksum(&frame[14]);
+		frame[24] = static_cast<uint8_t>(checksum >> 8);
+		frame[25] = static_cast<uint8_t>(checksum);
+
+		frame[34] = static_cast<uint8_t>(sourcePort >> 8);
+		frame[35] = static_cast<uint8_t>(sourcePort);
+		frame[36] = static_cast<uint8_t>(this->m_port >> 8);
+		frame[37] = static_cast<uint8_t>(this->m_port);
+		frame[38] = static_cast<uint8_t>(datagramLength >> 8);
+		frame[39] = static_cast<uint8_t>(datagramLength);
+
+		std::memcpy(&frame[42], payload.data(), payload.size());
+
+		this->m_frames.push_back(std::vector<char>(frame.begin(), frame.end()));
+	}
+};
+
+//---------------------------------------------------------------------- measure
+// Implementation notes:
+//  The socket backends read the same way the server does, with the kernel
+//  stamping every datagram. The receiver keeps going briefly after the
+//  generator stops to take what is still queued.
+//------------------------------------------------------------------------------
+xdpBenchmark::backendResult xdpBenchmark::measure(
+	const std::string& inBackend)
+{
+	backendResult outResult;
+	outResult.backend = inBackend;
+	outResult.sent = 0;
+	outResult.received = 0;
+	outResult.seconds = 1;
+	outResult.receiverCpuNanoseconds = 0;
+	outResult.processCpuNanoseconds = 0;
+
+	int socketDescriptor = -1;
+	xdpSocket* receiveSocket = nullptr;
+
+	if(inBackend == "af_xdp")
+	{
+		try
+		{
+			receiveSocket = new xdpSocket(
+				this->m_receiveInterface,
+				0,
+				this->m_port);
+		}
+		catch(std::exception& exception)
+		{
+			std::cout << "Skipping " << inBackend << ": " << exception.what() << std::endl;
+			return outResult;
+		}
+	}
+	else
+	{
+		socketDescriptor = socket(AF_INET, SOCK_DGRAM, 0);
+
+		const int enabled = 1;
+		const int bufferLength = 4 * 1024 * 1024;
+		const timeval timeout = {0, 10000};
+
+		setsockopt(socketDescriptor, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+		setsockopt(socketDescriptor, SOL_SOCKET, SO_RCVBUF, &bufferLength, sizeof(bufferLength));
+		setsockopt(socketDescriptor, SOL_SOCKET, SO_TIMESTAMPNS, &enabled, sizeof(enabled));
+		setsockopt(socketDescriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		sockaddr_in address;
+		std::memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_port = htons(this->m_port);
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+		if(bind(socketDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			std::cout << "Skipping " << inBackend << ": port " << this->m_port
+				<< " is in use" << std::endl;
+			close(socketDescriptor);
+			return outResult;
+		}
+	}
+
+	const boost::chrono::steady_clock::time_point timeStarted =
+		boost::chrono::steady_clock::now();
+
+	const boost::chrono::steady_clock::time_point deadline =
+		timeStarted + boost::chrono::milliseconds(this->m_runMilliseconds);
+
+	const int64_t processCpuBefore =
+		xdpBenchmark::cpuNanoseconds(CLOCK_PROCESS_CPUTIME_ID);
+
+	boost::thread receiver(boost::bind(
+		&xdpBenchmark::receiveLoop,
+		this,
+		inBackend,
+		socketDescriptor,
+		receiveSocket,
+		deadline + boost::chrono::milliseconds(100),
+		&outResult));
+
+	outResult.sent = this->generateLoop(
+		deadline);
+
+	receiver.join();
+
+	outResult.processCpuNanoseconds =
+		xdpBenchmark::cpuNanoseconds(CLOCK_PROCESS_CPUTIME_ID) - processCpuBefore;
+
+	outResult.seconds = boost::chrono::duration<double>(
+		boost::chrono::steady_clock::now() - timeStarted).count();
+
+	delete receiveSocket;
+
+	if(socketDescriptor >= 0)
+	{
+		close(socketDescriptor);
+	}
+
+	return outResult;
+};
+
+//------------------------------------------------------------------ receiveLoop
+// Implementation notes:
+//  The clock is read once per batch, or per thousand datagrams for
+//  recvmsg, so reading it costs every backend about the same
+//------------------------------------------------------------------------------
+void xdpBenchmark::receiveLoop(
+	const std::string& inBackend,
+	const int& inSocketDescriptor,
+	xdpSocket* inXdpSocket,
+	const boost::chrono::steady_clock::time_point& inDeadline,
+	backendResult* outResult)
+{
+	const uint16_t batchSize = constants::pipelineBatchSize;
+
+	std::vector<char> buffer(constants::maximumDatagramLength);
+	std::vector<std::vector<char>> buffers(batchSize, std::vector<char>(2048));
+	std::vector<std::vector<char>> controls(batchSize, std::vector<char>(CMSG_SPACE(sizeof(timespec))));
+	std::vector<sockaddr_in> senders(batchSize);
+	std::vector<iovec> vectors(batchSize);
+	std::vector<mmsghdr> headers(batchSize);
+
+	for(uint16_t i = 0; i < batchSize; i++)
+	{
+		vectors[i].iov_base = buffers[i].data();
+		vectors[i].iov_len = buffers[i].size();
+
+		std::memset(&headers[i], 0, sizeof(mmsghdr));
+		headers[i].msg_hdr.msg_name = &senders[i];
+		headers[i].msg_hdr.msg_iov = &vectors[i];
+		headers[i].msg_hdr.msg_iovlen = 1;
+		headers[i].msg_hdr.msg_control = controls[i].data();
+	}
+
+	uint64_t received = 0;
+	const int64_t cpuBefore = xdpBenchmark::cpuNanoseconds(CLOCK_THREAD_CPUTIME_ID);
+
+	if(inXdpSocket != nullptr)
+	{
+		size_t receivedLength = 0;
+		boost::asio::ip::udp::endpoint senderEndpoint;
+
+		while(boost::chrono::steady_clock::now() < inDeadline)
+		{
+			pollfd descriptor;
+			descriptor.fd = inXdpSocket->viewDescriptor();
+			descriptor.events = POLLIN;
+
+			if(poll(&descriptor, 1, 10) <= 0)
+			{
+				continue;
+			}
+
+			while(inXdpSocket->receive(buffer, receivedLength, senderEndpoint))
+			{
+				received++;
+			}
+		}
+	}
+	else if(inBackend == "recvmmsg")
+	{
+		while(boost::chrono::steady_clock::now() < inDeadline)
+		{
+			for(uint16_t i = 0; i < batchSize; i++)
+			{
+				headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+				headers[i].msg_hdr.msg_controllen = controls[i].size();
+			}
+
+			const int result = recvmmsg(
+				inSocketDescriptor,
+				headers.data(),
+				batchSize,
+				MSG_WAITFORONE,
+				nullptr);
+
+			received += (result > 0) ? result : 0;
+		}
+	}
+	else
+	{
+		msghdr& header = headers[0].msg_hdr;
+		header.msg_iov = &vectors[0];
+		vectors[0].iov_base = buffer.data();
+		vectors[0].iov_len = buffer.size();
+
+		uint64_t sinceClockRead = 0;
+
+		while(true)
+		{
+			header.msg_namelen = sizeof(sockaddr_in);
+			header.msg_controllen = controls[0].size();
+
+			if(recvmsg(inSocketDescriptor, &header, 0) >= 0)
+			{
+				received++;
+
+				if(++sinceClockRead < 1000)
+				{
+					continue;
+				}
+			}
+
+			sinceClockRead = 0;
+
+			if(boost::chrono::steady_clock::now() >= inDeadline)
+			{
+				break;
+			}
+		}
+	}
+
+	outResult->receiverCpuNanoseconds =
+		xdpBenchmark::cpuNanoseconds(CLOCK_THREAD_CPUTIME_ID) - cpuBefore;
+	outResult->received = received;
+};
+
+//----------------------------------------------------------------- generateLoop
+// Implementation notes:
+//  The packet socket skips the queueing discipline, so frames go straight
+//  to the veth and on to the receiving end
+//------------------------------------------------------------------------------
+uint64_t xdpBenchmark::generateLoop(
+	const boost::chrono::steady_clock::time_point& inDeadline)
+{
+	const int descriptor = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_IP));
+
+	if(descriptor < 0)
+	{
+		std::cout << "Cannot open a packet socket: " << std::strerror(errno) << std::endl;
+		return 0;
+	}
+
+	const int enabled = 1;
+	setsockopt(descriptor, SOL_PACKET, PACKET_QDISC_BYPASS, &enabled, sizeof(enabled));
+
+	sockaddr_ll address;
+	std::memset(&address, 0, sizeof(address));
+	address.sll_family = AF_PACKET;
+	address.sll_protocol = htons(ETH_P_IP);
+	address.sll_ifindex = if_nametoindex(this->m_sendInterface.c_str());
+
+	bind(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+
+	std::vector<iovec> vectors(this->m_frames.size());
+	std::vector<mmsghdr> headers(this->m_frames.size());
+
+	for(size_t i = 0; i < this->m_frames.size(); i++)
+	{
+		vectors[i].iov_base = this->m_frames[i].data();
+		vectors[i].iov_len = this->m_frames[i].size();
+
+		std::memset(&headers[i], 0, sizeof(mmsghdr));
+		headers[i].msg_hdr.msg_iov = &vectors[i];
+		headers[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	uint64_t outSent = 0;
+
+	while(boost::chrono::steady_clock::now() < inDeadline)
+	{
+		const int result = sendmmsg(
+			descriptor,
+			headers.data(),
+			headers.size(),
+			0);
+
+		outSent += (result > 0) ? result : 0;
+	}
+
+	close(descriptor);
+
+	return outSent;
+};
+
+//--------------------------------------------------------------- cpuNanoseconds
+// Implementation notes:
+//  Both clocks count user and kernel time
+//------------------------------------------------------------------------------
+int64_t xdpBenchmark::cpuNanoseconds(
+	const int& inClock)
+{
+	timespec now;
+	clock_gettime(inClock, &now);
+
+	return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+};
+#endif
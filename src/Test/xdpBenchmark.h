@@ -0,0 +1,166 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Linux only, so only declared here
+class xdpSocket;
+
+class xdpBenchmark
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the benchmark of the server's receive backends over
+	//  a veth pair. The receiving end needs an IPv4 address, datagrams are
+	//  sent to it from the next address up, through the sending end.
+	//
+	// Method:    xdpBenchmark
+	// FullName:  xdpBenchmark::xdpBenchmark
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inReceiveInterface
+	// Parameter: const std::string& inSendInterface
+	// Parameter: const int64_t& inRunMilliseconds
+	//--------------------------------------------------------------------------
+	xdpBenchmark(
+		const std::string& inReceiveInterface,
+		const std::string& inSendInterface,
+		const int64_t& inRunMilliseconds);
+
+	//---------------------------------------------------------------------- run
+	// Brief Description
+	//  Floods the listening port of an Alpha server with pings through the
+	//  sending end for the configured time per backend, receiving them with
+	//  recvmsg, recvmmsg and AF_XDP in turn, and prints the datagrams each
+	//  received per second of CPU time. Returns false if the interfaces
+	//  cannot be used, or outside Linux.
+	//
+	// Method:    run
+	// FullName:  xdpBenchmark::run
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool run();
+
+private:
+
+	// What one backend did during a run
+	struct backendResult
+	{
+		std::string backend;
+		uint64_t sent;
+		uint64_t received;
+		double seconds;
+		int64_t receiverCpuNanoseconds;
+		int64_t processCpuNanoseconds;
+	};
+
+	//----------------------------------------------------------- readInterfaces
+	// Brief Description
+	//  Reads the link addresses of both ends and the network address of the
+	//  receiving end, and prints why if it cannot.
+	//
+	// Method:    readInterfaces
+	// FullName:  xdpBenchmark::readInterfaces
+	// Access:    private
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool readInterfaces();
+
+	//-------------------------------------------------------------- buildFrames
+	// Brief Description
+	//  Builds the Ethernet frames the generator sends, pings from one
+	//  source port per frame.
+	//
+	// Method:    buildFrames
+	// FullName:  xdpBenchmark::buildFrames
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void buildFrames();
+
+	//------------------------------------------------------------------ measure
+	// Brief Description
+	//  Opens the backend on the listening port, floods it until the
+	//  deadline and returns what it received. Returns nothing received for
+	//  a backend that cannot be opened, and prints why.
+	//
+	// Method:    measure
+	// FullName:  xdpBenchmark::measure
+	// Access:    private
+	// Returns:   xdpBenchmark::backendResult
+	// Parameter: const std::string& inBackend
+	//--------------------------------------------------------------------------
+	backendResult measure(
+		const std::string& inBackend);
+
+	//-------------------------------------------------------------- receiveLoop
+	// Brief Description
+	//  Receives with the backend until the deadline, from the UDP socket or
+	//  the AF_XDP socket, whichever is open, counting the datagrams and the
+	//  CPU time of the thread.
+	//
+	// Method:    receiveLoop
+	// FullName:  xdpBenchmark::receiveLoop
+	// Access:    private
+	// Returns:   void
+	// Parameter: const std::string& inBackend
+	// Parameter: const int& inSocketDescriptor
+	// Parameter: xdpSocket* inXdpSocket
+	// Parameter: const boost::chrono::steady_clock::time_point& inDeadline
+	// Parameter: backendResult* outResult
+	//--------------------------------------------------------------------------
+	void receiveLoop(
+		const std::string& inBackend,
+		const int& inSocketDescriptor,
+		xdpSocket* inXdpSocket,
+		const boost::chrono::steady_clock::time_point& inDeadline,
+		backendResult* outResult);
+
+	//------------------------------------------------------------- generateLoop
+	// Brief Description
+	//  Sends the frames from a packet socket on the sending end as fast as
+	//  it can until the deadline, and returns how many went out.
+	//
+	// Method:    generateLoop
+	// FullName:  xdpBenchmark::generateLoop
+	// Access:    private
+	// Returns:   uint64_t
+	// Parameter: const boost::chrono::steady_clock::time_point& inDeadline
+	//--------------------------------------------------------------------------
+	uint64_t generateLoop(
+		const boost::chrono::steady_clock::time_point& inDeadline);
+
+	//----------------------------------------------------------- cpuNanoseconds
+	// Brief Description
+	//  Returns the CPU time of the clock, the calling thread's or the
+	//  process's.
+	//
+	// Method:    cpuNanoseconds
+	// FullName:  xdpBenchmark::cpuNanoseconds
+	// Access:    private static
+	// Returns:   int64_t
+	// Parameter: const int& inClock
+	//--------------------------------------------------------------------------
+	static int64_t cpuNanoseconds(
+		const int& inClock);
+
+	// Member Variables
+	std::string m_receiveInterface;
+	std::string m_sendInterface;
+	int64_t m_runMilliseconds;
+	uint16_t m_port;
+
+	uint8_t m_receiveMac[6];
+	uint8_t m_sendMac[6];
+	uint32_t m_receiveAddress;
+
+	std::vector<std::vector<char>> m_frames;
+};